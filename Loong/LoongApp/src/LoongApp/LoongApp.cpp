@@ -5,6 +5,7 @@
 #include <glad/glad.h>
 
 #include "LoongApp/LoongApp.h"
+#include "LoongFoundation/LoongJobSystem.h"
 #include "LoongFoundation/LoongLogger.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
@@ -130,9 +131,11 @@ public:
         }
         glfwSwapInterval(1);
         InitImGui();
+        Foundation::LoongJobSystem::Initialize();
     }
     ~Impl()
     {
+        Foundation::LoongJobSystem::Uninitialize();
         if (glfwWindow_ != nullptr) {
             glfwDestroyWindow(glfwWindow_);
             glfwWindow_ = nullptr;
@@ -209,6 +212,9 @@ public:
             ImGui_ImplGlfw_NewFrame();
             ImGui::NewFrame();
 
+            // e.g. the GL uploads of the jobs finished since the last frame
+            Foundation::LoongJobSystem::RunMainThreadJobs();
+
             self_->BeginFrameSignal_.emit();
 
             self_->UpdateSignal_.emit();
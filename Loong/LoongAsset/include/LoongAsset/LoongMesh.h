@@ -4,15 +4,68 @@
 #pragma once
 
 #include "LoongAsset/LoongVertex.h"
+#include "LoongAsset/LoongVertexPacking.h"
 #include <cstdint>
 #include <vector>
 
-namespace Loong::Math {
-class AABB;
-}
-
 namespace Loong::Asset {
 
+// A simplified version of a mesh, it shares the vertices with the full resolution mesh
+struct LoongMeshLod {
+    std::vector<uint32_t> indices;
+    // The max geometric deviation from the full resolution mesh, in the mesh's space
+    float error { 0.0F };
+
+    template <class Archive>
+    bool Serialize(Archive& archive) { return archive(indices, error); }
+};
+
+// The form of a mesh in model files, only one array of each attribute is used depending on the flags
+struct LoongMeshStorage {
+    // Positions, UVs and normal/tangent frames are stored in separate arrays instead of LoongVertex
+    static constexpr uint32_t kCompactVertices = 1U << 0U;
+    // Positions are quantized in the AABB, only with kCompactVertices
+    static constexpr uint32_t kQuantizedPositions = 1U << 1U;
+    // UVs are half floats, only with kCompactVertices
+    static constexpr uint32_t kHalfUvs = 1U << 2U;
+    // Indices of all the LODs are 16 bits
+    static constexpr uint32_t k16BitIndices = 1U << 3U;
+
+    uint32_t flags { 0 };
+    uint32_t materialIndex { 0 };
+    Math::AABB aabb {};
+
+    std::vector<LoongVertex> vertices {};
+    std::vector<Math::Vector3> positions {};
+    std::vector<LoongQuantizedPosition> quantizedPositions {};
+    std::vector<Math::Vector2> uvs {};
+    std::vector<uint32_t> halfUvs {};
+    std::vector<LoongPackedFrame> frames {};
+
+    // LOD 0 first
+    std::vector<std::vector<uint32_t>> lodIndices {};
+    std::vector<std::vector<uint16_t>> lodShortIndices {};
+    std::vector<float> lodErrors {};
+
+    template <class Archive>
+    bool Serialize(Archive& archive)
+    {
+        if (!archive(flags, materialIndex, aabb)) {
+            return false;
+        }
+        bool isOk = true;
+        if (flags & kCompactVertices) {
+            isOk = (flags & kQuantizedPositions) ? archive(quantizedPositions) : archive(positions);
+            isOk = isOk && ((flags & kHalfUvs) ? archive(halfUvs) : archive(uvs));
+            isOk = isOk && archive(frames);
+        } else {
+            isOk = archive(vertices);
+        }
+        isOk = isOk && ((flags & k16BitIndices) ? archive(lodShortIndices) : archive(lodIndices));
+        return isOk && archive(lodErrors);
+    }
+};
+
 class LoongMesh {
 public:
     LoongMesh() = default;
@@ -24,9 +77,22 @@ public:
 
     const Math::AABB& GetAABB() const { return aabb_; }
 
+    // LOD 1 to N, the full resolution mesh is LOD 0, the errors are in ascending order
+    const std::vector<LoongMeshLod>& GetLods() const { return lods_; }
+
+    std::vector<LoongMeshLod>& GetLods() { return lods_; }
+
+    void SetLods(std::vector<LoongMeshLod>&& lods) { lods_ = std::move(lods); }
+
+    // The layout before LoongMeshStorage, without LODs
     template <class Archive>
     bool Serialize(Archive& archive) { return archive(vertices_, indices_, materialIndex_, aabb_); }
 
+    // Only kCompactVertices and kQuantizedPositions of flags are taken, the others are decided by the mesh
+    void Store(uint32_t flags, LoongMeshStorage& storage) const;
+
+    bool Load(LoongMeshStorage&& storage);
+
 private:
     void UpdateAABB();
 
@@ -35,6 +101,7 @@ protected:
     std::vector<uint32_t> indices_;
     uint32_t materialIndex_ { 0 };
     Math::AABB aabb_ {};
+    std::vector<LoongMeshLod> lods_ {};
 };
 
 }
@@ -3,6 +3,7 @@
 //
 #pragma once
 
+#include "LoongAsset/LoongMesh.h"
 #include "LoongFoundation/LoongMath.h"
 #include <memory>
 #include <string>
@@ -11,11 +12,16 @@
 
 namespace Loong::Asset {
 
-class LoongMesh;
+class LoongModelFile;
 
 class LoongModel {
 public:
+    // Any version of the model files
     explicit LoongModel(const std::string& path);
+    // A version 1 or legacy file already in memory, the path is only for the logs
+    explicit LoongModel(const uint8_t* data, uint64_t size, const std::string& path);
+    // Decode the vertices of a version 2 file, only for the CPU side users, e.g. ray casting
+    explicit LoongModel(const LoongModelFile& file);
     explicit LoongModel(std::vector<LoongMesh*>&& meshes, std::vector<std::string>&& materialNames)
         : meshes_(std::move(meshes))
         , materialNames_(std::move(materialNames))
@@ -44,12 +50,64 @@ public:
 
     explicit operator bool() const { return meshes_.size() > 0 || materialNames_.size() > 0; }
 
+    // How the meshes are written in version 1 files, see LoongMeshStorage
+    void SetStorageFlags(uint32_t flags) { storageFlags_ = flags; }
+
+    template <class Archive>
+    bool Serialize(Archive& archive)
+    {
+        uint32_t magic = kFileMagic;
+        uint32_t version = kFileVersion;
+        if (!archive(magic, version) || magic != kFileMagic || version != kFileVersion) {
+            return false;
+        }
+        std::vector<LoongMeshStorage> meshes;
+        if constexpr (Archive::kIsInputArchive) {
+            return archive(meshes, materialNames_, aabb_) && LoadMeshes(std::move(meshes));
+        } else {
+            StoreMeshes(meshes);
+            return archive(meshes, materialNames_, aabb_);
+        }
+    }
+
+    // Model files without the magic, the LOD section is optional
     template <class Archive>
-    bool Serialize(Archive& archive) { return archive(meshes_, materialNames_, aabb_); }
+    bool SerializeLegacy(Archive& archive)
+    {
+        static_assert(Archive::kIsInputArchive);
+        if (!archive(meshes_, materialNames_, aabb_)) {
+            return false;
+        }
+        uint32_t lodTag = 0;
+        if (!archive(lodTag)) {
+            return true;
+        }
+        if (lodTag != kLodSectionTag) {
+            return false;
+        }
+        for (auto* mesh : meshes_) {
+            if (!archive(mesh->GetLods())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static constexpr uint32_t kFileMagic = 0x4C444D4C; // "LMDL"
+    static constexpr uint32_t kFileVersion = 1;
+    static constexpr uint32_t kLodSectionTag = 0x444F4C4C; // "LLOD"
 
 private:
     void UpdateAABB();
 
+    void StoreMeshes(std::vector<LoongMeshStorage>& meshes) const;
+
+    bool LoadMeshes(std::vector<LoongMeshStorage>&& meshes);
+
+    bool LoadFile(const LoongModelFile& file);
+
+    bool LoadLegacyFile(const uint8_t* data, uint64_t size);
+
     void Clear();
 
 private:
@@ -57,6 +115,7 @@ private:
     std::vector<std::string> materialNames_ {};
 
     Math::AABB aabb_ {};
+    uint32_t storageFlags_ { LoongMeshStorage::kCompactVertices };
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongFileSystem/LoongMappedFile.h"
+#include "LoongFoundation/LoongMath.h"
+#include "LoongFoundation/LoongSerializer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Loong::Asset {
+
+class LoongModel;
+
+// The .lgmdl layout since version 2, it is used in place, without parsing:
+//   LoongModelFileHeader
+//   LoongModelFileSection[sectionCount]
+//   the sections, each one is 16 bytes aligned
+// The vertices and indices of each mesh are also 16 bytes aligned blobs, in the GPU layout, so they are uploaded
+// straight from the mapped file. All the offsets are from the start of the file. The numbers are little endian.
+struct LoongModelFileHeader {
+    uint32_t magic; // LoongModel::kFileMagic
+    uint32_t version;
+    uint32_t sectionCount;
+    uint32_t meshCount;
+    Math::AABB aabb;
+};
+
+struct LoongModelFileSection {
+    uint32_t tag;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// The records of the kMeshSectionTag section
+struct LoongModelFileMesh {
+    // The vertices are LoongPackedVertex<uint32_t> with kHalfUvs, otherwise LoongPackedVertex<Math::Vector2>
+    static constexpr uint32_t kHalfUvs = 1U << 0U;
+    // The indices are uint16_t, otherwise uint32_t
+    static constexpr uint32_t k16BitIndices = 1U << 1U;
+
+    uint32_t flags;
+    uint32_t materialIndex;
+    Math::AABB aabb;
+    uint32_t vertexCount;
+    uint32_t indexCount; // of all the LODs
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint32_t firstLod; // in the kLodSectionTag section
+    uint32_t lodCount; // LOD 0 included
+};
+
+// The records of the kLodSectionTag section
+struct LoongModelFileLod {
+    uint32_t indexOffset; // in the indices of the mesh
+    uint32_t indexCount;
+    float error;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(LoongModelFileHeader) == 40);
+static_assert(sizeof(LoongModelFileSection) == 24);
+static_assert(sizeof(LoongModelFileMesh) == 64);
+static_assert(sizeof(LoongModelFileLod) == 16);
+// The files are used in place, so the numbers are never swapped
+static_assert(!Foundation::Internal::kIsBigEndian, "The model files are little endian, big endian hosts are not supported");
+
+// A version 2 model file, the views point into the file, which is memory mapped if it can be
+class LoongModelFile {
+public:
+    static constexpr uint32_t kFileVersion = 2;
+    static constexpr uint32_t kMeshSectionTag = 0x4853454D; // "MESH"
+    static constexpr uint32_t kLodSectionTag = 0x53444F4C; // "LODS"
+    // uint32_t count, then uint32_t length and the characters of each name
+    static constexpr uint32_t kMaterialSectionTag = 0x4C52544D; // "MTRL"
+    static constexpr uint32_t kVertexSectionTag = 0x54524556; // "VERT"
+    static constexpr uint32_t kIndexSectionTag = 0x58444E49; // "INDX"
+
+    struct MeshView {
+        const LoongModelFileMesh* mesh { nullptr };
+        const void* vertices { nullptr };
+        const void* indices { nullptr };
+        const LoongModelFileLod* lods { nullptr };
+
+        uint32_t GetVertexSize() const;
+
+        uint32_t GetIndexSize() const { return (mesh->flags & LoongModelFileMesh::k16BitIndices) ? sizeof(uint16_t) : sizeof(uint32_t); }
+    };
+
+    // Only checks the magic and the version
+    static bool IsModelFile(const FS::LoongMappedFile& file);
+
+    // The whole file of the model
+    static void Write(const LoongModel& model, std::vector<uint8_t>& output);
+
+    LoongModelFile(FS::LoongMappedFile&& file, const std::string& path);
+    LoongModelFile(const LoongModelFile&) = delete;
+    LoongModelFile(LoongModelFile&&) = delete;
+    ~LoongModelFile() = default;
+    LoongModelFile& operator=(const LoongModelFile&) = delete;
+    LoongModelFile& operator=(LoongModelFile&&) = delete;
+
+    bool operator!() const { return !isValid_; }
+
+    explicit operator bool() const { return isValid_; }
+
+    uint32_t GetMeshCount() const { return uint32_t(meshes_.size()); }
+
+    const MeshView& GetMesh(uint32_t index) const { return meshes_[index]; }
+
+    const std::vector<std::string>& GetMaterialNames() const { return materialNames_; }
+
+    const Math::AABB& GetAABB() const { return header_->aabb; }
+
+    // The bytes of the vertices and indices
+    uint64_t GetGeometrySize() const;
+
+    const FS::LoongMappedFile& GetFile() const { return file_; }
+
+private:
+    bool Parse();
+
+    FS::LoongMappedFile file_;
+    std::string path_ {};
+    const LoongModelFileHeader* header_ { nullptr };
+    std::vector<MeshView> meshes_ {};
+    std::vector<std::string> materialNames_ {};
+    bool isValid_ { false };
+};
+
+}
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "LoongFoundation/LoongMath.h"
+#include "LoongFoundation/LoongSerializer.h"
 
 namespace Loong::Asset {
 
@@ -18,4 +19,14 @@ struct LoongVertex {
 
 static_assert(sizeof(LoongVertex) == sizeof(float) * 14);
 
+}
+
+namespace Loong::Foundation {
+
+template <>
+struct LoongArchiveBitwise<Asset::LoongVertex> {
+    static constexpr bool kValue = true;
+    using Scalar = float;
+};
+
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongAsset/LoongVertex.h"
+#include "LoongFoundation/LoongMath.h"
+#include "LoongFoundation/LoongSerializer.h"
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace Loong::Asset {
+
+// The normal and the tangent of a vertex, both octahedral encoded as signed normalized integers. tangent[2] is the
+// handedness of the bitangent: bitangent = cross(normal, tangent) * sign(tangent[2]), tangent[3] is unused.
+struct LoongPackedFrame {
+    int16_t normal[2];
+    int8_t tangent[4];
+};
+
+static_assert(sizeof(LoongPackedFrame) == 8);
+
+// A position quantized to 16 bits per axis inside the AABB of its mesh
+struct LoongQuantizedPosition {
+    uint16_t x;
+    uint16_t y;
+    uint16_t z;
+};
+
+static_assert(sizeof(LoongQuantizedPosition) == 6);
+
+// The vertex layout on the GPU, and in the model files since version 2. UV is Math::Vector2, or uint32_t for half
+// floats (see PackHalfUv). The shaders decode the normal and tangent frame.
+template <class UV>
+struct LoongPackedVertex {
+    Math::Vector3 position;
+    UV uv;
+    LoongPackedFrame frame;
+};
+
+static_assert(sizeof(LoongPackedVertex<uint32_t>) == 24);
+static_assert(sizeof(LoongPackedVertex<Math::Vector2>) == 28);
+
+// Octahedral encoding of a direction, the result is in [-1, 1]
+Math::Vector2 OctEncode(const Math::Vector3& direction);
+
+Math::Vector3 OctDecode(const Math::Vector2& encoded);
+
+LoongPackedFrame PackFrame(const LoongVertex& vertex);
+
+void UnpackFrame(const LoongPackedFrame& frame, LoongVertex& vertex);
+
+// Two half floats, x in the low 16 bits, which is also the memory layout of a half2 vertex attribute
+uint32_t PackHalfUv(const Math::Vector2& uv);
+
+Math::Vector2 UnpackHalfUv(uint32_t packed);
+
+// Half floats lose sub-texel precision for UVs far away from the origin, e.g. heavily tiled surfaces
+bool CanUseHalfUvs(const std::vector<LoongVertex>& vertices);
+
+std::vector<LoongPackedVertex<uint32_t>> PackVerticesWithHalfUvs(const std::vector<LoongVertex>& vertices);
+
+std::vector<LoongPackedVertex<Math::Vector2>> PackVertices(const std::vector<LoongVertex>& vertices);
+
+template <class UV>
+LoongVertex UnpackVertex(const LoongPackedVertex<UV>& packed)
+{
+    LoongVertex vertex {};
+    vertex.position = packed.position;
+    if constexpr (std::is_same_v<UV, uint32_t>) {
+        vertex.uv = UnpackHalfUv(packed.uv);
+    } else {
+        vertex.uv = packed.uv;
+    }
+    UnpackFrame(packed.frame, vertex);
+    return vertex;
+}
+
+LoongQuantizedPosition QuantizePosition(const Math::Vector3& position, const Math::AABB& aabb);
+
+Math::Vector3 DequantizePosition(const LoongQuantizedPosition& position, const Math::AABB& aabb);
+
+}
+
+namespace Loong::Foundation {
+
+template <>
+struct LoongArchiveBitwise<Asset::LoongPackedFrame> {
+    static constexpr bool kValue = true;
+    static void SwapBytes(Asset::LoongPackedFrame& frame)
+    {
+        ByteSwap(frame.normal[0]);
+        ByteSwap(frame.normal[1]);
+    }
+};
+
+template <>
+struct LoongArchiveBitwise<Asset::LoongQuantizedPosition> {
+    static constexpr bool kValue = true;
+    using Scalar = uint16_t;
+};
+
+}
@@ -3,7 +3,7 @@
 //
 
 #include "LoongAsset/LoongImage.h"
-#include "LoongFileSystem/LoongFileSystem.h"
+#include "LoongFileSystem/LoongFile.h"
 #include "LoongFoundation/LoongLogger.h"
 
 #ifdef _MSC_VER
@@ -21,6 +21,25 @@
 
 namespace Loong::Asset {
 
+namespace {
+
+// The image is decoded while the file is read through its read-ahead buffer, the whole file is never in memory
+const stbi_io_callbacks kFileCallbacks {
+    [](void* user, char* data, int size) -> int {
+        auto count = static_cast<FS::LoongFile*>(user)->Read(data, uint64_t(size));
+        return count < 0 ? 0 : int(count);
+    },
+    [](void* user, int n) {
+        auto* file = static_cast<FS::LoongFile*>(user);
+        file->Seek(uint64_t(file->Tell() + n));
+    },
+    [](void* user) -> int {
+        return static_cast<FS::LoongFile*>(user)->IsEof() ? 1 : 0;
+    },
+};
+
+}
+
 LoongImage::LoongImage(const std::string& path)
 {
     Load(path);
@@ -41,16 +60,14 @@ void LoongImage::FlipVertically()
 
 bool LoongImage::Load(const std::string& path)
 {
-    int64_t fileSize = FS::LoongFileSystem::GetFileSize(path);
-    if (fileSize <= 0) {
-        LOONG_ERROR("Failed to load image '{}': Wrong file size", path);
+    FS::LoongFile file(path);
+    if (!file) {
+        LOONG_ERROR("Failed to load image '{}': Open file failed", path);
         return false;
     }
-    std::vector<uint8_t> buffer(fileSize);
-    assert(FS::LoongFileSystem::LoadFileContent(path, buffer.data(), fileSize) == fileSize);
 
     LOONG_TRACE("Load image '{}' to '0x{:0X}'", path, intptr_t(this));
-    buffer_ = reinterpret_cast<char*>(stbi_load_from_memory(buffer.data(), int(fileSize), &width_, &height_, &channelCount_, 0));
+    buffer_ = reinterpret_cast<char*>(stbi_load_from_callbacks(&kFileCallbacks, &file, &width_, &height_, &channelCount_, 0));
     if (buffer_ == nullptr) {
         LOONG_ERROR("Failed to load image '{}'", path);
         width_ = 0;
@@ -4,6 +4,7 @@
 
 #include "LoongAsset/LoongMesh.h"
 #include <algorithm>
+#include <limits>
 
 namespace Loong::Asset {
 
@@ -15,6 +16,106 @@ LoongMesh::LoongMesh(std::vector<LoongVertex>&& vertices, std::vector<uint32_t>&
     UpdateAABB();
 }
 
+void LoongMesh::Store(uint32_t flags, LoongMeshStorage& storage) const
+{
+    storage = LoongMeshStorage {};
+    storage.flags = flags & (LoongMeshStorage::kCompactVertices | LoongMeshStorage::kQuantizedPositions);
+    if ((storage.flags & LoongMeshStorage::kCompactVertices) == 0) {
+        storage.flags &= ~LoongMeshStorage::kQuantizedPositions;
+    } else if (CanUseHalfUvs(vertices_)) {
+        storage.flags |= LoongMeshStorage::kHalfUvs;
+    }
+    if (vertices_.size() <= std::numeric_limits<uint16_t>::max() + size_t(1)) {
+        storage.flags |= LoongMeshStorage::k16BitIndices;
+    }
+    storage.materialIndex = materialIndex_;
+    storage.aabb = aabb_;
+
+    if (storage.flags & LoongMeshStorage::kCompactVertices) {
+        for (auto& vertex : vertices_) {
+            if (storage.flags & LoongMeshStorage::kQuantizedPositions) {
+                storage.quantizedPositions.push_back(QuantizePosition(vertex.position, aabb_));
+            } else {
+                storage.positions.push_back(vertex.position);
+            }
+            if (storage.flags & LoongMeshStorage::kHalfUvs) {
+                storage.halfUvs.push_back(PackHalfUv(vertex.uv));
+            } else {
+                storage.uvs.push_back(vertex.uv);
+            }
+            storage.frames.push_back(PackFrame(vertex));
+        }
+    } else {
+        storage.vertices = vertices_;
+    }
+
+    auto storeIndices = [&storage](const std::vector<uint32_t>& indices) {
+        if (storage.flags & LoongMeshStorage::k16BitIndices) {
+            storage.lodShortIndices.emplace_back(indices.begin(), indices.end());
+        } else {
+            storage.lodIndices.push_back(indices);
+        }
+    };
+    storeIndices(indices_);
+    storage.lodErrors.push_back(0.0F);
+    for (auto& lod : lods_) {
+        storeIndices(lod.indices);
+        storage.lodErrors.push_back(lod.error);
+    }
+}
+
+bool LoongMesh::Load(LoongMeshStorage&& storage)
+{
+    vertices_.clear();
+    indices_.clear();
+    lods_.clear();
+    materialIndex_ = storage.materialIndex;
+    aabb_ = storage.aabb;
+
+    if (storage.flags & LoongMeshStorage::kCompactVertices) {
+        bool isQuantized = storage.flags & LoongMeshStorage::kQuantizedPositions;
+        bool isHalfUv = storage.flags & LoongMeshStorage::kHalfUvs;
+        size_t vertexCount = storage.frames.size();
+        if ((isQuantized ? storage.quantizedPositions.size() : storage.positions.size()) != vertexCount
+            || (isHalfUv ? storage.halfUvs.size() : storage.uvs.size()) != vertexCount) {
+            return false;
+        }
+        vertices_.resize(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i) {
+            auto& vertex = vertices_[i];
+            vertex.position = isQuantized ? DequantizePosition(storage.quantizedPositions[i], aabb_) : storage.positions[i];
+            vertex.uv = isHalfUv ? UnpackHalfUv(storage.halfUvs[i]) : storage.uvs[i];
+            UnpackFrame(storage.frames[i], vertex);
+        }
+    } else {
+        vertices_ = std::move(storage.vertices);
+    }
+
+    std::vector<std::vector<uint32_t>> lodIndices;
+    if (storage.flags & LoongMeshStorage::k16BitIndices) {
+        for (auto& indices : storage.lodShortIndices) {
+            lodIndices.emplace_back(indices.begin(), indices.end());
+        }
+    } else {
+        lodIndices = std::move(storage.lodIndices);
+    }
+    if (lodIndices.empty() || lodIndices.size() != storage.lodErrors.size()) {
+        return false;
+    }
+    for (auto& indices : lodIndices) {
+        for (auto index : indices) {
+            if (index >= vertices_.size()) {
+                return false;
+            }
+        }
+    }
+    indices_ = std::move(lodIndices[0]);
+    for (size_t i = 1; i < lodIndices.size(); ++i) {
+        lods_.push_back({ std::move(lodIndices[i]), storage.lodErrors[i] });
+    }
+    return true;
+}
+
 void LoongMesh::UpdateAABB()
 {
     if (vertices_.empty()) {
@@ -4,49 +4,68 @@
 
 #include "LoongAsset/LoongModel.h"
 #include "LoongAsset/LoongMesh.h"
-#include "LoongFileSystem/LoongFileSystem.h"
+#include "LoongAsset/LoongModelFile.h"
+#include "LoongAsset/LoongVertexPacking.h"
+#include "LoongFileSystem/LoongMappedFile.h"
 #include "LoongFoundation/LoongLogger.h"
 #include "LoongFoundation/LoongSerializer.h"
 #include "LoongFoundation/LoongStringUtils.h"
 #include <algorithm>
+#include <cstring>
 
 namespace Loong::Asset {
 
-struct MemoryInputStream : public Foundation::LoongArchiveInputStream {
-    explicit MemoryInputStream(uint8_t* buffer, size_t size)
-        : buffer_(buffer)
-        , size_(size)
-    {
-    }
-    bool operator()(void* d, size_t l)
-    {
-        if (l <= size_) {
-            memcpy(d, buffer_, l);
-            buffer_ += l;
-            size_ -= l;
-            return true;
+template <class UV>
+void UnpackVertices(const LoongModelFile::MeshView& view, LoongMeshStorage& storage)
+{
+    auto* vertices = static_cast<const LoongPackedVertex<UV>*>(view.vertices);
+    for (uint32_t i = 0; i < view.mesh->vertexCount; ++i) {
+        storage.positions.push_back(vertices[i].position);
+        if constexpr (std::is_same_v<UV, uint32_t>) {
+            storage.halfUvs.push_back(vertices[i].uv);
+        } else {
+            storage.uvs.push_back(vertices[i].uv);
         }
-        return false;
+        storage.frames.push_back(vertices[i].frame);
     }
+}
 
-private:
-    uint8_t* buffer_ { nullptr };
-    size_t size_ { 0 };
-};
+template <class Index>
+void UnpackLods(const LoongModelFile::MeshView& view, std::vector<std::vector<uint32_t>>& lodIndices)
+{
+    auto* indices = static_cast<const Index*>(view.indices);
+    for (uint32_t i = 0; i < view.mesh->lodCount; ++i) {
+        auto& lod = view.lods[i];
+        lodIndices.emplace_back(indices + lod.indexOffset, indices + lod.indexOffset + lod.indexCount);
+    }
+}
 
 LoongModel::LoongModel(const std::string& path)
 {
-    int64_t fileSize = FS::LoongFileSystem::GetFileSize(path);
-    if (fileSize <= 0) {
-        LOONG_ERROR("Failed to load model '{}': Wrong file size", path);
+    FS::LoongMappedFile file(path);
+    if (!file) {
+        LOONG_ERROR("Failed to load model '{}': Can not read the file", path);
         return;
     }
-    std::vector<uint8_t> buffer(fileSize);
-    assert(FS::LoongFileSystem::LoadFileContent(path, buffer.data(), fileSize) == fileSize);
 
-    MemoryInputStream inputStream(buffer.data(), buffer.size());
+    bool isOk = false;
+    if (LoongModelFile::IsModelFile(file)) {
+        LoongModelFile modelFile(std::move(file), path);
+        isOk = modelFile && LoadFile(modelFile);
+    } else {
+        isOk = LoadLegacyFile(file.GetData(), file.GetSize());
+    }
+    if (isOk) {
+        LOONG_TRACE("Load model '{}' to 0x{:0X} succeed", path, intptr_t(this));
+    } else {
+        Clear();
+        LOONG_ERROR("Load model '{}' to 0x{:0X} failed", path, intptr_t(this));
+    }
+}
 
-    if (Foundation::Serialize(*this, inputStream)) {
+LoongModel::LoongModel(const uint8_t* data, uint64_t size, const std::string& path)
+{
+    if (LoadLegacyFile(data, size)) {
         LOONG_TRACE("Load model '{}' to 0x{:0X} succeed", path, intptr_t(this));
     } else {
         Clear();
@@ -54,6 +73,13 @@ LoongModel::LoongModel(const std::string& path)
     }
 }
 
+LoongModel::LoongModel(const LoongModelFile& file)
+{
+    if (!LoadFile(file)) {
+        Clear();
+    }
+}
+
 LoongModel::~LoongModel()
 {
     LOONG_TRACE("Unload model '0x{:0X}'", intptr_t(this));
@@ -83,6 +109,69 @@ void LoongModel::UpdateAABB()
     }
 }
 
+void LoongModel::StoreMeshes(std::vector<LoongMeshStorage>& meshes) const
+{
+    meshes.resize(meshes_.size());
+    for (size_t i = 0; i < meshes_.size(); ++i) {
+        meshes_[i]->Store(storageFlags_, meshes[i]);
+    }
+}
+
+bool LoongModel::LoadMeshes(std::vector<LoongMeshStorage>&& meshes)
+{
+    for (auto* mesh : meshes_) {
+        delete mesh;
+    }
+    meshes_.clear();
+    for (auto& storage : meshes) {
+        auto* mesh = new LoongMesh;
+        meshes_.push_back(mesh);
+        if (!mesh->Load(std::move(storage))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LoongModel::LoadLegacyFile(const uint8_t* data, uint64_t size)
+{
+    Foundation::LoongMemoryInputStream inputStream(data, size);
+    if (size >= sizeof(uint32_t) && memcmp(data, &kFileMagic, sizeof(uint32_t)) == 0) {
+        return Foundation::Serialize(*this, inputStream);
+    }
+    Foundation::Internal::ArchiveHelper<Foundation::LoongMemoryInputStream> archive(inputStream);
+    return SerializeLegacy(archive);
+}
+
+bool LoongModel::LoadFile(const LoongModelFile& file)
+{
+    std::vector<LoongMeshStorage> meshes(file.GetMeshCount());
+    for (uint32_t i = 0; i < file.GetMeshCount(); ++i) {
+        auto& view = file.GetMesh(i);
+        auto& storage = meshes[i];
+        storage.flags = LoongMeshStorage::kCompactVertices;
+        storage.materialIndex = view.mesh->materialIndex;
+        storage.aabb = view.mesh->aabb;
+        if (view.mesh->flags & LoongModelFileMesh::kHalfUvs) {
+            storage.flags |= LoongMeshStorage::kHalfUvs;
+            UnpackVertices<uint32_t>(view, storage);
+        } else {
+            UnpackVertices<Math::Vector2>(view, storage);
+        }
+        if (view.mesh->flags & LoongModelFileMesh::k16BitIndices) {
+            UnpackLods<uint16_t>(view, storage.lodIndices);
+        } else {
+            UnpackLods<uint32_t>(view, storage.lodIndices);
+        }
+        for (uint32_t lod = 0; lod < view.mesh->lodCount; ++lod) {
+            storage.lodErrors.push_back(view.lods[lod].error);
+        }
+    }
+    materialNames_ = file.GetMaterialNames();
+    aabb_ = file.GetAABB();
+    return LoadMeshes(std::move(meshes));
+}
+
 void LoongModel::Clear()
 {
     for (auto* mesh : meshes_) {
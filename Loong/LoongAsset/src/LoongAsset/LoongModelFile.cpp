@@ -0,0 +1,264 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongAsset/LoongModelFile.h"
+#include "LoongAsset/LoongMesh.h"
+#include "LoongAsset/LoongModel.h"
+#include "LoongAsset/LoongVertexPacking.h"
+#include "LoongFoundation/LoongLogger.h"
+#include <cstring>
+#include <limits>
+
+namespace Loong::Asset {
+
+namespace {
+
+constexpr uint64_t kAlignment = 16;
+
+// Pad the output to the alignment, then reserve the bytes, returns where they start
+uint64_t Reserve(std::vector<uint8_t>& output, uint64_t size)
+{
+    output.resize((output.size() + kAlignment - 1) / kAlignment * kAlignment, 0);
+    uint64_t offset = output.size();
+    output.resize(output.size() + size, 0);
+    return offset;
+}
+
+uint64_t Append(std::vector<uint8_t>& output, const void* data, uint64_t size)
+{
+    uint64_t offset = Reserve(output, size);
+    if (size > 0) {
+        memcpy(output.data() + offset, data, size);
+    }
+    return offset;
+}
+
+bool IsShortIndexable(const LoongMesh& mesh)
+{
+    return mesh.GetVertices().size() <= std::numeric_limits<uint16_t>::max() + size_t(1);
+}
+
+}
+
+uint32_t LoongModelFile::MeshView::GetVertexSize() const
+{
+    if (mesh->flags & LoongModelFileMesh::kHalfUvs) {
+        return sizeof(LoongPackedVertex<uint32_t>);
+    }
+    return sizeof(LoongPackedVertex<Math::Vector2>);
+}
+
+bool LoongModelFile::IsModelFile(const FS::LoongMappedFile& file)
+{
+    if (file.GetSize() < sizeof(LoongModelFileHeader)) {
+        return false;
+    }
+    auto* header = reinterpret_cast<const LoongModelFileHeader*>(file.GetData());
+    return header->magic == LoongModel::kFileMagic && header->version == kFileVersion;
+}
+
+void LoongModelFile::Write(const LoongModel& model, std::vector<uint8_t>& output)
+{
+    auto& meshes = model.GetMeshes();
+    std::vector<LoongModelFileMesh> meshRecords(meshes.size());
+    std::vector<LoongModelFileLod> lodRecords;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        auto& mesh = *meshes[i];
+        auto& record = meshRecords[i];
+        record = LoongModelFileMesh {};
+        record.flags = (CanUseHalfUvs(mesh.GetVertices()) ? LoongModelFileMesh::kHalfUvs : 0U)
+            | (IsShortIndexable(mesh) ? LoongModelFileMesh::k16BitIndices : 0U);
+        record.materialIndex = mesh.GetMaterialIndex();
+        record.aabb = mesh.GetAABB();
+        record.vertexCount = uint32_t(mesh.GetVertices().size());
+        record.firstLod = uint32_t(lodRecords.size());
+        record.lodCount = uint32_t(mesh.GetLods().size() + 1);
+
+        lodRecords.push_back({ 0, uint32_t(mesh.GetIndices().size()), 0.0F, 0 });
+        record.indexCount = uint32_t(mesh.GetIndices().size());
+        for (auto& lod : mesh.GetLods()) {
+            lodRecords.push_back({ record.indexCount, uint32_t(lod.indices.size()), lod.error, 0 });
+            record.indexCount += uint32_t(lod.indices.size());
+        }
+    }
+
+    std::vector<uint8_t> materials;
+    auto appendUint32 = [&materials](uint32_t value) {
+        auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        materials.insert(materials.end(), bytes, bytes + sizeof(value));
+    };
+    appendUint32(uint32_t(model.GetMaterialNames().size()));
+    for (auto& name : model.GetMaterialNames()) {
+        appendUint32(uint32_t(name.size()));
+        materials.insert(materials.end(), name.begin(), name.end());
+    }
+
+    constexpr uint32_t kSectionCount = 5;
+    output.clear();
+    Reserve(output, sizeof(LoongModelFileHeader) + kSectionCount * sizeof(LoongModelFileSection));
+
+    LoongModelFileSection sections[kSectionCount] {};
+    sections[0] = { kMeshSectionTag, 0, Reserve(output, meshRecords.size() * sizeof(LoongModelFileMesh)), meshRecords.size() * sizeof(LoongModelFileMesh) };
+    sections[1] = { kLodSectionTag, 0, Append(output, lodRecords.data(), lodRecords.size() * sizeof(LoongModelFileLod)), lodRecords.size() * sizeof(LoongModelFileLod) };
+    sections[2] = { kMaterialSectionTag, 0, Append(output, materials.data(), materials.size()), materials.size() };
+
+    sections[3] = { kVertexSectionTag, 0, Reserve(output, 0), 0 };
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        auto& vertices = meshes[i]->GetVertices();
+        if (meshRecords[i].flags & LoongModelFileMesh::kHalfUvs) {
+            auto packed = PackVerticesWithHalfUvs(vertices);
+            meshRecords[i].vertexOffset = Append(output, packed.data(), packed.size() * sizeof(packed[0]));
+        } else {
+            auto packed = PackVertices(vertices);
+            meshRecords[i].vertexOffset = Append(output, packed.data(), packed.size() * sizeof(packed[0]));
+        }
+    }
+    sections[3].size = output.size() - sections[3].offset;
+
+    sections[4] = { kIndexSectionTag, 0, Reserve(output, 0), 0 };
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        auto& mesh = *meshes[i];
+        std::vector<uint32_t> indices(mesh.GetIndices());
+        for (auto& lod : mesh.GetLods()) {
+            indices.insert(indices.end(), lod.indices.begin(), lod.indices.end());
+        }
+        if (meshRecords[i].flags & LoongModelFileMesh::k16BitIndices) {
+            std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+            meshRecords[i].indexOffset = Append(output, shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+        } else {
+            meshRecords[i].indexOffset = Append(output, indices.data(), indices.size() * sizeof(uint32_t));
+        }
+    }
+    sections[4].size = output.size() - sections[4].offset;
+
+    LoongModelFileHeader header { LoongModel::kFileMagic, kFileVersion, kSectionCount, uint32_t(meshes.size()), model.GetAABB() };
+    memcpy(output.data(), &header, sizeof(header));
+    memcpy(output.data() + sizeof(header), sections, sizeof(sections));
+    if (!meshRecords.empty()) {
+        memcpy(output.data() + sections[0].offset, meshRecords.data(), sections[0].size);
+    }
+}
+
+LoongModelFile::LoongModelFile(FS::LoongMappedFile&& file, const std::string& path)
+    : file_(std::move(file))
+    , path_(path)
+{
+    isValid_ = Parse();
+    if (isValid_) {
+        LOONG_TRACE("Open model file '{}' ({})", path_, file_.IsMapped() ? "mapped" : "read");
+    } else {
+        header_ = nullptr;
+        meshes_.clear();
+        materialNames_.clear();
+        LOONG_ERROR("Open model file '{}' failed: Corrupted file", path_);
+    }
+}
+
+uint64_t LoongModelFile::GetGeometrySize() const
+{
+    uint64_t size = 0;
+    for (auto& view : meshes_) {
+        size += uint64_t(view.mesh->vertexCount) * view.GetVertexSize() + uint64_t(view.mesh->indexCount) * view.GetIndexSize();
+    }
+    return size;
+}
+
+bool LoongModelFile::Parse()
+{
+    if (!IsModelFile(file_)) {
+        return false;
+    }
+    const uint8_t* data = file_.GetData();
+    const uint64_t size = file_.GetSize();
+    auto isInFile = [size](uint64_t offset, uint64_t length) {
+        return offset <= size && length <= size - offset;
+    };
+
+    header_ = reinterpret_cast<const LoongModelFileHeader*>(data);
+    if (!isInFile(sizeof(LoongModelFileHeader), uint64_t(header_->sectionCount) * sizeof(LoongModelFileSection))) {
+        return false;
+    }
+    const LoongModelFileSection* meshSection = nullptr;
+    const LoongModelFileSection* lodSection = nullptr;
+    const LoongModelFileSection* materialSection = nullptr;
+    auto* sections = reinterpret_cast<const LoongModelFileSection*>(data + sizeof(LoongModelFileHeader));
+    for (uint32_t i = 0; i < header_->sectionCount; ++i) {
+        auto& section = sections[i];
+        if (!isInFile(section.offset, section.size) || section.offset % kAlignment != 0) {
+            return false;
+        }
+        // Unknown sections are skipped
+        switch (section.tag) {
+        case kMeshSectionTag:
+            meshSection = &section;
+            break;
+        case kLodSectionTag:
+            lodSection = &section;
+            break;
+        case kMaterialSectionTag:
+            materialSection = &section;
+            break;
+        default:
+            break;
+        }
+    }
+    if (meshSection == nullptr || lodSection == nullptr || materialSection == nullptr
+        || meshSection->size != uint64_t(header_->meshCount) * sizeof(LoongModelFileMesh)) {
+        return false;
+    }
+
+    // The indices are not checked against the vertex counts, that would touch all of them
+    auto* meshes = reinterpret_cast<const LoongModelFileMesh*>(data + meshSection->offset);
+    auto* lods = reinterpret_cast<const LoongModelFileLod*>(data + lodSection->offset);
+    const uint64_t lodCount = lodSection->size / sizeof(LoongModelFileLod);
+    meshes_.resize(header_->meshCount);
+    for (uint32_t i = 0; i < header_->meshCount; ++i) {
+        auto& view = meshes_[i];
+        auto& mesh = meshes[i];
+        view.mesh = &mesh;
+        if (mesh.vertexOffset % kAlignment != 0 || mesh.indexOffset % kAlignment != 0
+            || !isInFile(mesh.vertexOffset, uint64_t(mesh.vertexCount) * view.GetVertexSize())
+            || !isInFile(mesh.indexOffset, uint64_t(mesh.indexCount) * view.GetIndexSize())
+            || mesh.lodCount == 0 || uint64_t(mesh.firstLod) + mesh.lodCount > lodCount) {
+            return false;
+        }
+        for (uint32_t lod = 0; lod < mesh.lodCount; ++lod) {
+            auto& lodRecord = lods[mesh.firstLod + lod];
+            if (uint64_t(lodRecord.indexOffset) + lodRecord.indexCount > mesh.indexCount) {
+                return false;
+            }
+        }
+        view.vertices = data + mesh.vertexOffset;
+        view.indices = data + mesh.indexOffset;
+        view.lods = lods + mesh.firstLod;
+    }
+
+    const uint8_t* materials = data + materialSection->offset;
+    uint64_t materialsSize = materialSection->size;
+    auto readUint32 = [&materials, &materialsSize](uint32_t& value) {
+        if (materialsSize < sizeof(value)) {
+            return false;
+        }
+        memcpy(&value, materials, sizeof(value));
+        materials += sizeof(value);
+        materialsSize -= sizeof(value);
+        return true;
+    };
+    uint32_t materialCount = 0;
+    if (!readUint32(materialCount)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < materialCount; ++i) {
+        uint32_t length = 0;
+        if (!readUint32(length) || length > materialsSize) {
+            return false;
+        }
+        materialNames_.emplace_back(reinterpret_cast<const char*>(materials), length);
+        materials += length;
+        materialsSize -= length;
+    }
+    return true;
+}
+
+}
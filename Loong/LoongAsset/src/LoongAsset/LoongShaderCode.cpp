@@ -5,24 +5,23 @@
 #include "LoongAsset/LoongShaderCode.h"
 #include "LoongFileSystem/LoongFileSystem.h"
 #include "LoongFoundation/LoongLogger.h"
-#include <cassert>
+#include <algorithm>
 #include <sstream>
+#include <string_view>
 
 namespace Loong::Asset {
 
 LoongShaderCode::LoongShaderCode(const std::string& path)
 {
-    int64_t fileSize = FS::LoongFileSystem::GetFileSize(path);
-    if (fileSize <= 0) {
-        LOONG_ERROR("Failed to load image '{}': Wrong file size", path);
+    auto file = FS::LoongFileSystem::MapFile(path);
+    if (!file) {
+        LOONG_ERROR("Failed to load shader '{}': Open file failed", path);
         return;
     }
-    std::vector<char> buffer(fileSize);
-    assert(FS::LoongFileSystem::LoadFileContent(path, buffer.data(), fileSize) == fileSize);
 
     LOONG_TRACE("Load shader '{}' to '0x{:0X}'", path, intptr_t(this));
     std::stringstream ss;
-    ss << std::string_view(buffer.data(), buffer.size());
+    ss << std::string_view(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
     enum ShaderType {
         NONE = -1,
         VERTEX = 0,
@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongAsset/LoongVertexPacking.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/packing.hpp>
+
+namespace Loong::Asset {
+
+namespace {
+
+// Beyond this the step of a half float is larger than 1/1024
+constexpr float kMaxHalfUv = 2.0F;
+
+int16_t PackSnorm16(float v)
+{
+    return int16_t(std::round(Math::Clamp(v, -1.0F, 1.0F) * 32767.0F));
+}
+
+float UnpackSnorm16(int16_t v)
+{
+    return std::max(float(v) / 32767.0F, -1.0F);
+}
+
+int8_t PackSnorm8(float v)
+{
+    return int8_t(std::round(Math::Clamp(v, -1.0F, 1.0F) * 127.0F));
+}
+
+float UnpackSnorm8(int8_t v)
+{
+    return std::max(float(v) / 127.0F, -1.0F);
+}
+
+}
+
+Math::Vector2 OctEncode(const Math::Vector3& direction)
+{
+    float l1 = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+    if (l1 <= 0.0F) {
+        return Math::Vector2 { 0.0F };
+    }
+    Math::Vector2 p = Math::Vector2 { direction.x, direction.y } / l1;
+    if (direction.z < 0.0F) {
+        // Fold the lower hemisphere over the diagonals
+        p = Math::Vector2 {
+            (1.0F - std::abs(p.y)) * (p.x >= 0.0F ? 1.0F : -1.0F),
+            (1.0F - std::abs(p.x)) * (p.y >= 0.0F ? 1.0F : -1.0F),
+        };
+    }
+    return p;
+}
+
+Math::Vector3 OctDecode(const Math::Vector2& encoded)
+{
+    Math::Vector3 n { encoded.x, encoded.y, 1.0F - std::abs(encoded.x) - std::abs(encoded.y) };
+    float t = std::max(-n.z, 0.0F);
+    n.x += n.x >= 0.0F ? -t : t;
+    n.y += n.y >= 0.0F ? -t : t;
+    return Math::Normalize(n);
+}
+
+LoongPackedFrame PackFrame(const LoongVertex& vertex)
+{
+    LoongPackedFrame frame {};
+    Math::Vector2 normal = OctEncode(vertex.normal);
+    frame.normal[0] = PackSnorm16(normal.x);
+    frame.normal[1] = PackSnorm16(normal.y);
+    Math::Vector2 tangent = OctEncode(vertex.tangent);
+    frame.tangent[0] = PackSnorm8(tangent.x);
+    frame.tangent[1] = PackSnorm8(tangent.y);
+    frame.tangent[2] = Math::Dot(Math::Cross(vertex.normal, vertex.tangent), vertex.bitangent) < 0.0F ? -127 : 127;
+    frame.tangent[3] = 0;
+    return frame;
+}
+
+void UnpackFrame(const LoongPackedFrame& frame, LoongVertex& vertex)
+{
+    vertex.normal = OctDecode({ UnpackSnorm16(frame.normal[0]), UnpackSnorm16(frame.normal[1]) });
+    vertex.tangent = OctDecode({ UnpackSnorm8(frame.tangent[0]), UnpackSnorm8(frame.tangent[1]) });
+    vertex.bitangent = Math::Cross(vertex.normal, vertex.tangent) * (frame.tangent[2] < 0 ? -1.0F : 1.0F);
+}
+
+uint32_t PackHalfUv(const Math::Vector2& uv)
+{
+    return glm::packHalf2x16(uv);
+}
+
+Math::Vector2 UnpackHalfUv(uint32_t packed)
+{
+    return glm::unpackHalf2x16(packed);
+}
+
+bool CanUseHalfUvs(const std::vector<LoongVertex>& vertices)
+{
+    return std::all_of(vertices.begin(), vertices.end(), [](const LoongVertex& vertex) {
+        return std::abs(vertex.uv.x) <= kMaxHalfUv && std::abs(vertex.uv.y) <= kMaxHalfUv;
+    });
+}
+
+std::vector<LoongPackedVertex<uint32_t>> PackVerticesWithHalfUvs(const std::vector<LoongVertex>& vertices)
+{
+    std::vector<LoongPackedVertex<uint32_t>> packed(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        packed[i] = { vertices[i].position, PackHalfUv(vertices[i].uv), PackFrame(vertices[i]) };
+    }
+    return packed;
+}
+
+std::vector<LoongPackedVertex<Math::Vector2>> PackVertices(const std::vector<LoongVertex>& vertices)
+{
+    std::vector<LoongPackedVertex<Math::Vector2>> packed(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        packed[i] = { vertices[i].position, vertices[i].uv, PackFrame(vertices[i]) };
+    }
+    return packed;
+}
+
+LoongQuantizedPosition QuantizePosition(const Math::Vector3& position, const Math::AABB& aabb)
+{
+    Math::Vector3 extent = aabb.max - aabb.min;
+    auto quantize = [](float v, float min, float extent) {
+        return extent > 0.0F ? uint16_t(std::round(Math::Clamp((v - min) / extent, 0.0F, 1.0F) * 65535.0F)) : uint16_t(0);
+    };
+    return LoongQuantizedPosition {
+        quantize(position.x, aabb.min.x, extent.x),
+        quantize(position.y, aabb.min.y, extent.y),
+        quantize(position.z, aabb.min.z, extent.z),
+    };
+}
+
+Math::Vector3 DequantizePosition(const LoongQuantizedPosition& position, const Math::AABB& aabb)
+{
+    Math::Vector3 t { float(position.x), float(position.y), float(position.z) };
+    return aabb.min + (aabb.max - aabb.min) * (t / 65535.0F);
+}
+
+}
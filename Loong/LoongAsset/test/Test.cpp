@@ -0,0 +1,251 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongAsset/LoongModel.h"
+#include "LoongAsset/LoongModelFile.h"
+#include "LoongAsset/LoongVertexPacking.h"
+#include "LoongFileSystem/LoongFileSystem.h"
+#include "LoongFileSystem/LoongMappedFile.h"
+#include "LoongFoundation/LoongMath.h"
+#include "LoongFoundation/LoongSerializer.h"
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Loong;
+using namespace Loong::Asset;
+
+void TestOctEncoding();
+
+void TestVertexPacking();
+
+void TestPositionQuantization();
+
+void TestModelFileRoundTrip();
+
+int main(int argc, const char* argv[])
+{
+    FS::LoongFileSystem::Initialize(argv[0]);
+
+    TestOctEncoding();
+
+    TestVertexPacking();
+
+    TestPositionQuantization();
+
+    TestModelFileRoundTrip();
+
+    FS::LoongFileSystem::Uninitialize();
+    return 0;
+}
+
+std::vector<Math::Vector3> GetTestDirections()
+{
+    // The poles, the axes, the diagonals folded over in the -Z hemisphere and the seams between the hemispheres
+    std::vector<Math::Vector3> directions {
+        { 0.0F, 0.0F, 1.0F },
+        { 0.0F, 0.0F, -1.0F },
+        { 1.0F, 0.0F, 0.0F },
+        { -1.0F, 0.0F, 0.0F },
+        { 0.0F, 1.0F, 0.0F },
+        { 0.0F, -1.0F, 0.0F },
+        { 1.0F, 1.0F, -1.0F },
+        { -1.0F, 1.0F, -1.0F },
+        { 1.0F, -1.0F, -1.0F },
+        { -1.0F, -1.0F, -1.0F },
+        { 1.0F, 1.0F, 1.0F },
+        { 1e-4F, -1e-4F, -1.0F },
+        { -1e-4F, 1e-4F, 1.0F },
+        { 1.0F, 1.0F, 0.0F },
+        { -1.0F, 0.5F, -1e-4F },
+        { 0.3F, -0.7F, -0.2F },
+    };
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> normal;
+    for (int i = 0; i < 10000; ++i) {
+        directions.emplace_back(normal(rng), normal(rng), normal(rng));
+    }
+    for (auto& direction : directions) {
+        direction = Math::Normalize(direction);
+    }
+    return directions;
+}
+
+void TestOctEncoding()
+{
+    for (auto& direction : GetTestDirections()) {
+        Math::Vector2 encoded = OctEncode(direction);
+        assert(std::abs(encoded.x) <= 1.0F && std::abs(encoded.y) <= 1.0F);
+        // The upper hemisphere is inside the diamond, the lower one is folded outside of it
+        assert(direction.z >= 0.0F || std::abs(encoded.x) + std::abs(encoded.y) >= 1.0F - 1e-6F);
+        assert(Math::Distance(OctDecode(encoded), direction) < 1e-5F);
+    }
+    assert(Math::Distance(OctDecode(OctEncode({ 0.0F, 0.0F, -1.0F })), { 0.0F, 0.0F, -1.0F }) < 1e-6F);
+    assert(Math::Distance(OctDecode(OctEncode({ 0.0F, 0.0F, 1.0F })), { 0.0F, 0.0F, 1.0F }) < 1e-6F);
+}
+
+void TestVertexPacking()
+{
+    std::mt19937 rng(5678);
+    std::uniform_real_distribution<float> uv(-2.0F, 2.0F);
+    std::vector<LoongVertex> vertices;
+    for (auto& normal : GetTestDirections()) {
+        // Any direction perpendicular to the normal, with both handedness
+        Math::Vector3 axis = std::abs(normal.x) < 0.9F ? Math::Vector3 { 1.0F, 0.0F, 0.0F } : Math::Vector3 { 0.0F, 1.0F, 0.0F };
+        Math::Vector3 tangent = Math::Normalize(Math::Cross(normal, axis));
+        float handedness = vertices.size() % 2 == 0 ? 1.0F : -1.0F;
+        LoongVertex vertex {};
+        vertex.position = normal * 10.0F;
+        vertex.uv = { uv(rng), uv(rng) };
+        vertex.normal = normal;
+        vertex.tangent = tangent;
+        vertex.bitangent = Math::Cross(normal, tangent) * handedness;
+        vertices.push_back(vertex);
+    }
+    assert(CanUseHalfUvs(vertices));
+
+    auto checkFrame = [](const LoongVertex& vertex, const LoongVertex& unpacked) {
+        // 16 bits for the normal, 8 bits for the tangent
+        assert(Math::Distance(unpacked.normal, vertex.normal) < 1e-3F);
+        assert(Math::Distance(unpacked.tangent, vertex.tangent) < 3e-2F);
+        assert(Math::Dot(unpacked.bitangent, vertex.bitangent) > 0.9F);
+    };
+
+    auto packed = PackVertices(vertices);
+    auto halfPacked = PackVerticesWithHalfUvs(vertices);
+    assert(packed.size() == vertices.size() && halfPacked.size() == vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        auto& vertex = vertices[i];
+        LoongVertex unpacked = UnpackVertex(packed[i]);
+        assert(unpacked.position == vertex.position);
+        assert(unpacked.uv == vertex.uv);
+        checkFrame(vertex, unpacked);
+
+        unpacked = UnpackVertex(halfPacked[i]);
+        assert(unpacked.position == vertex.position);
+        assert(std::abs(unpacked.uv.x - vertex.uv.x) < 1e-3F && std::abs(unpacked.uv.y - vertex.uv.y) < 1e-3F);
+        checkFrame(vertex, unpacked);
+    }
+
+    // Far away UVs need floats
+    vertices[0].uv = { 100.0F, 0.0F };
+    assert(!CanUseHalfUvs(vertices));
+}
+
+void TestPositionQuantization()
+{
+    Math::AABB aabb { { -3.0F, 0.0F, 10.0F }, { 5.0F, 1.0F, 10.5F } };
+    Math::Vector3 step = (aabb.max - aabb.min) / 65535.0F;
+    std::mt19937 rng(9012);
+    std::uniform_real_distribution<float> t(0.0F, 1.0F);
+    for (int i = 0; i < 1000; ++i) {
+        Math::Vector3 position = aabb.min + (aabb.max - aabb.min) * Math::Vector3 { t(rng), t(rng), t(rng) };
+        Math::Vector3 dequantized = DequantizePosition(QuantizePosition(position, aabb), aabb);
+        Math::Vector3 difference = Math::Abs(dequantized - position);
+        assert(difference.x <= step.x && difference.y <= step.y && difference.z <= step.z);
+    }
+    // The corners are exact
+    assert(Math::Distance(DequantizePosition(QuantizePosition(aabb.min, aabb), aabb), aabb.min) < 1e-6F);
+    assert(Math::Distance(DequantizePosition(QuantizePosition(aabb.max, aabb), aabb), aabb.max) < 1e-5F);
+}
+
+// Two meshes with both index sizes and both UV layouts
+LoongModel MakeTestModel()
+{
+    std::vector<LoongVertex> quadVertices;
+    for (auto& uv : { Math::Vector2 { 0.0F, 0.0F }, Math::Vector2 { 1.0F, 0.0F }, Math::Vector2 { 1.0F, 1.0F }, Math::Vector2 { 0.0F, 1.0F } }) {
+        quadVertices.push_back({ { uv.x, uv.y, 0.0F }, uv, { 0.0F, 0.0F, 1.0F }, { 1.0F, 0.0F, 0.0F }, { 0.0F, 1.0F, 0.0F } });
+    }
+    auto* quad = new LoongMesh(std::move(quadVertices), { 0, 1, 2, 2, 3, 0 }, 1);
+    quad->SetLods({ { { 0, 1, 2 }, 0.5F } });
+
+    // Too many vertices for 16 bits indices
+    std::vector<LoongVertex> lineVertices;
+    for (uint32_t i = 0; i <= 65536; ++i) {
+        lineVertices.push_back({ { float(i), 1.0F, -2.0F }, { 100.0F, float(i) }, { 0.0F, 1.0F, 0.0F }, { 1.0F, 0.0F, 0.0F }, { 0.0F, 0.0F, -1.0F } });
+    }
+    auto* line = new LoongMesh(std::move(lineVertices), { 0, 65536, 1 }, 0);
+
+    return LoongModel({ quad, line }, { "Line", "Quad material" });
+}
+
+void CheckSameModel(const LoongModel& a, const LoongModel& b)
+{
+    assert(a.GetMaterialNames() == b.GetMaterialNames());
+    assert(a.GetMeshes().size() == b.GetMeshes().size());
+    for (size_t i = 0; i < a.GetMeshes().size(); ++i) {
+        auto& meshA = *a.GetMeshes()[i];
+        auto& meshB = *b.GetMeshes()[i];
+        assert(meshA.GetMaterialIndex() == meshB.GetMaterialIndex());
+        assert(meshA.GetIndices() == meshB.GetIndices());
+        assert(meshA.GetVertices().size() == meshB.GetVertices().size());
+        for (size_t v = 0; v < meshA.GetVertices().size(); ++v) {
+            assert(meshA.GetVertices()[v].position == meshB.GetVertices()[v].position);
+        }
+        assert(meshA.GetLods().size() == meshB.GetLods().size());
+        for (size_t lod = 0; lod < meshA.GetLods().size(); ++lod) {
+            assert(meshA.GetLods()[lod].indices == meshB.GetLods()[lod].indices);
+            assert(meshA.GetLods()[lod].error == meshB.GetLods()[lod].error);
+        }
+    }
+}
+
+void TestModelFileRoundTrip()
+{
+    const std::string kPath = "/ModelFileTest.lgmdl";
+    bool isWriteDirSet = FS::LoongFileSystem::SetWriteDir(".");
+    bool isMounted = FS::LoongFileSystem::MountSearchPath(".");
+    assert(isWriteDirSet && isMounted);
+
+    auto model = MakeTestModel();
+    std::vector<uint8_t> bytes;
+    LoongModelFile::Write(model, bytes);
+    int64_t writtenSize = FS::LoongFileSystem::StoreFileContent(kPath, bytes.data(), bytes.size());
+    assert(writtenSize == int64_t(bytes.size()));
+
+    {
+        FS::LoongMappedFile mappedFile(kPath);
+        assert(LoongModelFile::IsModelFile(mappedFile));
+        LoongModelFile file(std::move(mappedFile), kPath);
+        assert(file);
+        assert(file.GetMeshCount() == 2);
+        assert(file.GetMaterialNames() == model.GetMaterialNames());
+
+        auto& quad = file.GetMesh(0);
+        assert(quad.mesh->flags == (LoongModelFileMesh::kHalfUvs | LoongModelFileMesh::k16BitIndices));
+        assert(quad.mesh->materialIndex == 1 && quad.mesh->vertexCount == 4 && quad.mesh->indexCount == 9);
+        assert(quad.mesh->lodCount == 2 && quad.lods[1].indexOffset == 6 && quad.lods[1].indexCount == 3 && quad.lods[1].error == 0.5F);
+        assert(static_cast<const uint16_t*>(quad.indices)[4] == 3);
+        assert(reinterpret_cast<uintptr_t>(quad.vertices) % 16 == 0 && reinterpret_cast<uintptr_t>(quad.indices) % 16 == 0);
+
+        auto& line = file.GetMesh(1);
+        assert(line.mesh->flags == 0);
+        assert(line.mesh->vertexCount == 65537 && line.mesh->lodCount == 1);
+        assert(static_cast<const uint32_t*>(line.indices)[1] == 65536);
+        assert(file.GetGeometrySize() == 4 * quad.GetVertexSize() + 9 * sizeof(uint16_t) + 65537 * line.GetVertexSize() + 3 * sizeof(uint32_t));
+
+        CheckSameModel(model, LoongModel(file));
+    }
+
+    // A truncated file is rejected, not read out of bounds
+    writtenSize = FS::LoongFileSystem::StoreFileContent(kPath, bytes.data(), bytes.size() - 4);
+    assert(writtenSize == int64_t(bytes.size() - 4));
+    {
+        LoongModelFile file(FS::LoongMappedFile(kPath), kPath);
+        assert(!file);
+    }
+    bool isDeleted = FS::LoongFileSystem::Delete(kPath);
+    assert(isDeleted);
+
+    // Version 1 files are decoded from memory
+    Foundation::LoongMemoryOutputStream outputStream;
+    bool isSerialized = Foundation::Serialize(model, outputStream);
+    assert(isSerialized);
+    LoongModel decoded(outputStream.GetData().data(), outputStream.GetData().size(), "[Memory]");
+    assert(decoded);
+    CheckSameModel(model, decoded);
+
+    FS::LoongFileSystem::UnmountSearchPath(".");
+}
@@ -2,6 +2,7 @@
 #include "LoongFoundation/LoongFormat.h"
 #include "LoongFoundation/LoongLogger.h"
 #include "LoongFoundation/LoongStringUtils.h"
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <unordered_map>
@@ -20,6 +21,29 @@ namespace Loong::AssetConverter {
         return true;                                                                                           \
     }
 
+#define DEFINE_UINT_OPTION_HANDLER(optionVariable)                                                             \
+    [](int& index, int argc, char** argv) -> bool {                                                            \
+        if (index + 1 >= argc) {                                                                               \
+            std::cout << Foundation::Format(R"(Missing argument for "{}" option!)", argv[index]) << std::endl; \
+            return false;                                                                                      \
+        }                                                                                                      \
+        ++index;                                                                                               \
+        char* end = nullptr;                                                                                   \
+        unsigned long value = strtoul(argv[index], &end, 10);                                                  \
+        if (end == argv[index] || *end != '\0') {                                                              \
+            std::cout << Foundation::Format(R"(Invalid number "{}")", argv[index]) << std::endl;               \
+            return false;                                                                                      \
+        }                                                                                                      \
+        optionVariable = decltype(optionVariable)(value);                                                      \
+        return true;                                                                                           \
+    }
+
+#define DEFINE_BOOL_OPTION_HANDLER(optionVariable)  \
+    [](int& index, int argc, char** argv) -> bool { \
+        optionVariable = true;                      \
+        return true;                                \
+    }
+
 struct CommandOptionDesc {
     std::vector<std::string> option;
     std::string helpDesc;
@@ -52,6 +76,14 @@ bool Flags::ParseCommandLine(int argc, char** argv)
         { { "-tt", "--texture-type" }, "Specify the image format to store uncompressed embedded texture (support png/jpg/bmp/tga, default jpg)",
             DEFINE_STRING_OPTION_HANDLER(GetInterial().rawTextureOutputFormat) },
         { { "-tp", "--texture-path" }, "Specify the path (under output path) of texture files", DEFINE_STRING_OPTION_HANDLER(GetInterial().texturePath) },
+        { { "-lod", "--lod-count" }, "Specify the number of LODs generated for each mesh (0 to disable, default 3)",
+            DEFINE_UINT_OPTION_HANDLER(GetInterial().lodCount) },
+        { { "-lmf", "--legacy-model-format" }, "Write the version 1 model files instead of the memory mappable version 2 ones",
+            DEFINE_BOOL_OPTION_HANDLER(GetInterial().legacyModelFormat) },
+        { { "-raw", "--raw-vertices" }, "Store the vertices without compression (positions, uvs, normals, tangents and bitangents as floats)",
+            DEFINE_BOOL_OPTION_HANDLER(GetInterial().rawVertices) },
+        { { "-qp", "--quantize-positions" }, "Quantize the vertex positions to 16 bits in the bounding box of each mesh",
+            DEFINE_BOOL_OPTION_HANDLER(GetInterial().quantizePositions) },
         { { "-h", "--help" }, "Print this help", [](int& index, int argc, char** argv) -> bool { return false; } },
     };
     std::unordered_map<std::string, std::function<bool(int&, int, char**)>> kCommandHandlerMap;
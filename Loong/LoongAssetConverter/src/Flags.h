@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace Loong::AssetConverter {
@@ -20,6 +21,18 @@ struct Flags {
 
     std::string rawTextureOutputFormat = ".jpg";
 
+    // Number of LODs generated for each mesh besides the full resolution one
+    uint32_t lodCount = 3;
+
+    // Write the version 1 model files, which are decoded when loaded, instead of the mappable version 2 ones
+    bool legacyModelFormat = false;
+
+    // Store the vertices as float LoongVertex instead of the compact layout, only with the legacy format
+    bool rawVertices = false;
+
+    // Quantize the positions to 16 bits in the AABB of each mesh, only with the compact layout of the legacy format
+    bool quantizePositions = false;
+
 private:
     Flags() = default;
     static Flags& GetInterial();
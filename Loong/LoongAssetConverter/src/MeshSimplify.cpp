@@ -0,0 +1,660 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "MeshSimplify.h"
+#include "LoongFoundation/LoongMath.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace Loong::AssetConverter {
+
+namespace {
+
+// Meshes smaller than this are not worth LODs
+constexpr size_t kMinLodIndexCount = 3 * 64;
+
+struct Quadric {
+    // The upper triangle of the symmetric 4x4 matrix
+    double a00 { 0 }, a01 { 0 }, a02 { 0 }, a03 { 0 };
+    double a11 { 0 }, a12 { 0 }, a13 { 0 };
+    double a22 { 0 }, a23 { 0 };
+    double a33 { 0 };
+    double weight { 0 };
+
+    static Quadric FromPlane(const Math::Vector3& n, float d, double weight)
+    {
+        Quadric q;
+        q.a00 = weight * n.x * n.x;
+        q.a01 = weight * n.x * n.y;
+        q.a02 = weight * n.x * n.z;
+        q.a03 = weight * n.x * d;
+        q.a11 = weight * n.y * n.y;
+        q.a12 = weight * n.y * n.z;
+        q.a13 = weight * n.y * d;
+        q.a22 = weight * n.z * n.z;
+        q.a23 = weight * n.z * d;
+        q.a33 = weight * d * d;
+        q.weight = weight;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& q)
+    {
+        a00 += q.a00, a01 += q.a01, a02 += q.a02, a03 += q.a03;
+        a11 += q.a11, a12 += q.a12, a13 += q.a13;
+        a22 += q.a22, a23 += q.a23;
+        a33 += q.a33;
+        weight += q.weight;
+        return *this;
+    }
+
+    Quadric operator+(const Quadric& q) const
+    {
+        Quadric result = *this;
+        result += q;
+        return result;
+    }
+
+    // The area weighted mean of the squared distances from p to the planes
+    double Evaluate(const Math::Vector3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+            + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+            + a22 * z * z + 2 * a23 * z
+            + a33;
+        return weight > 0 ? std::max(e / weight, 0.0) : 0.0;
+    }
+};
+
+struct PositionKey {
+    uint32_t x, y, z;
+
+    bool operator==(const PositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey& key) const
+    {
+        return (size_t(key.x) * 73856093U) ^ (size_t(key.y) * 19349663U) ^ (size_t(key.z) * 83492791U);
+    }
+};
+
+PositionKey MakePositionKey(const Math::Vector3& position)
+{
+    PositionKey key {};
+    // -0.0F and 0.0F should be the same position
+    Math::Vector3 p = position + Math::Vector3(0.0F);
+    memcpy(&key.x, &p.x, sizeof(float));
+    memcpy(&key.y, &p.y, sizeof(float));
+    memcpy(&key.z, &p.z, sizeof(float));
+    return key;
+}
+
+constexpr uint32_t kNone = ~uint32_t(0);
+
+// The planes through the border and seam edges, perpendicular to their triangles, are weighted by this times the
+// squared edge length, so that the collapses along them keep their shapes and the ones away from them are expensive
+constexpr double kEdgePlaneWeight = 10.0;
+
+// Each pass only collapses the edges as cheap as the cheapest 1/kPassCandidateDivisor of the candidates
+constexpr size_t kPassCandidateDivisor = 4;
+
+enum class VertexKind : uint8_t {
+    kManifold, // collapses to any neighbor
+    kBorder, // on an open border, collapses along it
+    kSeam, // one of the two vertices at a position on a UV/normal seam, collapses along the seam with its twin
+    kLocked, // where borders or seams meet, or non-manifold
+};
+
+enum class EdgeKind : uint8_t {
+    kInterior,
+    kBorder,
+    kSeam, // the triangle on the other side uses other vertices at the same positions
+    kNonManifold,
+};
+
+struct Topology {
+    std::vector<uint32_t> positionIds; // the first vertex at the same position
+    std::vector<uint32_t> twins; // the other vertex at the same position of the seam vertices
+    std::vector<VertexKind> kinds;
+    std::unordered_map<uint64_t, EdgeKind> edgeKinds;
+};
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    // The twins of seam vertices collapse together
+    uint32_t twinFrom;
+    uint32_t twinTo;
+    double cost;
+};
+
+uint64_t EdgeKey(uint32_t a, uint32_t b)
+{
+    return a < b ? (uint64_t(a) << 32U) | b : (uint64_t(b) << 32U) | a;
+}
+
+Topology AnalyzeTopology(const std::vector<Asset::LoongVertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    const uint32_t vertexCount = uint32_t(vertices.size());
+    Topology topology;
+
+    // Vertices on UV/normal seams are split, so several vertices share the same position. Only the vertices still
+    // referenced count, the topology changes with the collapses.
+    std::vector<uint8_t> isReferenced(vertexCount, 0);
+    for (auto index : indices) {
+        isReferenced[index] = 1;
+    }
+    topology.positionIds.resize(vertexCount);
+    topology.twins.assign(vertexCount, kNone);
+    std::vector<uint32_t> positionCounts(vertexCount, 0);
+    std::unordered_map<PositionKey, uint32_t, PositionKeyHash> firstVertices;
+    firstVertices.reserve(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+        if (!isReferenced[i]) {
+            topology.positionIds[i] = i;
+            continue;
+        }
+        auto result = firstVertices.insert({ MakePositionKey(vertices[i].position), i });
+        uint32_t first = result.first->second;
+        topology.positionIds[i] = first;
+        if (++positionCounts[first] == 2) {
+            topology.twins[i] = first;
+            topology.twins[first] = i;
+        }
+    }
+
+    // Count each edge both by the vertices and by the positions
+    std::unordered_map<uint64_t, uint32_t> edgeCounts;
+    std::unordered_map<uint64_t, uint32_t> positionEdgeCounts;
+    edgeCounts.reserve(indices.size());
+    positionEdgeCounts.reserve(indices.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (size_t k = 0; k < 3; ++k) {
+            uint32_t a = indices[i + k];
+            uint32_t b = indices[i + (k + 1) % 3];
+            ++edgeCounts[EdgeKey(a, b)];
+            ++positionEdgeCounts[EdgeKey(topology.positionIds[a], topology.positionIds[b])];
+        }
+    }
+
+    std::vector<uint8_t> borderEdges(vertexCount, 0);
+    std::vector<uint8_t> seamEdges(vertexCount, 0);
+    std::vector<uint8_t> isNonManifold(vertexCount, 0);
+    topology.edgeKinds.reserve(edgeCounts.size());
+    for (auto& [key, count] : edgeCounts) {
+        uint32_t a = uint32_t(key >> 32U);
+        uint32_t b = uint32_t(key & 0xFFFFFFFFU);
+        uint32_t positionCount = positionEdgeCounts[EdgeKey(topology.positionIds[a], topology.positionIds[b])];
+        EdgeKind kind = EdgeKind::kNonManifold;
+        if (count == 2 && positionCount == 2) {
+            kind = EdgeKind::kInterior;
+        } else if (count == 1 && positionCount == 1) {
+            kind = EdgeKind::kBorder;
+            borderEdges[a] = uint8_t(std::min(borderEdges[a] + 1, 3));
+            borderEdges[b] = uint8_t(std::min(borderEdges[b] + 1, 3));
+        } else if (count == 1 && positionCount == 2) {
+            kind = EdgeKind::kSeam;
+            seamEdges[a] = uint8_t(std::min(seamEdges[a] + 1, 3));
+            seamEdges[b] = uint8_t(std::min(seamEdges[b] + 1, 3));
+        } else {
+            isNonManifold[a] = 1;
+            isNonManifold[b] = 1;
+        }
+        topology.edgeKinds.insert({ key, kind });
+    }
+
+    topology.kinds.assign(vertexCount, VertexKind::kLocked);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        uint32_t positionCount = positionCounts[topology.positionIds[v]];
+        if (isNonManifold[v]) {
+            continue;
+        }
+        if (positionCount == 1 && seamEdges[v] == 0) {
+            if (borderEdges[v] == 0) {
+                topology.kinds[v] = VertexKind::kManifold;
+            } else if (borderEdges[v] == 2) {
+                topology.kinds[v] = VertexKind::kBorder;
+            }
+        } else if (positionCount == 2 && seamEdges[v] == 2 && borderEdges[v] == 0) {
+            topology.kinds[v] = VertexKind::kSeam;
+        }
+    }
+    // Both of the twins have to be able to move
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        if (topology.kinds[v] == VertexKind::kSeam && topology.kinds[topology.twins[v]] != VertexKind::kSeam) {
+            topology.kinds[v] = VertexKind::kLocked;
+            topology.kinds[topology.twins[v]] = VertexKind::kLocked;
+        }
+    }
+    return topology;
+}
+
+void BuildAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint32_t>& offsets, std::vector<uint32_t>& triangles)
+{
+    offsets.assign(vertexCount + 1, 0);
+    for (auto index : indices) {
+        ++offsets[index + 1];
+    }
+    for (size_t i = 0; i < vertexCount; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    triangles.resize(indices.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        triangles[fill[indices[i]]++] = uint32_t(i / 3);
+    }
+}
+
+bool IsDegenerate(const uint32_t* triangle)
+{
+    return triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0];
+}
+
+// The collapse must not flip any remaining triangle around the removed vertex
+bool IsCollapseValid(const std::vector<Asset::LoongVertex>& vertices, const std::vector<uint32_t>& indices, const uint32_t* adjacency, uint32_t adjacencyCount, uint32_t from, uint32_t to)
+{
+    for (uint32_t i = 0; i < adjacencyCount; ++i) {
+        const uint32_t* triangle = &indices[size_t(adjacency[i]) * 3];
+        if (IsDegenerate(triangle) || triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+            continue;
+        }
+        Math::Vector3 p[3];
+        Math::Vector3 q[3];
+        for (int k = 0; k < 3; ++k) {
+            p[k] = vertices[triangle[k]].position;
+            q[k] = vertices[triangle[k] == from ? to : triangle[k]].position;
+        }
+        Math::Vector3 oldNormal = Math::Cross(p[1] - p[0], p[2] - p[0]);
+        Math::Vector3 newNormal = Math::Cross(q[1] - q[0], q[2] - q[0]);
+        if (Math::Dot(oldNormal, newNormal) <= 0.0F) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Real-Time Collision Detection 5.1.5
+float PointTriangleDistanceSquared(const Math::Vector3& p, const Math::Vector3& a, const Math::Vector3& b, const Math::Vector3& c)
+{
+    auto distanceSquared = [&p](const Math::Vector3& q) { return Math::Dot(p - q, p - q); };
+    Math::Vector3 ab = b - a;
+    Math::Vector3 ac = c - a;
+    Math::Vector3 ap = p - a;
+    float d1 = Math::Dot(ab, ap);
+    float d2 = Math::Dot(ac, ap);
+    if (d1 <= 0.0F && d2 <= 0.0F) {
+        return distanceSquared(a);
+    }
+    Math::Vector3 bp = p - b;
+    float d3 = Math::Dot(ab, bp);
+    float d4 = Math::Dot(ac, bp);
+    if (d3 >= 0.0F && d4 <= d3) {
+        return distanceSquared(b);
+    }
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0F && d1 >= 0.0F && d3 <= 0.0F) {
+        return distanceSquared(a + ab * (d1 / (d1 - d3)));
+    }
+    Math::Vector3 cp = p - c;
+    float d5 = Math::Dot(ab, cp);
+    float d6 = Math::Dot(ac, cp);
+    if (d6 >= 0.0F && d5 <= d6) {
+        return distanceSquared(c);
+    }
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0F && d2 >= 0.0F && d6 <= 0.0F) {
+        return distanceSquared(a + ac * (d2 / (d2 - d6)));
+    }
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0F && (d4 - d3) >= 0.0F && (d5 - d6) >= 0.0F) {
+        return distanceSquared(b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+    }
+    float denominator = va + vb + vc;
+    if (denominator <= 0.0F) {
+        // Degenerate, the vertices are close enough
+        return std::min(distanceSquared(a), std::min(distanceSquared(b), distanceSquared(c)));
+    }
+    return distanceSquared(a + ab * (vb / denominator) + ac * (vc / denominator));
+}
+
+// The triangles in a uniform grid, for the distances from the removed vertices to the simplified surface
+class TriangleGrid {
+public:
+    TriangleGrid(const std::vector<Asset::LoongVertex>& vertices, const std::vector<uint32_t>& indices)
+        : vertices_(vertices)
+        , indices_(indices)
+    {
+        // About a triangle per cell
+        double area = 0.0;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            area += Math::Length(Math::Cross(Position(i + 1) - Position(i), Position(i + 2) - Position(i))) * 0.5;
+        }
+        cellSize_ = std::max(float(std::sqrt(area / std::max<size_t>(indices.size() / 3, 1))), 1e-6F);
+
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            Math::Vector3 min = Math::Min(Position(i), Math::Min(Position(i + 1), Position(i + 2)));
+            Math::Vector3 max = Math::Max(Position(i), Math::Max(Position(i + 1), Position(i + 2)));
+            Cell first = GetCell(min);
+            Cell last = GetCell(max);
+            for (int32_t z = first.z; z <= last.z; ++z) {
+                for (int32_t y = first.y; y <= last.y; ++y) {
+                    for (int32_t x = first.x; x <= last.x; ++x) {
+                        cells_[Cell { x, y, z }].push_back(uint32_t(i));
+                    }
+                }
+            }
+        }
+    }
+
+    // No further than maxDistanceSquared, which is a known upper bound
+    float GetDistanceSquared(const Math::Vector3& p, float maxDistanceSquared) const
+    {
+        Cell center = GetCell(p);
+        float best = maxDistanceSquared;
+        for (int32_t r = 0;; ++r) {
+            // The cells r rings away are at least (r - 1) * cellSize_ away
+            float ringDistance = float(std::max(r - 1, 0)) * cellSize_;
+            if (ringDistance * ringDistance >= best) {
+                break;
+            }
+            for (int32_t z = -r; z <= r; ++z) {
+                for (int32_t y = -r; y <= r; ++y) {
+                    // Only the shell of the cube, the inner rows only have their ends in it
+                    int32_t step = std::abs(z) == r || std::abs(y) == r ? 1 : 2 * r;
+                    for (int32_t x = -r; x <= r; x += step) {
+                        auto it = cells_.find(Cell { center.x + x, center.y + y, center.z + z });
+                        if (it == cells_.end()) {
+                            continue;
+                        }
+                        for (uint32_t i : it->second) {
+                            best = std::min(best, PointTriangleDistanceSquared(p, Position(i), Position(i + 1), Position(i + 2)));
+                        }
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+private:
+    struct Cell {
+        int32_t x, y, z;
+
+        bool operator==(const Cell& other) const { return x == other.x && y == other.y && z == other.z; }
+    };
+
+    struct CellHash {
+        size_t operator()(const Cell& cell) const
+        {
+            return (size_t(uint32_t(cell.x)) * 73856093U) ^ (size_t(uint32_t(cell.y)) * 19349663U) ^ (size_t(uint32_t(cell.z)) * 83492791U);
+        }
+    };
+
+    const Math::Vector3& Position(size_t index) const { return vertices_[indices_[index]].position; }
+
+    Cell GetCell(const Math::Vector3& p) const
+    {
+        return { int32_t(std::floor(p.x / cellSize_)), int32_t(std::floor(p.y / cellSize_)), int32_t(std::floor(p.z / cellSize_)) };
+    }
+
+    const std::vector<Asset::LoongVertex>& vertices_;
+    const std::vector<uint32_t>& indices_;
+    float cellSize_ { 1.0F };
+    std::unordered_map<Cell, std::vector<uint32_t>, CellHash> cells_ {};
+};
+
+}
+
+std::vector<uint32_t> SimplifyMesh(const std::vector<Asset::LoongVertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float& error)
+{
+    error = 0.0F;
+    std::vector<uint32_t> result(indices.begin(), indices.begin() + indices.size() / 3 * 3);
+    const size_t vertexCount = vertices.size();
+    if (result.size() <= targetIndexCount || vertexCount == 0) {
+        return result;
+    }
+
+    Topology topology = AnalyzeTopology(vertices, result);
+    auto getEdgeKind = [&topology](uint32_t a, uint32_t b) {
+        auto it = topology.edgeKinds.find(EdgeKey(a, b));
+        return it != topology.edgeKinds.end() ? it->second : EdgeKind::kNonManifold;
+    };
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        const uint32_t* triangle = &result[i];
+        auto& p0 = vertices[triangle[0]].position;
+        auto& p1 = vertices[triangle[1]].position;
+        auto& p2 = vertices[triangle[2]].position;
+        Math::Vector3 normal = Math::Cross(p1 - p0, p2 - p0);
+        float length = Math::Length(normal);
+        if (length <= 0.0F) {
+            continue;
+        }
+        normal /= length;
+        auto quadric = Quadric::FromPlane(normal, -Math::Dot(normal, p0), length * 0.5F);
+        for (int k = 0; k < 3; ++k) {
+            quadrics[triangle[k]] += quadric;
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            uint32_t a = triangle[k];
+            uint32_t b = triangle[(k + 1) % 3];
+            EdgeKind kind = getEdgeKind(a, b);
+            if (kind != EdgeKind::kBorder && kind != EdgeKind::kSeam) {
+                continue;
+            }
+            Math::Vector3 edge = vertices[b].position - vertices[a].position;
+            Math::Vector3 edgeNormal = Math::Cross(edge, normal);
+            float edgeNormalLength = Math::Length(edgeNormal);
+            if (edgeNormalLength <= 0.0F) {
+                continue;
+            }
+            edgeNormal /= edgeNormalLength;
+            auto edgeQuadric = Quadric::FromPlane(edgeNormal, -Math::Dot(edgeNormal, vertices[a].position), kEdgePlaneWeight * Math::Dot(edge, edge));
+            quadrics[a] += edgeQuadric;
+            quadrics[b] += edgeQuadric;
+        }
+    }
+
+    std::vector<uint32_t> adjacencyOffsets;
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint8_t> isTouched;
+    std::vector<uint32_t> collapsedInto(vertexCount, kNone);
+
+    // The neighbor of v at the position of u, the twin of a seam vertex collapses to it
+    auto findTwinTarget = [&](uint32_t v, uint32_t u) {
+        for (uint32_t i = adjacencyOffsets[v]; i < adjacencyOffsets[v + 1]; ++i) {
+            const uint32_t* triangle = &result[size_t(adjacency[i]) * 3];
+            for (int k = 0; k < 3; ++k) {
+                uint32_t w = triangle[k];
+                if (w != v && topology.positionIds[w] == topology.positionIds[u] && getEdgeKind(v, w) == EdgeKind::kSeam) {
+                    return w;
+                }
+            }
+        }
+        return kNone;
+    };
+
+    // Every pass collapses an independent set of the cheapest edges, the vertices around a collapse can't be
+    // collapsed again until the next pass, since their costs are out of date
+    while (result.size() > targetIndexCount) {
+        // The collapses of the last pass changed the borders and seams
+        if (!collapses.empty()) {
+            topology = AnalyzeTopology(vertices, result);
+        }
+        BuildAdjacency(result, vertexCount, adjacencyOffsets, adjacency);
+
+        collapses.clear();
+        for (uint32_t v = 0; v < uint32_t(vertexCount); ++v) {
+            VertexKind kind = topology.kinds[v];
+            if (kind == VertexKind::kLocked || adjacencyOffsets[v] == adjacencyOffsets[v + 1]) {
+                continue;
+            }
+            // The collapses of the seam twins are found from the first one
+            if (kind == VertexKind::kSeam && topology.twins[v] < v) {
+                continue;
+            }
+            Collapse best { v, v, kNone, kNone, std::numeric_limits<double>::max() };
+            for (uint32_t i = adjacencyOffsets[v]; i < adjacencyOffsets[v + 1]; ++i) {
+                const uint32_t* triangle = &result[size_t(adjacency[i]) * 3];
+                for (int k = 0; k < 3; ++k) {
+                    uint32_t u = triangle[k];
+                    if (u == v) {
+                        continue;
+                    }
+                    // Borders and seams only collapse along themselves
+                    EdgeKind edgeKind = getEdgeKind(v, u);
+                    if ((kind == VertexKind::kBorder && edgeKind != EdgeKind::kBorder) || (kind == VertexKind::kSeam && edgeKind != EdgeKind::kSeam)) {
+                        continue;
+                    }
+                    Quadric quadric = quadrics[v] + quadrics[u];
+                    uint32_t twinFrom = kNone;
+                    uint32_t twinTo = kNone;
+                    if (kind == VertexKind::kSeam) {
+                        twinFrom = topology.twins[v];
+                        twinTo = findTwinTarget(twinFrom, u);
+                        if (twinTo == kNone) {
+                            continue;
+                        }
+                        quadric += quadrics[twinFrom];
+                        if (twinTo != u) {
+                            quadric += quadrics[twinTo];
+                        }
+                    }
+                    double cost = quadric.Evaluate(vertices[u].position);
+                    if (cost < best.cost) {
+                        best = { v, u, twinFrom, twinTo, cost };
+                    }
+                }
+            }
+            if (best.to != v) {
+                collapses.push_back(best);
+            }
+        }
+        if (collapses.empty()) {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+        // The expensive collapses wait for the next passes, where the cheap ones may be available again
+        const double costLimit = collapses[collapses.size() / kPassCandidateDivisor].cost;
+
+        const size_t trianglesToRemove = std::max<size_t>((result.size() - targetIndexCount) / 3, 1);
+        size_t removedTriangles = 0;
+        size_t collapsedCount = 0;
+        isTouched.assign(vertexCount, 0);
+        auto isValid = [&](uint32_t from, uint32_t to) {
+            const uint32_t* triangles = &adjacency[adjacencyOffsets[from]];
+            const uint32_t triangleCount = adjacencyOffsets[from + 1] - adjacencyOffsets[from];
+            return IsCollapseValid(vertices, result, triangles, triangleCount, from, to);
+        };
+        auto collapse = [&](uint32_t from, uint32_t to) {
+            for (uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; ++i) {
+                uint32_t* triangle = &result[size_t(adjacency[i]) * 3];
+                if (IsDegenerate(triangle)) {
+                    continue;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    if (triangle[k] == from) {
+                        triangle[k] = to;
+                    }
+                    isTouched[triangle[k]] = 1;
+                }
+                removedTriangles += IsDegenerate(triangle) ? 1 : 0;
+            }
+            isTouched[from] = 1;
+            quadrics[to] += quadrics[from];
+            collapsedInto[from] = to;
+        };
+        for (auto& candidate : collapses) {
+            if (removedTriangles >= trianglesToRemove || candidate.cost > costLimit) {
+                break;
+            }
+            bool hasTwin = candidate.twinFrom != kNone;
+            if (isTouched[candidate.from] || isTouched[candidate.to] || (hasTwin && (isTouched[candidate.twinFrom] || isTouched[candidate.twinTo]))) {
+                continue;
+            }
+            if (!isValid(candidate.from, candidate.to) || (hasTwin && !isValid(candidate.twinFrom, candidate.twinTo))) {
+                continue;
+            }
+            collapse(candidate.from, candidate.to);
+            if (hasTwin) {
+                collapse(candidate.twinFrom, candidate.twinTo);
+            }
+            ++collapsedCount;
+        }
+        if (collapsedCount == 0) {
+            break;
+        }
+
+        // Remove the collapsed triangles
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            if (!IsDegenerate(&result[i])) {
+                result[writeIndex++] = result[i];
+                result[writeIndex++] = result[i + 1];
+                result[writeIndex++] = result[i + 2];
+            }
+        }
+        result.resize(writeIndex);
+    }
+
+    // The distance of a removed vertex to the triangles around the vertex it ended up in bounds the search for the
+    // nearest triangle
+    BuildAdjacency(result, vertexCount, adjacencyOffsets, adjacency);
+    TriangleGrid grid(vertices, result);
+    float maxDistanceSquared = 0.0F;
+    for (uint32_t v = 0; v < uint32_t(vertexCount); ++v) {
+        if (collapsedInto[v] == kNone) {
+            continue;
+        }
+        uint32_t last = collapsedInto[v];
+        while (collapsedInto[last] != kNone) {
+            last = collapsedInto[last];
+        }
+        auto& p = vertices[v].position;
+        float distanceSquared = Math::Dot(p - vertices[last].position, p - vertices[last].position);
+        for (uint32_t i = adjacencyOffsets[last]; i < adjacencyOffsets[last + 1]; ++i) {
+            const uint32_t* triangle = &result[size_t(adjacency[i]) * 3];
+            distanceSquared = std::min(distanceSquared, PointTriangleDistanceSquared(p, vertices[triangle[0]].position, vertices[triangle[1]].position, vertices[triangle[2]].position));
+        }
+        maxDistanceSquared = std::max(maxDistanceSquared, grid.GetDistanceSquared(p, distanceSquared));
+    }
+    error = std::sqrt(maxDistanceSquared);
+    return result;
+}
+
+std::vector<Asset::LoongMeshLod> GenerateMeshLods(const Asset::LoongMesh& mesh, uint32_t lodCount)
+{
+    std::vector<Asset::LoongMeshLod> lods;
+    auto& indices = mesh.GetIndices();
+    size_t previousIndexCount = indices.size();
+    float previousError = 0.0F;
+    for (uint32_t i = 1; i <= lodCount; ++i) {
+        size_t targetIndexCount = (indices.size() >> i) / 3 * 3;
+        if (targetIndexCount < kMinLodIndexCount) {
+            break;
+        }
+        Asset::LoongMeshLod lod {};
+        // Always simplify the full resolution mesh, so that the errors don't accumulate
+        lod.indices = SimplifyMesh(mesh.GetVertices(), indices, targetIndexCount, lod.error);
+        // A LOD which can't remove a quarter of the triangles of the previous one is not worth it
+        if (lod.indices.size() * 4 > previousIndexCount * 3) {
+            break;
+        }
+        lod.error = std::max(lod.error, previousError);
+        previousIndexCount = lod.indices.size();
+        previousError = lod.error;
+        lods.push_back(std::move(lod));
+    }
+    return lods;
+}
+
+}
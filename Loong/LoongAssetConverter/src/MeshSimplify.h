@@ -0,0 +1,24 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongAsset/LoongMesh.h"
+#include <cstdint>
+#include <vector>
+
+namespace Loong::AssetConverter {
+
+// Simplify a triangle list by quadric error edge collapses until it has no more than targetIndexCount indices, or
+// nothing can be collapsed any more. Vertices on open borders only collapse along the borders, and the two vertices at
+// a position on a UV/normal seam only collapse along the seam together, so the seams don't crack. The quadrics of the
+// borders and seams are weighted to keep their shapes. The result references the input vertices, the max distance of
+// the removed vertices to the simplified triangles is written to error, it's conservative.
+std::vector<uint32_t> SimplifyMesh(const std::vector<Asset::LoongVertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float& error);
+
+// Each LOD has about half of the triangles of the previous one, the chain stops early if a mesh can't be simplified
+// any further.
+std::vector<Asset::LoongMeshLod> GenerateMeshLods(const Asset::LoongMesh& mesh, uint32_t lodCount);
+
+}
@@ -11,11 +11,14 @@
 #include "Flags.h"
 #include "LoongAsset/LoongMesh.h"
 #include "LoongAsset/LoongModel.h"
+#include "LoongAsset/LoongModelFile.h"
+#include "LoongFoundation/LoongBufferedFileStream.h"
 #include "LoongFoundation/LoongDefer.h"
 #include "LoongFoundation/LoongLogger.h"
 #include "LoongFoundation/LoongMath.h"
 #include "LoongFoundation/LoongPathUtils.h"
 #include "LoongFoundation/LoongSerializer.h"
+#include "MeshSimplify.h"
 #include <assimp/matrix4x4.h>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
@@ -92,7 +95,9 @@ static void ProcessNode(const void* transform, const struct aiNode* node, const
         std::vector<uint32_t> indices;
         ProcessMesh(&nodeTransformation, mesh, scene, vertices, indices);
 
-        meshes.push_back(new Asset::LoongMesh(std::move(vertices), std::move(indices), mesh->mMaterialIndex)); // The model will handle mesh destruction
+        auto* loongMesh = new Asset::LoongMesh(std::move(vertices), std::move(indices), mesh->mMaterialIndex); // The model will handle mesh destruction
+        loongMesh->SetLods(GenerateMeshLods(*loongMesh, Flags::Get().lodCount));
+        meshes.push_back(loongMesh);
     }
 
     // Then do the same for each of its children
@@ -128,23 +133,23 @@ bool ExportModelFiles(const aiScene* scene)
     ProcessNode(&identity, scene->mRootNode, scene, meshes);
 
     Asset::LoongModel model(std::move(meshes), std::move(materials));
+    if (!flags.legacyModelFormat) {
+        std::vector<uint8_t> buffer;
+        Asset::LoongModelFile::Write(model, buffer);
+        return fwrite(buffer.data(), buffer.size(), 1, ofs) == 1;
+    }
 
-    struct FileOutputStream : public Foundation::LoongArchiveOutputStream {
-        explicit FileOutputStream(FILE* fout)
-            : fout_(fout)
-        {
-        }
-        bool operator()(void* d, size_t l)
-        {
-            return fwrite(d, l, 1, fout_) == 1;
+    uint32_t storageFlags = 0;
+    if (!flags.rawVertices) {
+        storageFlags |= Asset::LoongMeshStorage::kCompactVertices;
+        if (flags.quantizePositions) {
+            storageFlags |= Asset::LoongMeshStorage::kQuantizedPositions;
         }
+    }
+    model.SetStorageFlags(storageFlags);
 
-    private:
-        FILE* fout_ { nullptr };
-    };
-    FileOutputStream outputStream(ofs);
-
-    return Foundation::Serialize(model, outputStream);
+    Foundation::LoongBufferedFileOutputStream outputStream(ofs);
+    return Foundation::Serialize(model, outputStream) && outputStream.Flush();
 }
 
 }
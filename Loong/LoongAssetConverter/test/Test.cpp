@@ -0,0 +1,204 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongMath.h"
+#include "MeshSimplify.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+using namespace Loong;
+using namespace Loong::AssetConverter;
+
+void TestSimplifyFlatGrid();
+
+void TestSimplifyHeightField();
+
+void TestSimplifySeam();
+
+void TestGenerateMeshLods();
+
+int main(int argc, const char* argv[])
+{
+    TestSimplifyFlatGrid();
+
+    TestSimplifyHeightField();
+
+    TestSimplifySeam();
+
+    TestGenerateMeshLods();
+
+    return 0;
+}
+
+// A grid of n x n quads over [0, n] x [0, n], the height is z. With a seam, the vertices at x == seamX are split, the
+// quads on the right of it use the copies.
+void MakeGrid(uint32_t n, const std::function<float(float, float)>& height, uint32_t seamX, std::vector<Asset::LoongVertex>& vertices, std::vector<uint32_t>& indices, std::vector<uint32_t>& seamCopies)
+{
+    vertices.clear();
+    indices.clear();
+    seamCopies.assign((n + 1) * (n + 1), ~uint32_t(0));
+    for (uint32_t y = 0; y <= n; ++y) {
+        for (uint32_t x = 0; x <= n; ++x) {
+            Asset::LoongVertex vertex {};
+            vertex.position = { float(x), float(y), height(float(x), float(y)) };
+            vertex.uv = { float(x) / float(n), float(y) / float(n) };
+            vertex.normal = { 0.0F, 0.0F, 1.0F };
+            vertices.push_back(vertex);
+        }
+    }
+    if (seamX <= n) {
+        for (uint32_t y = 0; y <= n; ++y) {
+            uint32_t v = y * (n + 1) + seamX;
+            seamCopies[v] = uint32_t(vertices.size());
+            auto copy = vertices[v];
+            copy.uv.x += 1.0F;
+            vertices.push_back(copy);
+        }
+    }
+    for (uint32_t y = 0; y < n; ++y) {
+        for (uint32_t x = 0; x < n; ++x) {
+            uint32_t quad[4] = { y * (n + 1) + x, y * (n + 1) + x + 1, (y + 1) * (n + 1) + x, (y + 1) * (n + 1) + x + 1 };
+            if (x == seamX) {
+                quad[0] = seamCopies[quad[0]];
+                quad[2] = seamCopies[quad[2]];
+            }
+            indices.insert(indices.end(), { quad[0], quad[1], quad[3], quad[0], quad[3], quad[2] });
+        }
+    }
+}
+
+float PointSegmentDistance(const Math::Vector3& p, const Math::Vector3& a, const Math::Vector3& b)
+{
+    Math::Vector3 ab = b - a;
+    float t = std::clamp(Math::Dot(p - a, ab) / std::max(Math::Dot(ab, ab), 1e-12F), 0.0F, 1.0F);
+    return Math::Length(p - (a + ab * t));
+}
+
+float PointTriangleDistance(const Math::Vector3& p, const Math::Vector3& a, const Math::Vector3& b, const Math::Vector3& c)
+{
+    Math::Vector3 normal = Math::Cross(b - a, c - a);
+    float area = Math::Length(normal);
+    if (area > 1e-12F) {
+        normal /= area;
+        Math::Vector3 q = p - normal * Math::Dot(p - a, normal);
+        bool isInside = Math::Dot(Math::Cross(b - a, q - a), normal) >= 0.0F
+            && Math::Dot(Math::Cross(c - b, q - b), normal) >= 0.0F
+            && Math::Dot(Math::Cross(a - c, q - c), normal) >= 0.0F;
+        if (isInside) {
+            return std::abs(Math::Dot(p - a, normal));
+        }
+    }
+    return std::min(PointSegmentDistance(p, a, b), std::min(PointSegmentDistance(p, b, c), PointSegmentDistance(p, c, a)));
+}
+
+// The distance of the farthest input vertex to the simplified triangles
+float MeasureError(const std::vector<Asset::LoongVertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    float maxDistance = 0.0F;
+    for (auto& vertex : vertices) {
+        float distance = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            distance = std::min(distance, PointTriangleDistance(vertex.position, vertices[indices[i]].position, vertices[indices[i + 1]].position, vertices[indices[i + 2]].position));
+        }
+        maxDistance = std::max(maxDistance, distance);
+    }
+    return maxDistance;
+}
+
+void TestSimplifyFlatGrid()
+{
+    std::vector<Asset::LoongVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> seamCopies;
+    MakeGrid(32, [](float, float) { return 0.0F; }, ~uint32_t(0), vertices, indices, seamCopies);
+
+    // A plane can be simplified a lot without any error, the corners and the straight borders are kept
+    float error = -1.0F;
+    auto result = SimplifyMesh(vertices, indices, indices.size() / 8 / 3 * 3, error);
+    assert(result.size() % 3 == 0);
+    assert(result.size() <= indices.size() / 8);
+    assert(error >= 0.0F && error < 1e-4F);
+    assert(MeasureError(vertices, result) < 1e-4F);
+
+    // Nothing to do
+    result = SimplifyMesh(vertices, indices, indices.size(), error);
+    assert(result == indices);
+    assert(error == 0.0F);
+}
+
+void TestSimplifyHeightField()
+{
+    std::vector<Asset::LoongVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> seamCopies;
+    MakeGrid(32, [](float x, float y) { return std::sin(x * 0.4F) * std::cos(y * 0.3F); }, ~uint32_t(0), vertices, indices, seamCopies);
+
+    // The error is a bound of the real distance, and grows with the number of the removed triangles
+    float previousError = 0.0F;
+    for (size_t divisor : { 2, 4, 8 }) {
+        size_t targetIndexCount = indices.size() / divisor / 3 * 3;
+        float error = 0.0F;
+        auto result = SimplifyMesh(vertices, indices, targetIndexCount, error);
+        assert(result.size() <= targetIndexCount);
+        assert(error > 0.0F);
+        assert(MeasureError(vertices, result) <= error + 1e-4F);
+        assert(error + 1e-4F >= previousError);
+        // No further than the amplitude of the waves
+        assert(error < 2.0F);
+        previousError = error;
+    }
+}
+
+void TestSimplifySeam()
+{
+    std::vector<Asset::LoongVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> seamCopies;
+    constexpr uint32_t n = 32;
+    MakeGrid(n, [](float, float) { return 0.0F; }, n / 2, vertices, indices, seamCopies);
+
+    float error = 0.0F;
+    auto result = SimplifyMesh(vertices, indices, indices.size() / 8 / 3 * 3, error);
+    assert(result.size() <= indices.size() / 8);
+    assert(error < 1e-4F);
+
+    // The seam is simplified, but both of its sides keep the same vertices, so it doesn't crack
+    std::vector<uint8_t> isReferenced(vertices.size(), 0);
+    for (auto index : result) {
+        isReferenced[index] = 1;
+    }
+    uint32_t seamVertexCount = 0;
+    for (uint32_t v = 0; v < uint32_t(seamCopies.size()); ++v) {
+        if (seamCopies[v] != ~uint32_t(0)) {
+            assert(isReferenced[v] == isReferenced[seamCopies[v]]);
+            seamVertexCount += isReferenced[v];
+        }
+    }
+    assert(seamVertexCount >= 2);
+    assert(seamVertexCount < n + 1);
+}
+
+void TestGenerateMeshLods()
+{
+    std::vector<Asset::LoongVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> seamCopies;
+    MakeGrid(32, [](float x, float y) { return std::sin(x * 0.4F) * std::cos(y * 0.3F); }, 8, vertices, indices, seamCopies);
+    Asset::LoongMesh mesh(std::move(vertices), std::move(indices), 0);
+
+    auto lods = GenerateMeshLods(mesh, 4);
+    assert(!lods.empty());
+    size_t previousIndexCount = mesh.GetIndices().size();
+    float previousError = 0.0F;
+    for (auto& lod : lods) {
+        assert(lod.indices.size() * 4 <= previousIndexCount * 3);
+        assert(lod.error >= previousError);
+        assert(MeasureError(mesh.GetVertices(), lod.indices) <= lod.error + 1e-4F);
+        previousIndexCount = lod.indices.size();
+        previousError = lod.error;
+    }
+}
@@ -0,0 +1,86 @@
+#include "Flags.h"
+#include "LoongFoundation/LoongFormat.h"
+#include "LoongFoundation/LoongLogger.h"
+#include "LoongFoundation/LoongStringUtils.h"
+#include <iostream>
+
+namespace Loong::AssetPacker {
+
+void PrintHelp(int argc, char** argv)
+{
+    (void)argc;
+    std::cout << "Loong Asset Packer" << std::endl;
+    std::cout << "Usage:" << std::endl;
+    std::cout << Foundation::Format("        {} [options]\n", argv[0]) << std::endl;
+    std::cout << "e.g:" << std::endl;
+    std::cout << Foundation::Format("        {} -i Resources -o Resources.lgpak -s .ktx\n", argv[0]) << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "\t-i\tThe directory to pack" << std::endl;
+    std::cout << "\t-o\tThe output .lgpak file" << std::endl;
+    std::cout << "\t-s\tStore the files of this extension without compression (optional, repeatable, .jpg, .jpeg, .png, .zip and .lgpak are stored by default)" << std::endl;
+    std::cout << "\t-n\tStore all the files without compression (optional)" << std::endl;
+}
+
+#define GET_NEXT_ARGUMENT_AS_STRING(var)                        \
+    do {                                                        \
+        ++index;                                                \
+        if (index >= argc) {                                    \
+            LOONG_ERROR("Missing parameter for '{}'", command); \
+            return false;                                       \
+        }                                                       \
+        var = argv[index];                                      \
+    } while (false)
+
+bool Flags::ParseCommandLine(int argc, char** argv)
+{
+    for (int index = 1; index < argc; ++index) {
+        std::string command = argv[index];
+        if (command == "-i") {
+            GET_NEXT_ARGUMENT_AS_STRING(Flags::GetInterial().inputDir);
+        } else if (command == "-o") {
+            GET_NEXT_ARGUMENT_AS_STRING(Flags::GetInterial().outputPath);
+        } else if (command == "-s") {
+            std::string extension;
+            GET_NEXT_ARGUMENT_AS_STRING(extension);
+            Foundation::LoongStringUtils::ToLower(extension);
+            if (extension.empty() || extension.front() != '.') {
+                extension.insert(extension.begin(), '.');
+            }
+            Flags::GetInterial().storedExtensions.insert(extension);
+        } else if (command == "-n") {
+            Flags::GetInterial().noCompression = true;
+        } else {
+            LOONG_ERROR("Unknown option '{}'", command);
+            return false;
+        }
+    }
+
+    if (!CheckFlags()) {
+        PrintHelp(argc, argv);
+        return false;
+    }
+
+    return true;
+}
+
+bool Flags::CheckFlags()
+{
+    auto& flags = GetInterial();
+    if (flags.inputDir.empty() || flags.outputPath.empty()) {
+        LOONG_ERROR("Both the input directory and the output file should be set");
+        return false;
+    }
+    return true;
+}
+
+const Flags& Flags::Get()
+{
+    return GetInterial();
+}
+
+Flags& Flags::GetInterial()
+{
+    static Flags s;
+    return s;
+}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+namespace Loong::AssetPacker {
+
+struct Flags {
+
+    static bool ParseCommandLine(int argc, char** argv);
+
+    static const Flags& Get();
+
+    // A directory in the native file system
+    std::string inputDir;
+
+    // The .lgpak file
+    std::string outputPath;
+
+    // Compress none of the files
+    bool noCompression { false };
+
+    // The extensions (with the dot, lower case) of the files that are stored without compression, e.g. the ones that
+    // are compressed already, or read in place
+    std::set<std::string> storedExtensions { ".jpg", ".jpeg", ".png", ".zip", ".lgpak" };
+
+private:
+    Flags() = default;
+    static Flags& GetInterial();
+    static bool CheckFlags();
+};
+
+}
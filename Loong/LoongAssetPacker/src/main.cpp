@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "Flags.h"
+#include "LoongFileSystem/Driver.h"
+#include "LoongFileSystem/LoongFileSystem.h"
+#include "LoongFileSystem/LoongPackFile.h"
+#include "LoongFoundation/LoongLogger.h"
+#include "LoongFoundation/LoongPathUtils.h"
+#include "LoongFoundation/LoongStringUtils.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Loong::AssetPacker {
+
+bool PackDirectory(FS::LoongPackWriter& writer, const std::string& dir)
+{
+    auto files = FS::LoongFileSystem::ListFiles(dir.empty() ? "/" : dir);
+    if (!files.has_value()) {
+        LOONG_ERROR("List directory '{}' failed: {}", dir, FS::LoongFileSystem::GetLastError());
+        return false;
+    }
+    auto& flags = Flags::Get();
+    std::vector<uint8_t> buffer;
+    for (auto& fileName : *files) {
+        std::string path = dir + '/' + fileName;
+        if (FS::LoongFileSystem::IsDir(path)) {
+            if (!PackDirectory(writer, path)) {
+                return false;
+            }
+            continue;
+        }
+        FS::LoongFileSystem::FileStat stat {};
+        if (!FS::LoongFileSystem::GetFileStat(path, stat) || stat.filesize < 0) {
+            LOONG_ERROR("Stat file '{}' failed: {}", path, FS::LoongFileSystem::GetLastError());
+            return false;
+        }
+        buffer.resize(size_t(stat.filesize));
+        if (FS::LoongFileSystem::LoadFileContent(path, buffer.data(), buffer.size()) != stat.filesize) {
+            LOONG_ERROR("Read file '{}' failed: {}", path, FS::LoongFileSystem::GetLastError());
+            return false;
+        }
+        std::string extension(Foundation::LoongPathUtils::GetFileExtension(fileName));
+        Foundation::LoongStringUtils::ToLower(extension);
+        bool allowCompression = !flags.noCompression && flags.storedExtensions.count(extension) == 0;
+        if (!writer.AddFile(path, buffer.data(), buffer.size(), stat.modtime, allowCompression)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int Pack()
+{
+    auto& flags = Flags::Get();
+    if (!FS::LoongFileSystem::MountSearchPath(flags.inputDir)) {
+        LOONG_ERROR("Mount '{}' failed: {}", flags.inputDir, FS::LoongFileSystem::GetLastError());
+        return 1;
+    }
+    FS::LoongPackWriter writer;
+    if (!writer.Open(flags.outputPath) || !PackDirectory(writer, "") || !writer.Finish()) {
+        LOONG_ERROR("Pack '{}' to '{}' failed!", flags.inputDir, flags.outputPath);
+        return 2;
+    }
+    return 0;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace Loong::Foundation;
+    using namespace Loong::AssetPacker;
+
+    auto listener = Logger::Get().SubscribeLog([](const LogItem& logItem) {
+        std::cout << "[" << logItem.level << "][" << logItem.location << "]: " << logItem.message << std::endl;
+    });
+
+    if (!Flags::ParseCommandLine(argc, argv)) {
+        return -1;
+    }
+
+    Loong::FS::ScopedDriver fsDriver(argv[0]);
+    if (!fsDriver) {
+        LOONG_ERROR("Initialize file system failed!");
+        return -1;
+    }
+
+    return Pack();
+}
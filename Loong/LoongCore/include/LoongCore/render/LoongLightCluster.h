@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongCore/render/LoongRenderPass.h"
+#include "LoongFoundation/LoongMath.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Loong::Renderer {
+class LoongCamera;
+}
+
+namespace Loong::Resource {
+class LoongTextureBuffer;
+}
+
+namespace Loong::Core {
+
+// Clustered forward lighting: the view frustum is split into a grid of clusters (froxels), uniformly in screen space
+// and exponentially in depth, and each point/spot light is assigned to the clusters its bounding sphere touches. The
+// fragment shader then only evaluates the lights of the cluster it's in, instead of all the lights of the scene.
+//
+// The lights, the per cluster ranges and the light index lists are uploaded as buffer textures, which are available
+// on GL 3.3, see LoongShader::kLightBufferTextureUnit.
+class LoongLightCluster {
+public:
+    static constexpr uint32_t kClusterCountX = 16;
+    static constexpr uint32_t kClusterCountY = 9;
+    static constexpr uint32_t kClusterCountZ = 24;
+    static constexpr uint32_t kClusterCount = kClusterCountX * kClusterCountY * kClusterCountZ;
+
+    // Binning is split by depth slices into jobs if there are at least this many lights to bin
+    static constexpr uint32_t kParallelLightCount = 64;
+    static constexpr uint32_t kMinSlicesPerJob = 3;
+
+    struct ClusterRange {
+        uint32_t offset; // of the first light index of the cluster
+        uint32_t count;
+    };
+
+    LoongLightCluster();
+    LoongLightCluster(const LoongLightCluster&) = delete;
+    LoongLightCluster(LoongLightCluster&&) = delete;
+    ~LoongLightCluster();
+    LoongLightCluster& operator=(const LoongLightCluster&) = delete;
+    LoongLightCluster& operator=(LoongLightCluster&&) = delete;
+
+    // Assign the lights to the clusters of the camera. The first directionalLightCount lights must be the directional
+    // lights, they affect all the clusters and are not binned
+    void Build(const Renderer::LoongCamera& camera, const std::vector<LoongRenderPass::Light>& lights, uint32_t directionalLightCount);
+
+    void FillLightUBO(LoongRenderPass::LightUBO& lightUbo) const;
+
+    // Upload the lights and the light lists to the buffer textures, and bind them to their texture units
+    void UploadAndBind();
+
+    const ClusterRange& GetClusterRange(uint32_t x, uint32_t y, uint32_t z) const { return clusterRanges_[GetClusterIndex(x, y, z)]; }
+
+    const std::vector<uint16_t>& GetLightIndices() const { return lightIndices_; }
+
+    static uint32_t GetClusterIndex(uint32_t x, uint32_t y, uint32_t z) { return x + kClusterCountX * (y + kClusterCountY * z); }
+
+private:
+    // The bounding sphere of a light in view space, and the range of clusters it may touch
+    struct LightBounds {
+        Math::Vector3 center;
+        float radius;
+        uint32_t minX, maxX, minY, maxY, minZ, maxZ;
+        uint16_t index;
+    };
+
+    uint32_t GetSlice(float depth) const;
+
+    void UpdateClusterBoxes(const Math::Matrix4& projection);
+
+    // Bin the lights to the clusters of depth slices [firstSlice, lastSlice)
+    void BinSlices(uint32_t firstSlice, uint32_t lastSlice);
+
+private:
+    std::vector<LoongRenderPass::Light> lights_ {};
+    uint32_t directionalLightCount_ { 0 };
+    float near_ { 0.0F };
+    float far_ { 0.0F };
+    float sliceScale_ { 0.0F };
+    float sliceBias_ { 0.0F };
+
+    std::vector<Math::AABB> clusterBoxes_ {}; // view space
+    Math::Matrix4 clusterBoxesProjection_ {};
+    std::vector<LightBounds> lightBounds_ {};
+    std::vector<std::vector<uint16_t>> clusterLights_ {}; // per cluster, merged to lightIndices_
+
+    std::vector<ClusterRange> clusterRanges_ {};
+    std::vector<uint16_t> lightIndices_ {};
+
+    std::unique_ptr<Resource::LoongTextureBuffer> lightBuffer_ { nullptr };
+    std::unique_ptr<Resource::LoongTextureBuffer> clusterBuffer_ { nullptr };
+    std::unique_ptr<Resource::LoongTextureBuffer> lightIndexBuffer_ { nullptr };
+};
+
+}
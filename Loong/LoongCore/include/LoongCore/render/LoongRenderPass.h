@@ -5,13 +5,21 @@
 #pragma once
 
 #include "LoongCore/scene/LoongScene.h"
+#include "LoongFoundation/LoongTransformHierarchy.h"
 #include "LoongResource/LoongGpuBuffer.h"
 #include "LoongResource/LoongPipelineFixedState.h"
 #include <memory>
+#include <vector>
+
+namespace Loong::Foundation {
+class Frustum;
+}
 
 namespace Loong::Resource {
 class LoongShader;
 class LoongFrameBuffer;
+class LoongGpuMesh;
+class LoongUniformRingBuffer;
 }
 
 namespace Loong::Renderer {
@@ -22,16 +30,22 @@ namespace Loong::Core {
 
 class LoongScene;
 class LoongCCamera;
+class LoongCModelRenderer;
 
 class LoongRenderPass {
 public:
+    // Per frame data
     struct BasicUBO {
-        Math::Matrix4 ub_Model;
         Math::Matrix4 ub_View;
         Math::Matrix4 ub_Projection;
         Math::Vector3 ub_ViewPos;
         float ub_Time;
     };
+    // Per object data
+    struct ObjectUBO {
+        Math::Matrix4 ub_Model;
+        Math::Matrix4 ub_NormalMatrix; // transpose(inverse(ub_Model)), only the upper left 3x3 is used
+    };
     struct Light {
         Math::Vector3 pos;
         float lightType;
@@ -44,20 +58,22 @@ public:
         float padding1_[2];
     };
 
-    static const int kMaxLightCount = 32;
+    // The lights are not in the uniform block, they are in a buffer texture along with the clustered light lists, see
+    // LoongLightCluster
+    static const int kMaxLightCount = 1024;
     struct LightUBO {
-        float ub_lightsCount;
-        float padding1_[3]; // align to vec4
-        Light ub_lights[kMaxLightCount];
+        Math::Vector4 ub_ClusterGrid; // xyz: cluster count along each axis, w: directional light count
+        Math::Vector4 ub_ClusterDepth; // x: near, y: far, slice = log(depth) * z + w
     };
     static_assert(sizeof(Light) == 16 * sizeof(float));
-    static_assert(sizeof(LightUBO) == kMaxLightCount * sizeof(Light) + 4 * sizeof(float));
+    static_assert(sizeof(LightUBO) == 8 * sizeof(float));
 
     struct Context {
         Renderer::LoongRenderer* renderer { nullptr };
         Resource::LoongUniformBuffer* basicUniforms { nullptr }; // Corresponding to UniformUBO struct
         // Consider use shader storage buffer, but MacOS's highest GL version is 4.1, which does not support it.
         Resource::LoongUniformBuffer* lightUniforms { nullptr }; // Corresponding to LightUBO struct
+        Resource::LoongUniformRingBuffer* objectUniforms { nullptr }; // Corresponding to ObjectUBO struct
         LoongScene* scene { nullptr };
         LoongCCamera* camera { nullptr };
     };
@@ -69,6 +85,24 @@ public:
     virtual void Render(const Context& context) = 0;
 
 protected:
+    static ObjectUBO MakeObjectUBO(const Math::Matrix4& model)
+    {
+        return ObjectUBO { model, Math::Transpose(Math::Inverse(model)) };
+    }
+
+    // By the id of the transform, see Foundation::Transform::GetID
+    static ObjectUBO MakeObjectUBO(uint32_t transformId)
+    {
+        return MakeObjectUBO(Foundation::LoongTransformHierarchy::GetDefault().GetWorldMatrix(transformId));
+    }
+
+    // Collect the meshes of the model renderer that are (potentially) visible to the frustum according to its cull mode,
+    // returns the number of the culled meshes. Only the scene pass records them to the renderer's frame info, so the
+    // statistics are not counted again by the other passes.
+    // isInside means the model renderer is known to be completely inside the frustum, the tests are skipped then.
+    static size_t CollectVisibleMeshes(Renderer::LoongRenderer& renderer, const LoongCModelRenderer& modelRenderer,
+        const Foundation::Frustum& frustum, std::vector<Resource::LoongGpuMesh*>& visibleMeshes, bool isInside = false);
+
     std::shared_ptr<Resource::LoongFrameBuffer> frameBuffer_ {};
     Resource::LoongPipelineFixedState renderState_ {};
 };
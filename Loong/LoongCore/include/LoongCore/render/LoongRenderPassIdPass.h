@@ -5,9 +5,11 @@
 #pragma once
 
 #include "LoongCore/render/LoongRenderPass.h"
+#include "LoongCore/render/LoongRenderQueue.h"
 
 namespace Loong::Resource {
 class LoongGpuModel;
+class LoongGpuMesh;
 }
 namespace Loong::Core {
 
@@ -29,6 +31,13 @@ public:
     }
 
 private:
+    struct IdPassDrawable {
+        uint32_t transformId; // the matrices may move while the queue is alive, the ids don't
+        const Resource::LoongGpuMesh* mesh;
+        uint32_t actorId;
+    };
+
+    LoongRenderQueue<IdPassDrawable> renderQueue_ {};
     Resource::LoongPipelineFixedState state_;
     std::shared_ptr<Resource::LoongShader> sceneIdShader_ { nullptr };
     std::shared_ptr<Resource::LoongGpuModel> cameraModel_ { nullptr };
@@ -4,11 +4,16 @@
 
 #pragma once
 
+#include "LoongCore/render/LoongLightCluster.h"
 #include "LoongCore/render/LoongRenderPass.h"
+#include "LoongCore/render/LoongRenderQueue.h"
 #include "LoongFoundation/LoongMath.h"
+#include "LoongRenderer/LoongRenderer.h"
 
 namespace Loong::Resource {
 class LoongGpuModel;
+class LoongGpuMesh;
+class LoongUniformRingBuffer;
 };
 
 namespace Loong::Core {
@@ -26,6 +31,39 @@ public:
     void SetRenderCamera(bool b) { shouldRenderCamera_ = b; }
 
 protected:
+    struct ScenePassDrawable {
+        uint32_t transformId; // the matrices may move while the queue is alive, the ids don't
+        const Resource::LoongGpuMesh* mesh;
+        const Resource::LoongMaterial* material;
+        uint32_t lod;
+    };
+
+    // A run of drawables in the render queue that share the same mesh, LOD and material. Single drawables of the same
+    // object share the slot.
+    struct ScenePassBatch {
+        size_t first;
+        uint32_t count;
+        bool instanced;
+        intptr_t instanceOffset; // in bytes, valid if instanced
+        uint32_t firstSlot; // slot of the first drawable in the object uniform buffer, valid if not instanced
+    };
+
+    // Groups smaller than this are not worth an instanced draw
+    static constexpr uint32_t kMinInstanceCount = 2;
+
+    void PushDrawable(const ScenePassDrawable& drawable, float depth, bool translucent);
+
+    // Also writes the per object data of the drawables to the instance buffer or the object uniform buffer
+    void BuildBatches(Resource::LoongUniformRingBuffer& objectUniforms);
+
+    LoongRenderQueue<ScenePassDrawable> renderQueue_ {};
+    std::vector<ScenePassBatch> batches_ {};
+    std::vector<ObjectUBO> instanceData_ {};
+    std::vector<Renderer::LoongRenderer::DrawItem> multiDrawItems_ {};
+    std::unique_ptr<Resource::LoongVertexBuffer> instanceBuffer_ { nullptr }; // created lazily
+    std::vector<Light> lights_ {};
+    LoongLightCluster lightCluster_ {};
+    bool isLightOverflowReported_ { false };
     std::shared_ptr<Resource::LoongMaterial> defaultMaterial_ { nullptr };
     std::shared_ptr<Resource::LoongMaterial> cameraMaterial_ { nullptr };
     std::shared_ptr<Resource::LoongGpuModel> cameraModel_ { nullptr };
@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Loong::Core {
+
+// Layout of the 64 bits sort key, from the most significant bit:
+//   opaque:      | layer(4) | translucent(1)=0 | shader(12) | material(12) | mesh(11) | depth(24) |
+//   translucent: | layer(4) | translucent(1)=1 | inverted depth(24) | shader(12) | material(12) | mesh(11) |
+// So opaque drawables are grouped by GPU state first and then drawn front to back, translucent drawables are
+// drawn back to front, and all the opaque drawables of a layer are drawn before the translucent ones.
+class LoongRenderSortKey {
+public:
+    static constexpr uint32_t kLayerBits = 4;
+    static constexpr uint32_t kShaderBits = 12;
+    static constexpr uint32_t kMaterialBits = 12;
+    static constexpr uint32_t kMeshBits = 11;
+    static constexpr uint32_t kDepthBits = 24;
+    static_assert(kLayerBits + 1 + kShaderBits + kMaterialBits + kMeshBits + kDepthBits == 64);
+
+    // depth should be normalized to [0, 1], values out of range are clamped
+    static uint64_t MakeOpaque(uint32_t layer, uint32_t shader, uint32_t material, uint32_t mesh, float depth);
+
+    static uint64_t MakeTranslucent(uint32_t layer, uint32_t shader, uint32_t material, uint32_t mesh, float depth);
+
+    static uint32_t QuantizeDepth(float depth);
+};
+
+class LoongRenderQueueBase {
+public:
+    enum class StateType {
+        kShader,
+        kMaterial,
+        kMesh,
+        kCount,
+    };
+
+    // Returns a small id for a GPU state object, which is stable until Clear() is called. The ids are used to compose
+    // the sort key, so that drawables sharing the same object are adjacent after sorting. Each type has its own ids,
+    // which fit in the bits of the type in the sort key. When they run out, the last id is shared by all the objects
+    // after that: they are still drawn correctly (the batches compare the objects), only less grouped.
+    uint32_t GetStateId(StateType type, const void* object);
+
+    static uint32_t GetMaxStateId(StateType type);
+
+protected:
+    struct Entry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    void ClearEntries();
+
+    // LSD radix sort, 8 bits per pass. Passes in which all the keys have the same digit are skipped.
+    void SortEntries();
+
+    std::vector<Entry> entries_ {};
+    std::vector<Entry> scratch_ {};
+    std::unordered_map<const void*, uint32_t> stateIds_[size_t(StateType::kCount)] {};
+    bool isStateIdOverflowReported_ { false };
+};
+
+// A queue of drawables, the memory is reused across frames so Clear() it instead of creating a new one for every frame.
+template <class Drawable>
+class LoongRenderQueue : public LoongRenderQueueBase {
+public:
+    void Clear()
+    {
+        ClearEntries();
+        drawables_.clear();
+    }
+
+    void Push(uint64_t key, const Drawable& drawable)
+    {
+        entries_.push_back(Entry { key, uint32_t(drawables_.size()) });
+        drawables_.push_back(drawable);
+    }
+
+    void Sort() { SortEntries(); }
+
+    size_t Size() const { return entries_.size(); }
+
+    bool Empty() const { return entries_.empty(); }
+
+    uint64_t GetKey(size_t i) const { return entries_[i].key; }
+
+    // The i-th drawable in sorted order
+    const Drawable& operator[](size_t i) const { return drawables_[entries_[i].index]; }
+
+private:
+    std::vector<Drawable> drawables_ {};
+};
+
+}
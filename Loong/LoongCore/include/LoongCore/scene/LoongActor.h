@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include "LoongCore/scene/LoongActorPool.h"
 #include "LoongCore/scene/LoongComponent.h"
+#include "LoongCore/scene/LoongComponentPool.h"
 #include "LoongFoundation/LoongClock.h"
+#include "LoongFoundation/LoongSigslotHelper.h"
 #include "LoongFoundation/LoongTransform.h"
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -17,7 +21,7 @@ class LoongComponent;
 
 class LoongActor {
 protected:
-    LoongActor(uint32_t actorID, std::string name, std::string tag);
+    LoongActor(std::string name, std::string tag);
 
 public:
     LoongActor(const LoongActor&) = delete;
@@ -28,13 +32,18 @@ public:
     LoongActor& operator=(const LoongActor&) = delete;
     LoongActor& operator=(LoongActor&&) = delete;
 
+    // The actors live in the blocks of LoongActorPool
+    static void* operator new(size_t size) { return LoongActorPool::Allocate(size); }
+
+    static void operator delete(void* memory, size_t size) { LoongActorPool::Free(memory, size); }
+
     const std::string& GetName() const { return name_; }
 
     const std::string& GetTag() const { return tag_; }
 
-    void SetName(const std::string& name) { name_ = name; }
+    void SetName(const std::string& name);
 
-    void SetTag(const std::string& tag) { tag_ = tag; }
+    void SetTag(const std::string& tag);
 
     void SetActive(bool active);
 
@@ -42,8 +51,7 @@ public:
 
     bool IsActive() const { return IsSelfActive() && (HasParent() ? GetParent()->IsActive() : true); }
 
-    void SetID(uint32_t id) { actorID_ = id; }
-
+    // A generational handle, see LoongActorPool::Resolve()
     uint32_t GetID() const { return actorID_; }
 
     void SetParent(LoongActor* parent);
@@ -131,14 +139,19 @@ public:
         if (auto found = GetComponent<T>(); found != nullptr) {
             return found;
         } else {
-            std::shared_ptr<T> comp = std::make_shared<T>(this, std::forward<Args>(args)...);
+            T* comp = LoongComponentPool<T>::Get().Create(this, std::forward<Args>(args)...);
             components_.push_back(comp);
-            AddComponentSignal_.emit(this, comp.get());
+            uint32_t typeIndex = comp->GetTypeIndex();
+            if (typeIndex >= componentsByType_.size()) {
+                componentsByType_.resize(typeIndex + 1, nullptr);
+            }
+            componentsByType_[typeIndex] = comp;
+            AddComponentSignal_.emit(this, comp);
             if (IsActive()) {
                 static_cast<LoongComponent&>(*comp).OnEnable();
                 static_cast<LoongComponent&>(*comp).OnStart();
             }
-            return comp.get();
+            return comp;
         }
     }
 
@@ -147,40 +160,24 @@ public:
     {
         static_assert(std::is_base_of<LoongComponent, T>::value, "T should derive from AComponent");
 
-        std::shared_ptr<T> result(nullptr);
-
-        for (auto it = components_.begin(); it != components_.end(); ++it) {
-            result = std::dynamic_pointer_cast<T>(*it);
-            if (result) {
-                RemoveComponentSignal_.emit(this, result.get());
-                components_.erase(it);
-                return true;
-            }
-        }
-
-        return false;
+        auto* component = GetComponent<T>();
+        return component != nullptr && RemoveComponent(component);
     }
 
     bool RemoveComponent(LoongComponent* component);
 
+    // Only finds the component added as exactly T, not the ones of the classes derived from T
     template <typename T>
-    T* GetComponent()
+    T* GetComponent() const
     {
         static_assert(std::is_base_of<LoongComponent, T>::value, "T should derive from AComponent");
 
-        std::shared_ptr<T> result(nullptr);
-
-        for (auto& component : components_) {
-            result = std::dynamic_pointer_cast<T>(component);
-            if (result) {
-                return result.get();
-            }
-        }
-
-        return nullptr;
+        uint32_t typeIndex = GetComponentTypeIndex<T>();
+        return typeIndex < componentsByType_.size() ? static_cast<T*>(componentsByType_[typeIndex]) : nullptr;
     }
 
-    const std::vector<std::shared_ptr<LoongComponent>>& GetComponents() { return components_; }
+    // In the order they were added
+    const std::vector<LoongComponent*>& GetComponents() const { return components_; }
 
     // virtual void OnSerialize(tinyxml2::XMLDocument& doc, tinyxml2::XMLNode* actorsRoot) override;
 
@@ -213,7 +210,9 @@ private:
     LoongActor* parent_ { nullptr };
     std::vector<LoongActor*> children_ {};
 
-    std::vector<std::shared_ptr<LoongComponent>> components_ {};
+    std::vector<LoongComponent*> components_ {};
+    // Indexed by the component type index, see GetComponentTypeIndex()
+    std::vector<LoongComponent*> componentsByType_ {};
 
     Foundation::Transform transform_ {};
 
@@ -0,0 +1,45 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Loong::Core {
+
+class LoongActor;
+
+// The memory of the actors, and the table from the actor IDs to the actors.
+// An actor ID is a 32-bit generational handle: the low kIndexBits bits are a slot of the table, the high bits are the
+// generation of the slot, which is bumped every time the slot is freed. So the ID of a destroyed actor never resolves
+// to the actor that reuses its slot, it resolves to nullptr instead. 0 is never a valid ID.
+// The freed slots are reused in first in first out order once there are kMinFreeSlots of them, so the generation of a
+// slot is bumped slowly, and a slot whose generation runs out is retired instead of wrapping around. So an ID is never
+// issued twice.
+// The actors are allocated from fixed size blocks, LoongActor::operator new and delete go through here.
+// NOTE: Actors are created and destroyed on the main thread only
+class LoongActorPool {
+public:
+    static constexpr uint32_t kIndexBits = 20;
+    static constexpr uint32_t kMaxActorCount = (1U << kIndexBits) - 1U;
+    static constexpr uint32_t kInvalidID = 0;
+    static constexpr uint32_t kMinFreeSlots = 1024;
+
+    static void* Allocate(size_t size);
+
+    static void Free(void* memory, size_t size);
+
+    // Returns kInvalidID if all the kMaxActorCount slots are used or retired
+    static uint32_t Register(LoongActor* actor);
+
+    static void Unregister(uint32_t id);
+
+    // nullptr if the actor is destroyed
+    static LoongActor* Resolve(uint32_t id);
+
+    static uint32_t GetActorCount();
+};
+
+}
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace Loong::Foundation {
@@ -13,7 +14,9 @@ class LoongClock;
 namespace Loong::Core {
 
 class LoongActor;
+class LoongComponentPoolBase;
 
+// Components are created by LoongActor::AddComponent() in the pool of their type, see LoongComponentPool
 class LoongComponent {
 public:
     explicit LoongComponent(LoongActor* owner)
@@ -31,6 +34,8 @@ public:
 
     LoongActor* GetOwner() const { return owner_; }
 
+    uint32_t GetTypeIndex() const { return typeIndex_; }
+
     void SetSelfActive(bool active) { isActive_ = active; }
 
     bool IsSelfActive() const { return isActive_; }
@@ -66,8 +71,14 @@ public:
     virtual const std::string& GetName() = 0;
 
 private:
+    friend class LoongComponentPoolBase;
+
     LoongActor* owner_ { nullptr };
     bool isActive_ { true };
+
+    LoongComponentPoolBase* pool_ { nullptr };
+    uint32_t typeIndex_ { 0 };
+    uint32_t poolIndex_ { 0 };
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongCore/scene/LoongComponent.h"
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Loong::Core {
+
+class LoongActor;
+
+// Assigned in the order the component types are first used, it indexes the component table of the actors
+uint32_t NextComponentTypeIndex();
+
+template <class T>
+uint32_t GetComponentTypeIndex()
+{
+    static const uint32_t kIndex = NextComponentTypeIndex();
+    return kIndex;
+}
+
+class LoongComponentPoolBase {
+public:
+    LoongComponentPoolBase() = default;
+    LoongComponentPoolBase(const LoongComponentPoolBase&) = delete;
+    LoongComponentPoolBase(LoongComponentPoolBase&&) = delete;
+    virtual ~LoongComponentPoolBase() = default;
+    LoongComponentPoolBase& operator=(const LoongComponentPoolBase&) = delete;
+    LoongComponentPoolBase& operator=(LoongComponentPoolBase&&) = delete;
+
+    // Destroy the component and give its slot back to the pool it was created by
+    static void DestroyComponent(LoongComponent* component) { component->pool_->Destroy(component); }
+
+protected:
+    virtual void Destroy(LoongComponent* component) = 0;
+
+    static void Attach(LoongComponent* component, LoongComponentPoolBase* pool, uint32_t typeIndex, uint32_t poolIndex)
+    {
+        component->pool_ = pool;
+        component->typeIndex_ = typeIndex;
+        component->poolIndex_ = poolIndex;
+    }
+
+    static uint32_t GetPoolIndex(const LoongComponent* component) { return component->poolIndex_; }
+
+    static void SetPoolIndex(LoongComponent* component, uint32_t poolIndex) { component->poolIndex_ = poolIndex; }
+};
+
+// All the components of type T. They are constructed in place in fixed size chunks, so they are never moved and the
+// pointers to them stay valid until they are destroyed. The live ones are also kept packed in one array (a sparse
+// set, each component knows its position in it), which is what the systems iterate.
+template <class T>
+class LoongComponentPool final : public LoongComponentPoolBase {
+public:
+    static LoongComponentPool& Get()
+    {
+        static LoongComponentPool pool;
+        return pool;
+    }
+
+    template <class... Args>
+    T* Create(LoongActor* owner, Args&&... args)
+    {
+        if (freeSlots_.empty()) {
+            AllocateChunk();
+        }
+        void* slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        T* component = new (slot) T(owner, std::forward<Args>(args)...);
+        Attach(component, this, GetComponentTypeIndex<T>(), uint32_t(components_.size()));
+        components_.push_back(component);
+        return component;
+    }
+
+    // The live components, in no particular order
+    const std::vector<T*>& GetComponents() const { return components_; }
+
+protected:
+    void Destroy(LoongComponent* component) override
+    {
+        auto* typed = static_cast<T*>(component);
+        uint32_t index = GetPoolIndex(component);
+        assert(index < components_.size() && components_[index] == typed);
+
+        // Move the last one into the hole
+        components_[index] = components_.back();
+        SetPoolIndex(components_[index], index);
+        components_.pop_back();
+
+        typed->~T();
+        freeSlots_.push_back(typed);
+    }
+
+private:
+    static constexpr size_t kChunkSize = 64;
+
+    struct Slot {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    LoongComponentPool() = default;
+
+    void AllocateChunk()
+    {
+        chunks_.emplace_back(new Slot[kChunkSize]);
+        // The lowest addresses are handed out first
+        for (size_t i = kChunkSize; i > 0; --i) {
+            freeSlots_.push_back(&chunks_.back()[i - 1]);
+        }
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> chunks_ {};
+    std::vector<void*> freeSlots_ {};
+    std::vector<T*> components_ {};
+};
+
+}
@@ -5,15 +5,21 @@
 #pragma once
 
 #include "LoongCore/scene/LoongActor.h"
+#include "LoongFoundation/LoongAABBTree.h"
 #include <functional>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace Loong::Resource {
 class LoongMaterial;
+class LoongGpuModel;
 }
 namespace Loong::Renderer {
 class LoongRenderer;
 }
+namespace Loong::Foundation {
+class Frustum;
+}
 
 namespace Loong::Core {
 
@@ -23,26 +29,53 @@ class LoongCLight;
 
 class LoongScene : public LoongActor {
 public:
+    struct RaycastHit {
+        LoongActor* actor { nullptr };
+        // In units of the ray direction length
+        float distance { 0.0F };
+        // In the world space
+        Math::Vector3 point {};
+        Math::Vector3 normal {};
+        uint32_t meshIndex { 0 };
+        uint32_t triangleIndex { 0 };
+    };
+
     struct FastAccess {
         std::unordered_set<LoongCModelRenderer*> modelRenderers_;
         std::unordered_set<LoongCCamera*> cameras_;
         std::unordered_set<LoongCLight*> lights_;
+        std::unordered_multimap<std::string, LoongActor*> actorsByName_;
+        std::unordered_multimap<std::string, LoongActor*> actorsByTag_;
 
+        void AddActor(LoongActor* actor);
+        void RemoveActor(LoongActor* actor);
         void AbsorbAnother(const FastAccess& another);
         void SubtractAnother(const FastAccess& another);
         void Clear();
     };
 
 protected:
-    LoongScene(uint32_t actorID, std::string name, std::string tag)
-        : LoongActor(actorID, std::move(name), std::move(tag))
+    LoongScene(std::string name, std::string tag);
+
+public:
+    ~LoongScene() override;
+
+    void AddModelRenderer(LoongCModelRenderer* modelRenderer)
     {
+        fastAccess_.modelRenderers_.insert(modelRenderer);
+        WatchTransform(modelRenderer);
+        MarkBoundsDirty(modelRenderer);
     }
 
-public:
-    void AddModelRenderer(LoongCModelRenderer* modelRenderer) { fastAccess_.modelRenderers_.insert(modelRenderer); }
+    void RemoveModelRenderer(LoongCModelRenderer* modelRenderer)
+    {
+        fastAccess_.modelRenderers_.erase(modelRenderer);
+        UnwatchTransform(modelRenderer);
+        RemoveFromSpatialIndex(modelRenderer);
+    }
 
-    void RemoveModelRenderer(LoongCModelRenderer* modelRenderer) { fastAccess_.modelRenderers_.erase(modelRenderer); }
+    // The world bounds of the model renderer will be refreshed in the spatial index before the next query
+    void MarkBoundsDirty(LoongCModelRenderer* modelRenderer) { dirtyBounds_.insert(modelRenderer); }
 
     void AddCamera(LoongCCamera* camera) { fastAccess_.cameras_.insert(camera); }
 
@@ -60,6 +93,36 @@ public:
 
     const FastAccess& GetFastAccess() const { return fastAccess_; }
 
+    // The actor in this scene with the ID, nullptr if it is destroyed or in another scene
+    LoongActor* GetActorById(uint32_t id) const;
+
+    // Any of the actors in this scene with the name or the tag, nullptr if there is none
+    LoongActor* FindActorByName(const std::string& name) const;
+
+    LoongActor* FindActorByTag(const std::string& tag) const;
+
+    void FindActorsByTag(const std::string& tag, std::vector<LoongActor*>& actors) const;
+
+    // Spatial queries against the fat world bounds of the model renderers, the results are conservative.
+    // Model renderers without a model are never reported.
+
+    // isInside is true if the bounds are completely inside the frustum, or the model renderer is not culled at all.
+    // Returns the mesh count of the model renderers culled without being reported.
+    uint64_t QueryFrustum(const Foundation::Frustum& frustum, const std::function<void(LoongCModelRenderer*, bool isInside)>& callback);
+
+    void QueryAABB(const Math::AABB& aabb, const std::function<void(LoongCModelRenderer*)>& callback);
+
+    void QuerySphere(const Math::Vector3& center, float radius, const std::function<void(LoongCModelRenderer*)>& callback);
+
+    // See LoongAABBTree::QueryRay for the meaning of the distances
+    void QueryRay(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, const std::function<float(LoongCModelRenderer*, float distance)>& callback);
+
+    // Find the nearest triangle of the models hit by the world space ray, on the CPU
+    bool Raycast(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, RaycastHit& hit);
+
+    // Ray cast a model placed at the actor's world transform, e.g. a gizmo which is not managed by the scene
+    static bool RaycastModel(const Resource::LoongGpuModel& model, LoongActor* actor, const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, RaycastHit& hit);
+
     static std::unique_ptr<LoongActor> CreateActor(const std::string& name, const std::string& tag = "");
 
     static std::unique_ptr<LoongScene> CreateScene(const std::string& name, const std::string& tag = "");
@@ -67,9 +130,39 @@ public:
 private:
     void ConstructFastAccess();
 
+    void ClearFastAccess();
+
+    void UpdateSpatialIndex();
+
+    void RemoveFromSpatialIndex(LoongCModelRenderer* modelRenderer);
+
+    // The world bounds of the model renderers are refreshed when their transforms are reported to our watcher
+    void WatchTransform(LoongCModelRenderer* modelRenderer);
+
+    void UnwatchTransform(LoongCModelRenderer* modelRenderer);
+
 private:
     FastAccess fastAccess_ {};
 
+    Foundation::LoongAABBTree spatialIndex_ {};
+    struct SpatialProxy {
+        int32_t proxy { -1 };
+        uint32_t meshCount { 0 };
+    };
+    std::unordered_map<LoongCModelRenderer*, SpatialProxy> spatialProxies_ {};
+    // Of all the model renderers in the spatial index
+    uint64_t spatialMeshCount_ { 0 };
+    std::unordered_set<LoongCModelRenderer*> dirtyBounds_ {};
+    // Model renderers with CullMode::kDisabled, they are always reported by frustum queries
+    std::unordered_set<LoongCModelRenderer*> unculledRenderers_ {};
+    // Model renderers with CullMode::kCullCustom, their custom bounds in the spatial index don't bound their meshes, so
+    // ray casts test them one by one
+    std::unordered_set<LoongCModelRenderer*> customCulledRenderers_ {};
+
+    uint32_t transformWatcher_ { 0 };
+    std::unordered_map<const Foundation::Transform*, LoongCModelRenderer*> watchedRenderers_ {};
+    std::vector<Foundation::Transform*> changedTransforms_ {};
+
     friend class LoongActor;
 };
 
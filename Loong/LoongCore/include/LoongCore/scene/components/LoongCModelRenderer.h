@@ -5,9 +5,11 @@
 #pragma once
 
 #include "LoongCore/scene/LoongComponent.h"
+#include "LoongFoundation/LoongMath.h"
 #include "LoongFoundation/LoongSigslotHelper.h"
 #include "LoongResource/LoongGpuModel.h"
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace Loong::Resource {
@@ -16,7 +18,7 @@ class LoongMaterial;
 
 namespace Loong::Core {
 
-class LoongCModelRenderer final : public LoongComponent {
+class LoongCModelRenderer final : public LoongComponent, public Foundation::LoongHasSlots {
     using MaterialRef = std::shared_ptr<Resource::LoongMaterial>;
 
 public:
@@ -39,18 +41,25 @@ public:
 
     void SetModel(std::shared_ptr<Resource::LoongGpuModel> model)
     {
+        pendingModelPath_.clear();
         if (model_ != model) {
             auto oldModel = model_;
             model_ = std::move(model);
             if (model_ != nullptr) {
                 materials_.resize(model_->GetMaterialNames().size());
+                meshLods_.assign(model_->GetMeshes().size(), 0);
             } else {
                 materials_.clear();
+                meshLods_.clear();
             }
             ModelChangedSignal_.emit(model_.get(), oldModel.get());
         }
     }
 
+    // The current model is kept until the model is loaded asynchronously, the placeholder model is rendered if there is
+    // none. If the loading fails, the current model is kept. A later SetModel() cancels it.
+    void SetModelAsync(const std::string& path);
+
     std::shared_ptr<Resource::LoongGpuModel> GetModel() const { return model_; }
 
     const std::vector<MaterialRef>& GetMaterials() const
@@ -63,16 +72,43 @@ public:
         materials_[index] = material;
     }
 
-    void SetCullMode(CullMode mode) { cullMode_ = mode; }
+    void SetCullMode(CullMode mode)
+    {
+        cullMode_ = mode;
+        OnBoundsChanged();
+    }
 
     CullMode GetCullMode() const { return cullMode_; }
 
+    // Bounds in the owner's local space, only used when the cull mode is kCullCustom
+    void SetCustomBounds(const Math::AABB& bounds)
+    {
+        customBounds_ = bounds;
+        OnBoundsChanged();
+    }
+
+    const Math::AABB& GetCustomBounds() const { return customBounds_; }
+
+    // Select the LOD of each mesh by the projected size of its error on the screen, pixelsPerUnit comes from the camera
+    void UpdateLods(const Math::Vector3& viewPosition, float pixelsPerUnit);
+
+    uint32_t GetMeshLod(size_t meshIndex) const { return meshLods_[meshIndex]; }
+
     LOONG_DECLARE_SIGNAL(ModelChanged, Resource::LoongGpuModel*, Resource::LoongGpuModel*); // new model, old model
 
+private:
+    // Notify the scene to refresh our world bounds in its spatial index
+    void OnBoundsChanged();
+
+    void OnModelChanged(Resource::LoongGpuModel*, Resource::LoongGpuModel*) { OnBoundsChanged(); }
+
 private:
     std::shared_ptr<Resource::LoongGpuModel> model_ { nullptr };
     std::vector<MaterialRef> materials_ {};
     CullMode cullMode_ { CullMode::kCullModel };
+    Math::AABB customBounds_ {};
+    std::vector<uint32_t> meshLods_ {};
+    std::string pendingModelPath_ {};
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,240 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongCore/render/LoongLightCluster.h"
+#include "LoongFoundation/LoongJobSystem.h"
+#include "LoongRenderer/LoongCamera.h"
+#include "LoongRenderer/LoongLight.h"
+#include "LoongResource/LoongShader.h"
+#include "LoongResource/LoongTextureBuffer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace Loong::Core {
+
+LoongLightCluster::LoongLightCluster()
+{
+    clusterLights_.resize(kClusterCount);
+    clusterRanges_.resize(kClusterCount, ClusterRange { 0, 0 });
+}
+
+LoongLightCluster::~LoongLightCluster() = default;
+
+// The bounding sphere of the lit volume in world space
+static void GetLightSphere(const LoongRenderPass::Light& light, Math::Vector3& center, float& radius)
+{
+    center = light.pos;
+    radius = light.falloffRadius;
+
+    if (int(light.lightType) != Renderer::LoongLight::kTypeSpot || light.outerAngle >= float(Math::Pi) * 0.5F) {
+        return;
+    }
+    // Bound the cone only, see "Bounding sphere of a spot light cone" by Bart Wronski
+    auto dir = Math::Normalize(light.dir);
+    float cosAngle = std::cos(light.outerAngle);
+    if (light.outerAngle > float(Math::Pi) * 0.25F) {
+        center = light.pos + dir * (cosAngle * light.falloffRadius);
+        radius = std::sin(light.outerAngle) * light.falloffRadius;
+    } else {
+        radius = light.falloffRadius / (2.0F * cosAngle);
+        center = light.pos + dir * radius;
+    }
+}
+
+static bool IsSphereIntersectBox(const Math::Vector3& center, float radius, const Math::AABB& box)
+{
+    float distanceSquare = 0.0F;
+    for (int i = 0; i < 3; ++i) {
+        float v = Math::Clamp(center[i], box.min[i], box.max[i]) - center[i];
+        distanceSquare += v * v;
+    }
+    return distanceSquare <= radius * radius;
+}
+
+static uint32_t NdcToTile(float ndc, uint32_t tileCount)
+{
+    auto tile = int32_t(std::floor((ndc * 0.5F + 0.5F) * float(tileCount)));
+    return uint32_t(std::clamp(tile, 0, int32_t(tileCount) - 1));
+}
+
+uint32_t LoongLightCluster::GetSlice(float depth) const
+{
+    auto slice = int32_t(std::floor(std::log(depth) * sliceScale_ + sliceBias_));
+    return uint32_t(std::clamp(slice, 0, int32_t(kClusterCountZ) - 1));
+}
+
+void LoongLightCluster::UpdateClusterBoxes(const Math::Matrix4& projection)
+{
+    clusterBoxesProjection_ = projection;
+    clusterBoxes_.resize(kClusterCount);
+
+    // Unproject the tile corners on the near plane, a point at depth d on the same view ray is p * (d / -p.z)
+    const auto inverseProjection = Math::Inverse(projection);
+    auto unproject = [&inverseProjection](float x, float y) {
+        auto p = inverseProjection * Math::Vector4(x, y, -1.0F, 1.0F);
+        return Math::Vector3(p) / p.w;
+    };
+
+    for (uint32_t z = 0; z < kClusterCountZ; ++z) {
+        const float sliceNear = near_ * std::pow(far_ / near_, float(z) / float(kClusterCountZ));
+        const float sliceFar = near_ * std::pow(far_ / near_, float(z + 1) / float(kClusterCountZ));
+        for (uint32_t y = 0; y < kClusterCountY; ++y) {
+            const float y0 = -1.0F + 2.0F * float(y) / float(kClusterCountY);
+            const float y1 = -1.0F + 2.0F * float(y + 1) / float(kClusterCountY);
+            for (uint32_t x = 0; x < kClusterCountX; ++x) {
+                const float x0 = -1.0F + 2.0F * float(x) / float(kClusterCountX);
+                const float x1 = -1.0F + 2.0F * float(x + 1) / float(kClusterCountX);
+                const Math::Vector3 corners[4] { unproject(x0, y0), unproject(x1, y0), unproject(x0, y1), unproject(x1, y1) };
+
+                Math::AABB box { Math::Vector3(std::numeric_limits<float>::max()), Math::Vector3(std::numeric_limits<float>::lowest()) };
+                for (auto& corner : corners) {
+                    for (float depth : { sliceNear, sliceFar }) {
+                        auto p = corner * (depth / -corner.z);
+                        box.min = Math::Min(box.min, p);
+                        box.max = Math::Max(box.max, p);
+                    }
+                }
+                clusterBoxes_[GetClusterIndex(x, y, z)] = box;
+            }
+        }
+    }
+}
+
+void LoongLightCluster::Build(const Renderer::LoongCamera& camera, const std::vector<LoongRenderPass::Light>& lights, uint32_t directionalLightCount)
+{
+    assert(directionalLightCount <= lights.size());
+    assert(lights.size() <= LoongRenderPass::kMaxLightCount);
+
+    lights_ = lights;
+    directionalLightCount_ = directionalLightCount;
+
+    const auto& projection = camera.GetProjectionMatrix();
+    if (near_ != camera.GetNear() || far_ != camera.GetFar() || clusterBoxes_.empty() || clusterBoxesProjection_ != projection) {
+        near_ = camera.GetNear();
+        far_ = camera.GetFar();
+        const float logRatio = std::log(far_ / near_);
+        sliceScale_ = float(kClusterCountZ) / logRatio;
+        sliceBias_ = -float(kClusterCountZ) * std::log(near_) / logRatio;
+        UpdateClusterBoxes(projection);
+    }
+
+    // Compute the cluster ranges of the lights
+    const auto& view = camera.GetViewMatrix();
+    lightBounds_.clear();
+    for (size_t i = directionalLightCount; i < lights.size(); ++i) {
+        Math::Vector3 worldCenter;
+        float radius;
+        GetLightSphere(lights[i], worldCenter, radius);
+
+        LightBounds bounds {};
+        bounds.center = Math::Vector3(view * Math::Vector4(worldCenter, 1.0F));
+        bounds.radius = radius;
+        bounds.index = uint16_t(i);
+
+        const float minDepth = -bounds.center.z - radius;
+        const float maxDepth = -bounds.center.z + radius;
+        if (maxDepth < near_ || minDepth > far_) {
+            continue;
+        }
+        bounds.minZ = GetSlice(Math::Max(minDepth, near_));
+        bounds.maxZ = GetSlice(Math::Min(maxDepth, far_));
+
+        if (minDepth <= near_) {
+            // The sphere crosses the near plane, its projection is unbounded
+            bounds.minX = bounds.minY = 0;
+            bounds.maxX = kClusterCountX - 1;
+            bounds.maxY = kClusterCountY - 1;
+        } else {
+            // The sphere is in front of the camera, the projection of its box bounds its projection
+            Math::Vector2 ndcMin { std::numeric_limits<float>::max() };
+            Math::Vector2 ndcMax { std::numeric_limits<float>::lowest() };
+            for (int corner = 0; corner < 8; ++corner) {
+                Math::Vector3 p {
+                    bounds.center.x + ((corner & 1) ? radius : -radius),
+                    bounds.center.y + ((corner & 2) ? radius : -radius),
+                    bounds.center.z + ((corner & 4) ? radius : -radius),
+                };
+                auto clip = projection * Math::Vector4(p, 1.0F);
+                auto ndc = Math::Vector2(clip) / clip.w;
+                ndcMin = Math::Min(ndcMin, ndc);
+                ndcMax = Math::Max(ndcMax, ndc);
+            }
+            if (ndcMax.x < -1.0F || ndcMin.x > 1.0F || ndcMax.y < -1.0F || ndcMin.y > 1.0F) {
+                continue;
+            }
+            bounds.minX = NdcToTile(ndcMin.x, kClusterCountX);
+            bounds.maxX = NdcToTile(ndcMax.x, kClusterCountX);
+            bounds.minY = NdcToTile(ndcMin.y, kClusterCountY);
+            bounds.maxY = NdcToTile(ndcMax.y, kClusterCountY);
+        }
+        lightBounds_.push_back(bounds);
+    }
+
+    // Bin, each job owns a range of depth slices so they never write to the same cluster
+    uint32_t slicesPerJob = kClusterCountZ;
+    if (lightBounds_.size() >= kParallelLightCount) {
+        slicesPerJob = kMinSlicesPerJob;
+    }
+    Foundation::LoongJobSystem::ParallelFor(0, kClusterCountZ, slicesPerJob, [this](uint32_t first, uint32_t last) { BinSlices(first, last); });
+
+    // Merge the lists
+    lightIndices_.clear();
+    for (uint32_t i = 0; i < kClusterCount; ++i) {
+        auto& list = clusterLights_[i];
+        clusterRanges_[i] = ClusterRange { uint32_t(lightIndices_.size()), uint32_t(list.size()) };
+        lightIndices_.insert(lightIndices_.end(), list.begin(), list.end());
+    }
+}
+
+void LoongLightCluster::BinSlices(uint32_t firstSlice, uint32_t lastSlice)
+{
+    for (uint32_t z = firstSlice; z < lastSlice; ++z) {
+        for (uint32_t i = GetClusterIndex(0, 0, z), end = GetClusterIndex(0, 0, z + 1); i < end; ++i) {
+            clusterLights_[i].clear();
+        }
+    }
+
+    for (const auto& bounds : lightBounds_) {
+        const uint32_t minZ = Math::Max(bounds.minZ, firstSlice);
+        const uint32_t maxZ = Math::Min(bounds.maxZ + 1, lastSlice);
+        for (uint32_t z = minZ; z < maxZ; ++z) {
+            for (uint32_t y = bounds.minY; y <= bounds.maxY; ++y) {
+                for (uint32_t x = bounds.minX; x <= bounds.maxX; ++x) {
+                    const uint32_t clusterIndex = GetClusterIndex(x, y, z);
+                    if (IsSphereIntersectBox(bounds.center, bounds.radius, clusterBoxes_[clusterIndex])) {
+                        clusterLights_[clusterIndex].push_back(bounds.index);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LoongLightCluster::FillLightUBO(LoongRenderPass::LightUBO& lightUbo) const
+{
+    lightUbo.ub_ClusterGrid = Math::Vector4(float(kClusterCountX), float(kClusterCountY), float(kClusterCountZ), float(directionalLightCount_));
+    lightUbo.ub_ClusterDepth = Math::Vector4(near_, far_, sliceScale_, sliceBias_);
+}
+
+void LoongLightCluster::UploadAndBind()
+{
+    if (lightBuffer_ == nullptr) {
+        lightBuffer_ = std::make_unique<Resource::LoongTextureBuffer>(GL_RGBA32F);
+        clusterBuffer_ = std::make_unique<Resource::LoongTextureBuffer>(GL_RG32UI);
+        lightIndexBuffer_ = std::make_unique<Resource::LoongTextureBuffer>(GL_R16UI);
+    }
+
+    static_assert(sizeof(ClusterRange) == 2 * sizeof(uint32_t));
+    lightBuffer_->BufferData(lights_.data(), lights_.size() * sizeof(LoongRenderPass::Light));
+    clusterBuffer_->BufferData(clusterRanges_.data(), clusterRanges_.size() * sizeof(ClusterRange));
+    lightIndexBuffer_->BufferData(lightIndices_.data(), lightIndices_.size() * sizeof(uint16_t));
+
+    lightBuffer_->Bind(Resource::LoongShader::kLightBufferTextureUnit);
+    clusterBuffer_->Bind(Resource::LoongShader::kClusterBufferTextureUnit);
+    lightIndexBuffer_->Bind(Resource::LoongShader::kLightIndexBufferTextureUnit);
+}
+
+}
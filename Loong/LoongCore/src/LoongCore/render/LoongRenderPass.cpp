@@ -3,7 +3,11 @@
 //
 
 #include "LoongCore/render/LoongRenderPass.h"
+#include "LoongCore/scene/components/LoongCModelRenderer.h"
+#include "LoongFoundation/LoongFrustum.h"
+#include "LoongRenderer/LoongRenderer.h"
 #include "LoongResource/LoongFrameBuffer.h"
+#include "LoongResource/LoongGpuModel.h"
 
 namespace Loong::Core {
 
@@ -12,4 +16,44 @@ LoongRenderPass::LoongRenderPass()
     frameBuffer_ = std::make_shared<Resource::LoongFrameBuffer>();
 }
 
+size_t LoongRenderPass::CollectVisibleMeshes(Renderer::LoongRenderer& renderer, const LoongCModelRenderer& modelRenderer,
+    const Foundation::Frustum& frustum, std::vector<Resource::LoongGpuMesh*>& visibleMeshes, bool isInside)
+{
+    visibleMeshes.clear();
+
+    auto gpuModel = modelRenderer.GetModel();
+    if (gpuModel == nullptr) {
+        return 0;
+    }
+    auto& meshes = gpuModel->GetMeshes();
+    auto& modelMatrix = modelRenderer.GetOwner()->GetTransform().GetWorldTransformMatrix();
+
+    if (isInside) {
+        visibleMeshes = meshes;
+        return 0;
+    }
+
+    switch (modelRenderer.GetCullMode()) {
+    case LoongCModelRenderer::CullMode::kCullModel:
+        if (frustum.IsBoxVisible(gpuModel->GetAABB().Transformed(modelMatrix))) {
+            visibleMeshes = meshes;
+        }
+        break;
+    case LoongCModelRenderer::CullMode::kCullMesh:
+        visibleMeshes = renderer.GetMeshesInFrustum(*gpuModel, modelMatrix, frustum);
+        break;
+    case LoongCModelRenderer::CullMode::kCullCustom:
+        if (frustum.IsBoxVisible(modelRenderer.GetCustomBounds().Transformed(modelMatrix))) {
+            visibleMeshes = meshes;
+        }
+        break;
+    case LoongCModelRenderer::CullMode::kDisabled:
+    default:
+        visibleMeshes = meshes;
+        break;
+    }
+
+    return meshes.size() - visibleMeshes.size();
+}
+
 }
@@ -10,6 +10,7 @@
 #include "LoongResource/LoongMaterial.h"
 #include "LoongResource/LoongResourceManager.h"
 #include "LoongResource/LoongShader.h"
+#include "LoongResource/LoongUniformRingBuffer.h"
 
 namespace Loong::Core {
 
@@ -28,77 +29,84 @@ LoongRenderPassIdPass::LoongRenderPassIdPass()
 
 void LoongRenderPassIdPass::Render(const Context& context)
 {
-    struct IdPassDrawable {
-        const Math::Matrix4* transform;
-        const Resource::LoongGpuMesh* mesh;
-        uint32_t actorId;
-        float distance;
-    };
-
     auto& camera = *context.camera;
     auto& scene = *context.scene;
     auto& renderer = *context.renderer;
     auto& basicUniforms = *context.basicUniforms;
+    auto& objectUniforms = *context.objectUniforms;
 
     BasicUBO ub {};
     ub.ub_ViewPos = camera.GetOwner()->GetTransform().GetWorldPosition();
     ub.ub_Projection = camera.GetCamera().GetProjectionMatrix();
     ub.ub_View = camera.GetCamera().GetViewMatrix();
 
-    std::vector<IdPassDrawable> allDrawables;
+    renderQueue_.Clear();
 
     auto& cameraActor = *camera.GetOwner();
     auto& cameraActorTransform = cameraActor.GetTransform();
+    auto& frustum = camera.GetCamera().GetFrustum();
+    const float invFar = 1.0F / camera.GetCamera().GetFar();
 
     // Prepare drawables
-    for (auto* modelRenderer : scene.GetFastAccess().modelRenderers_) {
-        // TODO: cull the objects cannot be seen
+    std::vector<Resource::LoongGpuMesh*> visibleMeshes;
+    // Hierarchical culling with the scene's spatial index, only the potentially visible model renderers are visited
+    scene.QueryFrustum(frustum, [&](LoongCModelRenderer* modelRenderer, bool isInside) {
+        CollectVisibleMeshes(renderer, *modelRenderer, frustum, visibleMeshes, isInside);
+        if (visibleMeshes.empty()) {
+            return;
+        }
 
         IdPassDrawable drawable {};
         auto* actor = modelRenderer->GetOwner();
         auto& actorTransform = actor->GetTransform();
-        drawable.transform = &actorTransform.GetWorldTransformMatrix();
-        drawable.distance = Math::Distance(actorTransform.GetWorldPosition(), cameraActorTransform.GetWorldPosition());
+        drawable.transformId = actorTransform.GetID();
+        float depth = Math::Distance(actorTransform.GetWorldPosition(), cameraActorTransform.GetWorldPosition()) * invFar;
         drawable.actorId = actor->GetID();
 
-        auto gpuModel = modelRenderer->GetModel();
-        if (gpuModel == nullptr) {
-            continue;
-        }
-        for (auto* mesh : gpuModel->GetMeshes()) {
+        for (auto* mesh : visibleMeshes) {
             drawable.mesh = mesh;
-            allDrawables.push_back(drawable);
+            renderQueue_.Push(LoongRenderSortKey::MakeOpaque(0, 0, 0, renderQueue_.GetStateId(LoongRenderQueueBase::StateType::kMesh, mesh), depth), drawable);
         }
-    }
+    });
 
     if (cameraModel_ != nullptr) {
+        auto& meshes = cameraModel_->GetMeshes();
         for (auto* cam : scene.GetFastAccess().cameras_) {
-            // TODO: cull the objects cannot be seen
             IdPassDrawable drawable {};
             auto* actor = cam->GetOwner();
             auto& actorTransform = actor->GetTransform();
-            drawable.transform = &actorTransform.GetWorldTransformMatrix();
-            drawable.distance = Math::Distance(actorTransform.GetWorldPosition(), cameraActorTransform.GetWorldPosition());
+            drawable.transformId = actorTransform.GetID();
+            if (!frustum.IsBoxVisible(cameraModel_->GetAABB().Transformed(actorTransform.GetWorldTransformMatrix()))) {
+                continue;
+            }
+            float depth = Math::Distance(actorTransform.GetWorldPosition(), cameraActorTransform.GetWorldPosition()) * invFar;
             drawable.actorId = actor->GetID();
 
-            for (auto* mesh : cameraModel_->GetMeshes()) {
+            for (auto* mesh : meshes) {
                 drawable.mesh = mesh;
-                allDrawables.push_back(drawable);
+                renderQueue_.Push(LoongRenderSortKey::MakeOpaque(0, 0, 0, renderQueue_.GetStateId(LoongRenderQueueBase::StateType::kMesh, mesh), depth), drawable);
             }
         }
     }
 
-    // sort
-    std::sort(allDrawables.begin(), allDrawables.end(), [](const IdPassDrawable& a, const IdPassDrawable& b) -> bool {
-        return a.distance < b.distance;
-    });
+    renderQueue_.Sort();
+
+    basicUniforms.SetSubData(&ub, 0);
+    uint32_t firstSlot = 0;
+    for (size_t i = 0, count = renderQueue_.Size(); i < count; ++i) {
+        auto slot = objectUniforms.Push(MakeObjectUBO(renderQueue_[i].transformId));
+        if (i == 0) {
+            firstSlot = slot;
+        }
+    }
+    objectUniforms.Upload();
 
     renderer.ApplyStateMask(state_);
     sceneIdShader_->Bind();
     // render
-    for (auto& drawable : allDrawables) {
-        ub.ub_Model = *drawable.transform;
-        basicUniforms.SetSubData(&ub, 0);
+    for (size_t i = 0, count = renderQueue_.Size(); i < count; ++i) {
+        auto& drawable = renderQueue_[i];
+        objectUniforms.BindSlot(firstSlot + uint32_t(i));
         sceneIdShader_->SetUniformVec4("u_id", ActorIdToColor(drawable.actorId));
 
         renderer.Draw(*drawable.mesh);
@@ -7,57 +7,128 @@
 #include "LoongCore/scene/components/LoongCLight.h"
 #include "LoongCore/scene/components/LoongCModelRenderer.h"
 #include "LoongCore/scene/components/LoongCSky.h"
+#include "LoongFoundation/LoongLogger.h"
 #include "LoongRenderer/LoongRenderer.h"
 #include "LoongResource/LoongGpuMesh.h"
 #include "LoongResource/LoongMaterial.h"
 #include "LoongResource/LoongResourceManager.h"
+#include "LoongResource/LoongUniformRingBuffer.h"
 
 namespace Loong::Core {
 
-void LoongRenderPassScenePass::Render(const Context& context)
+void LoongRenderPassScenePass::PushDrawable(const ScenePassDrawable& drawable, float depth, bool translucent)
 {
-    struct ScenePassDrawable {
-        const Math::Matrix4* transform;
-        const Resource::LoongGpuMesh* mesh;
-        const Resource::LoongMaterial* material;
-        float distance;
-    };
+    using StateType = LoongRenderQueueBase::StateType;
+    auto shaderId = renderQueue_.GetStateId(StateType::kShader, drawable.material->GetShader().get());
+    auto materialId = renderQueue_.GetStateId(StateType::kMaterial, drawable.material);
+    // Each LOD of a mesh is a different draw
+    auto meshId = renderQueue_.GetStateId(StateType::kMesh, &drawable.mesh->GetLod(drawable.lod));
+    if (translucent) {
+        renderQueue_.Push(LoongRenderSortKey::MakeTranslucent(0, shaderId, materialId, meshId, depth), drawable);
+    } else {
+        renderQueue_.Push(LoongRenderSortKey::MakeOpaque(0, shaderId, materialId, meshId, depth), drawable);
+    }
+}
+
+void LoongRenderPassScenePass::BuildBatches(Resource::LoongUniformRingBuffer& objectUniforms)
+{
+    batches_.clear();
+    instanceData_.clear();
+
+    const size_t count = renderQueue_.Size();
+    size_t first = 0;
+    // The object uniforms of the last non instanced drawable, a single drawable of the same object reuses them
+    uint32_t lastTransformId = Foundation::LoongTransformHierarchy::kNone;
+    uint32_t lastSlot = 0;
+    while (first < count) {
+        auto& firstDrawable = renderQueue_[first];
+        size_t last = first + 1;
+        while (last < count && renderQueue_[last].mesh == firstDrawable.mesh && renderQueue_[last].lod == firstDrawable.lod
+            && renderQueue_[last].material == firstDrawable.material) {
+            ++last;
+        }
+
+        ScenePassBatch batch { first, uint32_t(last - first), false, 0, 0 };
+        if (batch.count >= kMinInstanceCount && firstDrawable.material->IsInstancingSupported()) {
+            batch.instanced = true;
+            batch.instanceOffset = intptr_t(instanceData_.size() * sizeof(ObjectUBO));
+            for (size_t i = first; i < last; ++i) {
+                instanceData_.push_back(MakeObjectUBO(renderQueue_[i].transformId));
+            }
+        } else if (batch.count == 1 && firstDrawable.transformId == lastTransformId) {
+            batch.firstSlot = lastSlot;
+        } else {
+            for (size_t i = first; i < last; ++i) {
+                lastSlot = objectUniforms.Push(MakeObjectUBO(renderQueue_[i].transformId));
+                if (i == first) {
+                    batch.firstSlot = lastSlot;
+                }
+            }
+            lastTransformId = renderQueue_[last - 1].transformId;
+        }
+        batches_.push_back(batch);
+        first = last;
+    }
 
+    objectUniforms.Upload();
+    if (!instanceData_.empty()) {
+        if (instanceBuffer_ == nullptr) {
+            instanceBuffer_ = std::make_unique<Resource::LoongVertexBuffer>();
+        }
+        instanceBuffer_->BufferData(instanceData_.data(), instanceData_.size(), Resource::LoongGpuBufferUsage::kStreamDraw);
+    }
+}
+
+void LoongRenderPassScenePass::Render(const Context& context)
+{
     auto& camera = *context.camera;
     auto& scene = *context.scene;
     auto& renderer = *context.renderer;
     auto& basicUniforms = *context.basicUniforms;
+    auto& objectUniforms = *context.objectUniforms;
 
     BasicUBO ub {};
     ub.ub_ViewPos = camera.GetOwner()->GetTransform().GetWorldPosition();
     ub.ub_Projection = camera.GetCamera().GetProjectionMatrix();
     ub.ub_View = camera.GetCamera().GetViewMatrix();
 
-    std::vector<ScenePassDrawable> opaqueDrawables;
-    std::vector<ScenePassDrawable> transparentDrawables;
+    renderQueue_.Clear();
 
     auto& cameraActor = *camera.GetOwner();
     auto& cameraActorTransform = cameraActor.GetTransform();
+    auto& frustum = camera.GetCamera().GetFrustum();
+    const float invFar = 1.0F / camera.GetCamera().GetFar();
+    const float pixelsPerUnit = camera.GetCamera().GetPixelsPerUnit();
 
     // Prepare drawables
-    for (auto* modelRenderer : scene.GetFastAccess().modelRenderers_) {
-        // TODO: cull the objects cannot be seen
+    std::vector<Resource::LoongGpuMesh*> visibleMeshes;
+    // Hierarchical culling with the scene's spatial index, only the potentially visible model renderers are visited
+    uint64_t culledRendererMeshCount = scene.QueryFrustum(frustum, [&](LoongCModelRenderer* modelRenderer, bool isInside) {
+        size_t culledMeshCount = CollectVisibleMeshes(renderer, *modelRenderer, frustum, visibleMeshes, isInside);
+        renderer.AddCullingResult(visibleMeshes.size(), culledMeshCount);
+        if (visibleMeshes.empty()) {
+            return;
+        }
 
         ScenePassDrawable drawable {};
         auto* actor = modelRenderer->GetOwner();
         auto& actorTransform = actor->GetTransform();
-        drawable.transform = &actorTransform.GetWorldTransformMatrix();
-        drawable.distance = Math::Distance(actorTransform.GetWorldPosition(), cameraActorTransform.GetWorldPosition());
+        drawable.transformId = actorTransform.GetID();
+        float depth = Math::Distance(actorTransform.GetWorldPosition(), cameraActorTransform.GetWorldPosition()) * invFar;
 
-        auto gpuModel = modelRenderer->GetModel();
-        if (gpuModel == nullptr) {
-            continue;
-        }
+        modelRenderer->UpdateLods(cameraActorTransform.GetWorldPosition(), pixelsPerUnit);
+
+        // The visible meshes keep the order of the model's meshes, find their indices with a merge walk
+        auto model = modelRenderer->GetModel();
+        auto& meshes = model->GetMeshes();
+        size_t meshIndex = 0;
         auto& materials = modelRenderer->GetMaterials();
-        auto& meshes = gpuModel->GetMeshes();
-        size_t meshCount = meshes.size();
-        for (size_t i = 0; i < meshCount; ++i) {
-            drawable.mesh = meshes[i];
+        for (auto* mesh : visibleMeshes) {
+            while (meshes[meshIndex] != mesh) {
+                ++meshIndex;
+            }
+            drawable.mesh = mesh;
+            drawable.lod = modelRenderer->GetMeshLod(meshIndex);
             drawable.material = materials[drawable.mesh->GetMaterialIndex()].get();
             if (drawable.material == nullptr || !drawable.material->HasShader()) {
                 drawable.material = defaultMaterial_.get();
@@ -65,89 +136,136 @@ void LoongRenderPassScenePass::Render(const Context& context)
                     continue;
                 }
             }
-            if (drawable.material->IsBlendable()) {
-                transparentDrawables.push_back(drawable);
-            } else {
-                opaqueDrawables.push_back(drawable);
-            }
+            PushDrawable(drawable, depth, drawable.material->IsBlendable());
         }
-    }
+    });
+    // The meshes of the model renderers culled as a whole by the spatial index
+    renderer.AddCullingResult(0, culledRendererMeshCount);
 
     if (shouldRenderCamera_ && cameraModel_ != nullptr && cameraMaterial_ != nullptr && cameraMaterial_->HasShader()) {
-        // TODO: cull the objects cannot be seen
+        auto& meshes = cameraModel_->GetMeshes();
         for (auto* cam : scene.GetFastAccess().cameras_) {
             ScenePassDrawable drawable {};
             auto* actor = cam->GetOwner();
             auto& actorTransform = actor->GetTransform();
-            drawable.transform = &actorTransform.GetWorldTransformMatrix();
-            drawable.distance = Math::Distance(actorTransform.GetWorldPosition(), cameraActorTransform.GetWorldPosition());
+            drawable.transformId = actorTransform.GetID();
+            if (!frustum.IsBoxVisible(cameraModel_->GetAABB().Transformed(actorTransform.GetWorldTransformMatrix()))) {
+                renderer.AddCullingResult(0, meshes.size());
+                continue;
+            }
+            renderer.AddCullingResult(meshes.size(), 0);
+            float depth = Math::Distance(actorTransform.GetWorldPosition(), cameraActorTransform.GetWorldPosition()) * invFar;
             drawable.material = cameraMaterial_.get();
 
-            auto& meshes = cameraModel_->GetMeshes();
             for (auto* mesh : meshes) {
                 drawable.mesh = mesh;
-                transparentDrawables.push_back(drawable);
+                PushDrawable(drawable, depth, true);
             }
         }
     }
 
-    // sort
-    std::sort(opaqueDrawables.begin(), opaqueDrawables.end(), [](const ScenePassDrawable& a, const ScenePassDrawable& b) -> bool {
-        return a.distance < b.distance;
-    });
-    std::sort(transparentDrawables.begin(), transparentDrawables.end(), [](const ScenePassDrawable& a, const ScenePassDrawable& b) -> bool {
-        return a.distance > b.distance;
-    });
+    renderQueue_.Sort();
 
     if (auto* lightUniforms = context.lightUniforms; lightUniforms != nullptr) {
-        LightUBO lightUbo {};
-        int lightsCount = 0;
-        for (auto& light : scene.GetFastAccess().lights_) {
-            if (lightsCount >= kMaxLightCount) {
-                break;
+        // Directional lights come first, the point and spot lights are culled against the frustum and binned to clusters
+        lights_.clear();
+        uint32_t directionalLightCount = 0;
+        uint32_t droppedLightCount = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (auto* light : scene.GetFastAccess().lights_) {
+                bool isDirectional = light->GetType() == LoongCLight::Type::kTypeDirectional;
+                if (isDirectional != (pass == 0)) {
+                    continue;
+                }
+                auto& lightTransform = light->GetOwner()->GetTransform();
+                if (!isDirectional && !frustum.IsSphereVisible(lightTransform.GetWorldPosition(), light->GetFalloffRadius())) {
+                    continue;
+                }
+                if (lights_.size() >= kMaxLightCount) {
+                    ++droppedLightCount;
+                    continue;
+                }
+                auto& lightInfo = lights_.emplace_back();
+                lightInfo.lightType = float(light->GetType());
+                lightInfo.color = light->GetColor();
+                lightInfo.dir = lightTransform.GetWorldForward();
+                lightInfo.pos = lightTransform.GetWorldPosition();
+                lightInfo.intencity = light->GetIntensity();
+                lightInfo.falloffRadius = light->GetFalloffRadius();
+                lightInfo.innerAngle = light->GetInnerAngle();
+                lightInfo.outerAngle = light->GetOuterAngle();
+                directionalLightCount += isDirectional ? 1 : 0;
             }
-            auto& lightInfo = lightUbo.ub_lights[lightsCount++];
-            lightInfo.lightType = float(light->GetType());
-            lightInfo.color = light->GetColor();
-            lightInfo.dir = light->GetOwner()->GetTransform().GetWorldForward();
-            lightInfo.pos = light->GetOwner()->GetTransform().GetWorldPosition();
-            lightInfo.intencity = light->GetIntensity();
-            lightInfo.falloffRadius = light->GetFalloffRadius();
-            lightInfo.innerAngle = light->GetInnerAngle();
-            lightInfo.outerAngle = light->GetOuterAngle();
         }
-        lightUbo.ub_lightsCount = float(lightsCount);
-        lightUbo.padding1_[0] = float(lightsCount);
-        lightUbo.padding1_[2] = float(lightsCount);
-        lightUbo.padding1_[1] = float(lightsCount);
+        if (droppedLightCount > 0 && !isLightOverflowReported_) {
+            isLightOverflowReported_ = true;
+            LOONG_WARNING("Too many visible lights, {} of them over the limit {} are dropped", droppedLightCount, kMaxLightCount);
+        }
+        lightCluster_.Build(camera.GetCamera(), lights_, directionalLightCount);
+        lightCluster_.UploadAndBind();
 
+        LightUBO lightUbo {};
+        lightCluster_.FillLightUBO(lightUbo);
         lightUniforms->SetSubData(&lightUbo, 0);
     }
 
-    // render
-    for (auto& drawable : opaqueDrawables) {
-        ub.ub_Model = *drawable.transform;
-        basicUniforms.SetSubData(&ub, 0);
-        drawable.material->Bind(nullptr);
-        renderer.ApplyStateMask(drawable.material->GenerateStateMask());
+    basicUniforms.SetSubData(&ub, 0);
 
-        renderer.Draw(*drawable.mesh);
-    }
-    for (auto& drawable : transparentDrawables) {
-        ub.ub_Model = *drawable.transform;
-        basicUniforms.SetSubData(&ub, 0);
-        drawable.material->Bind(nullptr);
-        renderer.ApplyStateMask(drawable.material->GenerateStateMask());
+    // render
+    BuildBatches(objectUniforms);
+    const Resource::LoongMaterial* boundMaterial = nullptr;
+    bool isBoundInstanced = false;
+    for (size_t b = 0; b < batches_.size(); ++b) {
+        auto& batch = batches_[b];
+        auto& drawable = renderQueue_[batch.first];
+        if (drawable.material != boundMaterial || batch.instanced != isBoundInstanced) {
+            boundMaterial = drawable.material;
+            isBoundInstanced = batch.instanced;
+            if (batch.instanced) {
+                drawable.material->BindInstanced(nullptr);
+            } else {
+                drawable.material->Bind(nullptr);
+            }
+            renderer.ApplyStateMask(drawable.material->GenerateStateMask());
+        }
 
-        renderer.Draw(*drawable.mesh);
+        if (batch.instanced) {
+            drawable.mesh->BindInstanceAttributes(*instanceBuffer_, batch.instanceOffset);
+            renderer.Draw(*drawable.mesh, Renderer::LoongRenderer::PrimitiveMode::kTriangles, batch.count, drawable.lod);
+            drawable.mesh->UnbindInstanceAttributes();
+            continue;
+        }
+        if (batch.count == 1) {
+            // The following single drawables of the same object and material, whose meshes share the arena, e.g. the
+            // other meshes of a model, go in one multi draw
+            auto canMerge = [&](const ScenePassBatch& next) {
+                auto& nextDrawable = renderQueue_[next.first];
+                return !next.instanced && next.count == 1 && next.firstSlot == batch.firstSlot && nextDrawable.material == drawable.material
+                    && nextDrawable.mesh->GetArena() == drawable.mesh->GetArena();
+            };
+            multiDrawItems_.clear();
+            multiDrawItems_.push_back({ drawable.mesh, drawable.lod });
+            while (b + 1 < batches_.size() && canMerge(batches_[b + 1])) {
+                auto& nextDrawable = renderQueue_[batches_[++b].first];
+                multiDrawItems_.push_back({ nextDrawable.mesh, nextDrawable.lod });
+            }
+            objectUniforms.BindSlot(batch.firstSlot);
+            renderer.MultiDraw(multiDrawItems_.data(), multiDrawItems_.size());
+            continue;
+        }
+        for (uint32_t i = 0; i < batch.count; ++i) {
+            objectUniforms.BindSlot(batch.firstSlot + i);
+            renderer.Draw(*drawable.mesh, Renderer::LoongRenderer::PrimitiveMode::kTriangles, 1, drawable.lod);
+        }
     }
 
     // Sky
     if (auto* sky = scene.GetComponent<Core::LoongCSky>(); sky != nullptr) {
         auto material = sky->GetSkyMaterial();
         if (material != nullptr) {
-            ub.ub_Model = sky->GetOwner()->GetTransform().GetTransformMatrix();
-            basicUniforms.SetSubData(&ub, 0);
+            auto slot = objectUniforms.Push(MakeObjectUBO(sky->GetOwner()->GetTransform().GetTransformMatrix()));
+            objectUniforms.Upload();
+            objectUniforms.BindSlot(slot);
             material->Bind(nullptr);
             renderer.ApplyStateMask(material->GenerateStateMask());
 
@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongCore/render/LoongRenderQueue.h"
+#include "LoongFoundation/LoongLogger.h"
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+namespace Loong::Core {
+
+namespace {
+
+inline uint64_t Bits(uint32_t value, uint32_t bitCount)
+{
+    // The fields would run into each other otherwise
+    assert(uint64_t(value) < (uint64_t(1) << bitCount));
+    return uint64_t(value) & ((uint64_t(1) << bitCount) - 1);
+}
+
+}
+
+uint32_t LoongRenderSortKey::QuantizeDepth(float depth)
+{
+    constexpr uint32_t kMaxDepth = (1u << kDepthBits) - 1;
+    if (!(depth > 0.0F)) { // NaN goes here too
+        return 0;
+    }
+    if (depth >= 1.0F) {
+        return kMaxDepth;
+    }
+    return uint32_t(depth * float(kMaxDepth));
+}
+
+uint64_t LoongRenderSortKey::MakeOpaque(uint32_t layer, uint32_t shader, uint32_t material, uint32_t mesh, float depth)
+{
+    uint64_t key = Bits(layer, kLayerBits);
+    key = (key << 1u) | 0u;
+    key = (key << kShaderBits) | Bits(shader, kShaderBits);
+    key = (key << kMaterialBits) | Bits(material, kMaterialBits);
+    key = (key << kMeshBits) | Bits(mesh, kMeshBits);
+    key = (key << kDepthBits) | Bits(QuantizeDepth(depth), kDepthBits);
+    return key;
+}
+
+uint64_t LoongRenderSortKey::MakeTranslucent(uint32_t layer, uint32_t shader, uint32_t material, uint32_t mesh, float depth)
+{
+    constexpr uint32_t kMaxDepth = (1u << kDepthBits) - 1;
+    uint64_t key = Bits(layer, kLayerBits);
+    key = (key << 1u) | 1u;
+    key = (key << kDepthBits) | Bits(kMaxDepth - QuantizeDepth(depth), kDepthBits);
+    key = (key << kShaderBits) | Bits(shader, kShaderBits);
+    key = (key << kMaterialBits) | Bits(material, kMaterialBits);
+    key = (key << kMeshBits) | Bits(mesh, kMeshBits);
+    return key;
+}
+
+uint32_t LoongRenderQueueBase::GetMaxStateId(StateType type)
+{
+    switch (type) {
+    case StateType::kShader:
+        return (1u << LoongRenderSortKey::kShaderBits) - 1;
+    case StateType::kMaterial:
+        return (1u << LoongRenderSortKey::kMaterialBits) - 1;
+    case StateType::kMesh:
+    default:
+        return (1u << LoongRenderSortKey::kMeshBits) - 1;
+    }
+}
+
+uint32_t LoongRenderQueueBase::GetStateId(StateType type, const void* object)
+{
+    auto& stateIds = stateIds_[size_t(type)];
+    auto it = stateIds.find(object);
+    if (it != stateIds.end()) {
+        return it->second;
+    }
+    const uint32_t maxId = GetMaxStateId(type);
+    if (stateIds.size() >= maxId) {
+        // Not inserted, so the map doesn't grow with the overflowed objects
+        if (!isStateIdOverflowReported_) {
+            isStateIdOverflowReported_ = true;
+            LOONG_WARNING("Render queue runs out of state ids of type {}, the drawables are less grouped", int(type));
+        }
+        return maxId;
+    }
+    auto id = uint32_t(stateIds.size());
+    stateIds.insert({ object, id });
+    return id;
+}
+
+void LoongRenderQueueBase::ClearEntries()
+{
+    entries_.clear();
+    for (auto& stateIds : stateIds_) {
+        stateIds.clear();
+    }
+}
+
+void LoongRenderQueueBase::SortEntries()
+{
+    const size_t count = entries_.size();
+    if (count < 2) {
+        return;
+    }
+    scratch_.resize(count);
+
+    constexpr uint32_t kPassCount = sizeof(uint64_t);
+    size_t histograms[kPassCount][256];
+    memset(histograms, 0, sizeof(histograms));
+
+    // Build all the histograms within one pass over the data
+    for (const auto& entry : entries_) {
+        auto key = entry.key;
+        for (uint32_t pass = 0; pass < kPassCount; ++pass) {
+            ++histograms[pass][(key >> (pass * 8u)) & 0xFFu];
+        }
+    }
+
+    Entry* src = entries_.data();
+    Entry* dst = scratch_.data();
+    for (uint32_t pass = 0; pass < kPassCount; ++pass) {
+        auto& histogram = histograms[pass];
+        const uint32_t shift = pass * 8u;
+        if (histogram[(src[0].key >> shift) & 0xFFu] == count) {
+            continue; // All keys have the same digit, nothing to do
+        }
+
+        size_t offset = 0;
+        for (auto& bucket : histogram) {
+            auto bucketSize = bucket;
+            bucket = offset;
+            offset += bucketSize;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            auto& entry = src[i];
+            dst[histogram[(entry.key >> shift) & 0xFFu]++] = entry;
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != entries_.data()) {
+        entries_.swap(scratch_);
+    }
+}
+
+}
@@ -9,10 +9,10 @@
 
 namespace Loong::Core {
 
-LoongActor::LoongActor(uint32_t actorID, std::string name, std::string tag)
+LoongActor::LoongActor(std::string name, std::string tag)
     : name_(std::move(name))
     , tag_(std::move(tag))
-    , actorID_(actorID)
+    , actorID_(LoongActorPool::Register(this))
 {
 }
 
@@ -27,12 +27,39 @@ LoongActor::~LoongActor()
         child->DetachFromParent();
     }
 
-    toDetach.clear();
-
     DetachFromParent();
 
-    std::for_each(components_.begin(), components_.end(), [&](const std::shared_ptr<LoongComponent>& component) { RemoveComponentSignal_.emit(this, component.get()); });
-    std::for_each(children_.begin(), children_.end(), [](LoongActor* child) { delete child; });
+    std::for_each(components_.begin(), components_.end(), [&](LoongComponent* component) { RemoveComponentSignal_.emit(this, component); });
+    // The children are detached already, so they are deleted from the copy
+    std::for_each(toDetach.begin(), toDetach.end(), [](LoongActor* child) { delete child; });
+    std::for_each(components_.begin(), components_.end(), [](LoongComponent* component) { LoongComponentPoolBase::DestroyComponent(component); });
+
+    LoongActorPool::Unregister(actorID_);
+}
+
+void LoongActor::SetName(const std::string& name)
+{
+    // Keep the name index of the scene up to date
+    auto* scene = dynamic_cast<LoongScene*>(GetRoot());
+    if (scene == nullptr || scene == this) {
+        name_ = name;
+        return;
+    }
+    scene->fastAccess_.RemoveActor(this);
+    name_ = name;
+    scene->fastAccess_.AddActor(this);
+}
+
+void LoongActor::SetTag(const std::string& tag)
+{
+    auto* scene = dynamic_cast<LoongScene*>(GetRoot());
+    if (scene == nullptr || scene == this) {
+        tag_ = tag;
+        return;
+    }
+    scene->fastAccess_.RemoveActor(this);
+    tag_ = tag;
+    scene->fastAccess_.AddActor(this);
 }
 
 void LoongActor::SetActive(bool active)
@@ -62,7 +89,7 @@ void LoongActor::SetParent(LoongActor* parent)
             root->RecursiveAddToFastAccess(this);
         }
         if (auto* scene = dynamic_cast<LoongScene*>(this); scene != nullptr) {
-            scene->fastAccess_.Clear();
+            scene->ClearFastAccess();
         }
     } else {
         transform_.SetParent(nullptr);
@@ -132,18 +159,16 @@ LoongActor* LoongActor::GetChildByNameRecursive(const std::string& name) const
     return FindChildRecursive<ActorNameGetter>(this, name);
 }
 
-struct ActorIdGetter {
-    static const uint32_t GetProperty(const LoongActor* actor) { return actor->GetID(); }
-};
-
 LoongActor* LoongActor::GetChildById(uint32_t id) const
 {
-    return FindChild<ActorIdGetter>(this, id);
+    auto* actor = LoongActorPool::Resolve(id);
+    return actor != nullptr && actor->GetParent() == this ? actor : nullptr;
 }
 
 LoongActor* LoongActor::GetChildByIdRecursive(uint32_t id) const
 {
-    return FindChildRecursive<ActorIdGetter>(this, id);
+    auto* actor = LoongActorPool::Resolve(id);
+    return actor != nullptr && IsAncestorOf(actor) ? actor : nullptr;
 }
 
 struct ActorTagGetter {
@@ -172,49 +197,50 @@ void LoongActor::OnStart()
 {
     assert(!isStarted_);
     isStarted_ = true;
-    std::for_each(components_.begin(), components_.end(), [](const std::shared_ptr<LoongComponent>& component) { component->OnStart(); });
+    std::for_each(components_.begin(), components_.end(), [](LoongComponent* component) { component->OnStart(); });
 }
 
 void LoongActor::OnEnable()
 {
-    std::for_each(components_.begin(), components_.end(), [](const std::shared_ptr<LoongComponent>& component) { component->OnEnable(); });
+    std::for_each(components_.begin(), components_.end(), [](LoongComponent* component) { component->OnEnable(); });
 }
 
 void LoongActor::OnDisable()
 {
-    std::for_each(components_.begin(), components_.end(), [](const std::shared_ptr<LoongComponent>& component) { component->OnDisable(); });
+    std::for_each(components_.begin(), components_.end(), [](LoongComponent* component) { component->OnDisable(); });
 }
 
 void LoongActor::OnDestroy()
 {
-    std::for_each(components_.begin(), components_.end(), [](const std::shared_ptr<LoongComponent>& component) { component->OnDestroy(); });
+    std::for_each(components_.begin(), components_.end(), [](LoongComponent* component) { component->OnDestroy(); });
 }
 
 void LoongActor::OnUpdate(const Foundation::LoongClock& clock)
 {
-    std::for_each(components_.begin(), components_.end(), [&clock](const std::shared_ptr<LoongComponent>& component) { component->OnUpdate(clock); });
+    std::for_each(components_.begin(), components_.end(), [&clock](LoongComponent* component) { component->OnUpdate(clock); });
 }
 
 void LoongActor::OnFixedUpdate(const Foundation::LoongClock& clock)
 {
-    std::for_each(components_.begin(), components_.end(), [&clock](const std::shared_ptr<LoongComponent>& component) { component->OnFixedUpdate(clock); });
+    std::for_each(components_.begin(), components_.end(), [&clock](LoongComponent* component) { component->OnFixedUpdate(clock); });
 }
 
 void LoongActor::OnLateUpdate(const Foundation::LoongClock& clock)
 {
-    std::for_each(components_.begin(), components_.end(), [&clock](const std::shared_ptr<LoongComponent>& component) { component->OnLateUpdate(clock); });
+    std::for_each(components_.begin(), components_.end(), [&clock](LoongComponent* component) { component->OnLateUpdate(clock); });
 }
 
 bool LoongActor::RemoveComponent(LoongComponent* component)
 {
-    for (auto it = components_.begin(); it != components_.end(); ++it) {
-        if (it->get() == component) {
-            RemoveComponentSignal_.emit(this, component);
-            components_.erase(it);
-            return true;
-        }
+    auto it = std::find(components_.begin(), components_.end(), component);
+    if (it == components_.end()) {
+        return false;
     }
-    return false;
+    RemoveComponentSignal_.emit(this, component);
+    components_.erase(it);
+    componentsByType_[component->GetTypeIndex()] = nullptr;
+    LoongComponentPoolBase::DestroyComponent(component);
+    return true;
 }
 
 void LoongActor::RecursiveActiveUpdate()
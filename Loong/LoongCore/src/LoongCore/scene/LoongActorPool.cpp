@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongCore/scene/LoongActorPool.h"
+#include "LoongCore/scene/LoongActor.h"
+#include "LoongFoundation/LoongLogger.h"
+#include "LoongFoundation/LoongPoolAllocator.h"
+#include <cassert>
+#include <deque>
+#include <vector>
+
+namespace Loong::Core {
+
+namespace {
+
+constexpr uint32_t kIndexMask = LoongActorPool::kMaxActorCount;
+constexpr uint32_t kGenerationCount = 1U << (32U - LoongActorPool::kIndexBits);
+
+struct Slot {
+    LoongActor* actor { nullptr };
+    uint32_t generation { 1 };
+};
+
+struct ActorTable {
+    // Slot 0 is never used
+    std::vector<Slot> slots = std::vector<Slot>(1);
+    std::deque<uint32_t> freeSlots {};
+    uint32_t actorCount { 0 };
+};
+
+ActorTable& GetTable()
+{
+    static ActorTable table;
+    return table;
+}
+
+// Scenes are larger, they are rare enough to use the global heap
+Foundation::LoongPoolAllocator& GetAllocator()
+{
+    static Foundation::LoongPoolAllocator allocator(sizeof(LoongActor), 128);
+    return allocator;
+}
+
+}
+
+void* LoongActorPool::Allocate(size_t size)
+{
+    if (size > GetAllocator().GetBlockSize()) {
+        return ::operator new(size);
+    }
+    return GetAllocator().Allocate();
+}
+
+void LoongActorPool::Free(void* memory, size_t size)
+{
+    if (size > GetAllocator().GetBlockSize()) {
+        ::operator delete(memory);
+        return;
+    }
+    GetAllocator().Free(memory);
+}
+
+uint32_t LoongActorPool::Register(LoongActor* actor)
+{
+    auto& table = GetTable();
+    uint32_t index = 0;
+    // The table only stops growing when it's full, so the free slots wait before they are reused
+    bool isTableFull = table.slots.size() > kMaxActorCount;
+    if (table.freeSlots.size() > kMinFreeSlots || (isTableFull && !table.freeSlots.empty())) {
+        index = table.freeSlots.front();
+        table.freeSlots.pop_front();
+    } else {
+        if (isTableFull) {
+            LOONG_ERROR("Too many actors, the limit is {}", kMaxActorCount);
+            return kInvalidID;
+        }
+        index = uint32_t(table.slots.size());
+        table.slots.emplace_back();
+    }
+    auto& slot = table.slots[index];
+    slot.actor = actor;
+    ++table.actorCount;
+    return slot.generation << kIndexBits | index;
+}
+
+void LoongActorPool::Unregister(uint32_t id)
+{
+    if (Resolve(id) == nullptr) {
+        return;
+    }
+    auto& table = GetTable();
+    uint32_t index = id & kIndexMask;
+    auto& slot = table.slots[index];
+    slot.actor = nullptr;
+    --table.actorCount;
+    // Retire the slot instead of wrapping around its generation, the last ID of it resolves to nullptr from now on
+    if (slot.generation + 1 == kGenerationCount) {
+        return;
+    }
+    ++slot.generation;
+    table.freeSlots.push_back(index);
+}
+
+LoongActor* LoongActorPool::Resolve(uint32_t id)
+{
+    auto& table = GetTable();
+    uint32_t index = id & kIndexMask;
+    if (index == 0 || index >= table.slots.size()) {
+        return nullptr;
+    }
+    auto& slot = table.slots[index];
+    return slot.generation == id >> kIndexBits ? slot.actor : nullptr;
+}
+
+uint32_t LoongActorPool::GetActorCount()
+{
+    return GetTable().actorCount;
+}
+
+}
@@ -4,9 +4,17 @@
 
 #include "LoongCore/scene/LoongComponent.h"
 #include "LoongCore/scene/LoongActor.h"
+#include "LoongCore/scene/LoongComponentPool.h"
+#include <atomic>
 
 namespace Loong::Core {
 
+uint32_t NextComponentTypeIndex()
+{
+    static std::atomic<uint32_t> nextIndex { 0 };
+    return nextIndex.fetch_add(1, std::memory_order_relaxed);
+}
+
 bool LoongComponent::IsActive() const
 {
     return IsSelfActive() && GetOwner()->IsActive();
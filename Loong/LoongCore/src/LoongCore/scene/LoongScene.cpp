@@ -6,6 +6,7 @@
 #include "LoongCore/scene/components/LoongCCamera.h"
 #include "LoongCore/scene/components/LoongCLight.h"
 #include "LoongCore/scene/components/LoongCModelRenderer.h"
+#include "LoongFoundation/LoongFrustum.h"
 #include "LoongFoundation/LoongMath.h"
 #include "LoongRenderer/LoongRenderer.h"
 #include "LoongResource/LoongGpuMesh.h"
@@ -16,11 +17,63 @@
 
 namespace Loong::Core {
 
+namespace {
+
+void EraseActor(std::unordered_multimap<std::string, LoongActor*>& actors, const std::string& key, LoongActor* actor)
+{
+    auto range = actors.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == actor) {
+            actors.erase(it);
+            return;
+        }
+    }
+}
+
+LoongActor* FindActor(const std::unordered_multimap<std::string, LoongActor*>& actors, const std::string& key, const LoongScene* scene)
+{
+    auto range = actors.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second != scene) {
+            return it->second;
+        }
+    }
+    return nullptr;
+}
+
+}
+
+LoongScene::LoongScene(std::string name, std::string tag)
+    : LoongActor(std::move(name), std::move(tag))
+    , transformWatcher_(Foundation::LoongTransformHierarchy::GetDefault().CreateWatcher())
+{
+}
+
+LoongScene::~LoongScene()
+{
+    // The transforms still watched are unwatched by the hierarchy
+    Foundation::LoongTransformHierarchy::GetDefault().DestroyWatcher(transformWatcher_);
+}
+
+void LoongScene::FastAccess::AddActor(LoongActor* actor)
+{
+    actorsByName_.emplace(actor->GetName(), actor);
+    actorsByTag_.emplace(actor->GetTag(), actor);
+}
+
+void LoongScene::FastAccess::RemoveActor(LoongActor* actor)
+{
+    EraseActor(actorsByName_, actor->GetName(), actor);
+    EraseActor(actorsByTag_, actor->GetTag(), actor);
+}
+
 void LoongScene::FastAccess::AbsorbAnother(const LoongScene::FastAccess& another)
 {
     modelRenderers_.insert(another.modelRenderers_.begin(), another.modelRenderers_.end());
     cameras_.insert(another.cameras_.begin(), another.cameras_.end());
     lights_.insert(another.lights_.begin(), another.lights_.end());
+    actorsByName_.insert(another.actorsByName_.begin(), another.actorsByName_.end());
+    actorsByTag_.insert(another.actorsByTag_.begin(), another.actorsByTag_.end());
 }
 
 void LoongScene::FastAccess::SubtractAnother(const LoongScene::FastAccess& another)
@@ -34,6 +87,12 @@ void LoongScene::FastAccess::SubtractAnother(const LoongScene::FastAccess& anoth
     for (auto* light : another.lights_) {
         lights_.erase(light);
     }
+    for (auto& pair : another.actorsByName_) {
+        EraseActor(actorsByName_, pair.first, pair.second);
+    }
+    for (auto& pair : another.actorsByTag_) {
+        EraseActor(actorsByTag_, pair.first, pair.second);
+    }
 }
 
 void LoongScene::FastAccess::Clear()
@@ -41,10 +100,13 @@ void LoongScene::FastAccess::Clear()
     modelRenderers_.clear();
     cameras_.clear();
     lights_.clear();
+    actorsByName_.clear();
+    actorsByTag_.clear();
 }
 
 void RecursiveAdd(LoongScene::FastAccess& access, LoongActor* actor)
 {
+    access.AddActor(actor);
     if (auto* modelRenderer = actor->GetComponent<LoongCModelRenderer>(); modelRenderer != nullptr) {
         access.modelRenderers_.insert(modelRenderer);
     }
@@ -66,8 +128,21 @@ void Core::LoongScene::RecursiveAddToFastAccess(LoongActor* actor)
     if (auto* subScene = dynamic_cast<LoongScene*>(actor); subScene != nullptr) {
         // If the new sub-tree is a scene, we just use it's FastAccess to update this
         fastAccess_.AbsorbAnother(subScene->fastAccess_);
+        // Its FastAccess may or may not have itself
+        fastAccess_.RemoveActor(subScene);
+        fastAccess_.AddActor(subScene);
+        for (auto* modelRenderer : subScene->fastAccess_.modelRenderers_) {
+            WatchTransform(modelRenderer);
+            dirtyBounds_.insert(modelRenderer);
+        }
     } else {
-        RecursiveAdd(fastAccess_, actor);
+        FastAccess tmp;
+        RecursiveAdd(tmp, actor);
+        fastAccess_.AbsorbAnother(tmp);
+        for (auto* modelRenderer : tmp.modelRenderers_) {
+            WatchTransform(modelRenderer);
+            dirtyBounds_.insert(modelRenderer);
+        }
     }
 }
 
@@ -84,16 +159,220 @@ void Core::LoongScene::RecursiveRemoveFromFastAccess(LoongActor* actor)
     if (auto* subScene = dynamic_cast<LoongScene*>(actor); subScene != nullptr) {
         // If the leaving sub-tree is a scene, we just use it's FastAccess to update this
         fastAccess_.SubtractAnother(subScene->fastAccess_);
+        for (auto* modelRenderer : subScene->fastAccess_.modelRenderers_) {
+            UnwatchTransform(modelRenderer);
+            RemoveFromSpatialIndex(modelRenderer);
+        }
     } else {
         FastAccess tmp;
         ::Loong::Core::ConstructFastAccess(tmp, actor);
         fastAccess_.SubtractAnother(tmp);
+        for (auto* modelRenderer : tmp.modelRenderers_) {
+            UnwatchTransform(modelRenderer);
+            RemoveFromSpatialIndex(modelRenderer);
+        }
     }
 }
 
 void LoongScene::ConstructFastAccess()
 {
+    ClearFastAccess();
     ::Loong::Core::ConstructFastAccess(fastAccess_, this);
+    for (auto* modelRenderer : fastAccess_.modelRenderers_) {
+        WatchTransform(modelRenderer);
+        dirtyBounds_.insert(modelRenderer);
+    }
+}
+
+void LoongScene::ClearFastAccess()
+{
+    for (auto* modelRenderer : fastAccess_.modelRenderers_) {
+        UnwatchTransform(modelRenderer);
+    }
+    fastAccess_.Clear();
+    spatialIndex_.Clear();
+    spatialProxies_.clear();
+    spatialMeshCount_ = 0;
+    dirtyBounds_.clear();
+    unculledRenderers_.clear();
+    customCulledRenderers_.clear();
+}
+
+static bool GetWorldBounds(const LoongCModelRenderer& modelRenderer, Math::AABB& bounds)
+{
+    auto* gpuModel = modelRenderer.GetModel().get();
+    if (gpuModel == nullptr) {
+        return false;
+    }
+    auto& modelMatrix = modelRenderer.GetOwner()->GetTransform().GetWorldTransformMatrix();
+    if (modelRenderer.GetCullMode() == LoongCModelRenderer::CullMode::kCullCustom) {
+        bounds = modelRenderer.GetCustomBounds().Transformed(modelMatrix);
+    } else {
+        bounds = gpuModel->GetAABB().Transformed(modelMatrix);
+    }
+    return true;
+}
+
+void LoongScene::UpdateSpatialIndex()
+{
+    // The transforms of the model renderers that moved are reported to our watcher
+    auto& hierarchy = Foundation::LoongTransformHierarchy::GetDefault();
+    hierarchy.Update();
+    hierarchy.TakeChanged(transformWatcher_, changedTransforms_);
+    for (auto* transform : changedTransforms_) {
+        if (auto it = watchedRenderers_.find(transform); it != watchedRenderers_.end()) {
+            dirtyBounds_.insert(it->second);
+        }
+    }
+
+    for (auto* modelRenderer : dirtyBounds_) {
+        Math::AABB bounds {};
+        if (fastAccess_.modelRenderers_.count(modelRenderer) == 0 || !GetWorldBounds(*modelRenderer, bounds)) {
+            // Don't use RemoveFromSpatialIndex, we are iterating dirtyBounds_
+            if (auto it = spatialProxies_.find(modelRenderer); it != spatialProxies_.end()) {
+                spatialIndex_.Remove(it->second.proxy);
+                spatialMeshCount_ -= it->second.meshCount;
+                spatialProxies_.erase(it);
+            }
+            unculledRenderers_.erase(modelRenderer);
+            customCulledRenderers_.erase(modelRenderer);
+            continue;
+        }
+
+        if (modelRenderer->GetCullMode() == LoongCModelRenderer::CullMode::kDisabled) {
+            unculledRenderers_.insert(modelRenderer);
+        } else {
+            unculledRenderers_.erase(modelRenderer);
+        }
+        if (modelRenderer->GetCullMode() == LoongCModelRenderer::CullMode::kCullCustom) {
+            customCulledRenderers_.insert(modelRenderer);
+        } else {
+            customCulledRenderers_.erase(modelRenderer);
+        }
+
+        // The model may be another one
+        auto meshCount = uint32_t(modelRenderer->GetModel()->GetMeshes().size());
+        if (auto it = spatialProxies_.find(modelRenderer); it != spatialProxies_.end()) {
+            spatialIndex_.Update(it->second.proxy, bounds);
+            spatialMeshCount_ = spatialMeshCount_ - it->second.meshCount + meshCount;
+            it->second.meshCount = meshCount;
+        } else {
+            spatialProxies_.insert({ modelRenderer, { spatialIndex_.Insert(bounds, modelRenderer), meshCount } });
+            spatialMeshCount_ += meshCount;
+        }
+    }
+    dirtyBounds_.clear();
+}
+
+void LoongScene::RemoveFromSpatialIndex(LoongCModelRenderer* modelRenderer)
+{
+    if (auto it = spatialProxies_.find(modelRenderer); it != spatialProxies_.end()) {
+        spatialIndex_.Remove(it->second.proxy);
+        spatialMeshCount_ -= it->second.meshCount;
+        spatialProxies_.erase(it);
+    }
+    dirtyBounds_.erase(modelRenderer);
+    unculledRenderers_.erase(modelRenderer);
+    customCulledRenderers_.erase(modelRenderer);
+}
+
+void LoongScene::WatchTransform(LoongCModelRenderer* modelRenderer)
+{
+    auto& transform = modelRenderer->GetOwner()->GetTransform();
+    transform.SetWatcher(transformWatcher_);
+    watchedRenderers_[&transform] = modelRenderer;
+}
+
+void LoongScene::UnwatchTransform(LoongCModelRenderer* modelRenderer)
+{
+    auto& transform = modelRenderer->GetOwner()->GetTransform();
+    // It may be watched by a scene it was moved to already
+    if (transform.GetWatcher() == transformWatcher_) {
+        transform.SetWatcher(0);
+    }
+    watchedRenderers_.erase(&transform);
+}
+
+uint64_t LoongScene::QueryFrustum(const Foundation::Frustum& frustum, const std::function<void(LoongCModelRenderer*, bool isInside)>& callback)
+{
+    UpdateSpatialIndex();
+    // The mesh counts are taken before the callbacks, which may change the models
+    uint64_t reportedMeshCount = 0;
+    spatialIndex_.QueryFrustum(frustum, [this, &callback, &reportedMeshCount](int32_t proxy, bool isInside) {
+        auto* modelRenderer = static_cast<LoongCModelRenderer*>(spatialIndex_.GetUserData(proxy));
+        if (unculledRenderers_.count(modelRenderer) == 0) {
+            reportedMeshCount += modelRenderer->GetModel()->GetMeshes().size();
+            callback(modelRenderer, isInside);
+        }
+    });
+    for (auto* modelRenderer : unculledRenderers_) {
+        reportedMeshCount += modelRenderer->GetModel()->GetMeshes().size();
+        callback(modelRenderer, true);
+    }
+    return spatialMeshCount_ > reportedMeshCount ? spatialMeshCount_ - reportedMeshCount : 0;
+}
+
+void LoongScene::QueryAABB(const Math::AABB& aabb, const std::function<void(LoongCModelRenderer*)>& callback)
+{
+    UpdateSpatialIndex();
+    spatialIndex_.QueryAABB(aabb, [this, &callback](int32_t proxy) {
+        callback(static_cast<LoongCModelRenderer*>(spatialIndex_.GetUserData(proxy)));
+    });
+}
+
+void LoongScene::QuerySphere(const Math::Vector3& center, float radius, const std::function<void(LoongCModelRenderer*)>& callback)
+{
+    UpdateSpatialIndex();
+    spatialIndex_.QuerySphere(center, radius, [this, &callback](int32_t proxy) {
+        callback(static_cast<LoongCModelRenderer*>(spatialIndex_.GetUserData(proxy)));
+    });
+}
+
+void LoongScene::QueryRay(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, const std::function<float(LoongCModelRenderer*, float distance)>& callback)
+{
+    UpdateSpatialIndex();
+    spatialIndex_.QueryRay(origin, direction, maxDistance, [this, &callback](int32_t proxy, float distance) {
+        return callback(static_cast<LoongCModelRenderer*>(spatialIndex_.GetUserData(proxy)), distance);
+    });
+}
+
+bool LoongScene::Raycast(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, RaycastHit& hit)
+{
+    bool isHit = false;
+    QueryRay(origin, direction, maxDistance, [&](LoongCModelRenderer* modelRenderer, float) {
+        if (customCulledRenderers_.count(modelRenderer) == 0 && RaycastModel(*modelRenderer->GetModel(), modelRenderer->GetOwner(), origin, direction, maxDistance, hit)) {
+            isHit = true;
+            maxDistance = hit.distance;
+        }
+        return maxDistance;
+    });
+    for (auto* modelRenderer : customCulledRenderers_) {
+        if (RaycastModel(*modelRenderer->GetModel(), modelRenderer->GetOwner(), origin, direction, maxDistance, hit)) {
+            isHit = true;
+            maxDistance = hit.distance;
+        }
+    }
+    return isHit;
+}
+
+bool LoongScene::RaycastModel(const Resource::LoongGpuModel& model, LoongActor* actor, const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, RaycastHit& hit)
+{
+    Math::Matrix4 invModelMatrix = Math::Inverse(actor->GetTransform().GetWorldTransformMatrix());
+    // An affine transform keeps the ray parameter, so the distances need no conversion
+    Math::Vector3 localOrigin = invModelMatrix * Math::Vector4(origin, 1.0F);
+    Math::Vector3 localDirection = invModelMatrix * Math::Vector4(direction, 0.0F);
+
+    Resource::LoongGpuModel::RaycastHit modelHit {};
+    if (!model.Raycast(localOrigin, localDirection, maxDistance, modelHit)) {
+        return false;
+    }
+    hit.actor = actor;
+    hit.distance = modelHit.distance;
+    hit.point = origin + direction * modelHit.distance;
+    hit.normal = Math::Normalize(Math::Matrix3(Math::Transpose(invModelMatrix)) * modelHit.normal);
+    hit.meshIndex = modelHit.meshIndex;
+    hit.triangleIndex = modelHit.triangleIndex;
+    return true;
 }
 
 LoongCCamera* LoongScene::GetFirstActiveCamera()
@@ -106,17 +385,41 @@ LoongCCamera* LoongScene::GetFirstActiveCamera()
     return nullptr;
 }
 
-// TODO: Use an object pool?
-static uint32_t gActorIdCounter = 0;
+LoongActor* LoongScene::GetActorById(uint32_t id) const
+{
+    auto* actor = LoongActorPool::Resolve(id);
+    return actor != nullptr && (actor == this || IsAncestorOf(actor)) ? actor : nullptr;
+}
+
+LoongActor* LoongScene::FindActorByName(const std::string& name) const
+{
+    return FindActor(fastAccess_.actorsByName_, name, this);
+}
+
+LoongActor* LoongScene::FindActorByTag(const std::string& tag) const
+{
+    return FindActor(fastAccess_.actorsByTag_, tag, this);
+}
+
+void LoongScene::FindActorsByTag(const std::string& tag, std::vector<LoongActor*>& actors) const
+{
+    auto range = fastAccess_.actorsByTag_.equal_range(tag);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second != this) {
+            actors.push_back(it->second);
+        }
+    }
+}
+
 std::unique_ptr<LoongActor> LoongScene::CreateActor(const std::string& name, const std::string& tag)
 {
-    auto* actor = new LoongActor(++gActorIdCounter, name, tag);
+    auto* actor = new LoongActor(name, tag);
     return std::unique_ptr<LoongActor>(actor);
 }
 
 std::unique_ptr<LoongScene> LoongScene::CreateScene(const std::string& name, const std::string& tag)
 {
-    auto* scene = new LoongScene(++gActorIdCounter, name, tag);
+    auto* scene = new LoongScene(name, tag);
     return std::unique_ptr<LoongScene>(scene);
 }
 
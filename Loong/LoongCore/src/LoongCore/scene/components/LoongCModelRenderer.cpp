@@ -4,16 +4,27 @@
 
 #include "LoongCore/scene/components/LoongCModelRenderer.h"
 #include "LoongCore/scene/LoongActor.h"
+#include "LoongCore/scene/LoongActorPool.h"
 #include "LoongCore/scene/LoongScene.h"
+#include "LoongFoundation/LoongLogger.h"
+#include "LoongResource/LoongGpuMesh.h"
+#include "LoongResource/LoongResourceManager.h"
+#include <algorithm>
 
 namespace Loong::Core {
 
+// A LOD is used as long as its error is no more than this many pixels on the screen
+static constexpr float kLodPixelError = 1.0F;
+// Switching to a coarser LOD needs its error to be clearly small enough, so that the LOD doesn't flip every frame
+static constexpr float kLodHysteresis = 0.75F;
+
 LoongCModelRenderer::LoongCModelRenderer(LoongActor* owner)
     : LoongComponent(owner)
 {
     if (auto* scene = dynamic_cast<LoongScene*>(owner->GetRoot()); scene != nullptr) {
         scene->AddModelRenderer(this);
     }
+    SubscribeModelChanged(this, &LoongCModelRenderer::OnModelChanged);
 }
 
 LoongCModelRenderer::~LoongCModelRenderer()
@@ -23,4 +34,64 @@ LoongCModelRenderer::~LoongCModelRenderer()
     }
 }
 
+void LoongCModelRenderer::SetModelAsync(const std::string& path)
+{
+    if (model_ == nullptr) {
+        SetModel(Resource::LoongResourceManager::GetPlaceholderModel());
+    }
+    pendingModelPath_ = path;
+    // We may be destroyed before the model is loaded, so find us again by the owner's ID
+    Resource::LoongResourceManager::GetModelAsync(path, [ownerId = GetOwner()->GetID(), path](std::shared_ptr<Resource::LoongGpuModel> model) {
+        auto* owner = LoongActorPool::Resolve(ownerId);
+        auto* self = owner != nullptr ? owner->GetComponent<LoongCModelRenderer>() : nullptr;
+        if (self == nullptr || self->pendingModelPath_ != path) {
+            return;
+        }
+        if (model != nullptr) {
+            self->SetModel(std::move(model));
+            return;
+        }
+        LOONG_ERROR("Cannot set model to '{}', which is not a valid model file", path);
+        self->pendingModelPath_.clear();
+        // Only the placeholder goes away, the model we had is kept
+        if (self->model_ == Resource::LoongResourceManager::GetPlaceholderModel()) {
+            self->SetModel(nullptr);
+        }
+    });
+}
+
+void LoongCModelRenderer::UpdateLods(const Math::Vector3& viewPosition, float pixelsPerUnit)
+{
+    if (model_ == nullptr) {
+        return;
+    }
+
+    auto& transform = GetOwner()->GetTransform();
+    auto bounds = model_->GetAABB().Transformed(transform.GetWorldTransformMatrix());
+    Math::Vector3 closestPoint = Math::Min(Math::Max(viewPosition, bounds.min), bounds.max);
+    float distance = std::max(Math::Distance(closestPoint, viewPosition), 1e-3F);
+    Math::Vector3 scale = Math::Abs(transform.GetWorldScale());
+    float errorToPixels = std::max(scale.x, std::max(scale.y, scale.z)) / distance * pixelsPerUnit;
+
+    auto& meshes = model_->GetMeshes();
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        auto& mesh = *meshes[i];
+        uint32_t lod = std::min(meshLods_[i], mesh.GetLodCount() - 1);
+        while (lod > 0 && mesh.GetLod(lod).error * errorToPixels > kLodPixelError) {
+            --lod;
+        }
+        while (lod + 1 < mesh.GetLodCount() && mesh.GetLod(lod + 1).error * errorToPixels <= kLodPixelError * kLodHysteresis) {
+            ++lod;
+        }
+        meshLods_[i] = lod;
+    }
+}
+
+void LoongCModelRenderer::OnBoundsChanged()
+{
+    if (auto* scene = dynamic_cast<LoongScene*>(GetOwner()->GetRoot()); scene != nullptr) {
+        scene->MarkBoundsDirty(this);
+    }
+}
+
 }
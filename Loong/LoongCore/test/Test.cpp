@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongCore/render/LoongRenderQueue.h"
+#include "LoongCore/scene/LoongActorPool.h"
+#include "LoongCore/scene/LoongScene.h"
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+using namespace Loong;
+using namespace Loong::Core;
+
+void TestRenderQueue();
+
+void TestActorPool();
+
+int main(int argc, const char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    TestRenderQueue();
+
+    TestActorPool();
+
+    return 0;
+}
+
+void TestRenderQueue()
+{
+    // The radix sort orders the keys like std::sort
+    LoongRenderQueue<int> queue;
+    std::mt19937_64 random(1234);
+    std::vector<uint64_t> keys;
+    for (int i = 0; i < 10000; ++i) {
+        // Some of them share the high or the low digits, so some of the passes are skipped
+        uint64_t key = i % 3 == 0 ? (random() & 0xFFFFFFULL) : random();
+        keys.push_back(key);
+        queue.Push(key, i);
+    }
+    queue.Sort();
+    std::sort(keys.begin(), keys.end());
+    assert(queue.Size() == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        assert(queue.GetKey(i) == keys[i]);
+    }
+
+    // Opaque ones are grouped by state and then drawn front to back, translucent ones are drawn back to front after them
+    queue.Clear();
+    queue.Push(LoongRenderSortKey::MakeTranslucent(0, 0, 0, 0, 0.2F), 0);
+    queue.Push(LoongRenderSortKey::MakeOpaque(0, 1, 0, 0, 0.1F), 1);
+    queue.Push(LoongRenderSortKey::MakeOpaque(0, 0, 0, 0, 0.9F), 2);
+    queue.Push(LoongRenderSortKey::MakeTranslucent(0, 0, 0, 0, 0.8F), 3);
+    queue.Push(LoongRenderSortKey::MakeOpaque(0, 0, 0, 0, 0.5F), 4);
+    queue.Push(LoongRenderSortKey::MakeOpaque(1, 0, 0, 0, 0.0F), 5);
+    queue.Sort();
+    const int kOrder[] = { 4, 2, 1, 3, 0, 5 };
+    for (size_t i = 0; i < queue.Size(); ++i) {
+        assert(queue[i] == kOrder[i]);
+    }
+
+    // The state ids of each type are counted separately, and saturate instead of wrapping around
+    queue.Clear();
+    using StateType = LoongRenderQueueBase::StateType;
+    std::vector<int> objects(5000);
+    const uint32_t maxMeshId = LoongRenderQueueBase::GetMaxStateId(StateType::kMesh);
+    for (size_t i = 0; i < objects.size(); ++i) {
+        uint32_t id = queue.GetStateId(StateType::kMesh, &objects[i]);
+        assert(id == std::min(uint32_t(i), maxMeshId));
+    }
+    assert(queue.GetStateId(StateType::kMesh, &objects[7]) == 7);
+    assert(queue.GetStateId(StateType::kShader, &objects[4000]) == 0);
+    assert(queue.GetStateId(StateType::kMaterial, &objects[0]) == 0);
+    uint64_t overflowed = LoongRenderSortKey::MakeOpaque(0, 0, 0, queue.GetStateId(StateType::kMesh, &objects[4999]), 0.0F);
+    uint64_t first = LoongRenderSortKey::MakeOpaque(0, 0, 0, queue.GetStateId(StateType::kMesh, &objects[0]), 0.0F);
+    assert(overflowed != first);
+    queue.Clear();
+    assert(queue.GetStateId(StateType::kMesh, &objects[4999]) == 0);
+}
+
+void TestActorPool()
+{
+    constexpr uint32_t kIndexMask = LoongActorPool::kMaxActorCount;
+
+    // The ID of a destroyed actor doesn't resolve to the actor spawned into its slot
+    auto actor = LoongScene::CreateActor("first");
+    const uint32_t oldId = actor->GetID();
+    assert(LoongActorPool::Resolve(oldId) == actor.get());
+    actor.reset();
+    assert(LoongActorPool::Resolve(oldId) == nullptr);
+    uint32_t newId = LoongActorPool::kInvalidID;
+    for (uint32_t i = 0; i <= LoongActorPool::kMinFreeSlots + 1 && newId == LoongActorPool::kInvalidID; ++i) {
+        actor = LoongScene::CreateActor("reuse");
+        if ((actor->GetID() & kIndexMask) == (oldId & kIndexMask)) {
+            newId = actor->GetID();
+        } else {
+            actor.reset();
+        }
+    }
+    assert(newId != LoongActorPool::kInvalidID && newId != oldId);
+    assert(LoongActorPool::Resolve(oldId) == nullptr);
+    assert(LoongActorPool::Resolve(newId) == actor.get());
+    actor.reset();
+
+    // A slot is retired when its generation runs out, instead of issuing its old IDs again
+    int dummy = 0;
+    auto* fakeActor = reinterpret_cast<LoongActor*>(&dummy);
+    const uint32_t first = LoongActorPool::Register(fakeActor);
+    LoongActorPool::Unregister(first);
+    constexpr uint32_t kGenerationCount = 1U << (32U - LoongActorPool::kIndexBits);
+    std::unordered_set<uint32_t> slotIds { first };
+    // About the number of the slots in use by now, times the generations
+    for (uint32_t i = 0; i < (LoongActorPool::kMinFreeSlots + 64) * kGenerationCount; ++i) {
+        uint32_t id = LoongActorPool::Register(fakeActor);
+        assert(LoongActorPool::Resolve(id) == fakeActor);
+        if ((id & kIndexMask) == (first & kIndexMask)) {
+            assert(slotIds.insert(id).second);
+        }
+        LoongActorPool::Unregister(id);
+        assert(LoongActorPool::Resolve(id) == nullptr);
+    }
+    // The generations from the first one up, 0 is never used
+    assert(slotIds.size() == kGenerationCount - (first >> LoongActorPool::kIndexBits));
+    assert(LoongActorPool::GetActorCount() == 0);
+}
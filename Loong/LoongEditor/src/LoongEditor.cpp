@@ -6,6 +6,9 @@
 #include "LoongApp/LoongApp.h"
 #include "LoongCore/scene/LoongScene.h"
 #include "LoongFoundation/LoongClock.h"
+#include "LoongResource/LoongGLStateCache.h"
+#include "LoongResource/LoongResourceManager.h"
+#include "LoongResource/LoongUniformRingBuffer.h"
 #include "panels/LoongEditorContentPanel.h"
 #include "panels/LoongEditorGamePanel.h"
 #include "panels/LoongEditorHierarchyPanel.h"
@@ -67,6 +70,13 @@ void LoongEditor::OnBeginFrame()
 
     auto& editorClock = GetContext().GetEditorClock();
     editorClock.Update();
+
+    // The app clears the default frame buffer with raw GL calls, so the cached state can't be trusted any more
+    Resource::LoongGLStateCache::Invalidate();
+    GetContext().GetObjectUniformBuffer()->BeginFrame();
+
+    // The models and textures decoded by the workers since the last frame
+    Resource::LoongResourceManager::Update();
 }
 
 bool showImGuiDemoWindow_ = true;
@@ -9,6 +9,8 @@
 #include "LoongRenderer/LoongRenderer.h"
 #include "LoongResource/LoongGpuBuffer.h"
 #include "LoongResource/LoongResourceManager.h"
+#include "LoongResource/LoongShader.h"
+#include "LoongResource/LoongUniformRingBuffer.h"
 #include <memory>
 
 namespace Loong::Editor {
@@ -21,14 +23,15 @@ LoongEditorContext::LoongEditorContext(const std::string& projectFile)
         basicUniformBuffer_ = std::make_shared<Resource::LoongUniformBuffer>();
         Core::LoongRenderPass::BasicUBO ub {};
         basicUniformBuffer_->BufferData(&ub, 1, Resource::LoongGpuBufferUsage::kStreamDraw);
-        basicUniformBuffer_->SetBindingPoint(0, sizeof(ub));
+        basicUniformBuffer_->SetBindingPoint(Resource::LoongShader::kBasicUBOBindingPoint, sizeof(ub));
     }
     {
         lightUniformBuffer_ = std::make_shared<Resource::LoongUniformBuffer>();
         Core::LoongRenderPass::LightUBO lub {};
         lightUniformBuffer_->BufferData(&lub, 1, Resource::LoongGpuBufferUsage::kStreamDraw);
-        lightUniformBuffer_->SetBindingPoint(1, sizeof(lub));
+        lightUniformBuffer_->SetBindingPoint(Resource::LoongShader::kLightUBOBindingPoint, sizeof(lub));
     }
+    objectUniformBuffer_ = std::make_shared<Resource::LoongUniformRingBuffer>(Resource::LoongShader::kObjectUBOBindingPoint, uint32_t(sizeof(Core::LoongRenderPass::ObjectUBO)));
 
     defaultMaterial_ = Resource::LoongResourceManager::GetMaterial("/Materials/Default.lgmtl");
     renderer_ = std::make_unique<Renderer::LoongRenderer>();
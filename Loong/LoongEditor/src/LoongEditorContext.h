@@ -22,6 +22,7 @@ class LoongRenderer;
 }
 namespace Loong::Resource {
 class LoongMaterial;
+class LoongUniformRingBuffer;
 }
 
 namespace Loong::Editor {
@@ -43,6 +44,8 @@ public:
 
     std::shared_ptr<Resource::LoongUniformBuffer> GetLightUniformBuffer() const { return lightUniformBuffer_; }
 
+    std::shared_ptr<Resource::LoongUniformRingBuffer> GetObjectUniformBuffer() const { return objectUniformBuffer_; }
+
     Foundation::LoongClock& GetGameClock() { return gameClock_; }
 
     Foundation::LoongClock& GetEditorClock() { return editorClock_; }
@@ -68,6 +71,7 @@ private:
     std::string projectDir_ {};
     std::shared_ptr<Resource::LoongUniformBuffer> basicUniformBuffer_ {};
     std::shared_ptr<Resource::LoongUniformBuffer> lightUniformBuffer_ {};
+    std::shared_ptr<Resource::LoongUniformRingBuffer> objectUniformBuffer_ {};
     std::shared_ptr<Resource::LoongMaterial> defaultMaterial_ { nullptr };
     Foundation::LoongClock gameClock_ {};
     Foundation::LoongClock editorClock_ {};
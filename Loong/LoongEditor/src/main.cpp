@@ -11,6 +11,7 @@
 #include "LoongFoundation/LoongLogger.h"
 #include "LoongFoundation/LoongPathUtils.h"
 #include "LoongRenderer/LoongRenderer.h"
+#include "LoongResource/LoongResourceManager.h"
 #include "LoongResource/LoongTexture.h"
 #include "LoongResource/loader/LoongTextureLoader.h"
 #include "utils/IconsFontAwesome5.h"
@@ -106,15 +107,25 @@ int StartApp(int argc, char** argv)
         // Set the project directory as write dir, and mount it to root
         Loong::FS::LoongFileSystem::SetWriteDir(context->GetProjectDirPath());
         Loong::FS::LoongFileSystem::MountSearchPath(context->GetProjectDirPath());
+        // The assets may be changed by other programs while the editor is running
+        Loong::FS::LoongFileSystem::SetChangeWatcherEnabled(true);
     }
 
-    Loong::Editor::LoongEditor editor(app.get(), context);
-    if (!editor.Initialize()) {
-        LOONG_ERROR("Initialized editor failed!");
-        return 2;
+    int ret = 0;
+    {
+        Loong::Editor::LoongEditor editor(app.get(), context);
+        context = nullptr;
+        if (!editor.Initialize()) {
+            LOONG_ERROR("Initialized editor failed!");
+            return 2;
+        }
+
+        ret = app->Run();
     }
+    // The cached resources own GL objects, release them while the context is still alive
+    Loong::Resource::LoongResourceManager::ClearCache();
 
-    return app->Run();
+    return ret;
 }
 
 int main(int argc, char** argv)
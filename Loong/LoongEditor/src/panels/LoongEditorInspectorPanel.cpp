@@ -53,16 +53,16 @@ void LoongEditorInspectorPanel::UpdateImpl(const Foundation::LoongClock& clock)
     //
 
     Core::LoongComponent* componentToRemove = nullptr;
-    for (const std::shared_ptr<Core::LoongComponent>& component : selectedActor->GetComponents()) {
+    for (Core::LoongComponent* component : selectedActor->GetComponents()) {
         bool open = true;
         ImGui::Columns(1, nullptr);
 
-        ImGui::PushID(component.get());
+        ImGui::PushID(component);
         auto showProps = ImGui::CollapsingHeader(component->GetName().c_str(), &open, ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_OpenOnDoubleClick);
         ImGui::PopID();
 
         if (!open) {
-            componentToRemove = component.get();
+            componentToRemove = component;
             continue; // Don't need to draw it
         }
 
@@ -70,18 +70,18 @@ void LoongEditorInspectorPanel::UpdateImpl(const Foundation::LoongClock& clock)
             ImGui::Columns(2, nullptr);
             // TODO Display properties
 
-            ImGuiUtils::ScopedId componentScopeId(component.get());
+            ImGuiUtils::ScopedId componentScopeId(component);
 
-            if (auto* camera = dynamic_cast<Core::LoongCCamera*>(component.get()); camera != nullptr) {
+            if (auto* camera = dynamic_cast<Core::LoongCCamera*>(component); camera != nullptr) {
                 LoongEditorInspector::Inspect(camera);
             }
-            if (auto* light = dynamic_cast<Core::LoongCLight*>(component.get()); light != nullptr) {
+            if (auto* light = dynamic_cast<Core::LoongCLight*>(component); light != nullptr) {
                 LoongEditorInspector::Inspect(light);
             }
-            if (auto* model = dynamic_cast<Core::LoongCModelRenderer*>(component.get()); model != nullptr) {
+            if (auto* model = dynamic_cast<Core::LoongCModelRenderer*>(component); model != nullptr) {
                 LoongEditorInspector::Inspect(model);
             }
-            if (auto* sky = dynamic_cast<Core::LoongCSky*>(component.get()); sky != nullptr) {
+            if (auto* sky = dynamic_cast<Core::LoongCSky*>(component); sky != nullptr) {
                 LoongEditorInspector::Inspect(sky);
             }
         }
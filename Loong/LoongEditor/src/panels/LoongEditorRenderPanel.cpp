@@ -100,6 +100,7 @@ void LoongEditorRenderPanel::RenderSceneForCamera(Core::LoongScene& scene, Core:
         &context.GetRenderer(),
         context.GetBasicUniformBuffer().get(),
         context.GetLightUniformBuffer().get(),
+        context.GetObjectUniformBuffer().get(),
         &scene,
         &camera
     };
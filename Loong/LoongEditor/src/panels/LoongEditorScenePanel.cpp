@@ -8,9 +8,9 @@
 #include "../utils/ImGuiUtils.h"
 #include "LoongApp/LoongApp.h"
 #include "LoongApp/LoongInput.h"
-#include "LoongCore/render/LoongRenderPassIdPass.h"
 #include "LoongCore/render/LoongRenderPassScenePass.h"
 #include "LoongCore/scene/LoongActor.h"
+#include "LoongCore/scene/LoongScene.h"
 #include "LoongCore/scene/components/LoongCCamera.h"
 #include "LoongCore/scene/components/LoongCModelRenderer.h"
 #include "LoongEditorScenePanel.h"
@@ -18,6 +18,7 @@
 #include "LoongResource/LoongFrameBuffer.h"
 #include "LoongResource/LoongResourceManager.h"
 #include "LoongResource/LoongShader.h"
+#include "LoongResource/LoongUniformRingBuffer.h"
 #include "LoongResource/loader/LoongTextureLoader.h"
 
 #include <imgui.h>
@@ -29,21 +30,17 @@ namespace Loong::Editor {
 LoongEditorScenePanel::LoongEditorScenePanel(LoongEditor* editor, const std::string& name, bool opened, const LoongEditorPanelConfig& cfg)
     : LoongEditorRenderPanel(editor, name, opened, cfg)
 {
-    idPass_ = std::make_shared<Core::LoongRenderPassIdPass>();
-
     auto cameraMaterial = std::make_shared<Resource::LoongMaterial>();
     cameraMaterial->SetShaderByFile("/Shaders/unlit.glsl");
     uint8_t color[4] = { 0x40, 0x80, 0xFF, 0xFF };
     cameraMaterial->GetUniformsData()["u_DiffuseMap"] = Resource::LoongTextureLoader::CreateColor(color, true, nullptr);
 
-    auto cameraModel = Resource::LoongResourceManager::GetModel("/Models/camera.lgmdl");
+    cameraModel_ = Resource::LoongResourceManager::GetModel("/Models/camera.lgmdl");
 
     scenePass_->SetCameraMaterial(cameraMaterial);
-    scenePass_->SetCameraModel(cameraModel);
+    scenePass_->SetCameraModel(cameraModel_);
     scenePass_->SetRenderCamera(true);
 
-    idPass_->SetCameraModel(cameraModel);
-
     wireframeShader_ = Resource::LoongResourceManager::GetShader("/Shaders/wireframe.glsl");
     wireframeShader_->Bind();
     static const Math::Vector4 kWireframeColor { 0.3F, 0.4F, 0.5F, 1.0F };
@@ -166,28 +163,33 @@ void LoongEditorScenePanel::Render(const Foundation::LoongClock& clock)
     if (IsFocused() && !isOverToolButton_
         && inputManager.IsMouseButtonReleaseEvent(Loong::App::LoongMouseButton::kButtonLeft)
         && Math::Distance(inputManager.GetMouseDownPosition(), mousePos) < 4.0F) {
-        // Render selecting
-        auto* frameBuffer = idPass_->GetFrameBuffer().get();
-        frameBuffer->Resize(viewportWidth_, viewportHeight_);
-
-        frameBuffer->Bind();
-
-        glViewport(0, 0, viewportWidth_, viewportHeight_);
-        glClearColor(0.F, 0.F, 0.F, 0.F);
-        renderer.Clear(true, true, true);
-        RenderSceneForCamera(*scene, camera, *idPass_);
-
+        // Pick on the CPU, rendering the ID pass and reading it back stalls the pipeline
         auto mouseX = mousePos.x - viewportMin_.x;
-        auto mouseY = viewportHeight_ - (mousePos.y - viewportMin_.y); // Flip upside down, since the image is also upside down.
-
-        uint8_t pixel[4] { 0 };
-        glReadPixels(static_cast<int>(mouseX), static_cast<int>(mouseY), 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
-        uint32_t actorId = (pixel[0] << 24u) | (pixel[1] << 16u) | (pixel[2] << 8u) | (pixel[3] << 0u);
-
-        frameBuffer->Unbind();
-
-        auto* clickedActor = scene->GetChildByIdRecursive(actorId);
-        auto* oldSelectedActor = GetEditorContext().GetCurrentSelectedActor();
+        auto mouseY = viewportHeight_ - (mousePos.y - viewportMin_.y); // Flip upside down, since the NDC y axis goes up.
+        Math::Vector2 ndc { mouseX / float(viewportWidth_) * 2.0F - 1.0F, mouseY / float(viewportHeight_) * 2.0F - 1.0F };
+
+        auto invViewProjection = Math::Inverse(camera.GetCamera().GetProjectionMatrix() * camera.GetCamera().GetViewMatrix());
+        Math::Vector4 nearPoint = invViewProjection * Math::Vector4 { ndc, -1.0F, 1.0F };
+        Math::Vector4 farPoint = invViewProjection * Math::Vector4 { ndc, 1.0F, 1.0F };
+        Math::Vector3 rayOrigin = Math::Vector3(nearPoint) / nearPoint.w;
+        Math::Vector3 rayDirection = Math::Vector3(farPoint) / farPoint.w - rayOrigin;
+
+        // The ray ends at the far plane
+        float maxDistance = 1.0F;
+        Core::LoongActor* clickedActor = nullptr;
+        Core::LoongScene::RaycastHit hit {};
+        if (scene->Raycast(rayOrigin, rayDirection, maxDistance, hit)) {
+            clickedActor = hit.actor;
+            maxDistance = hit.distance;
+        }
+        if (cameraModel_ != nullptr) {
+            for (auto* cam : scene->GetFastAccess().cameras_) {
+                if (Core::LoongScene::RaycastModel(*cameraModel_, cam->GetOwner(), rayOrigin, rayDirection, maxDistance, hit)) {
+                    clickedActor = hit.actor;
+                    maxDistance = hit.distance;
+                }
+            }
+        }
 
         GetEditorContext().SetCurrentSelectedActor(clickedActor);
     }
@@ -217,8 +219,11 @@ void LoongEditorScenePanel::Render(const Foundation::LoongClock& clock)
                 ubo.ub_Projection = camera.GetCamera().GetProjectionMatrix();
                 ubo.ub_View = camera.GetCamera().GetViewMatrix();
                 ubo.ub_ViewPos = camera.GetOwner()->GetTransform().GetWorldPosition();
-                ubo.ub_Model = selectedActor->GetTransform().GetWorldTransformMatrix();
                 GetEditorContext().GetBasicUniformBuffer()->SetSubData(&ubo, 0);
+                auto& objectUniforms = *GetEditorContext().GetObjectUniformBuffer();
+                auto slot = objectUniforms.Push(Core::LoongRenderPass::ObjectUBO { selectedActor->GetTransform().GetWorldTransformMatrix(), {} });
+                objectUniforms.Upload();
+                objectUniforms.BindSlot(slot);
                 for (auto* mesh : modelRenderer->GetModel()->GetMeshes()) {
                     renderer.Draw(*mesh);
                 }
@@ -7,12 +7,9 @@
 #include "../utils/LoongEditorGizmo.h"
 #include "LoongEditorRenderPanel.h"
 
-namespace Loong::Core {
-class LoongRenderPassIdPass;
-}
-
 namespace Loong::Resource {
 class LoongShader;
+class LoongGpuModel;
 }
 
 namespace Loong::Editor {
@@ -32,7 +29,7 @@ private:
     void UpdateShortcuts(const Foundation::LoongClock& clock);
 
 private:
-    std::shared_ptr<Core::LoongRenderPassIdPass> idPass_ { nullptr };
+    std::shared_ptr<Resource::LoongGpuModel> cameraModel_ { nullptr };
     std::shared_ptr<Resource::LoongShader> wireframeShader_ { nullptr };
     LoongEditorGizmo gizmo_ {};
     bool isOverToolButton_ {};
@@ -173,13 +173,8 @@ void LoongEditorInspector::Inspect(Core::LoongCModelRenderer* model)
             auto* node = ImGuiUtils::GetDropData<LoongFileTreeNode*>(ImGuiUtils::kDragTypeModelFile);
             if (node != nullptr) {
                 auto fullPath = node->GetFullPath();
-                auto newModel = Resource::LoongResourceManager::GetModel(fullPath);
-                if (newModel != nullptr) {
-                    model->SetModel(newModel);
-                    lowModel = newModel;
-                } else {
-                    LOONG_ERROR("Cannot set model to '{}', which is not a valid model file", fullPath);
-                }
+                model->SetModelAsync(fullPath);
+                lowModel = model->GetModel();
             }
             ImGui::EndDragDropTarget();
         }
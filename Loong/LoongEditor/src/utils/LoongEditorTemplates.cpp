@@ -13,7 +13,6 @@
 #include "LoongCore/scene/components/LoongCLight.h"
 #include "LoongCore/scene/components/LoongCModelRenderer.h"
 #include "LoongCore/scene/components/LoongCSky.h"
-#include "LoongResource/LoongResourceManager.h"
 #include <imgui.h>
 
 namespace Loong::Editor::LoongEditorTemplates {
@@ -89,7 +88,7 @@ void FillActorMenu(Core::LoongActor* actor, Core::LoongScene* scene, LoongEditor
                     newActor->SetName(actorName + std::to_string(newActor->GetID()));
                     newActor->SetParent(actor);
                     auto* modelRenderer = newActor->AddComponent<Core::LoongCModelRenderer>();
-                    modelRenderer->SetModel(Resource::LoongResourceManager::GetModel(path));
+                    modelRenderer->SetModelAsync(path);
                     editor->GetContext().SetCurrentSelectedActor(newActor);
                     LOONG_DEBUG("Create child(ID {}) for actor {}(ID {})", newActor->GetID(), actor->GetName(), actor->GetID());
                 });
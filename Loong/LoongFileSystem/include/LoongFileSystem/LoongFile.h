@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct PHYSFS_File;
+
+namespace Loong::FS {
+
+// A file opened for reading in the virtual file system. The size is known without a stat of the path, and large files
+// may be read piece by piece, e.g. decoded while being read, instead of loaded into a buffer first.
+// NOTE: Not thread safe, open a LoongFile per thread
+class LoongFile {
+public:
+    static constexpr uint64_t kDefaultReadAhead = 64 * 1024;
+
+    LoongFile() = default;
+    explicit LoongFile(const std::string& path);
+    LoongFile(const LoongFile&) = delete;
+    LoongFile(LoongFile&& file) noexcept { *this = std::move(file); }
+    ~LoongFile();
+    LoongFile& operator=(const LoongFile&) = delete;
+    LoongFile& operator=(LoongFile&& file) noexcept;
+
+    bool operator!() const { return file_ == nullptr; }
+
+    explicit operator bool() const { return file_ != nullptr; }
+
+    // -1 if unknown
+    int64_t GetSize() const;
+
+    // From the current position, returns the number of bytes read, which is less than size at the end of the file, or
+    // -1 on errors
+    int64_t Read(void* buffer, uint64_t size);
+
+    // From offset, the current position is kept
+    int64_t ReadAt(uint64_t offset, void* buffer, uint64_t size);
+
+    bool Seek(uint64_t position);
+
+    int64_t Tell() const;
+
+    bool IsEof() const;
+
+    // The sequential reads fetch this many bytes at least from the underlying file (or archive) at a time, small reads
+    // are served from the buffer then. 0 disables it.
+    bool SetReadAhead(uint64_t size);
+
+private:
+    PHYSFS_File* file_ { nullptr };
+};
+
+// The result of LoongFileSystem::ReadFileAsync, shared by the requester and the I/O thread
+class LoongAsyncRead {
+public:
+    using Callback = std::function<void(LoongAsyncRead&)>;
+
+    LoongAsyncRead(const std::string& path, uint64_t offset, uint64_t size, Callback callback)
+        : path_(path)
+        , offset_(offset)
+        , size_(size)
+        , callback_(std::move(callback))
+    {
+    }
+    LoongAsyncRead(const LoongAsyncRead&) = delete;
+    LoongAsyncRead(LoongAsyncRead&&) = delete;
+    ~LoongAsyncRead() = default;
+    LoongAsyncRead& operator=(const LoongAsyncRead&) = delete;
+    LoongAsyncRead& operator=(LoongAsyncRead&&) = delete;
+
+    const std::string& GetPath() const { return path_; }
+
+    bool IsDone() const;
+
+    void Wait() const;
+
+    // The following ones are valid once it's done
+    bool IsOk() const { return isOk_; }
+
+    std::vector<uint8_t>& GetData() { return data_; }
+
+    const std::vector<uint8_t>& GetData() const { return data_; }
+
+private:
+    friend class LoongFileReadQueue;
+
+    // Called on the I/O thread
+    void Finish(bool isOk);
+
+    std::string path_ {};
+    uint64_t offset_ { 0 };
+    uint64_t size_ { 0 };
+    Callback callback_ {};
+    bool isOk_ { false };
+    std::vector<uint8_t> data_ {};
+    mutable std::mutex mutex_ {};
+    mutable std::condition_variable doneCondition_ {};
+    bool isDone_ { false };
+};
+
+}
@@ -4,27 +4,43 @@
 
 #pragma once
 
+#include "LoongFileSystem/LoongMappedFile.h"
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
 namespace Loong::FS {
 
+class LoongAsyncRead;
+
 class LoongFileSystem {
 public:
     static bool Initialize(const std::string& argv0);
 
     static bool Uninitialize();
 
+    // sysPath is a directory or an archive, e.g. a .zip or a .lgpak (see LoongPackFile.h)
     static bool MountSearchPath(const std::string& sysPath, const std::string& mountPoint = "/", bool isAppend = true);
 
     static bool UnmountSearchPath(const std::string& sysPath);
 
+    // The writes through LoongFileSystem are seen by the metadata queries below, which are cached
     static bool SetWriteDir(const std::string& sysPath);
 
     static const char* GetWriteDir();
 
+    // The native directory of the user's settings and caches of the app, created if it doesn't exist, it ends with the
+    // separator. nullptr if it can't be created.
+    static const char* GetPrefDir(const std::string& organization, const std::string& app);
+
+    // The metadata of the files is cached until the files are changed through LoongFileSystem, enable this to see the
+    // changes made by other programs to the mounted directories, e.g. by an image editor. Only supported on Linux.
+    static bool SetChangeWatcherEnabled(bool isEnabled);
+
     static std::vector<std::string> GetSearchPaths();
 
     static bool MakeDir(const std::string& path);
@@ -77,6 +93,17 @@ public:
 
     static int64_t LoadFileContent(const std::string& path, void* buffer, uint64_t bufferSize);
 
+    // The whole file, memory mapped if it is in a mounted directory, otherwise read in one go. Check the result with
+    // operator bool. See LoongFile for reading a file piece by piece.
+    static LoongMappedFile MapFile(const std::string& path);
+
+    static constexpr uint64_t kWholeFile = std::numeric_limits<uint64_t>::max();
+
+    // Reads size bytes from offset on the I/O thread, less if the file ends before. The callback, if any, is called on
+    // the I/O thread when the read is done, successful or not, before the waiters of the result wake up.
+    static std::shared_ptr<LoongAsyncRead> ReadFileAsync(const std::string& path, uint64_t offset = 0, uint64_t size = kWholeFile,
+        std::function<void(LoongAsyncRead&)> callback = nullptr);
+
     static int64_t StoreFileContent(const std::string& path, const void* buffer, uint64_t bufferSize);
 
     enum class ErrorCode {
@@ -0,0 +1,54 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Loong::FS {
+
+// A read-only view of a whole file in the virtual file system. Files in mounted native directories are memory mapped,
+// the others (e.g. in archives) are read into memory with a single read. Either way the data is aligned to at least
+// alignof(std::max_align_t).
+class LoongMappedFile {
+public:
+    LoongMappedFile() = default;
+    explicit LoongMappedFile(const std::string& path);
+    LoongMappedFile(const LoongMappedFile&) = delete;
+    LoongMappedFile(LoongMappedFile&& file) noexcept { *this = std::move(file); }
+    ~LoongMappedFile();
+    LoongMappedFile& operator=(const LoongMappedFile&) = delete;
+    LoongMappedFile& operator=(LoongMappedFile&& file) noexcept;
+
+    const uint8_t* GetData() const { return data_; }
+
+    uint64_t GetSize() const { return size_; }
+
+    // False if the data was read into memory
+    bool IsMapped() const { return isMapped_; }
+
+    // Read every page of a mapped file once, so that the later accesses don't wait for the disk, e.g. on the main thread
+    void Prefault() const;
+
+    bool operator!() const { return data_ == nullptr; }
+
+    explicit operator bool() const { return data_ != nullptr; }
+
+private:
+    bool Map(const std::string& nativePath);
+
+    bool Read(const std::string& path);
+
+    void Close();
+
+    const uint8_t* data_ { nullptr };
+    uint64_t size_ { 0 };
+    bool isMapped_ { false };
+    std::unique_ptr<std::max_align_t[]> buffer_ {};
+};
+
+}
@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Loong::FS {
+
+// The .lgpak layout, a read-only archive of a whole tree of files, mounted with LoongFileSystem::MountSearchPath:
+//   LoongPackHeader
+//   the data of the files, the uncompressed files are kPackAlignment aligned
+//   the index at indexOffset, 8 bytes aligned, in the following order:
+//     LoongPackEntry[entryCount], sorted by the hashes of the paths
+//     LoongPackBlock[blockCount]
+//     uint32_t buckets[(1 << bucketBits) + 1], the entries in bucket i are [buckets[i], buckets[i + 1])
+//     uint32_t children[childCount], the entry indices of the children of the directories
+//     char names[namesSize], the paths of the entries without the leading '/', each one ends with '\0'
+// The files are found by the top bucketBits bits of the hashes of their paths, so the lookups are O(1). The
+// compressed files are split in blockSize blocks which are LZ4 compressed independently, so they are decompressed
+// while being read, and seeking only decompresses one block. The numbers are little endian.
+struct LoongPackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t blockSize;
+    uint32_t bucketBits;
+    uint32_t entryCount;
+    uint32_t blockCount;
+    uint32_t childCount;
+    uint32_t namesSize;
+    uint64_t indexOffset;
+    uint64_t indexSize;
+};
+
+struct LoongPackEntry {
+    static constexpr uint32_t kDirectory = 1U << 0U;
+    static constexpr uint32_t kCompressed = 1U << 1U;
+
+    uint64_t hash; // LoongPackHash of the path
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t flags;
+    uint32_t first; // the first child of a directory, or the first block of a compressed file
+    uint32_t count; // the children of a directory, or the blocks of a compressed file
+    uint32_t reserved;
+    uint64_t offset; // the data of an uncompressed file
+    uint64_t size; // of the uncompressed data
+    int64_t modTime; // seconds since the Unix epoch, -1 if unknown
+};
+
+// A block is stored without compression if it doesn't shrink, storedSize is size then
+struct LoongPackBlock {
+    uint64_t offset;
+    uint32_t storedSize;
+    uint32_t size;
+};
+
+static_assert(sizeof(LoongPackHeader) == 48);
+static_assert(sizeof(LoongPackEntry) == 56);
+static_assert(sizeof(LoongPackBlock) == 16);
+
+constexpr uint32_t kPackMagic = 0x4B41504C; // "LPAK"
+constexpr uint32_t kPackVersion = 1;
+constexpr uint32_t kPackBlockSize = 64 * 1024;
+constexpr uint64_t kPackAlignment = 4096;
+
+// FNV-1a of the path without the leading '/', the root is ""
+inline uint64_t LoongPackHash(std::string_view path)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : path) {
+        hash = (hash ^ uint8_t(c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+inline uint32_t LoongPackBucket(uint64_t hash, uint32_t bucketBits)
+{
+    return bucketBits == 0 ? 0 : uint32_t(hash >> (64U - bucketBits));
+}
+
+// Writes a .lgpak to the native file system. The data of the files is written as they are added, the index when
+// finished.
+class LoongPackWriter {
+public:
+    LoongPackWriter() = default;
+    LoongPackWriter(const LoongPackWriter&) = delete;
+    LoongPackWriter(LoongPackWriter&&) = delete;
+    // Closes the file without finishing it if Finish() is not called
+    ~LoongPackWriter();
+    LoongPackWriter& operator=(const LoongPackWriter&) = delete;
+    LoongPackWriter& operator=(LoongPackWriter&&) = delete;
+
+    bool Open(const std::string& nativePath);
+
+    // path is the one in the archive, e.g. "Models/cube.lgmdl". The file is compressed if it shrinks by 1/8 at least,
+    // otherwise it is stored aligned, so that it can be read without copies.
+    bool AddFile(const std::string& path, const void* data, uint64_t size, int64_t modTime, bool allowCompression = true);
+
+    bool Finish();
+
+    uint64_t GetDataSize() const { return dataSize_; }
+
+    uint64_t GetStoredSize() const { return storedSize_; }
+
+private:
+    struct File {
+        std::string path;
+        LoongPackEntry entry;
+    };
+
+    bool Append(const void* data, uint64_t size);
+
+    bool Pad(uint64_t alignment);
+
+    FILE* file_ { nullptr };
+    std::string nativePath_ {};
+    uint64_t fileSize_ { 0 };
+    std::vector<File> files_ {};
+    std::vector<LoongPackBlock> blocks_ {};
+    uint64_t dataSize_ { 0 };
+    uint64_t storedSize_ { 0 };
+};
+
+}
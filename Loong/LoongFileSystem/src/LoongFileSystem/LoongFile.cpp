@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFileSystem/LoongFile.h"
+#include "LoongFoundation/LoongLogger.h"
+#include <physfs.h>
+#include <utility>
+
+namespace Loong::FS {
+
+LoongFile::LoongFile(const std::string& path)
+{
+    file_ = PHYSFS_openRead(path.c_str());
+    if (file_ == nullptr) {
+        LOONG_ERROR("Open file '{}' failed: {}", path, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
+        return;
+    }
+    SetReadAhead(kDefaultReadAhead);
+}
+
+LoongFile::~LoongFile()
+{
+    if (file_ != nullptr) {
+        PHYSFS_close(file_);
+    }
+}
+
+LoongFile& LoongFile::operator=(LoongFile&& file) noexcept
+{
+    std::swap(file_, file.file_);
+    return *this;
+}
+
+int64_t LoongFile::GetSize() const
+{
+    return file_ != nullptr ? PHYSFS_fileLength(file_) : -1;
+}
+
+int64_t LoongFile::Read(void* buffer, uint64_t size)
+{
+    return file_ != nullptr ? PHYSFS_readBytes(file_, buffer, size) : -1;
+}
+
+int64_t LoongFile::ReadAt(uint64_t offset, void* buffer, uint64_t size)
+{
+    int64_t position = Tell();
+    if (position < 0 || !Seek(offset)) {
+        return -1;
+    }
+    int64_t result = Read(buffer, size);
+    return Seek(uint64_t(position)) ? result : -1;
+}
+
+bool LoongFile::Seek(uint64_t position)
+{
+    return file_ != nullptr && PHYSFS_seek(file_, position) != 0;
+}
+
+int64_t LoongFile::Tell() const
+{
+    return file_ != nullptr ? PHYSFS_tell(file_) : -1;
+}
+
+bool LoongFile::IsEof() const
+{
+    return file_ == nullptr || PHYSFS_eof(file_) != 0;
+}
+
+bool LoongFile::SetReadAhead(uint64_t size)
+{
+    return file_ != nullptr && PHYSFS_setBuffer(file_, size) != 0;
+}
+
+bool LoongAsyncRead::IsDone() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return isDone_;
+}
+
+void LoongAsyncRead::Wait() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCondition_.wait(lock, [this]() { return isDone_; });
+}
+
+void LoongAsyncRead::Finish(bool isOk)
+{
+    isOk_ = isOk;
+    if (!isOk) {
+        data_.clear();
+    }
+    // Before the waiters wake up, so the callback may hand the data over first
+    if (callback_ != nullptr) {
+        callback_(*this);
+        callback_ = nullptr;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        isDone_ = true;
+    }
+    doneCondition_.notify_all();
+}
+
+}
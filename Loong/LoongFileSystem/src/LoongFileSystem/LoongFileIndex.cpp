@@ -0,0 +1,222 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFileIndex.h"
+#include <algorithm>
+#include <mutex>
+#include <physfs.h>
+#include <string_view>
+#include <unordered_map>
+
+namespace Loong::FS {
+
+namespace {
+
+struct Entry {
+    static constexpr uint32_t kExists = 1U << 0U;
+    static constexpr uint32_t kStat = 1U << 1U;
+    static constexpr uint32_t kRealDir = 1U << 2U;
+    static constexpr uint32_t kFiles = 1U << 3U;
+
+    uint32_t cached { 0 };
+    bool exists { false };
+    std::optional<LoongFileSystem::FileStat> stat {};
+    std::optional<std::string> realDir {};
+    std::optional<std::vector<std::string>> files {};
+};
+
+std::mutex gMutex {};
+std::unordered_map<std::string, Entry> gEntries {};
+// Increased by every invalidation, a result queried meanwhile may be stale, so it is not cached
+uint64_t gGeneration { 0 };
+
+// The path as PhysFS sees it, without the leading, trailing and repeated '/'. False for the paths rejected by PhysFS,
+// they are not cached.
+bool Normalize(const std::string& path, std::string& key)
+{
+    key.clear();
+    key.reserve(path.size());
+    size_t componentStart = 0;
+    for (size_t i = 0; i <= path.size(); ++i) {
+        char c = i < path.size() ? path[i] : '/';
+        if (c == ':' || c == '\\') {
+            return false;
+        }
+        if (c != '/') {
+            key += c;
+            continue;
+        }
+        std::string_view component(key.data() + componentStart, key.size() - componentStart);
+        if (component == "." || component == "..") {
+            return false;
+        }
+        if (!component.empty()) {
+            key += '/';
+            componentStart = key.size();
+        }
+    }
+    if (!key.empty()) {
+        key.pop_back();
+    }
+    return true;
+}
+
+bool IsInside(std::string_view path, std::string_view dir)
+{
+    return dir.empty() || (path.substr(0, dir.size()) == dir && (path.size() == dir.size() || path[dir.size()] == '/'));
+}
+
+// Returns the cached result, or the one of query, which is called without the lock
+template <typename Result, typename Query>
+Result GetCached(const std::string& path, uint32_t flag, Result Entry::*field, const Query& query)
+{
+    std::string key;
+    if (!Normalize(path, key)) {
+        return query();
+    }
+    uint64_t generation = 0;
+    {
+        std::unique_lock<std::mutex> lock(gMutex);
+        auto it = gEntries.find(key);
+        if (it != gEntries.end() && (it->second.cached & flag) != 0) {
+            return it->second.*field;
+        }
+        generation = gGeneration;
+    }
+    Result result = query();
+    std::unique_lock<std::mutex> lock(gMutex);
+    if (generation == gGeneration) {
+        auto& entry = gEntries[key];
+        entry.*field = result;
+        entry.cached |= flag;
+    }
+    return result;
+}
+
+}
+
+bool LoongFileIndex::Exists(const std::string& path)
+{
+    return GetCached(path, Entry::kExists, &Entry::exists, [&path]() {
+        return 0 != PHYSFS_exists(path.c_str());
+    });
+}
+
+bool LoongFileIndex::GetFileStat(const std::string& path, LoongFileSystem::FileStat& stat)
+{
+    auto result = GetCached(path, Entry::kStat, &Entry::stat, [&path]() -> std::optional<LoongFileSystem::FileStat> {
+        PHYSFS_Stat physfsStat;
+        if (PHYSFS_stat(path.c_str(), &physfsStat) == 0) {
+            return {};
+        }
+        LoongFileSystem::FileStat stat {};
+        stat.filesize = physfsStat.filesize;
+        stat.modtime = physfsStat.modtime;
+        stat.createtime = physfsStat.createtime;
+        stat.accesstime = physfsStat.accesstime;
+        stat.filetype = LoongFileSystem::FileType(physfsStat.filetype);
+        stat.readonly = (bool)physfsStat.readonly;
+        return stat;
+    });
+    if (!result.has_value()) {
+        return false;
+    }
+    stat = *result;
+    return true;
+}
+
+std::optional<std::string> LoongFileIndex::GetRealDir(const std::string& path)
+{
+    return GetCached(path, Entry::kRealDir, &Entry::realDir, [&path]() -> std::optional<std::string> {
+        auto* realDir = PHYSFS_getRealDir(path.c_str());
+        if (realDir == nullptr) {
+            return {};
+        }
+        return std::make_optional<std::string>(realDir);
+    });
+}
+
+std::optional<std::vector<std::string>> LoongFileIndex::ListFiles(const std::string& dir)
+{
+    return GetCached(dir, Entry::kFiles, &Entry::files, [&dir]() -> std::optional<std::vector<std::string>> {
+        auto** files = PHYSFS_enumerateFiles(dir.c_str());
+        if (files == nullptr) {
+            return {};
+        }
+        std::vector<std::string> result;
+        for (char** f = files; *f != nullptr; f++) {
+            result.push_back(*f);
+        }
+        PHYSFS_freeList(files);
+        return result;
+    });
+}
+
+void LoongFileIndex::Invalidate(const std::string& path)
+{
+    std::string key;
+    bool isValid = Normalize(path, key);
+    std::unique_lock<std::mutex> lock(gMutex);
+    ++gGeneration;
+    if (!isValid || key.empty()) {
+        gEntries.clear();
+        return;
+    }
+    for (auto it = gEntries.begin(); it != gEntries.end();) {
+        if (IsInside(it->first, key) || IsInside(key, it->first)) {
+            it = gEntries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void LoongFileIndex::InvalidateWritePath(const std::string& path)
+{
+    const char* writeDir = PHYSFS_getWriteDir();
+    if (writeDir == nullptr) {
+        return;
+    }
+    // The write dir may be mounted itself, or be inside a mounted directory
+    const char separator = PHYSFS_getDirSeparator()[0];
+    auto trim = [separator](std::string_view dir) {
+        while (dir.size() > 1 && dir.back() == separator) {
+            dir.remove_suffix(1);
+        }
+        return dir;
+    };
+    std::string_view writeDirView = trim(writeDir);
+    auto** searchPaths = PHYSFS_getSearchPath();
+    if (searchPaths == nullptr) {
+        return;
+    }
+    for (char** searchPath = searchPaths; *searchPath != nullptr; searchPath++) {
+        std::string_view searchPathView = trim(*searchPath);
+        if (writeDirView.substr(0, searchPathView.size()) != searchPathView
+            || (writeDirView.size() != searchPathView.size() && writeDirView[searchPathView.size()] != separator)) {
+            continue;
+        }
+        const char* mountPoint = PHYSFS_getMountPoint(*searchPath);
+        if (mountPoint == nullptr) {
+            continue;
+        }
+        std::string virtualPath(mountPoint);
+        virtualPath += '/';
+        virtualPath += writeDirView.substr(searchPathView.size());
+        virtualPath += '/';
+        virtualPath += path;
+        std::replace(virtualPath.begin(), virtualPath.end(), separator, '/');
+        Invalidate(virtualPath);
+    }
+    PHYSFS_freeList(searchPaths);
+}
+
+void LoongFileIndex::Clear()
+{
+    std::unique_lock<std::mutex> lock(gMutex);
+    ++gGeneration;
+    gEntries.clear();
+}
+
+}
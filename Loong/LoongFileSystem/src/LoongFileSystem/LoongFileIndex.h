@@ -0,0 +1,39 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongFileSystem/LoongFileSystem.h"
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Loong::FS {
+
+// Caches the metadata queries of LoongFileSystem by path, so the repeated ones are hash lookups instead of walking
+// every search path in PhysFS. An entry is filled by the first query of the path, and is dropped when the path may
+// have changed: mounting or unmounting at or above it, writing it through the write dir, or a native change reported
+// by LoongFileWatcher. Thread safe.
+class LoongFileIndex {
+public:
+    LoongFileIndex() = delete;
+
+    static bool Exists(const std::string& path);
+
+    static bool GetFileStat(const std::string& path, LoongFileSystem::FileStat& stat);
+
+    static std::optional<std::string> GetRealDir(const std::string& path);
+
+    static std::optional<std::vector<std::string>> ListFiles(const std::string& dir);
+
+    // Drops the path, its descendants and its ancestors, the listings and stats of which may have changed too
+    static void Invalidate(const std::string& path);
+
+    // path is relative to the write dir, it is invalidated wherever the write dir is visible in the search paths
+    static void InvalidateWritePath(const std::string& path);
+
+    static void Clear();
+};
+
+}
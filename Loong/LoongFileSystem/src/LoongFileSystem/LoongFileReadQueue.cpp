@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFileReadQueue.h"
+#include "LoongFoundation/LoongLogger.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Loong::FS {
+
+namespace {
+
+std::mutex gMutex {};
+std::condition_variable gCondition {};
+std::deque<std::shared_ptr<LoongAsyncRead>> gRequests {};
+std::thread gThread {};
+bool gIsRunning { false };
+
+}
+
+void LoongFileReadQueue::Start()
+{
+    std::unique_lock<std::mutex> lock(gMutex);
+    if (gIsRunning) {
+        return;
+    }
+    gIsRunning = true;
+    gThread = std::thread([]() {
+        while (true) {
+            std::shared_ptr<LoongAsyncRead> request;
+            {
+                std::unique_lock<std::mutex> lock(gMutex);
+                gCondition.wait(lock, []() { return !gIsRunning || !gRequests.empty(); });
+                if (!gIsRunning) {
+                    return;
+                }
+                request = std::move(gRequests.front());
+                gRequests.pop_front();
+            }
+            Execute(*request);
+        }
+    });
+}
+
+void LoongFileReadQueue::Stop()
+{
+    std::deque<std::shared_ptr<LoongAsyncRead>> requests;
+    {
+        std::unique_lock<std::mutex> lock(gMutex);
+        if (!gIsRunning) {
+            return;
+        }
+        gIsRunning = false;
+        requests.swap(gRequests);
+    }
+    gCondition.notify_all();
+    gThread.join();
+    for (auto& request : requests) {
+        request->Finish(false);
+    }
+}
+
+void LoongFileReadQueue::Submit(const std::shared_ptr<LoongAsyncRead>& request)
+{
+    {
+        std::unique_lock<std::mutex> lock(gMutex);
+        if (gIsRunning) {
+            gRequests.push_back(request);
+            lock.unlock();
+            gCondition.notify_one();
+            return;
+        }
+    }
+    LOONG_ERROR("Read file '{}' failed: The file system is not initialized", request->GetPath());
+    request->Finish(false);
+}
+
+void LoongFileReadQueue::Execute(LoongAsyncRead& request)
+{
+    LoongFile file(request.path_);
+    int64_t fileSize = file.GetSize();
+    if (!file || fileSize < 0 || request.offset_ > uint64_t(fileSize)) {
+        request.Finish(false);
+        return;
+    }
+    // The whole request is read in one go, the read-ahead buffer would only add a copy
+    file.SetReadAhead(0);
+    uint64_t size = std::min(request.size_, uint64_t(fileSize) - request.offset_);
+    request.data_.resize(size);
+    bool isOk = size == 0 || file.ReadAt(request.offset_, request.data_.data(), size) == int64_t(size);
+    if (!isOk) {
+        LOONG_ERROR("Read file '{}' failed", request.path_);
+    }
+    request.Finish(isOk);
+}
+
+}
@@ -0,0 +1,29 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongFileSystem/LoongFile.h"
+#include <memory>
+
+namespace Loong::FS {
+
+// Reads the files of LoongFileSystem::ReadFileAsync on a dedicated I/O thread, in the order they are submitted, so
+// the job workers are not blocked by the disk
+class LoongFileReadQueue {
+public:
+    LoongFileReadQueue() = delete;
+
+    static void Start();
+
+    // The pending requests fail
+    static void Stop();
+
+    static void Submit(const std::shared_ptr<LoongAsyncRead>& request);
+
+private:
+    static void Execute(LoongAsyncRead& request);
+};
+
+}
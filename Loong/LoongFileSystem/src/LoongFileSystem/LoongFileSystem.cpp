@@ -4,31 +4,55 @@
 
 #include "LoongFileSystem/LoongFileSystem.h"
 #include "LoongFoundation/LoongDefer.h"
+#include "LoongFileSystem/LoongFile.h"
 #include "LoongFoundation/LoongLogger.h"
+#include "LoongFileIndex.h"
+#include "LoongFileReadQueue.h"
+#include "LoongFileWatcher.h"
+#include "LoongPackArchiver.h"
 #include <physfs.h>
 
 namespace Loong::FS {
 
 bool LoongFileSystem::Initialize(const std::string& argv0)
 {
-    return 0 != PHYSFS_init(argv0.empty() ? nullptr : argv0.c_str());
+    if (0 == PHYSFS_init(argv0.empty() ? nullptr : argv0.c_str())) {
+        return false;
+    }
+    if (!RegisterPackArchiver()) {
+        LOONG_ERROR("Register the pack archiver failed: {}", GetLastError());
+    }
+    LoongFileReadQueue::Start();
+    return true;
 }
 
 bool LoongFileSystem::Uninitialize()
 {
+    LoongFileReadQueue::Stop();
+    LoongFileWatcher::Stop();
+    LoongFileIndex::Clear();
     return 0 != PHYSFS_deinit();
 }
 
 bool LoongFileSystem::MountSearchPath(const std::string& sysPath, const std::string& mountPoint, bool isAppend)
 {
     bool ret = 0 != PHYSFS_mount(sysPath.c_str(), mountPoint.c_str(), int(isAppend));
+    if (ret) {
+        LoongFileIndex::Invalidate(mountPoint);
+        LoongFileWatcher::AddMount(sysPath, mountPoint);
+    }
     LOONG_INFO("Mount '{}' to virtual path '{}' {}", sysPath, mountPoint, ret ? "succeed" : "failed");
     return ret;
 }
 
 bool LoongFileSystem::UnmountSearchPath(const std::string& sysPath)
 {
+    auto mountPoint = GetMountPoint(sysPath);
     bool ret = 0 != PHYSFS_unmount(sysPath.c_str());
+    if (ret) {
+        LoongFileIndex::Invalidate(mountPoint.value_or("/"));
+        LoongFileWatcher::RemoveMount(sysPath);
+    }
     LOONG_INFO("Umount '{}' {}", sysPath, ret ? "succeed" : "failed");
     return ret;
 }
@@ -43,6 +67,20 @@ const char *LoongFileSystem::GetWriteDir()
     return PHYSFS_getWriteDir();
 }
 
+const char* LoongFileSystem::GetPrefDir(const std::string& organization, const std::string& app)
+{
+    return PHYSFS_getPrefDir(organization.c_str(), app.c_str());
+}
+
+bool LoongFileSystem::SetChangeWatcherEnabled(bool isEnabled)
+{
+    if (!isEnabled) {
+        LoongFileWatcher::Stop();
+        return true;
+    }
+    return LoongFileWatcher::Start();
+}
+
 std::vector<std::string> LoongFileSystem::GetSearchPaths()
 {
     std::vector<std::string> result;
@@ -60,17 +98,21 @@ std::vector<std::string> LoongFileSystem::GetSearchPaths()
 
 bool LoongFileSystem::MakeDir(const std::string& path)
 {
-    return 0 != PHYSFS_mkdir(path.c_str());
+    bool ret = 0 != PHYSFS_mkdir(path.c_str());
+    LoongFileIndex::InvalidateWritePath(path);
+    return ret;
 }
 
 bool LoongFileSystem::Delete(const std::string& file)
 {
-    return 0 != PHYSFS_delete(file.c_str());
+    bool ret = 0 != PHYSFS_delete(file.c_str());
+    LoongFileIndex::InvalidateWritePath(file);
+    return ret;
 }
 
 bool LoongFileSystem::Exists(const std::string& file)
 {
-    return 0 != PHYSFS_exists(file.c_str());
+    return LoongFileIndex::Exists(file);
 }
 
 bool LoongFileSystem::IsDir(const std::string& file)
@@ -102,56 +144,31 @@ std::optional<std::string> LoongFileSystem::GetMountPoint(const std::string& rea
 
 std::optional<std::string> LoongFileSystem::GetRealDir(const std::string& file)
 {
-    auto* realDir = PHYSFS_getRealDir(file.c_str());
-    if (realDir == nullptr) {
-        return {};
-    }
-    return std::make_optional<std::string>(realDir);
+    return LoongFileIndex::GetRealDir(file);
 }
 
 std::optional<std::vector<std::string>> LoongFileSystem::ListFiles(const std::string& dir)
 {
-    auto** files = PHYSFS_enumerateFiles(dir.c_str());
-    if (files == nullptr) {
-        return {};
-    }
-
-    std::vector<std::string> result;
-    for (char** f = files; *f != nullptr; f++) {
-        result.push_back(*f);
-    }
-    PHYSFS_freeList(files);
-    return result;
+    return LoongFileIndex::ListFiles(dir);
 }
 
 bool LoongFileSystem::EnumerateFiles(const std::string& dir, const EnumerateCallback& cb)
 {
-    struct CB {
-        const EnumerateCallback& cb;
-    };
-    CB localCb { cb };
-    return 0 != PHYSFS_enumerate(
-               dir.c_str(), [](void* data, const char* dir, const char* name) -> PHYSFS_EnumerateCallbackResult {
-                   (void)dir;
-                   CB& cb = *reinterpret_cast<CB*>(data);
-                   return cb.cb(name) ? PHYSFS_EnumerateCallbackResult::PHYSFS_ENUM_STOP : PHYSFS_EnumerateCallbackResult::PHYSFS_ENUM_OK;
-               },
-               &localCb);
+    auto files = LoongFileIndex::ListFiles(dir);
+    if (!files.has_value()) {
+        return false;
+    }
+    for (auto& name : *files) {
+        if (cb(name)) {
+            break;
+        }
+    }
+    return true;
 }
 
 bool LoongFileSystem::GetFileStat(const std::string& name, FileStat& stat)
 {
-    PHYSFS_Stat physfsStat;
-    if (PHYSFS_stat(name.c_str(), &physfsStat) == 0) {
-        return false;
-    }
-    stat.filesize = physfsStat.filesize;
-    stat.modtime = physfsStat.modtime;
-    stat.createtime = physfsStat.createtime;
-    stat.accesstime = physfsStat.accesstime;
-    stat.filetype = FileType(physfsStat.filetype);
-    stat.readonly = (bool)physfsStat.readonly;
-    return true;
+    return LoongFileIndex::GetFileStat(name, stat);
 }
 
 int64_t LoongFileSystem::LoadFileContent(const std::string& path, void* bufferVoid, uint64_t bufferSize)
@@ -181,8 +198,23 @@ int64_t LoongFileSystem::LoadFileContent(const std::string& path, void* bufferVo
     return totalCount;
 }
 
+LoongMappedFile LoongFileSystem::MapFile(const std::string& path)
+{
+    return LoongMappedFile(path);
+}
+
+std::shared_ptr<LoongAsyncRead> LoongFileSystem::ReadFileAsync(const std::string& path, uint64_t offset, uint64_t size,
+    std::function<void(LoongAsyncRead&)> callback)
+{
+    auto request = std::make_shared<LoongAsyncRead>(path, offset, size, std::move(callback));
+    LoongFileReadQueue::Submit(request);
+    return request;
+}
+
 int64_t LoongFileSystem::StoreFileContent(const std::string& path, const void* bufferVoid, uint64_t bufferSize)
 {
+    // After the file is closed
+    OnScopeExit { LoongFileIndex::InvalidateWritePath(path); };
     auto* file = PHYSFS_openWrite(path.c_str());
     if (file == nullptr) {
         return -1;
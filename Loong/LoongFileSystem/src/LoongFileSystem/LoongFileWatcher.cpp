@@ -0,0 +1,253 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFileWatcher.h"
+#include "LoongFoundation/LoongDefer.h"
+#include "LoongFoundation/LoongLogger.h"
+#include "LoongFileIndex.h"
+#include <physfs.h>
+
+#ifdef __linux__
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <mutex>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#endif
+
+namespace Loong::FS {
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+// How long the thread waits for the events before checking whether it should stop
+constexpr int kPollTimeout = 100;
+
+struct Watch {
+    std::string sysPath;
+    std::string nativePath;
+    std::string virtualPath;
+};
+
+std::mutex gMutex {};
+std::unordered_map<int, Watch> gWatches {};
+std::thread gThread {};
+std::atomic<bool> gIsRunning { false };
+int gInotify { -1 };
+
+std::string JoinPath(const std::string& dir, const char* name)
+{
+    return dir.empty() || dir.back() != '/' ? dir + '/' + name : dir + name;
+}
+
+// Watches the directory and its subdirectories, with gMutex locked
+void AddWatches(const std::string& sysPath, const std::string& nativePath, const std::string& virtualPath)
+{
+    int watch = inotify_add_watch(gInotify, nativePath.c_str(), kWatchMask);
+    if (watch < 0) {
+        LOONG_ERROR("Watch directory '{}' failed: {}", nativePath, strerror(errno));
+        return;
+    }
+    gWatches[watch] = { sysPath, nativePath, virtualPath };
+
+    DIR* dir = opendir(nativePath.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    OnScopeExit { closedir(dir); };
+    while (auto* child = readdir(dir)) {
+        if (strcmp(child->d_name, ".") == 0 || strcmp(child->d_name, "..") == 0) {
+            continue;
+        }
+        std::string childPath = JoinPath(nativePath, child->d_name);
+        struct stat childStat {};
+        if (lstat(childPath.c_str(), &childStat) == 0 && S_ISDIR(childStat.st_mode)) {
+            AddWatches(sysPath, childPath, JoinPath(virtualPath, child->d_name));
+        }
+    }
+}
+
+// Stops watching the directory and its subdirectories, with gMutex locked
+void RemoveWatches(const std::string& nativePath)
+{
+    std::string prefix = JoinPath(nativePath, "");
+    for (auto it = gWatches.begin(); it != gWatches.end();) {
+        auto& path = it->second.nativePath;
+        if (path == nativePath || path.compare(0, prefix.size(), prefix) == 0) {
+            inotify_rm_watch(gInotify, it->first);
+            it = gWatches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Watches the mounted directories again from scratch, e.g. the directories created meanwhile were missed, with
+// gMutex locked
+void RearmWatches()
+{
+    std::vector<Watch> mounts;
+    for (auto& [watch, info] : gWatches) {
+        if (info.nativePath == info.sysPath) {
+            mounts.push_back(info);
+        }
+        inotify_rm_watch(gInotify, watch);
+    }
+    gWatches.clear();
+    for (auto& mount : mounts) {
+        AddWatches(mount.sysPath, mount.nativePath, mount.virtualPath);
+    }
+}
+
+void HandleEvents()
+{
+    alignas(inotify_event) char buffer[4096];
+    ssize_t size = read(gInotify, buffer, sizeof(buffer));
+    std::unique_lock<std::mutex> lock(gMutex);
+    for (ssize_t offset = 0; offset < size;) {
+        auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+        offset += ssize_t(sizeof(inotify_event) + event->len);
+        if ((event->mask & IN_Q_OVERFLOW) != 0) {
+            // The events are lost, any file may have changed
+            LOONG_WARNING("The file watcher missed some changes, all the files are checked again");
+            RearmWatches();
+            LoongFileIndex::Clear();
+            continue;
+        }
+        auto it = gWatches.find(event->wd);
+        if (it == gWatches.end()) {
+            continue;
+        }
+        if ((event->mask & IN_IGNORED) != 0) {
+            gWatches.erase(it);
+            continue;
+        }
+        if (event->len == 0) {
+            LoongFileIndex::Invalidate(it->second.virtualPath);
+            continue;
+        }
+        std::string virtualPath = JoinPath(it->second.virtualPath, event->name);
+        LoongFileIndex::Invalidate(virtualPath);
+        if ((event->mask & IN_ISDIR) == 0) {
+            continue;
+        }
+        if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+            Watch watch = it->second;
+            AddWatches(watch.sysPath, JoinPath(watch.nativePath, event->name), virtualPath);
+        } else if ((event->mask & IN_MOVED_FROM) != 0) {
+            // The watches would follow the directory to where it is moved, under the wrong paths
+            RemoveWatches(JoinPath(it->second.nativePath, event->name));
+        }
+    }
+}
+
+}
+
+bool LoongFileWatcher::Start()
+{
+    std::unique_lock<std::mutex> lock(gMutex);
+    if (gIsRunning) {
+        return true;
+    }
+    gInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (gInotify < 0) {
+        LOONG_ERROR("Start the file watcher failed: {}", strerror(errno));
+        return false;
+    }
+    gIsRunning = true;
+    lock.unlock();
+
+    auto** searchPaths = PHYSFS_getSearchPath();
+    if (searchPaths != nullptr) {
+        for (char** searchPath = searchPaths; *searchPath != nullptr; searchPath++) {
+            const char* mountPoint = PHYSFS_getMountPoint(*searchPath);
+            AddMount(*searchPath, mountPoint != nullptr ? mountPoint : "/");
+        }
+        PHYSFS_freeList(searchPaths);
+    }
+    // The changes before the directories were watched are not reported
+    LoongFileIndex::Clear();
+
+    gThread = std::thread([]() {
+        while (gIsRunning) {
+            pollfd pollFd { gInotify, POLLIN, 0 };
+            if (poll(&pollFd, 1, kPollTimeout) > 0) {
+                HandleEvents();
+            }
+        }
+    });
+    return true;
+}
+
+void LoongFileWatcher::Stop()
+{
+    if (!gIsRunning.exchange(false)) {
+        return;
+    }
+    gThread.join();
+    std::unique_lock<std::mutex> lock(gMutex);
+    close(gInotify);
+    gInotify = -1;
+    gWatches.clear();
+}
+
+void LoongFileWatcher::AddMount(const std::string& sysPath, const std::string& mountPoint)
+{
+    std::unique_lock<std::mutex> lock(gMutex);
+    struct stat dirStat {};
+    // Archives are not watched
+    if (!gIsRunning || stat(sysPath.c_str(), &dirStat) != 0 || !S_ISDIR(dirStat.st_mode)) {
+        return;
+    }
+    AddWatches(sysPath, sysPath, mountPoint);
+}
+
+void LoongFileWatcher::RemoveMount(const std::string& sysPath)
+{
+    std::unique_lock<std::mutex> lock(gMutex);
+    for (auto it = gWatches.begin(); it != gWatches.end();) {
+        if (it->second.sysPath == sysPath) {
+            inotify_rm_watch(gInotify, it->first);
+            it = gWatches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+#else
+
+bool LoongFileWatcher::Start()
+{
+    LOONG_ERROR("Start the file watcher failed: Unsupported platform");
+    return false;
+}
+
+void LoongFileWatcher::Stop()
+{
+}
+
+void LoongFileWatcher::AddMount(const std::string& sysPath, const std::string& mountPoint)
+{
+    (void)sysPath;
+    (void)mountPoint;
+}
+
+void LoongFileWatcher::RemoveMount(const std::string& sysPath)
+{
+    (void)sysPath;
+}
+
+#endif
+
+}
@@ -0,0 +1,27 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <string>
+
+namespace Loong::FS {
+
+// Watches the native directories in the search paths, and invalidates the changed paths in LoongFileIndex, so the
+// changes made by other programs are seen. Implemented with inotify, Start fails on the other platforms.
+class LoongFileWatcher {
+public:
+    LoongFileWatcher() = delete;
+
+    // Watches the directories mounted at the moment, and the ones mounted later
+    static bool Start();
+
+    static void Stop();
+
+    static void AddMount(const std::string& sysPath, const std::string& mountPoint);
+
+    static void RemoveMount(const std::string& sysPath);
+};
+
+}
@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFileSystem/LoongMappedFile.h"
+#include "LoongFileSystem/LoongFileSystem.h"
+#include "LoongFoundation/LoongDefer.h"
+#include "LoongFoundation/LoongLogger.h"
+#include <physfs.h>
+#include <string_view>
+#include <sys/stat.h>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Loong::FS {
+
+namespace {
+
+// The path in the native file system if the file is in a mounted directory, not in an archive
+bool GetNativePath(const std::string& path, std::string& nativePath)
+{
+    auto realDir = LoongFileSystem::GetRealDir(path);
+    const char* mountPoint = realDir.has_value() ? PHYSFS_getMountPoint(realDir->c_str()) : nullptr;
+    if (mountPoint == nullptr) {
+        return false;
+    }
+    struct stat dirStat {};
+    if (stat(realDir->c_str(), &dirStat) != 0 || (dirStat.st_mode & S_IFMT) != S_IFDIR) {
+        return false;
+    }
+
+    // Both of them may start with '/', the mount point ends with '/'
+    std::string_view relativePath(path);
+    std::string_view mountPath(mountPoint);
+    while (!relativePath.empty() && relativePath.front() == '/') {
+        relativePath.remove_prefix(1);
+    }
+    while (!mountPath.empty() && mountPath.front() == '/') {
+        mountPath.remove_prefix(1);
+    }
+    if (relativePath.substr(0, mountPath.size()) != mountPath) {
+        return false;
+    }
+    relativePath.remove_prefix(mountPath.size());
+    nativePath = *realDir;
+    nativePath += '/';
+    nativePath += relativePath;
+    return true;
+}
+
+}
+
+LoongMappedFile::LoongMappedFile(const std::string& path)
+{
+    std::string nativePath;
+    if (GetNativePath(path, nativePath) && Map(nativePath)) {
+        return;
+    }
+    if (!Read(path)) {
+        LOONG_ERROR("Open file '{}' failed: {}", path, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
+    }
+}
+
+LoongMappedFile::~LoongMappedFile()
+{
+    Close();
+}
+
+LoongMappedFile& LoongMappedFile::operator=(LoongMappedFile&& file) noexcept
+{
+    std::swap(data_, file.data_);
+    std::swap(size_, file.size_);
+    std::swap(isMapped_, file.isMapped_);
+    std::swap(buffer_, file.buffer_);
+    return *this;
+}
+
+void LoongMappedFile::Prefault() const
+{
+    if (!isMapped_) {
+        return;
+    }
+    constexpr uint64_t kPageSize = 4096;
+    volatile uint8_t sum = 0;
+    for (uint64_t offset = 0; offset < size_; offset += kPageSize) {
+        sum += data_[offset];
+    }
+}
+
+bool LoongMappedFile::Map(const std::string& nativePath)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(nativePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    OnScopeExit { CloseHandle(file); };
+    LARGE_INTEGER fileSize {};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        return false;
+    }
+    OnScopeExit { CloseHandle(mapping); };
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        return false;
+    }
+    size_ = uint64_t(fileSize.QuadPart);
+#else
+    int file = open(nativePath.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    OnScopeExit { close(file); };
+    struct stat fileStat {};
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size <= 0) {
+        return false;
+    }
+    void* data = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    size_ = uint64_t(fileStat.st_size);
+#endif
+    data_ = static_cast<const uint8_t*>(data);
+    isMapped_ = true;
+    return true;
+}
+
+bool LoongMappedFile::Read(const std::string& path)
+{
+    auto* file = PHYSFS_openRead(path.c_str());
+    if (file == nullptr) {
+        return false;
+    }
+    OnScopeExit { PHYSFS_close(file); };
+
+    PHYSFS_sint64 fileSize = PHYSFS_fileLength(file);
+    if (fileSize <= 0) {
+        return false;
+    }
+    const size_t blockCount = (size_t(fileSize) + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+    buffer_.reset(new std::max_align_t[blockCount]);
+    if (PHYSFS_readBytes(file, buffer_.get(), PHYSFS_uint64(fileSize)) != fileSize) {
+        buffer_ = nullptr;
+        return false;
+    }
+    data_ = reinterpret_cast<const uint8_t*>(buffer_.get());
+    size_ = uint64_t(fileSize);
+    isMapped_ = false;
+    return true;
+}
+
+void LoongMappedFile::Close()
+{
+    if (isMapped_ && data_ != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+#else
+        munmap(const_cast<uint8_t*>(data_), size_t(size_));
+#endif
+    }
+    buffer_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+    isMapped_ = false;
+}
+
+}
@@ -0,0 +1,395 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongPackArchiver.h"
+#include "LoongFileSystem/LoongPackFile.h"
+#include "LoongFoundation/LoongLz4.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <physfs.h>
+#include <string_view>
+#include <vector>
+
+namespace Loong::FS {
+
+namespace {
+
+struct Pack {
+    // Shared by all the files of the pack, so a pack takes one file handle
+    PHYSFS_Io* io { nullptr };
+    std::mutex ioMutex {};
+    LoongPackHeader header {};
+    std::vector<uint64_t> index {};
+    const LoongPackEntry* entries { nullptr };
+    const LoongPackBlock* blocks { nullptr };
+    const uint32_t* buckets { nullptr };
+    const uint32_t* children { nullptr };
+    const char* names { nullptr };
+
+    const LoongPackEntry* Find(std::string_view path) const
+    {
+        uint64_t hash = LoongPackHash(path);
+        uint32_t bucket = LoongPackBucket(hash, header.bucketBits);
+        for (uint32_t i = buckets[bucket]; i < buckets[bucket + 1]; ++i) {
+            auto& entry = entries[i];
+            if (entry.hash == hash && std::string_view(names + entry.nameOffset, entry.nameLength) == path) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    bool ReadAt(uint64_t offset, void* buffer, uint64_t size)
+    {
+        std::unique_lock<std::mutex> lock(ioMutex);
+        return io->seek(io, offset) != 0 && io->read(io, buffer, size) == PHYSFS_sint64(size);
+    }
+};
+
+struct PackFile {
+    Pack* pack { nullptr };
+    const LoongPackEntry* entry { nullptr };
+    uint64_t position { 0 };
+    // The decompressed block of a compressed file
+    uint32_t blockIndex { std::numeric_limits<uint32_t>::max() };
+    std::vector<uint8_t> block {};
+    std::vector<uint8_t> storedBlock {};
+
+    bool LoadBlock(uint32_t index)
+    {
+        if (index == blockIndex) {
+            return true;
+        }
+        auto& packBlock = pack->blocks[entry->first + index];
+        block.resize(packBlock.size);
+        blockIndex = std::numeric_limits<uint32_t>::max();
+        if (packBlock.storedSize == packBlock.size) {
+            if (!pack->ReadAt(packBlock.offset, block.data(), packBlock.size)) {
+                return false;
+            }
+        } else {
+            storedBlock.resize(packBlock.storedSize);
+            if (!pack->ReadAt(packBlock.offset, storedBlock.data(), storedBlock.size())
+                || !Foundation::LoongLz4::Decompress(storedBlock.data(), storedBlock.size(), block.data(), block.size())) {
+                PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+                return false;
+            }
+        }
+        blockIndex = index;
+        return true;
+    }
+};
+
+PHYSFS_sint64 PackFileRead(PHYSFS_Io* io, void* buffer, PHYSFS_uint64 length)
+{
+    auto* file = static_cast<PackFile*>(io->opaque);
+    auto& entry = *file->entry;
+    length = std::min<uint64_t>(length, entry.size - file->position);
+    if (!(entry.flags & LoongPackEntry::kCompressed)) {
+        if (length > 0 && !file->pack->ReadAt(entry.offset + file->position, buffer, length)) {
+            return -1;
+        }
+        file->position += length;
+        return PHYSFS_sint64(length);
+    }
+
+    auto* output = static_cast<uint8_t*>(buffer);
+    uint64_t done = 0;
+    const uint32_t blockSize = file->pack->header.blockSize;
+    while (done < length) {
+        auto index = uint32_t(file->position / blockSize);
+        if (!file->LoadBlock(index)) {
+            return done > 0 ? PHYSFS_sint64(done) : -1;
+        }
+        uint64_t offset = file->position - uint64_t(index) * blockSize;
+        uint64_t size = std::min<uint64_t>(length - done, file->block.size() - offset);
+        memcpy(output + done, file->block.data() + offset, size);
+        done += size;
+        file->position += size;
+    }
+    return PHYSFS_sint64(done);
+}
+
+PHYSFS_sint64 PackFileWrite(PHYSFS_Io*, const void*, PHYSFS_uint64)
+{
+    PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+    return -1;
+}
+
+int PackFileSeek(PHYSFS_Io* io, PHYSFS_uint64 offset)
+{
+    auto* file = static_cast<PackFile*>(io->opaque);
+    if (offset > file->entry->size) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_PAST_EOF);
+        return 0;
+    }
+    file->position = offset;
+    return 1;
+}
+
+PHYSFS_sint64 PackFileTell(PHYSFS_Io* io)
+{
+    return PHYSFS_sint64(static_cast<PackFile*>(io->opaque)->position);
+}
+
+PHYSFS_sint64 PackFileLength(PHYSFS_Io* io)
+{
+    return PHYSFS_sint64(static_cast<PackFile*>(io->opaque)->entry->size);
+}
+
+PHYSFS_Io* PackFileDuplicate(PHYSFS_Io* io);
+
+int PackFileFlush(PHYSFS_Io*)
+{
+    return 1;
+}
+
+void PackFileDestroy(PHYSFS_Io* io)
+{
+    delete static_cast<PackFile*>(io->opaque);
+    delete io;
+}
+
+const PHYSFS_Io kPackFileIo {
+    0,
+    nullptr,
+    PackFileRead,
+    PackFileWrite,
+    PackFileSeek,
+    PackFileTell,
+    PackFileLength,
+    PackFileDuplicate,
+    PackFileFlush,
+    PackFileDestroy,
+};
+
+PHYSFS_Io* CreatePackFileIo(Pack* pack, const LoongPackEntry* entry, uint64_t position)
+{
+    auto* io = new PHYSFS_Io(kPackFileIo);
+    auto* file = new PackFile;
+    file->pack = pack;
+    file->entry = entry;
+    file->position = position;
+    io->opaque = file;
+    return io;
+}
+
+PHYSFS_Io* PackFileDuplicate(PHYSFS_Io* io)
+{
+    auto* file = static_cast<PackFile*>(io->opaque);
+    return CreatePackFileIo(file->pack, file->entry, file->position);
+}
+
+// All the offsets and the sizes are in range
+bool ValidatePack(const Pack& pack, uint64_t fileSize)
+{
+    auto& header = pack.header;
+    auto isInFile = [fileSize](uint64_t offset, uint64_t size) {
+        return offset <= fileSize && size <= fileSize - offset;
+    };
+    const uint64_t bucketCount = uint64_t(1) << header.bucketBits;
+    if (pack.buckets[0] != 0 || pack.buckets[bucketCount] != header.entryCount) {
+        return false;
+    }
+    for (uint64_t i = 0; i < bucketCount; ++i) {
+        if (pack.buckets[i] > pack.buckets[i + 1]) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.childCount; ++i) {
+        if (pack.children[i] >= header.entryCount) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.blockCount; ++i) {
+        auto& block = pack.blocks[i];
+        if (block.size == 0 || block.size > header.blockSize || block.storedSize > block.size || !isInFile(block.offset, block.storedSize)) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.entryCount; ++i) {
+        auto& entry = pack.entries[i];
+        if (uint64_t(entry.nameOffset) + entry.nameLength >= header.namesSize || pack.names[entry.nameOffset + entry.nameLength] != '\0') {
+            return false;
+        }
+        if (entry.flags & LoongPackEntry::kDirectory) {
+            if (uint64_t(entry.first) + entry.count > header.childCount) {
+                return false;
+            }
+        } else if (entry.flags & LoongPackEntry::kCompressed) {
+            // Only the last block may be smaller
+            if (uint64_t(entry.first) + entry.count > header.blockCount
+                || entry.count != (entry.size + header.blockSize - 1) / header.blockSize) {
+                return false;
+            }
+            for (uint32_t block = 0; block + 1 < entry.count; ++block) {
+                if (pack.blocks[entry.first + block].size != header.blockSize) {
+                    return false;
+                }
+            }
+        } else if (!isInFile(entry.offset, entry.size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void* OpenArchive(PHYSFS_Io* io, const char* name, int forWrite, int* claimed)
+{
+    auto pack = std::make_unique<Pack>();
+    auto& header = pack->header;
+    if (io->read(io, &header, sizeof(header)) != PHYSFS_sint64(sizeof(header)) || header.magic != kPackMagic) {
+        // Not ours, let the other archivers try
+        return nullptr;
+    }
+    *claimed = 1;
+    if (forWrite) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+        return nullptr;
+    }
+    if (header.version != kPackVersion) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_UNSUPPORTED);
+        return nullptr;
+    }
+
+    PHYSFS_sint64 fileSize = io->length(io);
+    const uint64_t bucketCount = uint64_t(1) << std::min<uint32_t>(header.bucketBits, 32);
+    const uint64_t indexSize = uint64_t(header.entryCount) * sizeof(LoongPackEntry) + uint64_t(header.blockCount) * sizeof(LoongPackBlock)
+        + (bucketCount + 1 + header.childCount) * sizeof(uint32_t) + header.namesSize;
+    if (fileSize < 0 || header.bucketBits >= 32 || header.blockSize == 0 || header.namesSize == 0 || header.indexSize != indexSize
+        || header.indexOffset % 8 != 0 || header.indexOffset > uint64_t(fileSize) || indexSize > uint64_t(fileSize) - header.indexOffset) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+        return nullptr;
+    }
+    // The index is read in one go, the uint64_t storage aligns the entries
+    pack->index.resize((indexSize + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    if (!io->seek(io, header.indexOffset) || io->read(io, pack->index.data(), indexSize) != PHYSFS_sint64(indexSize)) {
+        return nullptr;
+    }
+    auto* index = reinterpret_cast<const uint8_t*>(pack->index.data());
+    pack->entries = reinterpret_cast<const LoongPackEntry*>(index);
+    index += header.entryCount * sizeof(LoongPackEntry);
+    pack->blocks = reinterpret_cast<const LoongPackBlock*>(index);
+    index += header.blockCount * sizeof(LoongPackBlock);
+    pack->buckets = reinterpret_cast<const uint32_t*>(index);
+    index += (bucketCount + 1) * sizeof(uint32_t);
+    pack->children = reinterpret_cast<const uint32_t*>(index);
+    index += header.childCount * sizeof(uint32_t);
+    pack->names = reinterpret_cast<const char*>(index);
+    if (!ValidatePack(*pack, uint64_t(fileSize))) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+        return nullptr;
+    }
+    (void)name;
+    // Owned by the pack from now on
+    pack->io = io;
+    return pack.release();
+}
+
+PHYSFS_EnumerateCallbackResult Enumerate(void* opaque, const char* dirName, PHYSFS_EnumerateCallback callback, const char* origDir, void* callbackData)
+{
+    auto* pack = static_cast<Pack*>(opaque);
+    auto* entry = pack->Find(dirName);
+    if (entry == nullptr || !(entry->flags & LoongPackEntry::kDirectory)) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+        return PHYSFS_ENUM_ERROR;
+    }
+    for (uint32_t i = 0; i < entry->count; ++i) {
+        auto& child = pack->entries[pack->children[entry->first + i]];
+        std::string_view path(pack->names + child.nameOffset, child.nameLength);
+        auto separator = path.rfind('/');
+        auto result = callback(callbackData, origDir, path.data() + (separator == std::string_view::npos ? 0 : separator + 1));
+        if (result == PHYSFS_ENUM_ERROR) {
+            PHYSFS_setErrorCode(PHYSFS_ERR_APP_CALLBACK);
+            return result;
+        }
+        if (result == PHYSFS_ENUM_STOP) {
+            return result;
+        }
+    }
+    return PHYSFS_ENUM_OK;
+}
+
+PHYSFS_Io* OpenRead(void* opaque, const char* fileName)
+{
+    auto* pack = static_cast<Pack*>(opaque);
+    auto* entry = pack->Find(fileName);
+    if (entry == nullptr) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+        return nullptr;
+    }
+    if (entry->flags & LoongPackEntry::kDirectory) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_A_FILE);
+        return nullptr;
+    }
+    return CreatePackFileIo(pack, entry, 0);
+}
+
+PHYSFS_Io* OpenWrite(void*, const char*)
+{
+    PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+    return nullptr;
+}
+
+int Remove(void*, const char*)
+{
+    PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+    return 0;
+}
+
+int Stat(void* opaque, const char* fileName, PHYSFS_Stat* stat)
+{
+    auto* entry = static_cast<Pack*>(opaque)->Find(fileName);
+    if (entry == nullptr) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+        return 0;
+    }
+    const bool isDirectory = entry->flags & LoongPackEntry::kDirectory;
+    stat->filesize = isDirectory ? 0 : PHYSFS_sint64(entry->size);
+    stat->modtime = entry->modTime;
+    stat->createtime = entry->modTime;
+    stat->accesstime = -1;
+    stat->filetype = isDirectory ? PHYSFS_FILETYPE_DIRECTORY : PHYSFS_FILETYPE_REGULAR;
+    stat->readonly = 1;
+    return 1;
+}
+
+void CloseArchive(void* opaque)
+{
+    auto* pack = static_cast<Pack*>(opaque);
+    pack->io->destroy(pack->io);
+    delete pack;
+}
+
+const PHYSFS_Archiver kPackArchiver {
+    0,
+    {
+        "lgpak",
+        "Loong asset pack",
+        "Carl Chen",
+        "https://github.com/carlcc/Loong",
+        0,
+    },
+    OpenArchive,
+    Enumerate,
+    OpenRead,
+    OpenWrite,
+    OpenWrite,
+    Remove,
+    Remove,
+    Stat,
+    CloseArchive,
+};
+
+}
+
+bool RegisterPackArchiver()
+{
+    return PHYSFS_registerArchiver(&kPackArchiver) != 0;
+}
+
+}
@@ -0,0 +1,12 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+namespace Loong::FS {
+
+// Let PhysFS mount the .lgpak files, see LoongPackFile.h
+bool RegisterPackArchiver();
+
+}
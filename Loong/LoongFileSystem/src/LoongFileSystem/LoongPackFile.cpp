@@ -0,0 +1,238 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#ifdef _MSC_VER
+// e.g. This function or variable may be unsafe. Consider using fopen_s instead.
+#pragma warning(disable : 4996)
+#endif
+
+#include "LoongFileSystem/LoongPackFile.h"
+#include "LoongFoundation/LoongLogger.h"
+#include "LoongFoundation/LoongLz4.h"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace Loong::FS {
+
+namespace {
+
+std::string_view GetParentPath(std::string_view path)
+{
+    auto index = path.rfind('/');
+    return index == std::string_view::npos ? std::string_view() : path.substr(0, index);
+}
+
+}
+
+LoongPackWriter::~LoongPackWriter()
+{
+    if (file_ != nullptr) {
+        fclose(file_);
+    }
+}
+
+bool LoongPackWriter::Open(const std::string& nativePath)
+{
+    file_ = fopen(nativePath.c_str(), "wb");
+    if (file_ == nullptr) {
+        LOONG_ERROR("Open pack '{}' for writing failed", nativePath);
+        return false;
+    }
+    nativePath_ = nativePath;
+    // Finish() writes the real one
+    LoongPackHeader header {};
+    return Append(&header, sizeof(header));
+}
+
+bool LoongPackWriter::AddFile(const std::string& path, const void* data, uint64_t size, int64_t modTime, bool allowCompression)
+{
+    if (file_ == nullptr) {
+        return false;
+    }
+    std::string_view name(path);
+    while (!name.empty() && name.front() == '/') {
+        name.remove_prefix(1);
+    }
+    if (name.empty()) {
+        LOONG_ERROR("Add file '{}' to pack '{}' failed: Bad file name", path, nativePath_);
+        return false;
+    }
+
+    auto* bytes = static_cast<const uint8_t*>(data);
+    LoongPackEntry entry {};
+    entry.size = size;
+    entry.modTime = modTime;
+    std::vector<uint8_t> compressed;
+    std::vector<LoongPackBlock> blocks;
+    if (allowCompression) {
+        std::vector<uint8_t> block;
+        for (uint64_t offset = 0; offset < size; offset += kPackBlockSize) {
+            auto blockSize = uint32_t(std::min<uint64_t>(size - offset, kPackBlockSize));
+            Foundation::LoongLz4::Compress(bytes + offset, blockSize, block);
+            blocks.push_back({ compressed.size(), blockSize, blockSize });
+            if (block.size() < blockSize) {
+                blocks.back().storedSize = uint32_t(block.size());
+                compressed.insert(compressed.end(), block.begin(), block.end());
+            } else {
+                compressed.insert(compressed.end(), bytes + offset, bytes + offset + blockSize);
+            }
+        }
+    }
+
+    if (!blocks.empty() && compressed.size() <= size - size / 8) {
+        entry.flags = LoongPackEntry::kCompressed;
+        entry.first = uint32_t(blocks_.size());
+        entry.count = uint32_t(blocks.size());
+        for (auto& block : blocks) {
+            block.offset += fileSize_;
+            blocks_.push_back(block);
+        }
+        if (!Append(compressed.data(), compressed.size())) {
+            return false;
+        }
+        storedSize_ += compressed.size();
+    } else {
+        if (!Pad(kPackAlignment)) {
+            return false;
+        }
+        entry.offset = fileSize_;
+        if (!Append(data, size)) {
+            return false;
+        }
+        storedSize_ += size;
+    }
+    dataSize_ += size;
+    files_.push_back({ std::string(name), entry });
+    return true;
+}
+
+bool LoongPackWriter::Finish()
+{
+    if (file_ == nullptr) {
+        return false;
+    }
+
+    std::set<std::string> directories { "" };
+    std::set<std::string_view> filePaths;
+    for (auto& file : files_) {
+        if (!filePaths.insert(file.path).second) {
+            LOONG_ERROR("Finish pack '{}' failed: File '{}' is added twice", nativePath_, file.path);
+            return false;
+        }
+        auto parent = GetParentPath(file.path);
+        while (directories.insert(std::string(parent)).second) {
+            parent = GetParentPath(parent);
+        }
+    }
+    for (auto& directory : directories) {
+        if (filePaths.count(directory) != 0) {
+            LOONG_ERROR("Finish pack '{}' failed: '{}' is both a file and a directory", nativePath_, directory);
+            return false;
+        }
+    }
+    std::vector<File> entries(files_);
+    for (auto& directory : directories) {
+        LoongPackEntry entry {};
+        entry.flags = LoongPackEntry::kDirectory;
+        entry.modTime = -1;
+        entries.push_back({ directory, entry });
+    }
+    for (auto& file : entries) {
+        file.entry.hash = LoongPackHash(file.path);
+    }
+    std::sort(entries.begin(), entries.end(), [](const File& a, const File& b) {
+        return std::tie(a.entry.hash, a.path) < std::tie(b.entry.hash, b.path);
+    });
+
+    // The children of each directory, in the order of their names
+    std::map<std::string_view, std::vector<uint32_t>> directoryChildren;
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        if (!entries[i].path.empty()) {
+            directoryChildren[GetParentPath(entries[i].path)].push_back(i);
+        }
+    }
+    std::vector<uint32_t> children;
+    std::vector<char> names;
+    for (auto& file : entries) {
+        if (file.entry.flags & LoongPackEntry::kDirectory) {
+            auto& list = directoryChildren[file.path];
+            std::sort(list.begin(), list.end(), [&entries](uint32_t a, uint32_t b) { return entries[a].path < entries[b].path; });
+            file.entry.first = uint32_t(children.size());
+            file.entry.count = uint32_t(list.size());
+            children.insert(children.end(), list.begin(), list.end());
+        }
+        file.entry.nameOffset = uint32_t(names.size());
+        file.entry.nameLength = uint32_t(file.path.size());
+        names.insert(names.end(), file.path.begin(), file.path.end());
+        names.push_back('\0');
+    }
+
+    uint32_t bucketBits = 0;
+    while ((uint64_t(1) << bucketBits) < entries.size()) {
+        ++bucketBits;
+    }
+    std::vector<uint32_t> buckets((size_t(1) << bucketBits) + 1, 0);
+    for (auto& file : entries) {
+        ++buckets[LoongPackBucket(file.entry.hash, bucketBits) + 1];
+    }
+    for (size_t i = 1; i < buckets.size(); ++i) {
+        buckets[i] += buckets[i - 1];
+    }
+
+    std::vector<LoongPackEntry> entryRecords;
+    for (auto& file : entries) {
+        entryRecords.push_back(file.entry);
+    }
+    if (!Pad(8)) {
+        return false;
+    }
+    LoongPackHeader header {};
+    header.magic = kPackMagic;
+    header.version = kPackVersion;
+    header.blockSize = kPackBlockSize;
+    header.bucketBits = bucketBits;
+    header.entryCount = uint32_t(entryRecords.size());
+    header.blockCount = uint32_t(blocks_.size());
+    header.childCount = uint32_t(children.size());
+    header.namesSize = uint32_t(names.size());
+    header.indexOffset = fileSize_;
+    if (!Append(entryRecords.data(), entryRecords.size() * sizeof(LoongPackEntry))
+        || !Append(blocks_.data(), blocks_.size() * sizeof(LoongPackBlock))
+        || !Append(buckets.data(), buckets.size() * sizeof(uint32_t))
+        || !Append(children.data(), children.size() * sizeof(uint32_t))
+        || !Append(names.data(), names.size())) {
+        return false;
+    }
+    header.indexSize = fileSize_ - header.indexOffset;
+
+    bool isOk = fseek(file_, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file_) == 1;
+    isOk = fclose(file_) == 0 && isOk;
+    file_ = nullptr;
+    if (!isOk) {
+        LOONG_ERROR("Finish pack '{}' failed: Can not write the file", nativePath_);
+        return false;
+    }
+    LOONG_INFO("Pack '{}': {} files, {} bytes stored as {} bytes", nativePath_, files_.size(), dataSize_, storedSize_);
+    return true;
+}
+
+bool LoongPackWriter::Append(const void* data, uint64_t size)
+{
+    if (size > 0 && fwrite(data, size_t(size), 1, file_) != 1) {
+        LOONG_ERROR("Write pack '{}' failed", nativePath_);
+        return false;
+    }
+    fileSize_ += size;
+    return true;
+}
+
+bool LoongPackWriter::Pad(uint64_t alignment)
+{
+    static const uint8_t kZeros[kPackAlignment] {};
+    return Append(kZeros, (alignment - fileSize_ % alignment) % alignment);
+}
+
+}
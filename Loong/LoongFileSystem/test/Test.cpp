@@ -2,9 +2,16 @@
 // Copyright (c) 2020 Carl Chen. All rights reserved.
 //
 
+#include "LoongFileSystem/LoongFile.h"
 #include "LoongFileSystem/LoongFileSystem.h"
+#include "LoongFileSystem/LoongMappedFile.h"
+#include "LoongFileSystem/LoongPackFile.h"
 #include <cassert>
+#include <cstdio>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <thread>
 
 using namespace Loong::FS;
 
@@ -39,6 +46,107 @@ int main(int argc, const char* argv[])
     auto& answer = files.value();
     assert(answer == kRightAnswer);
 
+    {
+        auto fileSize = LoongFileSystem::GetFileSize("/Test.cpp");
+        std::vector<uint8_t> content(fileSize);
+        assert(LoongFileSystem::LoadFileContent("/Test.cpp", content.data(), content.size()) == fileSize);
+
+        LoongMappedFile mappedFile("/Test.cpp");
+        assert(mappedFile && mappedFile.IsMapped());
+        assert(mappedFile.GetSize() == content.size() && memcmp(mappedFile.GetData(), content.data(), content.size()) == 0);
+
+        LoongMappedFile movedFile(std::move(mappedFile));
+        assert(!mappedFile && movedFile.GetSize() == content.size());
+        assert(!LoongMappedFile("/NotExists.txt"));
+        assert(LoongFileSystem::MapFile("/Test.cpp").GetSize() == content.size());
+
+        LoongFile file("/Test.cpp");
+        assert(file && file.GetSize() == fileSize);
+        std::vector<uint8_t> fileContent(content.size() + 16);
+        assert(file.Read(fileContent.data(), 10) == 10 && file.Tell() == 10);
+        assert(file.ReadAt(100, fileContent.data() + 100, 20) == 20 && file.Tell() == 10);
+        assert(memcmp(fileContent.data() + 100, content.data() + 100, 20) == 0);
+        assert(file.Read(fileContent.data() + 10, fileContent.size() - 10) == fileSize - 10 && file.IsEof());
+        fileContent.resize(content.size());
+        assert(fileContent == content);
+        assert(!LoongFile("/NotExists.txt"));
+
+        bool isCalledBack = false;
+        auto asyncRead = LoongFileSystem::ReadFileAsync("/Test.cpp", 0, LoongFileSystem::kWholeFile, [&isCalledBack](LoongAsyncRead&) { isCalledBack = true; });
+        auto asyncPart = LoongFileSystem::ReadFileAsync("/Test.cpp", uint64_t(fileSize) - 5, 100);
+        auto asyncMissing = LoongFileSystem::ReadFileAsync("/NotExists.txt");
+        asyncRead->Wait();
+        asyncPart->Wait();
+        asyncMissing->Wait();
+        assert(asyncRead->IsOk() && asyncRead->GetData() == content && isCalledBack);
+        assert(asyncPart->IsOk() && asyncPart->GetData().size() == 5);
+        assert(memcmp(asyncPart->GetData().data(), content.data() + fileSize - 5, 5) == 0);
+        assert(asyncMissing->IsDone() && !asyncMissing->IsOk());
+
+        // Test.cpp is compressed, the other one is stored
+        const char* kPackPath = "LoongFileSystem_unittest.lgpak";
+        std::vector<uint8_t> incompressible(100000);
+        for (size_t i = 0; i < incompressible.size(); ++i) {
+            incompressible[i] = uint8_t((i * 2654435761U) >> 13U);
+        }
+        LoongPackWriter writer;
+        bool isOpened = writer.Open(kPackPath);
+        bool isSourceAdded = writer.AddFile("/Source/Test.cpp", content.data(), content.size(), 1);
+        bool isDataAdded = writer.AddFile("/Source/Data/Random.bin", incompressible.data(), incompressible.size(), 2);
+        bool isFinished = writer.Finish();
+        assert(isOpened && isSourceAdded && isDataAdded && isFinished);
+        assert(writer.GetStoredSize() < writer.GetDataSize());
+        bool isPackMounted = LoongFileSystem::MountSearchPath(kPackPath, "/Pack");
+        assert(isPackMounted);
+
+        assert(LoongFileSystem::IsDir("/Pack/Source") && LoongFileSystem::IsDir("/Pack/Source/Data"));
+        assert((LoongFileSystem::ListFiles("/Pack/Source").value() == std::vector<std::string> { "Data", "Test.cpp" }));
+        assert(LoongFileSystem::GetFileSize("/Pack/Source/Test.cpp") == fileSize);
+        assert(!LoongFileSystem::Exists("/Pack/Source/NotExists.txt"));
+        std::vector<uint8_t> packedContent(fileSize);
+        int64_t packedSize = LoongFileSystem::LoadFileContent("/Pack/Source/Test.cpp", packedContent.data(), packedContent.size());
+        assert(packedSize == fileSize && packedContent == content);
+        LoongMappedFile packedFile("/Pack/Source/Data/Random.bin");
+        assert(packedFile && !packedFile.IsMapped() && packedFile.GetSize() == incompressible.size());
+        assert(memcmp(packedFile.GetData(), incompressible.data(), incompressible.size()) == 0);
+
+        bool isPackUnmounted = LoongFileSystem::UnmountSearchPath(kPackPath);
+        assert(isPackUnmounted);
+        assert(!LoongFileSystem::Exists("/Pack/Source") && !LoongFileSystem::IsDir("/Pack"));
+        std::remove(kPackPath);
+    }
+
+    {
+        // The cached metadata follows the writes, and the native changes reported by the watcher
+        const char* kWriteFile = "LoongFileSystem_unittest.txt";
+        const std::string kVirtualPath = std::string("/Write/") + kWriteFile;
+        bool isWriteDirSet = LoongFileSystem::SetWriteDir(".");
+        bool isWriteDirMounted = LoongFileSystem::MountSearchPath(".", "/Write");
+        assert(isWriteDirSet && isWriteDirMounted);
+        assert(!LoongFileSystem::Exists(kVirtualPath));
+        int64_t storedSize = LoongFileSystem::StoreFileContent(kWriteFile, "1234", 4);
+        assert(storedSize == 4);
+        assert(LoongFileSystem::Exists(kVirtualPath) && LoongFileSystem::GetFileSize(kVirtualPath) == 4);
+#ifdef __linux__
+        bool isWatcherEnabled = LoongFileSystem::SetChangeWatcherEnabled(true);
+        assert(isWatcherEnabled);
+        FILE* file = fopen(kWriteFile, "ab");
+        assert(file != nullptr);
+        fwrite("5678", 1, 4, file);
+        fclose(file);
+        for (int i = 0; i < 200 && LoongFileSystem::GetFileSize(kVirtualPath) != 8; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        assert(LoongFileSystem::GetFileSize(kVirtualPath) == 8);
+        bool isWatcherDisabled = LoongFileSystem::SetChangeWatcherEnabled(false);
+        assert(isWatcherDisabled);
+#endif
+        bool isDeleted = LoongFileSystem::Delete(kWriteFile);
+        assert(isDeleted && !LoongFileSystem::Exists(kVirtualPath));
+        bool isWriteDirUnmounted = LoongFileSystem::UnmountSearchPath(".");
+        assert(isWriteDirUnmounted && !LoongFileSystem::IsDir("/Write"));
+    }
+
     LoongFileSystem::EnumerateFiles("/", [&kRightAnswer](const std::string& name) -> bool {
         assert(name == kRightAnswer[0]);
         std::cout << name << std::endl;
@@ -0,0 +1,224 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongFoundation/LoongFrustum.h"
+#include "LoongFoundation/LoongMath.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Loong::Foundation {
+
+// A dynamic bounding volume hierarchy, a.k.a. dynamic AABB tree (like b2DynamicTree in Box2D).
+// Leaves store fattened boxes, so that objects moving a little don't need to touch the tree.
+class LoongAABBTree {
+public:
+    static constexpr int32_t kNullNode = -1;
+
+    static constexpr size_t kStackReserve = 64;
+
+    explicit LoongAABBTree(float margin = 0.1F);
+
+    LoongAABBTree(const LoongAABBTree&) = delete;
+    LoongAABBTree(LoongAABBTree&&) = delete;
+    LoongAABBTree& operator=(const LoongAABBTree&) = delete;
+    LoongAABBTree& operator=(LoongAABBTree&&) = delete;
+
+    // Returns the proxy id of the new leaf
+    int32_t Insert(const Math::AABB& aabb, void* userData);
+
+    void Remove(int32_t proxy);
+
+    // Returns true if the leaf has been re-inserted, that is the new box escaped from the fat box
+    bool Update(int32_t proxy, const Math::AABB& aabb);
+
+    void Clear();
+
+    void* GetUserData(int32_t proxy) const { return nodes_[proxy].userData; }
+
+    const Math::AABB& GetFatAABB(int32_t proxy) const { return nodes_[proxy].aabb; }
+
+    int32_t GetProxyCount() const { return proxyCount_; }
+
+    int32_t GetHeight() const { return root_ == kNullNode ? 0 : nodes_[root_].height; }
+
+    // Check the structure and the bounds of the whole tree, for debugging purpose
+    bool Validate() const;
+
+    // callback(proxy)
+    template <class Callback>
+    void QueryAABB(const Math::AABB& aabb, Callback&& callback) const
+    {
+        Query([&aabb](const Math::AABB& box) { return box.Overlaps(aabb); }, callback);
+    }
+
+    // callback(proxy)
+    template <class Callback>
+    void QuerySphere(const Math::Vector3& center, float radius, Callback&& callback) const
+    {
+        const float radius2 = radius * radius;
+        Query([&center, radius2](const Math::AABB& box) {
+            Math::Vector3 d = Math::Max(box.min - center, Math::Vector3(0.0F)) + Math::Max(center - box.max, Math::Vector3(0.0F));
+            return Math::Dot(d, d) <= radius2;
+        },
+            callback);
+    }
+
+    // callback(proxy, distance) returns the new max distance, which is used to clip the rest of the traversal.
+    // Return the passed in max distance to keep going, or the distance to the hit to find the nearest one.
+    // The distance is where the ray enters the fat box, in units of the direction length.
+    template <class Callback>
+    void QueryRay(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, Callback&& callback) const
+    {
+        if (root_ == kNullNode) {
+            return;
+        }
+        const Math::Vector3 invDir = 1.0F / direction;
+        std::vector<int32_t> stack;
+        stack.reserve(kStackReserve);
+        stack.push_back(root_);
+        while (!stack.empty()) {
+            int32_t nodeId = stack.back();
+            stack.pop_back();
+            auto& node = nodes_[nodeId];
+            float distance = 0.0F;
+            if (!RayIntersects(node.aabb, origin, invDir, maxDistance, distance)) {
+                continue;
+            }
+            if (node.IsLeaf()) {
+                maxDistance = callback(nodeId, distance);
+                if (maxDistance <= 0.0F) {
+                    break;
+                }
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    // callback(proxy, isInside), isInside is true if the fat box is completely inside the frustum.
+    // Sub-trees completely inside the frustum are reported without any further tests, planes a node is
+    // in front of are not tested again for its children.
+    template <class Callback>
+    void QueryFrustum(const Frustum& frustum, Callback&& callback) const
+    {
+        if (root_ == kNullNode) {
+            return;
+        }
+        std::vector<int32_t> stack;
+        std::vector<uint32_t> masks;
+        stack.reserve(kStackReserve);
+        masks.reserve(kStackReserve);
+        stack.push_back(root_);
+        masks.push_back(Frustum::kAllPlanesMask);
+        while (!stack.empty()) {
+            int32_t nodeId = stack.back();
+            uint32_t planeMask = masks.back();
+            stack.pop_back();
+            masks.pop_back();
+            auto& node = nodes_[nodeId];
+            switch (frustum.ClassifyBox(node.aabb, planeMask)) {
+            case Frustum::Containment::kOutside:
+                break;
+            case Frustum::Containment::kInside:
+                ReportAll(nodeId, callback);
+                break;
+            case Frustum::Containment::kIntersect:
+                if (node.IsLeaf()) {
+                    callback(nodeId, false);
+                } else {
+                    stack.push_back(node.child1);
+                    masks.push_back(planeMask);
+                    stack.push_back(node.child2);
+                    masks.push_back(planeMask);
+                }
+                break;
+            }
+        }
+    }
+
+private:
+    struct Node {
+        Math::AABB aabb {};
+        void* userData { nullptr };
+        // The next free node if this node is in the free list
+        int32_t parent { kNullNode };
+        int32_t child1 { kNullNode };
+        int32_t child2 { kNullNode };
+        // leaf = 0, free node = -1
+        int32_t height { -1 };
+
+        bool IsLeaf() const { return child1 == kNullNode; }
+    };
+
+    template <class Predicate, class Callback>
+    void Query(Predicate&& predicate, Callback&& callback) const
+    {
+        if (root_ == kNullNode) {
+            return;
+        }
+        std::vector<int32_t> stack;
+        stack.reserve(kStackReserve);
+        stack.push_back(root_);
+        while (!stack.empty()) {
+            int32_t nodeId = stack.back();
+            stack.pop_back();
+            auto& node = nodes_[nodeId];
+            if (!predicate(node.aabb)) {
+                continue;
+            }
+            if (node.IsLeaf()) {
+                callback(nodeId);
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    template <class Callback>
+    void ReportAll(int32_t nodeId, Callback&& callback) const
+    {
+        auto& node = nodes_[nodeId];
+        if (node.IsLeaf()) {
+            callback(nodeId, true);
+        } else {
+            ReportAll(node.child1, callback);
+            ReportAll(node.child2, callback);
+        }
+    }
+
+    static bool RayIntersects(const Math::AABB& aabb, const Math::Vector3& origin, const Math::Vector3& invDir, float maxDistance, float& distance)
+    {
+        Math::Vector3 t1 = (aabb.min - origin) * invDir;
+        Math::Vector3 t2 = (aabb.max - origin) * invDir;
+        Math::Vector3 tMin = Math::Min(t1, t2);
+        Math::Vector3 tMax = Math::Max(t1, t2);
+        float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0F));
+        float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+        distance = enter;
+        return enter <= exit;
+    }
+
+    int32_t AllocateNode();
+
+    void FreeNode(int32_t nodeId);
+
+    void InsertLeaf(int32_t leaf);
+
+    void RemoveLeaf(int32_t leaf);
+
+    int32_t Balance(int32_t nodeId);
+
+    std::vector<Node> nodes_ {};
+    int32_t root_ { kNullNode };
+    int32_t freeList_ { kNullNode };
+    int32_t proxyCount_ { 0 };
+    float margin_ { 0.1F };
+};
+
+}
@@ -0,0 +1,41 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongFoundation/LoongSerializer.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace Loong::Foundation {
+
+// Gathers the small writes of the archives, so that the file is written in large blocks. The writes larger than the
+// buffer go to the file directly. The file is owned by the caller, the stream must be flushed or destroyed before
+// the file is closed.
+class LoongBufferedFileOutputStream : public LoongArchiveOutputStream {
+public:
+    static constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+    explicit LoongBufferedFileOutputStream(FILE* file, size_t bufferSize = kDefaultBufferSize);
+    LoongBufferedFileOutputStream(const LoongBufferedFileOutputStream&) = delete;
+    LoongBufferedFileOutputStream(LoongBufferedFileOutputStream&&) = delete;
+    // Flushes, check the result of Flush() before instead if the errors matter
+    ~LoongBufferedFileOutputStream();
+    LoongBufferedFileOutputStream& operator=(const LoongBufferedFileOutputStream&) = delete;
+    LoongBufferedFileOutputStream& operator=(LoongBufferedFileOutputStream&&) = delete;
+
+    bool operator()(void* d, size_t l);
+
+    // Write the buffered data to the file. All the later writes fail after a failed one.
+    bool Flush();
+
+private:
+    FILE* file_ { nullptr };
+    std::vector<uint8_t> buffer_ {};
+    size_t bufferUsed_ { 0 };
+    bool isOk_ { true };
+};
+
+}
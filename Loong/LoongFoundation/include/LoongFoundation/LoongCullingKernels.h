@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongFoundation/LoongMath.h"
+#include <cstdint>
+#include <vector>
+
+namespace Loong::Foundation {
+
+class Frustum;
+
+// Boxes in the center and extents form, one array per component, so that the kernels can load 4 or 8 boxes at once
+class LoongBoxArray {
+public:
+    size_t GetSize() const { return size_; }
+
+    void Resize(size_t size);
+
+    void Set(size_t index, const Math::AABB& aabb);
+
+    Math::AABB Get(size_t index) const;
+
+    float* GetCenters(int axis) { return centers_[axis].data(); }
+    const float* GetCenters(int axis) const { return centers_[axis].data(); }
+    float* GetExtents(int axis) { return extents_[axis].data(); }
+    const float* GetExtents(int axis) const { return extents_[axis].data(); }
+
+private:
+    std::vector<float> centers_[3] {};
+    std::vector<float> extents_[3] {};
+    size_t size_ { 0 };
+};
+
+class LoongSphereArray {
+public:
+    size_t GetSize() const { return size_; }
+
+    void Resize(size_t size);
+
+    void Set(size_t index, const Math::Vector3& center, float radius);
+
+    float* GetCenters(int axis) { return centers_[axis].data(); }
+    const float* GetCenters(int axis) const { return centers_[axis].data(); }
+    float* GetRadii() { return radii_.data(); }
+    const float* GetRadii() const { return radii_.data(); }
+
+private:
+    std::vector<float> centers_[3] {};
+    std::vector<float> radii_ {};
+    size_t size_ { 0 };
+};
+
+// Batch versions of AABB::Transformed() and the frustum tests. Every kernel has a scalar, an SSE2 and an AVX2 path, the
+// best one the CPU supports is picked at startup. The paths give the same results, they do the same operations in the
+// same order.
+// The visibility is a bit mask, bit i % 32 of word i / 32 is set if the i-th bounds are visible.
+class LoongCullingKernels {
+public:
+    enum class InstructionSet {
+        kScalar,
+        kSSE2,
+        kAVX2,
+    };
+
+    static InstructionSet GetSupportedInstructionSet();
+
+    static InstructionSet GetInstructionSet();
+
+    // Force a slower path, for tests and benchmarks. Instruction sets the CPU doesn't support are ignored.
+    static void SetInstructionSet(InstructionSet instructionSet);
+
+    static bool IsVisible(const std::vector<uint32_t>& visibleMask, size_t index)
+    {
+        return (visibleMask[index / 32] & (1U << (index % 32))) != 0;
+    }
+
+    // Same as AABB::Transformed() for affine matrices
+    static void TransformBoxes(const LoongBoxArray& boxes, const Math::Matrix4& matrix, LoongBoxArray& result);
+
+    // One matrix per box
+    static void TransformBoxes(const LoongBoxArray& boxes, const Math::Matrix4* matrices, LoongBoxArray& result);
+
+    // The planes only test with the positive vertex of each box, like Frustum::ClassifyBox(). It's more conservative
+    // than Frustum::IsBoxVisible(), which also tests the frustum corners against the box.
+    static void TestBoxes(const Frustum& frustum, const LoongBoxArray& boxes, std::vector<uint32_t>& visibleMask);
+
+    static void TestSpheres(const Frustum& frustum, const LoongSphereArray& spheres, std::vector<uint32_t>& visibleMask);
+};
+
+}
@@ -29,8 +29,23 @@ public:
 
     bool IsSphereVisible(const Math::Vector3& center, float radius) const;
 
+    enum class Containment {
+        kOutside,
+        kIntersect,
+        kInside,
+    };
+
+    static constexpr uint32_t kAllPlanesMask = (1U << Planes::kCount) - 1U;
+
+    // Conservative plane-only test for hierarchical culling. Bits of planeMask are the planes that still need to be
+    // tested, the planes the box is completely in front of are cleared, so that children can skip them.
+    Containment ClassifyBox(const Math::AABB& aabb, uint32_t& planeMask) const;
+
     const Math::Vector3* GetPoints() const { return points_; }
 
+    // Not normalized, the positive side is inside
+    const Math::Vector4* GetPlanes() const { return planes_; }
+
 private:
     template <Planes i, Planes j>
     struct ij2k {
@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Loong::Foundation {
+
+class LoongJobCounter;
+
+struct LoongJob {
+    std::function<void()> func {};
+    LoongJobCounter* counter { nullptr }; // decremented when the job is done
+    bool isMainThreadJob { false };
+};
+
+// Counts the unfinished jobs of a group. Jobs can wait for a counter to reach zero before they start, and
+// LoongJobSystem::Wait() runs other jobs until it does.
+// NOTE: Always LoongJobSystem::Wait() for a counter before destroying it, the last job may still be touching it
+class LoongJobCounter {
+public:
+    LoongJobCounter() = default;
+    LoongJobCounter(const LoongJobCounter&) = delete;
+    LoongJobCounter(LoongJobCounter&&) = delete;
+    ~LoongJobCounter() = default;
+    LoongJobCounter& operator=(const LoongJobCounter&) = delete;
+    LoongJobCounter& operator=(LoongJobCounter&&) = delete;
+
+    bool IsDone() const { return count_.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class LoongJobSystem;
+
+    std::atomic<uint32_t> count_ { 0 };
+    std::mutex mutex_ {};
+    std::vector<LoongJob> dependents_ {}; // started when the count reaches zero
+};
+
+// A fixed set of worker threads, each one has a deque of jobs. A worker pushes and pops the jobs it schedules at the
+// back of its own deque, and steals from the front of the others' when it runs dry. The jobs scheduled by other
+// threads are spread over the workers.
+// The main thread jobs are for the work that must happen on the GL context thread, they are run by
+// RunMainThreadJobs(), or by Wait() on the main thread.
+// Without workers (not initialized, or a single core machine) the jobs run right away on the scheduling thread.
+class LoongJobSystem {
+public:
+    // 0 workers means one less than the hardware threads, the main thread is the other one. Call it on the main thread.
+    static void Initialize(uint32_t workerCount = 0);
+
+    // Finish the queued jobs and join the workers
+    static void Uninitialize();
+
+    static uint32_t GetWorkerCount();
+
+    static bool IsMainThread();
+
+    // The counter is incremented now and decremented when the job is done. The job doesn't start until the
+    // dependency reaches zero.
+    static void Schedule(std::function<void()> func, LoongJobCounter* counter = nullptr, LoongJobCounter* dependency = nullptr);
+
+    static void ScheduleOnMainThread(std::function<void()> func, LoongJobCounter* counter = nullptr, LoongJobCounter* dependency = nullptr);
+
+    // Call it once per frame on the main thread
+    static void RunMainThreadJobs();
+
+    // Run the queued jobs until the counter reaches zero, instead of blocking
+    static void Wait(LoongJobCounter& counter);
+
+    // Call func(first, last) for the sub ranges of [begin, end) with at most grainSize elements, in parallel, returns
+    // when all of them are done. The calling thread takes the first sub range.
+    template <class Func>
+    static void ParallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, Func&& func)
+    {
+        if (begin >= end) {
+            return;
+        }
+        grainSize = std::max(grainSize, 1U);
+        if (end - begin <= grainSize || GetWorkerCount() == 0) {
+            func(begin, end);
+            return;
+        }
+        LoongJobCounter counter;
+        for (uint32_t first = begin + grainSize; first < end;) {
+            uint32_t last = first + std::min(grainSize, end - first);
+            Schedule([&func, first, last]() { func(first, last); }, &counter);
+            first = last;
+        }
+        func(begin, begin + grainSize);
+        Wait(counter);
+    }
+
+private:
+    static void Schedule(LoongJob&& job, LoongJobCounter* dependency);
+
+    static void Submit(LoongJob&& job);
+
+    static void Execute(LoongJob& job);
+};
+
+}
@@ -0,0 +1,28 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Loong::Foundation {
+
+// The LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), without the frame format. The
+// compressor is a greedy one, fast but not the best ratio, the decompressor checks all the offsets and lengths.
+class LoongLz4 {
+public:
+    LoongLz4() = delete;
+
+    // The worst case of the compressed size
+    static size_t GetMaxCompressedSize(size_t size) { return size + size / 255 + 16; }
+
+    static void Compress(const void* data, size_t size, std::vector<uint8_t>& output);
+
+    // False if the data is corrupted or doesn't decompress to exactly outputSize bytes
+    static bool Decompress(const void* data, size_t size, void* output, size_t outputSize);
+};
+
+}
@@ -234,6 +234,18 @@ inline float Distance(const T& a, const T& b)
     return glm::distance(a, b);
 }
 
+template <class T>
+inline float Length(const T& v)
+{
+    return glm::length(v);
+}
+
+template <class T>
+inline T Abs(const T& v)
+{
+    return glm::abs(v);
+}
+
 inline bool Decompose(const Matrix4& mat, Vector3& scale, Quat& rotation, Vector3& translation)
 {
     Vector3 skew;
@@ -285,6 +297,29 @@ public:
     Vector3 max {};
 
     AABB Transformed(const Math::Matrix4& transform) const;
+
+    AABB Merged(const AABB& another) const { return AABB { Min(min, another.min), Max(max, another.max) }; }
+
+    AABB Expanded(float margin) const { return AABB { min - Vector3(margin), max + Vector3(margin) }; }
+
+    bool Contains(const AABB& another) const
+    {
+        return min.x <= another.min.x && min.y <= another.min.y && min.z <= another.min.z
+            && another.max.x <= max.x && another.max.y <= max.y && another.max.z <= max.z;
+    }
+
+    bool Overlaps(const AABB& another) const
+    {
+        return min.x <= another.max.x && min.y <= another.max.y && min.z <= another.max.z
+            && another.min.x <= max.x && another.min.y <= max.y && another.min.z <= max.z;
+    }
+
+    // Used as the insertion cost of bounding volume hierarchies
+    float GetSurfaceArea() const
+    {
+        Vector3 d = max - min;
+        return 2.0F * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
 };
 
 } // namespace Loong::Math
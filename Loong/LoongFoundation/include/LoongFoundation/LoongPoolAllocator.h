@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Loong::Foundation {
+
+// Fixed size blocks carved from large chunks, the free blocks are linked through their own memory. Allocating and
+// freeing are a pop and a push of the free list. The chunks are only given back when the allocator is destroyed.
+// NOTE: Not thread safe
+class LoongPoolAllocator {
+public:
+    explicit LoongPoolAllocator(size_t blockSize, size_t blocksPerChunk = 256);
+    LoongPoolAllocator(const LoongPoolAllocator&) = delete;
+    LoongPoolAllocator(LoongPoolAllocator&&) = delete;
+    ~LoongPoolAllocator() = default;
+    LoongPoolAllocator& operator=(const LoongPoolAllocator&) = delete;
+    LoongPoolAllocator& operator=(LoongPoolAllocator&&) = delete;
+
+    // Aligned to alignof(std::max_align_t)
+    void* Allocate();
+
+    void Free(void* block);
+
+    size_t GetBlockSize() const { return blockSize_; }
+
+    size_t GetAllocatedCount() const { return allocatedCount_; }
+
+    size_t GetChunkCount() const { return chunks_.size(); }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    void AllocateChunk();
+
+    size_t blockSize_ { 0 };
+    size_t blocksPerChunk_ { 0 };
+    std::vector<std::unique_ptr<std::max_align_t[]>> chunks_ {};
+    FreeBlock* freeList_ { nullptr };
+    size_t allocatedCount_ { 0 };
+};
+
+}
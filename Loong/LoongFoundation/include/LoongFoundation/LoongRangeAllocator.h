@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+namespace Loong::Foundation {
+
+// Allocates ranges of [0, capacity) with first fit, a freed range is merged with its free neighbors. It only does the
+// bookkeeping, the storage is owned by the user, e.g. a GPU buffer.
+class LoongRangeAllocator {
+public:
+    static constexpr uint32_t kInvalidOffset = ~uint32_t(0);
+
+    explicit LoongRangeAllocator(uint32_t capacity = 0);
+
+    // Returns kInvalidOffset if there is no free range large enough. A zero sized allocation is always at 0.
+    uint32_t Allocate(uint32_t size);
+
+    void Free(uint32_t offset, uint32_t size);
+
+    // Extend the capacity, the new space is free
+    void Grow(uint32_t capacity);
+
+    // Free everything
+    void Reset(uint32_t capacity);
+
+    uint32_t GetCapacity() const { return capacity_; }
+
+    uint32_t GetFreeSize() const { return freeSize_; }
+
+    uint32_t GetUsedSize() const { return capacity_ - freeSize_; }
+
+    uint32_t GetLargestFreeRange() const;
+
+    uint32_t GetFreeRangeCount() const { return uint32_t(freeRanges_.size()); }
+
+private:
+    void AddFreeRange(uint32_t offset, uint32_t size);
+
+    // offset -> size
+    std::map<uint32_t, uint32_t> freeRanges_ {};
+    uint32_t capacity_ { 0 };
+    uint32_t freeSize_ { 0 };
+};
+
+}
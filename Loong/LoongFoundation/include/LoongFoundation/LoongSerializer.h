@@ -1,25 +1,281 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
 #pragma once
 
+#include "LoongFoundation/LoongLogger.h"
 #include "LoongFoundation/LoongMath.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-// TODO: This is absolutely not a portable serializer, we should rewrite it in the future
+// The archives are little endian on all the platforms. Strings and arrays of bitwise types (see LoongArchiveBitwise)
+// are read and written with a single call of the stream. Objects may be put in sections, which carry the tag and the
+// version of the layout of their types (see LoongArchiveSchema) and their sizes, so the readers skip what they don't
+// know.
 namespace Loong::Foundation {
 
-// Derive the following class and implement `bool operator()(void* d, size_t l)` function
+// Derive the following class and implement `bool operator()(void* d, size_t l)` function. Input streams may also
+// implement `bool Skip(size_t l)`, which is faster than reading the skipped data, and `size_t GetRemaining() const`,
+// which rejects corrupted sizes before allocating memory for them.
 class LoongArchiveOutputStream {
 };
 class LoongArchiveInputStream {
 };
 
-template <class T, class Stream, bool isPod = std::is_pod_v<T>>
+// Types archived as their bytes. They must be trivially copyable and have no padding. On big endian platforms the bytes
+// of each Scalar are swapped if they are made only of Scalar members, the others must have a
+// `static void SwapBytes(T& t)` instead of Scalar.
+template <class T, class Enable = void>
+struct LoongArchiveBitwise {
+    static constexpr bool kValue = false;
+};
+
+template <class T>
+struct LoongArchiveBitwise<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>> {
+    static constexpr bool kValue = true;
+    using Scalar = T;
+};
+
+template <>
+struct LoongArchiveBitwise<Math::Vector2> {
+    static constexpr bool kValue = true;
+    using Scalar = float;
+};
+
+template <>
+struct LoongArchiveBitwise<Math::Vector3> {
+    static constexpr bool kValue = true;
+    using Scalar = float;
+};
+
+template <>
+struct LoongArchiveBitwise<Math::Vector4> {
+    static constexpr bool kValue = true;
+    using Scalar = float;
+};
+
+template <>
+struct LoongArchiveBitwise<Math::Quat> {
+    static constexpr bool kValue = true;
+    using Scalar = float;
+};
+
+template <>
+struct LoongArchiveBitwise<Math::AABB> {
+    static constexpr bool kValue = true;
+    using Scalar = float;
+};
+
+template <class T>
+void ByteSwap(T& value)
+{
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+    auto* bytes = reinterpret_cast<uint8_t*>(&value);
+    std::reverse(bytes, bytes + sizeof(T));
+}
+
+// The tag and the version of the layout of a type put in sections. The new versions of a type may only append data,
+// the readers skip the rest of the sections of the newer versions. Use another tag for an incompatible layout.
+template <class T>
+struct LoongArchiveSchema {
+    static constexpr uint32_t kTag = T::kArchiveTag;
+    static constexpr uint32_t kVersion = T::kArchiveVersion;
+};
+
+// The header of the archives made by SerializeArchive
+constexpr uint32_t kArchiveMagic = 0x5241474C; // "LGAR"
+constexpr uint32_t kArchiveFormatVersion = 1;
+
+template <class T, class Stream, bool isBitwise = LoongArchiveBitwise<T>::kValue>
 struct LoongArchiver;
 
+class LoongMemoryInputStream : public LoongArchiveInputStream {
+public:
+    LoongMemoryInputStream(const void* data, size_t size)
+        : data_(static_cast<const uint8_t*>(data))
+        , size_(size)
+    {
+    }
+    bool operator()(void* d, size_t l)
+    {
+        if (l > size_) {
+            return false;
+        }
+        if (l > 0) {
+            memcpy(d, data_, l);
+        }
+        data_ += l;
+        size_ -= l;
+        return true;
+    }
+    bool Skip(size_t l)
+    {
+        if (l > size_) {
+            return false;
+        }
+        data_ += l;
+        size_ -= l;
+        return true;
+    }
+    size_t GetRemaining() const { return size_; }
+
+private:
+    const uint8_t* data_ { nullptr };
+    size_t size_ { 0 };
+};
+
+class LoongMemoryOutputStream : public LoongArchiveOutputStream {
+public:
+    bool operator()(void* d, size_t l)
+    {
+        auto* bytes = static_cast<const uint8_t*>(d);
+        data_.insert(data_.end(), bytes, bytes + l);
+        return true;
+    }
+
+    const std::vector<uint8_t>& GetData() const { return data_; }
+
+    std::vector<uint8_t>& GetData() { return data_; }
+
+private:
+    std::vector<uint8_t> data_ {};
+};
+
 namespace Internal {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    constexpr bool kIsBigEndian = true;
+#else
+    // MSVC only targets little endian platforms
+    constexpr bool kIsBigEndian = false;
+#endif
+
+    template <class Stream>
+    constexpr bool kIsInputStream = std::is_base_of_v<LoongArchiveInputStream, Stream>;
+
+    template <class Stream>
+    constexpr bool kIsOutputStream = std::is_base_of_v<LoongArchiveOutputStream, Stream>;
+
+    template <class Stream, class = void>
+    struct HasSkip : std::false_type {
+    };
+
+    template <class Stream>
+    struct HasSkip<Stream, std::void_t<decltype(std::declval<Stream&>().Skip(size_t()))>> : std::true_type {
+    };
+
+    template <class Stream, class = void>
+    struct HasRemaining : std::false_type {
+    };
+
+    template <class Stream>
+    struct HasRemaining<Stream, std::void_t<decltype(std::declval<const Stream&>().GetRemaining())>> : std::true_type {
+    };
+
+    // False if the stream knows it has less data
+    template <class Stream>
+    bool CanRead(const Stream& stream, uint64_t size)
+    {
+        if constexpr (HasRemaining<Stream>::value) {
+            return size <= stream.GetRemaining();
+        } else {
+            return size <= std::numeric_limits<size_t>::max();
+        }
+    }
+
+    template <class Stream>
+    bool SkipBytes(Stream& stream, uint64_t size)
+    {
+        if (!CanRead(stream, size)) {
+            return false;
+        }
+        if constexpr (HasSkip<Stream>::value) {
+            return stream.Skip(size_t(size));
+        } else {
+            uint8_t buffer[4096];
+            while (size > 0) {
+                auto length = size_t(std::min<uint64_t>(size, sizeof(buffer)));
+                if (!stream(buffer, length)) {
+                    return false;
+                }
+                size -= length;
+            }
+            return true;
+        }
+    }
+
+    template <class Bitwise, class = void>
+    struct HasScalar : std::false_type {
+    };
+
+    template <class Bitwise>
+    struct HasScalar<Bitwise, std::void_t<typename Bitwise::Scalar>> : std::true_type {
+    };
+
+    template <class T>
+    void SwapBytes(T* data, size_t count)
+    {
+        using Bitwise = LoongArchiveBitwise<T>;
+        if constexpr (HasScalar<Bitwise>::value) {
+            constexpr size_t kScalarSize = sizeof(typename Bitwise::Scalar);
+            static_assert(sizeof(T) % kScalarSize == 0);
+            auto* bytes = reinterpret_cast<uint8_t*>(data);
+            for (size_t i = 0; i < count * sizeof(T); i += kScalarSize) {
+                std::reverse(bytes + i, bytes + i + kScalarSize);
+            }
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                Bitwise::SwapBytes(data[i]);
+            }
+        }
+    }
+
+    // Read or write count bitwise Ts with a single call of the stream
+    template <class T, class Stream>
+    bool ArchiveBytes(T* data, size_t count, Stream& stream)
+    {
+        static_assert(LoongArchiveBitwise<T>::kValue && std::is_trivially_copyable_v<T>);
+        if (count == 0) {
+            return true;
+        }
+        if constexpr (kIsBigEndian) {
+            if constexpr (kIsOutputStream<Stream>) {
+                // Swapped back after writing, the data is only borrowed
+                SwapBytes(data, count);
+                bool isOk = stream(data, count * sizeof(T));
+                SwapBytes(data, count);
+                return isOk;
+            } else {
+                if (!stream(data, count * sizeof(T))) {
+                    return false;
+                }
+                SwapBytes(data, count);
+                return true;
+            }
+        } else {
+            return stream(data, count * sizeof(T));
+        }
+    }
+
+    template <class T, class Stream>
+    bool ArchiveSection(T& t, Stream& stream);
+
     template <class Stream>
     struct ArchiveHelper {
     public:
-        explicit ArchiveHelper(Stream& s)
+        static constexpr bool kIsInputArchive = kIsInputStream<Stream>;
+
+        explicit ArchiveHelper(Stream& s, uint32_t version = 0)
             : stream_(s)
+            , version_(version)
         {
         }
         template <class T>
@@ -33,8 +289,53 @@ namespace Internal {
             return operator()(arg) && operator()(args...);
         }
 
+        // The schema version of the section of the object being archived, 0 if it is not in a section. When reading
+        // it may be older than LoongArchiveSchema::kVersion, the data appended by the later versions is missing then.
+        uint32_t GetVersion() const { return version_; }
+
+        // Put t in a section. The reader skips the sections of the other types before the one of t, and the rest of
+        // the section that t doesn't read
+        template <class T>
+        bool Section(T& t)
+        {
+            return ArchiveSection(t, stream_);
+        }
+
     private:
         Stream& stream_;
+        uint32_t version_ { 0 };
+    };
+
+    // Limits the reads to the size of a section
+    template <class Stream>
+    class SectionInputStream : public LoongArchiveInputStream {
+    public:
+        SectionInputStream(Stream& stream, uint64_t size)
+            : stream_(stream)
+            , remaining_(size)
+        {
+        }
+        bool operator()(void* d, size_t l)
+        {
+            if (l > remaining_) {
+                return false;
+            }
+            remaining_ -= l;
+            return stream_(d, l);
+        }
+        bool Skip(size_t l)
+        {
+            if (l > remaining_) {
+                return false;
+            }
+            remaining_ -= l;
+            return SkipBytes(stream_, l);
+        }
+        size_t GetRemaining() const { return size_t(remaining_); }
+
+    private:
+        Stream& stream_;
+        uint64_t remaining_ { 0 };
     };
 }
 
@@ -42,11 +343,7 @@ template <class T, class Stream>
 struct LoongArchiver<T, Stream, true> {
     bool operator()(T& t, Stream& stream)
     {
-        if constexpr (std::is_pointer_v<T>) {
-            return LoongArchiver<typename std::pointer_traits<T>::element_type, Stream>()(*t, stream);
-        } else {
-            return stream(&t, sizeof(T));
-        }
+        return Internal::ArchiveBytes(&t, 1, stream);
     }
 };
 
@@ -54,114 +351,147 @@ template <class T, class Stream>
 struct LoongArchiver<T, Stream, false> {
     bool operator()(T& t, Stream& stream)
     {
-        Internal::ArchiveHelper<Stream> helper(stream);
-        return t.Serialize(helper);
-    }
-};
-
-template <class Stream>
-struct LoongArchiver<Math::Vector2, Stream> {
-    bool operator()(Math::Vector2& t, Stream& stream)
-    {
-        return stream(&t, sizeof(t));
-    }
-};
-
-template <class Stream>
-struct LoongArchiver<Math::AABB, Stream> {
-    bool operator()(Math::AABB& t, Stream& stream)
-    {
-        return stream(&t, sizeof(t));
-    }
-};
-
-template <class Stream>
-struct LoongArchiver<Math::Vector3, Stream> {
-    bool operator()(Math::Vector3& t, Stream& stream)
-    {
-        return stream(&t, sizeof(t));
-    }
-};
-
-template <class Stream>
-struct LoongArchiver<Math::Vector4, Stream> {
-    bool operator()(Math::Vector4& t, Stream& stream)
-    {
-        return stream(&t, sizeof(t));
+        if constexpr (std::is_pointer_v<T>) {
+            return LoongArchiver<typename std::pointer_traits<T>::element_type, Stream>()(*t, stream);
+        } else {
+            Internal::ArchiveHelper<Stream> helper(stream);
+            return t.Serialize(helper);
+        }
     }
 };
 
 template <class Stream>
-struct LoongArchiver<std::string, Stream> {
+struct LoongArchiver<std::string, Stream, false> {
     bool operator()(std::string& t, Stream& stream)
     {
-        if constexpr (std::is_base_of_v<LoongArchiveOutputStream, Stream>) {
+        if constexpr (Internal::kIsOutputStream<Stream>) {
             if (t.length() > std::numeric_limits<uint32_t>::max()) {
-                // TODO: LOG
+                LOONG_ERROR("Archive string failed: {} characters are too many", t.length());
                 return false;
             }
             auto size = uint32_t(t.length());
-            return LoongArchiver<uint32_t, Stream>()(size, stream) && stream(t.data(), t.length());
-        } else if constexpr (std::is_base_of_v<LoongArchiveInputStream, Stream>) {
+            return LoongArchiver<uint32_t, Stream>()(size, stream) && Internal::ArchiveBytes(t.data(), t.length(), stream);
+        } else if constexpr (Internal::kIsInputStream<Stream>) {
             uint32_t size;
-            if (!LoongArchiver<uint32_t, Stream>()(size, stream)) {
+            if (!LoongArchiver<uint32_t, Stream>()(size, stream) || !Internal::CanRead(stream, size)) {
                 return false;
             }
             t.resize(size);
-            return stream(t.data(), t.length());
+            return Internal::ArchiveBytes(t.data(), t.length(), stream);
         } else {
-            static_assert(std::is_base_of_v<LoongArchiveOutputStream, Stream>);
+            static_assert(Internal::kIsOutputStream<Stream>);
         }
     }
 };
 
 template <class T, class Stream>
 struct LoongArchiver<std::vector<T>, Stream, false> {
+    static_assert(!std::is_same_v<T, bool>, "std::vector<bool> is not supported");
+
     bool operator()(std::vector<T>& array, Stream& stream)
     {
-        if constexpr (std::is_base_of_v<LoongArchiveOutputStream, Stream>) {
+        if constexpr (Internal::kIsOutputStream<Stream>) {
             if (array.size() > std::numeric_limits<uint32_t>::max()) {
-                // TODO: LOG
+                LOONG_ERROR("Archive array failed: {} elements are too many", array.size());
                 return false;
             }
             auto size = uint32_t(array.size());
             if (!LoongArchiver<uint32_t, Stream>()(size, stream)) {
                 return false;
             }
-            for (auto& t : array) {
-                if (!LoongArchiver<T, Stream>()(t, stream)) {
-                    return false;
+            if constexpr (LoongArchiveBitwise<T>::kValue) {
+                return Internal::ArchiveBytes(array.data(), array.size(), stream);
+            } else {
+                for (auto& t : array) {
+                    if (!LoongArchiver<T, Stream>()(t, stream)) {
+                        return false;
+                    }
                 }
+                return true;
             }
-            return true;
-        } else if constexpr (std::is_base_of_v<LoongArchiveInputStream, Stream>) {
+        } else if constexpr (Internal::kIsInputStream<Stream>) {
             uint32_t size;
             if (!LoongArchiver<uint32_t, Stream>()(size, stream)) {
                 return false;
             }
-            if constexpr (std::is_pointer_v<T>) {
-                for (auto t : array) {
-                    delete t;
+            if constexpr (LoongArchiveBitwise<T>::kValue) {
+                if (!Internal::CanRead(stream, uint64_t(size) * sizeof(T))) {
+                    return false;
+                }
+                array.resize(size);
+                return Internal::ArchiveBytes(array.data(), array.size(), stream);
+            } else {
+                // Each element takes one byte at least
+                if (!Internal::CanRead(stream, size)) {
+                    return false;
+                }
+                if constexpr (std::is_pointer_v<T>) {
+                    for (auto t : array) {
+                        delete t;
+                    }
+                    array.clear();
+                }
+                array.resize(size);
+                if constexpr (std::is_pointer_v<T>) {
+                    // The owners of the arrays delete the elements one by one
+                    for (auto& t : array) {
+                        t = new typename std::pointer_traits<T>::element_type;
+                    }
                 }
-                array.clear();
-            }
-            array.resize(size);
-            if constexpr (std::is_pointer_v<T>) {
                 for (auto& t : array) {
-                    t = new typename std::pointer_traits<T>::element_type;
+                    if (!LoongArchiver<T, Stream>()(t, stream)) {
+                        return false;
+                    }
                 }
+                return true;
             }
-            for (auto& t : array) {
-                if (!LoongArchiver<T, Stream>()(t, stream)) {
+        } else {
+            static_assert(Internal::kIsOutputStream<Stream>);
+        }
+    }
+};
+
+namespace Internal {
+    template <class T, class Stream>
+    bool ArchiveSection(T& t, Stream& stream)
+    {
+        static_assert(!LoongArchiveBitwise<T>::kValue, "Only the types with Serialize are put in sections");
+        using Schema = LoongArchiveSchema<T>;
+        if constexpr (kIsOutputStream<Stream>) {
+            // The size comes first, so the section is made in memory
+            LoongMemoryOutputStream payload;
+            ArchiveHelper<LoongMemoryOutputStream> helper(payload, Schema::kVersion);
+            if (!t.Serialize(helper)) {
+                return false;
+            }
+            uint32_t tag = Schema::kTag;
+            uint32_t version = Schema::kVersion;
+            auto& data = payload.GetData();
+            uint64_t size = data.size();
+            return LoongArchiver<uint32_t, Stream>()(tag, stream) && LoongArchiver<uint32_t, Stream>()(version, stream)
+                && LoongArchiver<uint64_t, Stream>()(size, stream) && (data.empty() || stream(data.data(), data.size()));
+        } else {
+            while (true) {
+                uint32_t tag;
+                uint32_t version;
+                uint64_t size;
+                if (!LoongArchiver<uint32_t, Stream>()(tag, stream) || !LoongArchiver<uint32_t, Stream>()(version, stream)
+                    || !LoongArchiver<uint64_t, Stream>()(size, stream) || !CanRead(stream, size)) {
                     return false;
                 }
+                if (tag != Schema::kTag) {
+                    if (!SkipBytes(stream, size)) {
+                        return false;
+                    }
+                    continue;
+                }
+                SectionInputStream<Stream> section(stream, size);
+                ArchiveHelper<SectionInputStream<Stream>> helper(section, version);
+                return t.Serialize(helper) && SkipBytes(section, section.GetRemaining());
             }
-            return true;
-        } else {
-            static_assert(std::is_base_of_v<LoongArchiveOutputStream, Stream>);
         }
     }
-};
+}
 
 template <class T, class Stream>
 bool Serialize(T& t, Stream& s)
@@ -169,4 +499,21 @@ bool Serialize(T& t, Stream& s)
     return LoongArchiver<T, Stream>()(t, s);
 }
 
-}
\ No newline at end of file
+// The archive header, i.e. the magic and the format version, then t in a section
+template <class T, class Stream>
+bool SerializeArchive(T& t, Stream& s)
+{
+    uint32_t magic = kArchiveMagic;
+    uint32_t formatVersion = kArchiveFormatVersion;
+    if (!Serialize(magic, s) || !Serialize(formatVersion, s)) {
+        return false;
+    }
+    if (magic != kArchiveMagic || formatVersion > kArchiveFormatVersion) {
+        LOONG_ERROR("Archive 0x{:0X} of format version {} is not supported", magic, formatVersion);
+        return false;
+    }
+    Internal::ArchiveHelper<Stream> helper(s);
+    return helper.Section(t);
+}
+
+}
@@ -5,216 +5,125 @@
 #pragma once
 
 #include "LoongFoundation/LoongMath.h"
-#include "LoongFoundation/LoongSigslotHelper.h"
+#include "LoongFoundation/LoongTransformHierarchy.h"
 
 namespace Loong::Foundation {
 
-class Transform : public LoongHasSlots {
+// A node of LoongTransformHierarchy::GetDefault(), the data lives there
+class Transform {
 public:
     explicit Transform(Math::Vector3 pos = Math::Zero, Math::Quat rot = Math::Identity, Math::Vector3 scl = Math::One)
-        : position_(pos)
-        , rotation_(rot)
-        , scale_(scl)
-        , parent_(nullptr)
+        : id_(Hierarchy().Create(this, pos, rot, scl))
     {
     }
 
+    Transform(const Transform&) = delete;
+    Transform(Transform&&) = delete;
+
+    ~Transform();
+
+    Transform& operator=(const Transform&) = delete;
+    Transform& operator=(Transform&&) = delete;
+
     void SetPosition(const Math::Vector3& pos)
     {
-        position_ = pos;
+        Hierarchy().Position(id_) = pos;
         OnTransformChange();
     }
 
-    void SetWorldPosition(const Math::Vector3& pos)
-    {
-        if (parent_ == nullptr) {
-            position_ = pos;
-        } else {
-            // T_world = T_parent * T_local ====> T_local = T_parent^-1 * T_world
-            position_ = Math::Inverse(parent_->GetWorldTransformMatrix()) * Math::Vector4 { pos, 1.0F };
-        }
-        OnTransformChange();
-    }
+    void SetWorldPosition(const Math::Vector3& pos);
 
     void SetRotation(const Math::Quat& rot)
     {
-        rotation_ = rot;
+        Hierarchy().Rotation(id_) = rot;
         OnTransformChange();
     }
 
-    void SetWorldRotation(const Math::Quat& rot)
-    {
-        if (parent_ == nullptr) {
-            rotation_ = rot;
-        } else {
-            rotation_ = Math::Inverse(parent_->GetWorldRotation()) * rot;
-        }
-        OnTransformChange();
-    }
+    void SetWorldRotation(const Math::Quat& rot);
 
     void SetScale(const Math::Vector3& scl)
     {
-        scale_ = scl;
+        Hierarchy().Scale(id_) = scl;
         OnTransformChange();
     }
 
     void Translate(const Math::Vector3& trans)
     {
-        position_ += trans;
+        Hierarchy().Position(id_) += trans;
         OnTransformChange();
     }
 
     void Rotate(const Math::Quat& rot)
     {
-        rotation_ = Math::Normalize(rotation_ * rot);
+        auto& rotation = Hierarchy().Rotation(id_);
+        rotation = Math::Normalize(rotation * rot);
         OnTransformChange();
     }
 
     void Rotate(const Math::Vector3& axis, float radian)
     {
-        rotation_ = Math::Rotate(rotation_, axis, radian);
+        auto& rotation = Hierarchy().Rotation(id_);
+        rotation = Math::Rotate(rotation, axis, radian);
         OnTransformChange();
     }
 
     void Scale(const Math::Vector3& scl)
     {
-        scale_ *= scl;
+        Hierarchy().Scale(id_) *= scl;
         OnTransformChange();
     }
 
     void LookAt(const Math::Vector3& target, const Math::Vector3& up)
     {
-        rotation_ = Math::Conjugate(Math::MatrixToQuat(Math::LookAt(position_, target, up)));
+        Hierarchy().Rotation(id_) = Math::Conjugate(Math::MatrixToQuat(Math::LookAt(GetPosition(), target, up)));
         OnTransformChange();
     }
 
-    const Math::Vector3& GetPosition() const { return position_; }
-    const Math::Vector3& GetWorldPosition() const
-    {
-        UpdateWorldCache();
-        return worldPosition_;
-    }
+    const Math::Vector3& GetPosition() const { return Hierarchy().Position(id_); }
+    const Math::Vector3& GetWorldPosition() const { return Hierarchy().GetWorldPosition(id_); }
 
-    const Math::Quat& GetRotation() const { return rotation_; }
-    const Math::Quat& GetWorldRotation()
-    {
-        UpdateWorldCache();
-        return worldRotation_;
-    }
+    const Math::Quat& GetRotation() const { return Hierarchy().Rotation(id_); }
+    const Math::Quat& GetWorldRotation() const { return Hierarchy().GetWorldRotation(id_); }
 
-    const Math::Vector3& GetScale() const { return scale_; }
-    const Math::Vector3& GetWorldScale() const
-    {
-        UpdateWorldCache();
-        return worldScale_;
-    }
+    const Math::Vector3& GetScale() const { return Hierarchy().Scale(id_); }
+    const Math::Vector3& GetWorldScale() const { return Hierarchy().GetWorldScale(id_); }
 
-    Math::Vector3 GetForward() const { return rotation_ * Math::kForward; }
-    Math::Vector3 GetWorldForward() const
-    {
-        UpdateWorldCache();
-        return worldRotation_ * Math::kForward;
-    }
+    Math::Vector3 GetForward() const { return GetRotation() * Math::kForward; }
+    Math::Vector3 GetWorldForward() const { return GetWorldRotation() * Math::kForward; }
 
-    Math::Vector3 GetUp() const { return rotation_ * Math::kUp; }
-    Math::Vector3 GetWorldUp() const
-    {
-        UpdateWorldCache();
-        return worldRotation_ * Math::kUp;
-    }
+    Math::Vector3 GetUp() const { return GetRotation() * Math::kUp; }
+    Math::Vector3 GetWorldUp() const { return GetWorldRotation() * Math::kUp; }
 
-    Math::Vector3 GetRight() const { return rotation_ * Math::kRight; }
-    Math::Vector3 GetWorldRight() const
-    {
-        UpdateWorldCache();
-        return worldRotation_ * Math::kRight;
-    }
+    Math::Vector3 GetRight() const { return GetRotation() * Math::kRight; }
+    Math::Vector3 GetWorldRight() const { return GetWorldRotation() * Math::kRight; }
 
-    const Math::Matrix4& GetTransformMatrix() const
-    {
-        UpdateLocalCache();
-        return localMatrix_;
-    }
+    const Math::Matrix4& GetTransformMatrix() const { return Hierarchy().GetLocalMatrix(id_); }
 
-    const Math::Matrix4& GetWorldTransformMatrix() const
-    {
-        UpdateWorldCache();
-        return worldMatrix_;
-    }
+    const Math::Matrix4& GetWorldTransformMatrix() const { return Hierarchy().GetWorldMatrix(id_); }
 
-    Transform* GetParent() const { return parent_; }
+    // Increases whenever the world transform changes, e.g. by a change of an ancestor
+    uint64_t GetWorldVersion() const { return Hierarchy().GetWorldVersion(id_); }
 
-    void SetParent(Transform* parent)
-    {
-        if (parent == parent_) {
-            return;
-        }
-        UpdateWorldCache(); // ensure the worldMatrix_ is valid
-        if (parent_ != nullptr) {
-            parent_->UnsubscribeTransformChange(this);
-        }
-        parent_ = parent;
-        {
-            // Calculate new local matrix
-            Math::Matrix4 newLocalMatrix = parent_ ? Math::Inverse(parent_->GetWorldTransformMatrix()) * worldMatrix_
-                                                   : worldMatrix_;
-            Math::Decompose(newLocalMatrix, scale_, rotation_, position_);
-            // although our world transform should not be changed, and our local transform has been recomputed,
-            // but if the parent has a different scale, the result may change, thus, we need to notify the change
-            OnTransformChange();
-        }
-        if (parent_ != nullptr) {
-            parent_->SubscribeTransformChange(this, &Transform::OnTransformChange);
-        }
-    }
+    // See LoongTransformHierarchy::CreateWatcher
+    void SetWatcher(uint32_t watcher) { Hierarchy().SetWatcher(id_, watcher); }
 
-    LOONG_DECLARE_SIGNAL(TransformChange);
+    uint32_t GetWatcher() const { return Hierarchy().GetWatcher(id_); }
 
-private:
-    void OnTransformChange()
-    {
-        isWorldDirty_ = true;
-        isLocalDirty_ = true;
-        TransformChangeSignal_.emit();
-    }
+    // The id in LoongTransformHierarchy::GetDefault(), it stays valid as long as the transform lives
+    uint32_t GetID() const { return id_; }
 
-    void UpdateLocalCache() const
-    {
-        if (isLocalDirty_) {
-            isLocalDirty_ = false;
-            localMatrix_ = Math::Translate(position_) * Math::QuatToMatrix4(rotation_) * Math::Scale(scale_);
-        }
-    }
+    Transform* GetParent() const;
 
-    void UpdateWorldCache() const
-    {
-        if (isWorldDirty_) {
-            isWorldDirty_ = false;
-            if (parent_ != nullptr) {
-                worldMatrix_ = parent_->GetWorldTransformMatrix() * GetTransformMatrix();
-                Math::Decompose(worldMatrix_, worldScale_, worldRotation_, worldPosition_);
-            } else {
-                worldPosition_ = position_;
-                worldScale_ = scale_;
-                worldRotation_ = rotation_;
-                worldMatrix_ = GetTransformMatrix();
-            }
-        }
-    }
+    // Keeps the world transform
+    void SetParent(Transform* parent);
+
+private:
+    static LoongTransformHierarchy& Hierarchy() { return LoongTransformHierarchy::GetDefault(); }
+
+    void OnTransformChange() { Hierarchy().MarkChanged(id_); }
 
 private:
-    Math::Vector3 position_ { Math::Zero };
-    Math::Quat rotation_ { Math::Identity };
-    Math::Vector3 scale_ { Math::One };
-    Transform* parent_ { nullptr };
-
-    mutable bool isLocalDirty_ { true };
-    mutable bool isWorldDirty_ { true };
-    mutable Math::Matrix4 localMatrix_ {};
-    mutable Math::Matrix4 worldMatrix_ {};
-    mutable Math::Vector3 worldPosition_ {};
-    mutable Math::Quat worldRotation_ {};
-    mutable Math::Vector3 worldScale_ {};
+    const uint32_t id_ { LoongTransformHierarchy::kNone };
 };
 
 }
@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongFoundation/LoongMath.h"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Loong::Foundation {
+
+class Transform;
+
+// Structure of arrays storage of the transforms, see Transform for the object interface.
+// A change of a local transform only stamps it with a new version, nothing is propagated. A world matrix is stale when
+// its own local version or its parent's world version is newer, it's brought up to date either lazily by the getters,
+// which walk up the ancestors, or for all the transforms at once by Update(), which walks them level by level in
+// parent before child order.
+// The world rotation and scale are decomposed from the world matrix only when they are asked for.
+// A transform can be watched, then it's reported to its watcher when its world matrix is recomputed, so the users
+// don't have to poll the world versions of all their transforms.
+// The data is indexed by the ids, which stay the same for the lifetime of a transform, the level order is a separate list
+// of ids used by Update(). Moving the data itself into the level order would change the ids on every reparenting.
+// NOTE: The references returned are valid until the next Create(), keep the ids instead of them, e.g. in render queues
+class LoongTransformHierarchy {
+public:
+    static constexpr uint32_t kNone = ~uint32_t(0);
+
+    // All the Transforms live in this one
+    static LoongTransformHierarchy& GetDefault();
+
+    LoongTransformHierarchy() = default;
+    LoongTransformHierarchy(const LoongTransformHierarchy&) = delete;
+    LoongTransformHierarchy(LoongTransformHierarchy&&) = delete;
+    ~LoongTransformHierarchy() = default;
+    LoongTransformHierarchy& operator=(const LoongTransformHierarchy&) = delete;
+    LoongTransformHierarchy& operator=(LoongTransformHierarchy&&) = delete;
+
+    uint32_t Create(Transform* owner, const Math::Vector3& position, const Math::Quat& rotation, const Math::Vector3& scale);
+
+    // The children become roots, with their local transforms kept
+    void Destroy(uint32_t id);
+
+    void SetParent(uint32_t id, uint32_t parent);
+
+    uint32_t GetParent(uint32_t id) const { return parents_[id]; }
+
+    Transform* GetOwner(uint32_t id) const { return owners_[id]; }
+
+    // Call it after changing the local transform
+    void MarkChanged(uint32_t id) { localVersions_[id] = ++version_; }
+
+    Math::Vector3& Position(uint32_t id) { return positions_[id]; }
+    Math::Quat& Rotation(uint32_t id) { return rotations_[id]; }
+    Math::Vector3& Scale(uint32_t id) { return scales_[id]; }
+
+    const Math::Matrix4& GetLocalMatrix(uint32_t id);
+    const Math::Matrix4& GetWorldMatrix(uint32_t id);
+    const Math::Vector3& GetWorldPosition(uint32_t id);
+    const Math::Quat& GetWorldRotation(uint32_t id);
+    const Math::Vector3& GetWorldScale(uint32_t id);
+
+    // Increases whenever the world matrix changes
+    uint64_t GetWorldVersion(uint32_t id);
+
+    // Bring all the world matrices up to date, the levels with many transforms are split into jobs. After it the
+    // getters don't write anything until the next change, so they can be called from jobs.
+    void Update();
+
+    uint32_t GetCount() const { return count_; }
+
+    // Watchers are numbered from 1, 0 is no watcher. The transforms still watched by it are unwatched on destruction.
+    uint32_t CreateWatcher();
+
+    void DestroyWatcher(uint32_t watcher);
+
+    // A transform has at most one watcher, the changes not taken by the previous one are dropped
+    void SetWatcher(uint32_t id, uint32_t watcher);
+
+    uint32_t GetWatcher(uint32_t id) const { return watchers_[id]; }
+
+    // Replace the content of changed with the owners of the watched transforms whose world matrices were recomputed
+    // since the last call, each one once
+    void TakeChanged(uint32_t watcher, std::vector<Transform*>& changed);
+
+private:
+    void Validate(uint32_t id);
+
+    // The parent is up to date
+    void UpdateWorld(uint32_t id);
+
+    // Called from the jobs of Update()
+    void Report(uint32_t id);
+
+    void Unreport(uint32_t id);
+
+    void Link(uint32_t id, uint32_t parent);
+
+    void Unlink(uint32_t id);
+
+    void RebuildOrder();
+
+    // Hierarchy
+    std::vector<uint32_t> parents_ {};
+    std::vector<uint32_t> firstChildren_ {};
+    std::vector<uint32_t> nextSiblings_ {};
+    std::vector<uint32_t> prevSiblings_ {};
+    std::vector<uint8_t> isAlive_ {};
+    std::vector<Transform*> owners_ {};
+
+    // Local
+    std::vector<Math::Vector3> positions_ {};
+    std::vector<Math::Quat> rotations_ {};
+    std::vector<Math::Vector3> scales_ {};
+    std::vector<Math::Matrix4> localMatrices_ {};
+
+    // World
+    std::vector<Math::Matrix4> worldMatrices_ {};
+    std::vector<Math::Vector3> worldPositions_ {};
+    std::vector<Math::Quat> worldRotations_ {};
+    std::vector<Math::Vector3> worldScales_ {};
+
+    // Versions, all of them are values of version_
+    std::vector<uint64_t> localVersions_ {}; // when the local transform changed
+    std::vector<uint64_t> localMatrixVersions_ {}; // when the local matrix was computed
+    std::vector<uint64_t> worldVersions_ {}; // when the world matrix was computed
+    std::vector<uint64_t> checkedVersions_ {}; // when the world matrix was known to be up to date
+    std::vector<uint64_t> decomposedVersions_ {}; // the world version the world rotation and scale are of
+    uint64_t version_ { 1 };
+    uint64_t updatedVersion_ { 0 }; // of the last Update()
+
+    // The transforms in parent before child order, grouped by depth
+    std::vector<uint32_t> order_ {};
+    std::vector<uint32_t> levelOffsets_ {};
+    bool isOrderDirty_ { false };
+
+    std::vector<uint32_t> freeIds_ {};
+    uint32_t count_ { 0 };
+
+    // Watchers
+    std::vector<uint32_t> watchers_ {};
+    std::vector<uint8_t> isReported_ {}; // in the changed list of its watcher
+    std::vector<std::vector<uint32_t>> changedLists_ {}; // indexed by watcher
+    std::vector<uint8_t> isWatcherAlive_ {};
+    std::vector<uint32_t> freeWatchers_ {};
+    std::mutex changedMutex_ {};
+};
+
+}
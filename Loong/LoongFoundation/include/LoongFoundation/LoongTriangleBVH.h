@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongFoundation/LoongMath.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Loong::Foundation {
+
+// A static bounding volume hierarchy over the triangles of a mesh, built with the binned surface area heuristic.
+// Used for ray casts on the CPU, e.g. picking.
+class LoongTriangleBVH {
+public:
+    struct RaycastHit {
+        // In units of the ray direction length
+        float distance { 0.0F };
+        // The index of the triangle in the index buffer used to build, i.e. the first index is at triangleIndex * 3
+        uint32_t triangleIndex { 0 };
+        // The normalized geometric normal, in the same space with the positions
+        Math::Vector3 normal {};
+    };
+
+    static constexpr uint32_t kMaxLeafTriangles = 4;
+
+    LoongTriangleBVH() = default;
+    LoongTriangleBVH(const LoongTriangleBVH&) = delete;
+    LoongTriangleBVH(LoongTriangleBVH&&) = default;
+    ~LoongTriangleBVH() = default;
+    LoongTriangleBVH& operator=(const LoongTriangleBVH&) = delete;
+    LoongTriangleBVH& operator=(LoongTriangleBVH&&) = default;
+
+    // The positions are read as Math::Vector3 from the vertices every stride bytes
+    void Build(const void* vertices, size_t stride, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+    {
+        Build(vertices, stride, vertexCount, indices, sizeof(uint32_t), indexCount);
+    }
+
+    // The indices are uint16_t or uint32_t by indexSize, e.g. read in place from a model file
+    void Build(const void* vertices, size_t stride, size_t vertexCount, const void* indices, size_t indexSize, size_t indexCount);
+
+    void Clear();
+
+    // Find the nearest triangle hit by the ray within maxDistance, both sides of the triangles are hit
+    bool Raycast(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, RaycastHit& hit) const;
+
+    uint32_t GetTriangleCount() const { return uint32_t(triangleIndices_.size()); }
+
+    bool IsEmpty() const { return nodes_.empty(); }
+
+    size_t GetMemorySize() const
+    {
+        return nodes_.capacity() * sizeof(Node) + vertices_.capacity() * sizeof(Math::Vector3) + triangleIndices_.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    struct Node {
+        Math::AABB aabb {};
+        // The first triangle of a leaf, or the second child of an inner node. The first child always follows its parent.
+        uint32_t first { 0 };
+        // 0 for inner nodes
+        uint32_t count { 0 };
+    };
+
+    struct BuildItem {
+        Math::AABB aabb {};
+        Math::Vector3 centroid {};
+        uint32_t triangle { 0 };
+    };
+
+    uint32_t BuildRecursive(std::vector<BuildItem>& items, uint32_t begin, uint32_t end);
+
+    std::vector<Node> nodes_ {};
+    // 3 vertices per triangle, in the order of the leaves
+    std::vector<Math::Vector3> vertices_ {};
+    std::vector<uint32_t> triangleIndices_ {};
+};
+
+}
@@ -0,0 +1,288 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongAABBTree.h"
+#include <cassert>
+#include <functional>
+
+namespace Loong::Foundation {
+
+LoongAABBTree::LoongAABBTree(float margin)
+    : margin_(margin)
+{
+}
+
+int32_t LoongAABBTree::Insert(const Math::AABB& aabb, void* userData)
+{
+    int32_t proxy = AllocateNode();
+    auto& node = nodes_[proxy];
+    node.aabb = aabb.Expanded(margin_);
+    node.userData = userData;
+    node.height = 0;
+    InsertLeaf(proxy);
+    ++proxyCount_;
+    return proxy;
+}
+
+void LoongAABBTree::Remove(int32_t proxy)
+{
+    assert(0 <= proxy && proxy < int32_t(nodes_.size()));
+    assert(nodes_[proxy].IsLeaf());
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    --proxyCount_;
+}
+
+bool LoongAABBTree::Update(int32_t proxy, const Math::AABB& aabb)
+{
+    assert(0 <= proxy && proxy < int32_t(nodes_.size()));
+    assert(nodes_[proxy].IsLeaf());
+
+    auto& node = nodes_[proxy];
+    if (node.aabb.Contains(aabb)) {
+        // The fat box also has to be re-computed if the object shrinks a lot, otherwise it will be reported too often
+        if (aabb.Expanded(4.0F * margin_).Contains(node.aabb)) {
+            return false;
+        }
+    }
+
+    RemoveLeaf(proxy);
+    nodes_[proxy].aabb = aabb.Expanded(margin_);
+    InsertLeaf(proxy);
+    return true;
+}
+
+void LoongAABBTree::Clear()
+{
+    nodes_.clear();
+    root_ = kNullNode;
+    freeList_ = kNullNode;
+    proxyCount_ = 0;
+}
+
+bool LoongAABBTree::Validate() const
+{
+    if (root_ == kNullNode) {
+        return proxyCount_ == 0;
+    }
+    if (nodes_[root_].parent != kNullNode) {
+        return false;
+    }
+
+    int32_t leafCount = 0;
+    std::function<bool(int32_t)> validateNode = [this, &leafCount, &validateNode](int32_t nodeId) {
+        auto& node = nodes_[nodeId];
+        if (node.IsLeaf()) {
+            ++leafCount;
+            return node.child2 == kNullNode && node.height == 0;
+        }
+        auto& child1 = nodes_[node.child1];
+        auto& child2 = nodes_[node.child2];
+        if (child1.parent != nodeId || child2.parent != nodeId) {
+            return false;
+        }
+        if (node.height != 1 + std::max(child1.height, child2.height)) {
+            return false;
+        }
+        if (!node.aabb.Contains(child1.aabb) || !node.aabb.Contains(child2.aabb)) {
+            return false;
+        }
+        return validateNode(node.child1) && validateNode(node.child2);
+    };
+    return validateNode(root_) && leafCount == proxyCount_;
+}
+
+int32_t LoongAABBTree::AllocateNode()
+{
+    if (freeList_ == kNullNode) {
+        nodes_.emplace_back();
+        return int32_t(nodes_.size()) - 1;
+    }
+    int32_t nodeId = freeList_;
+    auto& node = nodes_[nodeId];
+    freeList_ = node.parent;
+    node = Node {};
+    return nodeId;
+}
+
+void LoongAABBTree::FreeNode(int32_t nodeId)
+{
+    auto& node = nodes_[nodeId];
+    node = Node {};
+    node.parent = freeList_;
+    freeList_ = nodeId;
+}
+
+void LoongAABBTree::InsertLeaf(int32_t leaf)
+{
+    if (root_ == kNullNode) {
+        root_ = leaf;
+        nodes_[root_].parent = kNullNode;
+        return;
+    }
+
+    // Find the best sibling with the surface area heuristic
+    const Math::AABB leafAABB = nodes_[leaf].aabb;
+    int32_t index = root_;
+    while (!nodes_[index].IsLeaf()) {
+        auto& node = nodes_[index];
+        float area = node.aabb.GetSurfaceArea();
+        float combinedArea = node.aabb.Merged(leafAABB).GetSurfaceArea();
+
+        // Cost of creating a new parent for this node and the new leaf
+        float cost = 2.0F * combinedArea;
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0F * (combinedArea - area);
+
+        auto descendCost = [this, &leafAABB, inheritanceCost](int32_t childId) {
+            auto& child = nodes_[childId];
+            float newArea = child.aabb.Merged(leafAABB).GetSurfaceArea();
+            return child.IsLeaf() ? newArea + inheritanceCost : newArea - child.aabb.GetSurfaceArea() + inheritanceCost;
+        };
+        float cost1 = descendCost(node.child1);
+        float cost2 = descendCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    int32_t sibling = index;
+    int32_t oldParent = nodes_[sibling].parent;
+    int32_t newParent = AllocateNode();
+    nodes_[newParent].parent = oldParent;
+    nodes_[newParent].aabb = leafAABB.Merged(nodes_[sibling].aabb);
+    nodes_[newParent].height = nodes_[sibling].height + 1;
+    nodes_[newParent].child1 = sibling;
+    nodes_[newParent].child2 = leaf;
+    nodes_[sibling].parent = newParent;
+    nodes_[leaf].parent = newParent;
+
+    if (oldParent != kNullNode) {
+        if (nodes_[oldParent].child1 == sibling) {
+            nodes_[oldParent].child1 = newParent;
+        } else {
+            nodes_[oldParent].child2 = newParent;
+        }
+    } else {
+        root_ = newParent;
+    }
+
+    // Walk back up the tree fixing heights and boxes
+    index = nodes_[leaf].parent;
+    while (index != kNullNode) {
+        index = Balance(index);
+        auto& node = nodes_[index];
+        node.height = 1 + std::max(nodes_[node.child1].height, nodes_[node.child2].height);
+        node.aabb = nodes_[node.child1].aabb.Merged(nodes_[node.child2].aabb);
+        index = node.parent;
+    }
+}
+
+void LoongAABBTree::RemoveLeaf(int32_t leaf)
+{
+    if (leaf == root_) {
+        root_ = kNullNode;
+        return;
+    }
+
+    int32_t parent = nodes_[leaf].parent;
+    int32_t grandParent = nodes_[parent].parent;
+    int32_t sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+
+    if (grandParent == kNullNode) {
+        root_ = sibling;
+        nodes_[sibling].parent = kNullNode;
+        FreeNode(parent);
+        return;
+    }
+
+    // Destroy the parent and connect the sibling to the grand parent
+    if (nodes_[grandParent].child1 == parent) {
+        nodes_[grandParent].child1 = sibling;
+    } else {
+        nodes_[grandParent].child2 = sibling;
+    }
+    nodes_[sibling].parent = grandParent;
+    FreeNode(parent);
+
+    int32_t index = grandParent;
+    while (index != kNullNode) {
+        index = Balance(index);
+        auto& node = nodes_[index];
+        node.height = 1 + std::max(nodes_[node.child1].height, nodes_[node.child2].height);
+        node.aabb = nodes_[node.child1].aabb.Merged(nodes_[node.child2].aabb);
+        index = node.parent;
+    }
+}
+
+// Perform a left or right rotation if node A is imbalanced, returns the new root of this sub-tree
+int32_t LoongAABBTree::Balance(int32_t iA)
+{
+    auto& A = nodes_[iA];
+    if (A.IsLeaf() || A.height < 2) {
+        return iA;
+    }
+
+    int32_t iB = A.child1;
+    int32_t iC = A.child2;
+    auto& B = nodes_[iB];
+    auto& C = nodes_[iC];
+
+    int32_t balance = C.height - B.height;
+
+    // Rotate the taller child up, the shorter grand child takes its place
+    auto rotate = [this, iA](int32_t iUp, int32_t iOther, bool upIsChild2) {
+        auto& A = nodes_[iA];
+        auto& up = nodes_[iUp];
+        int32_t iF = up.child1;
+        int32_t iG = up.child2;
+        auto& F = nodes_[iF];
+        auto& G = nodes_[iG];
+
+        // Swap A and the child going up
+        up.child1 = iA;
+        up.parent = A.parent;
+        A.parent = iUp;
+
+        if (up.parent != kNullNode) {
+            if (nodes_[up.parent].child1 == iA) {
+                nodes_[up.parent].child1 = iUp;
+            } else {
+                nodes_[up.parent].child2 = iUp;
+            }
+        } else {
+            root_ = iUp;
+        }
+
+        auto& other = nodes_[iOther];
+        int32_t iStay = F.height > G.height ? iF : iG;
+        int32_t iMove = F.height > G.height ? iG : iF;
+        up.child2 = iStay;
+        if (upIsChild2) {
+            A.child2 = iMove;
+        } else {
+            A.child1 = iMove;
+        }
+        nodes_[iMove].parent = iA;
+        A.aabb = other.aabb.Merged(nodes_[iMove].aabb);
+        up.aabb = A.aabb.Merged(nodes_[iStay].aabb);
+        A.height = 1 + std::max(other.height, nodes_[iMove].height);
+        up.height = 1 + std::max(A.height, nodes_[iStay].height);
+        return iUp;
+    };
+
+    if (balance > 1) {
+        // C is much taller than B
+        return C.IsLeaf() ? iA : rotate(iC, iB, true);
+    }
+    if (balance < -1) {
+        // B is much taller than C
+        return B.IsLeaf() ? iA : rotate(iB, iC, false);
+    }
+    return iA;
+}
+
+}
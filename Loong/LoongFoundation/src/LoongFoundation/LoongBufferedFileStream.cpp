@@ -0,0 +1,47 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongBufferedFileStream.h"
+#include <cstring>
+
+namespace Loong::Foundation {
+
+LoongBufferedFileOutputStream::LoongBufferedFileOutputStream(FILE* file, size_t bufferSize)
+    : file_(file)
+    , buffer_(bufferSize)
+{
+}
+
+LoongBufferedFileOutputStream::~LoongBufferedFileOutputStream()
+{
+    Flush();
+}
+
+bool LoongBufferedFileOutputStream::operator()(void* d, size_t l)
+{
+    if (l == 0) {
+        return isOk_;
+    }
+    if (l > buffer_.size() - bufferUsed_ && !Flush()) {
+        return false;
+    }
+    if (l >= buffer_.size()) {
+        isOk_ = isOk_ && fwrite(d, l, 1, file_) == 1;
+        return isOk_;
+    }
+    memcpy(buffer_.data() + bufferUsed_, d, l);
+    bufferUsed_ += l;
+    return isOk_;
+}
+
+bool LoongBufferedFileOutputStream::Flush()
+{
+    if (isOk_ && bufferUsed_ > 0) {
+        isOk_ = fwrite(buffer_.data(), bufferUsed_, 1, file_) == 1;
+    }
+    bufferUsed_ = 0;
+    return isOk_;
+}
+
+}
@@ -0,0 +1,502 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongCullingKernels.h"
+#include "LoongFoundation/LoongFrustum.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define LOONG_CULLING_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define LOONG_CULLING_X86 0
+#endif
+
+// MSVC compiles any intrinsic without flags, GCC and Clang need them enabled per function
+#if defined(__GNUC__) || defined(__clang__)
+#define LOONG_TARGET_SSE2 __attribute__((target("sse2")))
+#define LOONG_TARGET_AVX2 __attribute__((target("avx,avx2")))
+#else
+#define LOONG_TARGET_SSE2
+#define LOONG_TARGET_AVX2
+#endif
+
+namespace Loong::Foundation {
+
+namespace {
+
+using InstructionSet = LoongCullingKernels::InstructionSet;
+
+struct Planes {
+    float x[Frustum::kCount];
+    float y[Frustum::kCount];
+    float z[Frustum::kCount];
+    float w[Frustum::kCount];
+    float absX[Frustum::kCount];
+    float absY[Frustum::kCount];
+    float absZ[Frustum::kCount];
+};
+
+// The sphere test needs the planes normalized, the distances are compared with the radii
+Planes GetPlanes(const Frustum& frustum, bool isNormalized)
+{
+    Planes planes {};
+    for (int i = 0; i < Frustum::kCount; ++i) {
+        Math::Vector4 plane = frustum.GetPlanes()[i];
+        if (isNormalized) {
+            plane /= Math::Length(Math::Vector3(plane));
+        }
+        planes.x[i] = plane.x;
+        planes.y[i] = plane.y;
+        planes.z[i] = plane.z;
+        planes.w[i] = plane.w;
+        planes.absX[i] = std::abs(plane.x);
+        planes.absY[i] = std::abs(plane.y);
+        planes.absZ[i] = std::abs(plane.z);
+    }
+    return planes;
+}
+
+// The SIMD kernels process whole vectors and return how many elements they did, the scalar ones do the rest
+
+void TransformBoxScalar(const LoongBoxArray& boxes, const float* m, size_t i, LoongBoxArray& result)
+{
+    float cx = boxes.GetCenters(0)[i];
+    float cy = boxes.GetCenters(1)[i];
+    float cz = boxes.GetCenters(2)[i];
+    float ex = boxes.GetExtents(0)[i];
+    float ey = boxes.GetExtents(1)[i];
+    float ez = boxes.GetExtents(2)[i];
+    for (int row = 0; row < 3; ++row) {
+        result.GetCenters(row)[i] = m[row] * cx + m[4 + row] * cy + m[8 + row] * cz + m[12 + row];
+        result.GetExtents(row)[i] = std::abs(m[row]) * ex + std::abs(m[4 + row]) * ey + std::abs(m[8 + row]) * ez;
+    }
+}
+
+bool IsBoxVisibleScalar(const Planes& planes, const LoongBoxArray& boxes, size_t i)
+{
+    float cx = boxes.GetCenters(0)[i];
+    float cy = boxes.GetCenters(1)[i];
+    float cz = boxes.GetCenters(2)[i];
+    float ex = boxes.GetExtents(0)[i];
+    float ey = boxes.GetExtents(1)[i];
+    float ez = boxes.GetExtents(2)[i];
+    for (int p = 0; p < Frustum::kCount; ++p) {
+        // The distance of the center plus the projected extents is the distance of the positive vertex
+        float distance = planes.x[p] * cx + planes.y[p] * cy + planes.z[p] * cz + planes.w[p];
+        float radius = planes.absX[p] * ex + planes.absY[p] * ey + planes.absZ[p] * ez;
+        if (distance + radius < 0.0F) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IsSphereVisibleScalar(const Planes& planes, const LoongSphereArray& spheres, size_t i)
+{
+    float cx = spheres.GetCenters(0)[i];
+    float cy = spheres.GetCenters(1)[i];
+    float cz = spheres.GetCenters(2)[i];
+    float r = spheres.GetRadii()[i];
+    for (int p = 0; p < Frustum::kCount; ++p) {
+        float distance = planes.x[p] * cx + planes.y[p] * cy + planes.z[p] * cz + planes.w[p];
+        if (distance + r < 0.0F) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if LOONG_CULLING_X86
+
+LOONG_TARGET_SSE2 size_t TransformBoxesSSE2(const LoongBoxArray& boxes, const float* m, LoongBoxArray& result)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 columns[4][3];
+    __m128 absColumns[3][3];
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 3; ++row) {
+            columns[col][row] = _mm_set1_ps(m[col * 4 + row]);
+            if (col < 3) {
+                absColumns[col][row] = _mm_and_ps(columns[col][row], absMask);
+            }
+        }
+    }
+    const size_t count = boxes.GetSize() / 4 * 4;
+    for (size_t i = 0; i < count; i += 4) {
+        __m128 cx = _mm_loadu_ps(boxes.GetCenters(0) + i);
+        __m128 cy = _mm_loadu_ps(boxes.GetCenters(1) + i);
+        __m128 cz = _mm_loadu_ps(boxes.GetCenters(2) + i);
+        __m128 ex = _mm_loadu_ps(boxes.GetExtents(0) + i);
+        __m128 ey = _mm_loadu_ps(boxes.GetExtents(1) + i);
+        __m128 ez = _mm_loadu_ps(boxes.GetExtents(2) + i);
+        for (int row = 0; row < 3; ++row) {
+            __m128 center = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(columns[0][row], cx), _mm_mul_ps(columns[1][row], cy)), _mm_mul_ps(columns[2][row], cz)), columns[3][row]);
+            __m128 extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absColumns[0][row], ex), _mm_mul_ps(absColumns[1][row], ey)), _mm_mul_ps(absColumns[2][row], ez));
+            _mm_storeu_ps(result.GetCenters(row) + i, center);
+            _mm_storeu_ps(result.GetExtents(row) + i, extent);
+        }
+    }
+    return count;
+}
+
+LOONG_TARGET_SSE2 size_t TransformBoxesEachSSE2(const LoongBoxArray& boxes, const Math::Matrix4* matrices, LoongBoxArray& result)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const size_t count = boxes.GetSize() / 4 * 4;
+    for (size_t i = 0; i < count; i += 4) {
+        // Transpose the columns of 4 matrices, so that columns[col][row] holds the element of every box
+        __m128 columns[4][4];
+        for (int col = 0; col < 4; ++col) {
+            __m128 m0 = _mm_loadu_ps(&matrices[i][col][0]);
+            __m128 m1 = _mm_loadu_ps(&matrices[i + 1][col][0]);
+            __m128 m2 = _mm_loadu_ps(&matrices[i + 2][col][0]);
+            __m128 m3 = _mm_loadu_ps(&matrices[i + 3][col][0]);
+            _MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+            columns[col][0] = m0;
+            columns[col][1] = m1;
+            columns[col][2] = m2;
+            columns[col][3] = m3;
+        }
+        __m128 cx = _mm_loadu_ps(boxes.GetCenters(0) + i);
+        __m128 cy = _mm_loadu_ps(boxes.GetCenters(1) + i);
+        __m128 cz = _mm_loadu_ps(boxes.GetCenters(2) + i);
+        __m128 ex = _mm_loadu_ps(boxes.GetExtents(0) + i);
+        __m128 ey = _mm_loadu_ps(boxes.GetExtents(1) + i);
+        __m128 ez = _mm_loadu_ps(boxes.GetExtents(2) + i);
+        for (int row = 0; row < 3; ++row) {
+            __m128 center = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(columns[0][row], cx), _mm_mul_ps(columns[1][row], cy)), _mm_mul_ps(columns[2][row], cz)), columns[3][row]);
+            __m128 extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(columns[0][row], absMask), ex), _mm_mul_ps(_mm_and_ps(columns[1][row], absMask), ey)), _mm_mul_ps(_mm_and_ps(columns[2][row], absMask), ez));
+            _mm_storeu_ps(result.GetCenters(row) + i, center);
+            _mm_storeu_ps(result.GetExtents(row) + i, extent);
+        }
+    }
+    return count;
+}
+
+LOONG_TARGET_SSE2 size_t TestBoxesSSE2(const Planes& planes, const LoongBoxArray& boxes, uint32_t* visibleMask)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const size_t count = boxes.GetSize() / 4 * 4;
+    for (size_t i = 0; i < count; i += 4) {
+        __m128 cx = _mm_loadu_ps(boxes.GetCenters(0) + i);
+        __m128 cy = _mm_loadu_ps(boxes.GetCenters(1) + i);
+        __m128 cz = _mm_loadu_ps(boxes.GetCenters(2) + i);
+        __m128 ex = _mm_loadu_ps(boxes.GetExtents(0) + i);
+        __m128 ey = _mm_loadu_ps(boxes.GetExtents(1) + i);
+        __m128 ez = _mm_loadu_ps(boxes.GetExtents(2) + i);
+        __m128 outside = zero;
+        for (int p = 0; p < Frustum::kCount; ++p) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.x[p]), cx), _mm_mul_ps(_mm_set1_ps(planes.y[p]), cy)), _mm_mul_ps(_mm_set1_ps(planes.z[p]), cz)), _mm_set1_ps(planes.w[p]));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.absX[p]), ex), _mm_mul_ps(_mm_set1_ps(planes.absY[p]), ey)), _mm_mul_ps(_mm_set1_ps(planes.absZ[p]), ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+        }
+        uint32_t bits = ~uint32_t(_mm_movemask_ps(outside)) & 0xFU;
+        visibleMask[i / 32] |= bits << (i % 32);
+    }
+    return count;
+}
+
+LOONG_TARGET_SSE2 size_t TestSpheresSSE2(const Planes& planes, const LoongSphereArray& spheres, uint32_t* visibleMask)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const size_t count = spheres.GetSize() / 4 * 4;
+    for (size_t i = 0; i < count; i += 4) {
+        __m128 cx = _mm_loadu_ps(spheres.GetCenters(0) + i);
+        __m128 cy = _mm_loadu_ps(spheres.GetCenters(1) + i);
+        __m128 cz = _mm_loadu_ps(spheres.GetCenters(2) + i);
+        __m128 r = _mm_loadu_ps(spheres.GetRadii() + i);
+        __m128 outside = zero;
+        for (int p = 0; p < Frustum::kCount; ++p) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.x[p]), cx), _mm_mul_ps(_mm_set1_ps(planes.y[p]), cy)), _mm_mul_ps(_mm_set1_ps(planes.z[p]), cz)), _mm_set1_ps(planes.w[p]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, r), zero));
+        }
+        uint32_t bits = ~uint32_t(_mm_movemask_ps(outside)) & 0xFU;
+        visibleMask[i / 32] |= bits << (i % 32);
+    }
+    return count;
+}
+
+LOONG_TARGET_AVX2 size_t TransformBoxesAVX2(const LoongBoxArray& boxes, const float* m, LoongBoxArray& result)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 columns[4][3];
+    __m256 absColumns[3][3];
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 3; ++row) {
+            columns[col][row] = _mm256_set1_ps(m[col * 4 + row]);
+            if (col < 3) {
+                absColumns[col][row] = _mm256_and_ps(columns[col][row], absMask);
+            }
+        }
+    }
+    const size_t count = boxes.GetSize() / 8 * 8;
+    for (size_t i = 0; i < count; i += 8) {
+        __m256 cx = _mm256_loadu_ps(boxes.GetCenters(0) + i);
+        __m256 cy = _mm256_loadu_ps(boxes.GetCenters(1) + i);
+        __m256 cz = _mm256_loadu_ps(boxes.GetCenters(2) + i);
+        __m256 ex = _mm256_loadu_ps(boxes.GetExtents(0) + i);
+        __m256 ey = _mm256_loadu_ps(boxes.GetExtents(1) + i);
+        __m256 ez = _mm256_loadu_ps(boxes.GetExtents(2) + i);
+        for (int row = 0; row < 3; ++row) {
+            __m256 center = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(columns[0][row], cx), _mm256_mul_ps(columns[1][row], cy)), _mm256_mul_ps(columns[2][row], cz)), columns[3][row]);
+            __m256 extent = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absColumns[0][row], ex), _mm256_mul_ps(absColumns[1][row], ey)), _mm256_mul_ps(absColumns[2][row], ez));
+            _mm256_storeu_ps(result.GetCenters(row) + i, center);
+            _mm256_storeu_ps(result.GetExtents(row) + i, extent);
+        }
+    }
+    return count;
+}
+
+LOONG_TARGET_AVX2 size_t TransformBoxesEachAVX2(const LoongBoxArray& boxes, const Math::Matrix4* matrices, LoongBoxArray& result)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const size_t count = boxes.GetSize() / 8 * 8;
+    for (size_t i = 0; i < count; i += 8) {
+        // Transpose the columns of 2 x 4 matrices, so that columns[col][row] holds the element of every box
+        __m256 columns[4][4];
+        for (int col = 0; col < 4; ++col) {
+            __m128 lo[4];
+            __m128 hi[4];
+            for (int k = 0; k < 4; ++k) {
+                lo[k] = _mm_loadu_ps(&matrices[i + k][col][0]);
+                hi[k] = _mm_loadu_ps(&matrices[i + 4 + k][col][0]);
+            }
+            _MM_TRANSPOSE4_PS(lo[0], lo[1], lo[2], lo[3]);
+            _MM_TRANSPOSE4_PS(hi[0], hi[1], hi[2], hi[3]);
+            for (int row = 0; row < 4; ++row) {
+                columns[col][row] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo[row]), hi[row], 1);
+            }
+        }
+        __m256 cx = _mm256_loadu_ps(boxes.GetCenters(0) + i);
+        __m256 cy = _mm256_loadu_ps(boxes.GetCenters(1) + i);
+        __m256 cz = _mm256_loadu_ps(boxes.GetCenters(2) + i);
+        __m256 ex = _mm256_loadu_ps(boxes.GetExtents(0) + i);
+        __m256 ey = _mm256_loadu_ps(boxes.GetExtents(1) + i);
+        __m256 ez = _mm256_loadu_ps(boxes.GetExtents(2) + i);
+        for (int row = 0; row < 3; ++row) {
+            __m256 center = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(columns[0][row], cx), _mm256_mul_ps(columns[1][row], cy)), _mm256_mul_ps(columns[2][row], cz)), columns[3][row]);
+            __m256 extent = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_and_ps(columns[0][row], absMask), ex), _mm256_mul_ps(_mm256_and_ps(columns[1][row], absMask), ey)), _mm256_mul_ps(_mm256_and_ps(columns[2][row], absMask), ez));
+            _mm256_storeu_ps(result.GetCenters(row) + i, center);
+            _mm256_storeu_ps(result.GetExtents(row) + i, extent);
+        }
+    }
+    return count;
+}
+
+LOONG_TARGET_AVX2 size_t TestBoxesAVX2(const Planes& planes, const LoongBoxArray& boxes, uint32_t* visibleMask)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const size_t count = boxes.GetSize() / 8 * 8;
+    for (size_t i = 0; i < count; i += 8) {
+        __m256 cx = _mm256_loadu_ps(boxes.GetCenters(0) + i);
+        __m256 cy = _mm256_loadu_ps(boxes.GetCenters(1) + i);
+        __m256 cz = _mm256_loadu_ps(boxes.GetCenters(2) + i);
+        __m256 ex = _mm256_loadu_ps(boxes.GetExtents(0) + i);
+        __m256 ey = _mm256_loadu_ps(boxes.GetExtents(1) + i);
+        __m256 ez = _mm256_loadu_ps(boxes.GetExtents(2) + i);
+        __m256 outside = zero;
+        for (int p = 0; p < Frustum::kCount; ++p) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.x[p]), cx), _mm256_mul_ps(_mm256_set1_ps(planes.y[p]), cy)), _mm256_mul_ps(_mm256_set1_ps(planes.z[p]), cz)), _mm256_set1_ps(planes.w[p]));
+            __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.absX[p]), ex), _mm256_mul_ps(_mm256_set1_ps(planes.absY[p]), ey)), _mm256_mul_ps(_mm256_set1_ps(planes.absZ[p]), ez));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_LT_OQ));
+        }
+        uint32_t bits = ~uint32_t(_mm256_movemask_ps(outside)) & 0xFFU;
+        visibleMask[i / 32] |= bits << (i % 32);
+    }
+    return count;
+}
+
+LOONG_TARGET_AVX2 size_t TestSpheresAVX2(const Planes& planes, const LoongSphereArray& spheres, uint32_t* visibleMask)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const size_t count = spheres.GetSize() / 8 * 8;
+    for (size_t i = 0; i < count; i += 8) {
+        __m256 cx = _mm256_loadu_ps(spheres.GetCenters(0) + i);
+        __m256 cy = _mm256_loadu_ps(spheres.GetCenters(1) + i);
+        __m256 cz = _mm256_loadu_ps(spheres.GetCenters(2) + i);
+        __m256 r = _mm256_loadu_ps(spheres.GetRadii() + i);
+        __m256 outside = zero;
+        for (int p = 0; p < Frustum::kCount; ++p) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.x[p]), cx), _mm256_mul_ps(_mm256_set1_ps(planes.y[p]), cy)), _mm256_mul_ps(_mm256_set1_ps(planes.z[p]), cz)), _mm256_set1_ps(planes.w[p]));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, r), zero, _CMP_LT_OQ));
+        }
+        uint32_t bits = ~uint32_t(_mm256_movemask_ps(outside)) & 0xFFU;
+        visibleMask[i / 32] |= bits << (i % 32);
+    }
+    return count;
+}
+
+#endif
+
+InstructionSet DetectInstructionSet()
+{
+#if LOONG_CULLING_X86
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool hasSSE2 = (info[3] & (1 << 26)) != 0;
+    // AVX needs the OS to save the YMM registers too
+    const bool hasAVX = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    bool hasAVX2 = false;
+    if (hasAVX && maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        hasAVX2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    const bool hasSSE2 = __builtin_cpu_supports("sse2");
+    const bool hasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+    if (hasAVX2) {
+        return InstructionSet::kAVX2;
+    }
+    if (hasSSE2) {
+        return InstructionSet::kSSE2;
+    }
+#endif
+    return InstructionSet::kScalar;
+}
+
+InstructionSet gInstructionSet = LoongCullingKernels::GetSupportedInstructionSet();
+
+}
+
+void LoongBoxArray::Resize(size_t size)
+{
+    for (int axis = 0; axis < 3; ++axis) {
+        centers_[axis].resize(size);
+        extents_[axis].resize(size);
+    }
+    size_ = size;
+}
+
+void LoongBoxArray::Set(size_t index, const Math::AABB& aabb)
+{
+    Math::Vector3 center = (aabb.min + aabb.max) * 0.5F;
+    Math::Vector3 extent = (aabb.max - aabb.min) * 0.5F;
+    for (int axis = 0; axis < 3; ++axis) {
+        centers_[axis][index] = center[axis];
+        extents_[axis][index] = extent[axis];
+    }
+}
+
+Math::AABB LoongBoxArray::Get(size_t index) const
+{
+    Math::Vector3 center { centers_[0][index], centers_[1][index], centers_[2][index] };
+    Math::Vector3 extent { extents_[0][index], extents_[1][index], extents_[2][index] };
+    return Math::AABB { center - extent, center + extent };
+}
+
+void LoongSphereArray::Resize(size_t size)
+{
+    for (auto& centers : centers_) {
+        centers.resize(size);
+    }
+    radii_.resize(size);
+    size_ = size;
+}
+
+void LoongSphereArray::Set(size_t index, const Math::Vector3& center, float radius)
+{
+    for (int axis = 0; axis < 3; ++axis) {
+        centers_[axis][index] = center[axis];
+    }
+    radii_[index] = radius;
+}
+
+LoongCullingKernels::InstructionSet LoongCullingKernels::GetSupportedInstructionSet()
+{
+    static const InstructionSet kSupported = DetectInstructionSet();
+    return kSupported;
+}
+
+LoongCullingKernels::InstructionSet LoongCullingKernels::GetInstructionSet()
+{
+    return gInstructionSet;
+}
+
+void LoongCullingKernels::SetInstructionSet(InstructionSet instructionSet)
+{
+    gInstructionSet = std::min(instructionSet, GetSupportedInstructionSet());
+}
+
+void LoongCullingKernels::TransformBoxes(const LoongBoxArray& boxes, const Math::Matrix4& matrix, LoongBoxArray& result)
+{
+    result.Resize(boxes.GetSize());
+    const float* m = &matrix[0][0];
+    size_t done = 0;
+#if LOONG_CULLING_X86
+    if (gInstructionSet == InstructionSet::kAVX2) {
+        done = TransformBoxesAVX2(boxes, m, result);
+    } else if (gInstructionSet == InstructionSet::kSSE2) {
+        done = TransformBoxesSSE2(boxes, m, result);
+    }
+#endif
+    for (size_t i = done; i < boxes.GetSize(); ++i) {
+        TransformBoxScalar(boxes, m, i, result);
+    }
+}
+
+void LoongCullingKernels::TransformBoxes(const LoongBoxArray& boxes, const Math::Matrix4* matrices, LoongBoxArray& result)
+{
+    result.Resize(boxes.GetSize());
+    size_t done = 0;
+#if LOONG_CULLING_X86
+    if (gInstructionSet == InstructionSet::kAVX2) {
+        done = TransformBoxesEachAVX2(boxes, matrices, result);
+    } else if (gInstructionSet == InstructionSet::kSSE2) {
+        done = TransformBoxesEachSSE2(boxes, matrices, result);
+    }
+#endif
+    for (size_t i = done; i < boxes.GetSize(); ++i) {
+        TransformBoxScalar(boxes, &matrices[i][0][0], i, result);
+    }
+}
+
+void LoongCullingKernels::TestBoxes(const Frustum& frustum, const LoongBoxArray& boxes, std::vector<uint32_t>& visibleMask)
+{
+    visibleMask.assign((boxes.GetSize() + 31) / 32, 0U);
+    const Planes planes = GetPlanes(frustum, false);
+    size_t done = 0;
+#if LOONG_CULLING_X86
+    if (gInstructionSet == InstructionSet::kAVX2) {
+        done = TestBoxesAVX2(planes, boxes, visibleMask.data());
+    } else if (gInstructionSet == InstructionSet::kSSE2) {
+        done = TestBoxesSSE2(planes, boxes, visibleMask.data());
+    }
+#endif
+    for (size_t i = done; i < boxes.GetSize(); ++i) {
+        if (IsBoxVisibleScalar(planes, boxes, i)) {
+            visibleMask[i / 32] |= 1U << (i % 32);
+        }
+    }
+}
+
+void LoongCullingKernels::TestSpheres(const Frustum& frustum, const LoongSphereArray& spheres, std::vector<uint32_t>& visibleMask)
+{
+    visibleMask.assign((spheres.GetSize() + 31) / 32, 0U);
+    const Planes planes = GetPlanes(frustum, true);
+    size_t done = 0;
+#if LOONG_CULLING_X86
+    if (gInstructionSet == InstructionSet::kAVX2) {
+        done = TestSpheresAVX2(planes, spheres, visibleMask.data());
+    } else if (gInstructionSet == InstructionSet::kSSE2) {
+        done = TestSpheresSSE2(planes, spheres, visibleMask.data());
+    }
+#endif
+    for (size_t i = done; i < spheres.GetSize(); ++i) {
+        if (IsSphereVisibleScalar(planes, spheres, i)) {
+            visibleMask[i / 32] |= 1U << (i % 32);
+        }
+    }
+}
+
+}
@@ -86,4 +86,24 @@ bool Frustum::IsSphereVisible(const Math::Vector3& center, float radius) const
     return true;
 }
 
+Frustum::Containment Frustum::ClassifyBox(const Math::AABB& aabb, uint32_t& planeMask) const
+{
+    for (int i = 0; i < Planes::kCount; ++i) {
+        if ((planeMask & (1U << i)) == 0) {
+            continue;
+        }
+        auto& plane = planes_[i];
+        // The corners nearest to and farthest from the positive side of the plane
+        Math::Vector3 positive { plane.x >= 0.0F ? aabb.max.x : aabb.min.x, plane.y >= 0.0F ? aabb.max.y : aabb.min.y, plane.z >= 0.0F ? aabb.max.z : aabb.min.z };
+        Math::Vector3 negative { plane.x >= 0.0F ? aabb.min.x : aabb.max.x, plane.y >= 0.0F ? aabb.min.y : aabb.max.y, plane.z >= 0.0F ? aabb.min.z : aabb.max.z };
+        if (Math::Dot(plane, Math::Vector4(positive, 1.0F)) < 0.0F) {
+            return Containment::kOutside;
+        }
+        if (Math::Dot(plane, Math::Vector4(negative, 1.0F)) >= 0.0F) {
+            planeMask &= ~(1U << i);
+        }
+    }
+    return planeMask == 0 ? Containment::kInside : Containment::kIntersect;
+}
+
 }
\ No newline at end of file
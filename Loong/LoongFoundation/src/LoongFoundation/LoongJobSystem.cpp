@@ -0,0 +1,242 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongJobSystem.h"
+#include "LoongFoundation/LoongLogger.h"
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+
+namespace Loong::Foundation {
+
+namespace {
+
+constexpr uint32_t kNotWorker = ~uint32_t(0);
+
+struct WorkerQueue {
+    std::mutex mutex {};
+    std::deque<LoongJob> jobs {};
+};
+
+std::vector<std::unique_ptr<WorkerQueue>> gQueues {};
+std::vector<std::thread> gWorkers {};
+std::thread::id gMainThreadId { std::this_thread::get_id() };
+
+// Jobs in all the queues, the workers sleep when there are none
+std::atomic<uint32_t> gQueuedJobCount { 0 };
+std::atomic<uint32_t> gNextQueue { 0 };
+std::mutex gSleepMutex {};
+std::condition_variable gWakeCondition {};
+bool gIsQuitting { false };
+
+std::mutex gMainThreadMutex {};
+std::vector<LoongJob> gMainThreadJobs {};
+
+thread_local uint32_t tWorkerIndex = kNotWorker;
+
+bool PopJob(uint32_t workerIndex, LoongJob& job)
+{
+    const auto queueCount = uint32_t(gQueues.size());
+    if (workerIndex != kNotWorker) {
+        auto& queue = *gQueues[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            gQueuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    // Steal the oldest job of another worker
+    const uint32_t start = workerIndex == kNotWorker ? 0 : workerIndex + 1;
+    for (uint32_t i = 0; i < queueCount; ++i) {
+        auto& queue = *gQueues[(start + i) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            gQueuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PopMainThreadJob(LoongJob& job)
+{
+    std::lock_guard<std::mutex> lock(gMainThreadMutex);
+    if (gMainThreadJobs.empty()) {
+        return false;
+    }
+    job = std::move(gMainThreadJobs.back());
+    gMainThreadJobs.pop_back();
+    return true;
+}
+
+}
+
+void LoongJobSystem::Initialize(uint32_t workerCount)
+{
+    assert(gWorkers.empty());
+    gMainThreadId = std::this_thread::get_id();
+    if (workerCount == 0) {
+        workerCount = std::max(std::thread::hardware_concurrency(), 1U) - 1;
+    }
+    gIsQuitting = false;
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        gQueues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        gWorkers.emplace_back([i]() {
+            tWorkerIndex = i;
+            LoongJob job;
+            while (true) {
+                if (PopJob(i, job)) {
+                    Execute(job);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(gSleepMutex);
+                gWakeCondition.wait(lock, []() { return gIsQuitting || gQueuedJobCount.load(std::memory_order_relaxed) > 0; });
+                if (gIsQuitting && gQueuedJobCount.load(std::memory_order_relaxed) == 0) {
+                    return;
+                }
+            }
+        });
+    }
+    LOONG_INFO("Job system started {} workers", workerCount);
+}
+
+void LoongJobSystem::Uninitialize()
+{
+    {
+        std::lock_guard<std::mutex> lock(gSleepMutex);
+        gIsQuitting = true;
+    }
+    gWakeCondition.notify_all();
+    for (auto& worker : gWorkers) {
+        worker.join();
+    }
+    gWorkers.clear();
+    gQueues.clear();
+}
+
+uint32_t LoongJobSystem::GetWorkerCount()
+{
+    return uint32_t(gWorkers.size());
+}
+
+bool LoongJobSystem::IsMainThread()
+{
+    return std::this_thread::get_id() == gMainThreadId;
+}
+
+void LoongJobSystem::Schedule(std::function<void()> func, LoongJobCounter* counter, LoongJobCounter* dependency)
+{
+    Schedule(LoongJob { std::move(func), counter, false }, dependency);
+}
+
+void LoongJobSystem::ScheduleOnMainThread(std::function<void()> func, LoongJobCounter* counter, LoongJobCounter* dependency)
+{
+    Schedule(LoongJob { std::move(func), counter, true }, dependency);
+}
+
+void LoongJobSystem::Schedule(LoongJob&& job, LoongJobCounter* dependency)
+{
+    if (job.counter != nullptr) {
+        std::lock_guard<std::mutex> lock(job.counter->mutex_);
+        job.counter->count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (dependency != nullptr) {
+        std::lock_guard<std::mutex> lock(dependency->mutex_);
+        if (dependency->count_.load(std::memory_order_relaxed) > 0) {
+            dependency->dependents_.push_back(std::move(job));
+            return;
+        }
+    }
+    Submit(std::move(job));
+}
+
+void LoongJobSystem::Submit(LoongJob&& job)
+{
+    if (job.isMainThreadJob) {
+        std::lock_guard<std::mutex> lock(gMainThreadMutex);
+        gMainThreadJobs.push_back(std::move(job));
+        return;
+    }
+    if (gQueues.empty()) {
+        Execute(job);
+        return;
+    }
+
+    // A worker keeps its jobs for itself, until others steal them
+    uint32_t queueIndex = tWorkerIndex;
+    if (queueIndex == kNotWorker) {
+        queueIndex = gNextQueue.fetch_add(1, std::memory_order_relaxed) % uint32_t(gQueues.size());
+    }
+    {
+        auto& queue = *gQueues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+        gQueuedJobCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Taking the lock makes sure a worker either sees the job or is already waiting for the notification
+    { std::lock_guard<std::mutex> lock(gSleepMutex); }
+    gWakeCondition.notify_one();
+}
+
+void LoongJobSystem::Execute(LoongJob& job)
+{
+    job.func();
+    job.func = nullptr;
+
+    auto* counter = job.counter;
+    if (counter == nullptr) {
+        return;
+    }
+    std::vector<LoongJob> dependents;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex_);
+        if (counter->count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            dependents.swap(counter->dependents_);
+        }
+    }
+    // The counter may be gone from now on
+    for (auto& dependent : dependents) {
+        Submit(std::move(dependent));
+    }
+}
+
+void LoongJobSystem::RunMainThreadJobs()
+{
+    assert(IsMainThread());
+    std::vector<LoongJob> jobs;
+    {
+        std::lock_guard<std::mutex> lock(gMainThreadMutex);
+        jobs.swap(gMainThreadJobs);
+    }
+    for (auto& job : jobs) {
+        Execute(job);
+    }
+}
+
+void LoongJobSystem::Wait(LoongJobCounter& counter)
+{
+    const bool isMainThread = IsMainThread();
+    LoongJob job;
+    while (!counter.IsDone()) {
+        if (isMainThread && PopMainThreadJob(job)) {
+            Execute(job);
+        } else if (PopJob(tWorkerIndex, job)) {
+            Execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    // Wait for the last job to leave the counter
+    std::lock_guard<std::mutex> lock(counter.mutex_);
+}
+
+}
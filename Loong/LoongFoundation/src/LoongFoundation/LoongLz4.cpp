@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongLz4.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace Loong::Foundation {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+// The last match starts 12 bytes before the end at least, and the last 5 bytes are literals
+constexpr size_t kMatchStartLimit = 12;
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMaxOffset = 65535;
+constexpr uint32_t kHashBits = 16;
+
+uint32_t Read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32U - kHashBits);
+}
+
+void WriteLength(std::vector<uint8_t>& output, size_t length)
+{
+    for (; length >= 255; length -= 255) {
+        output.push_back(255);
+    }
+    output.push_back(uint8_t(length));
+}
+
+void WriteSequence(std::vector<uint8_t>& output, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength)
+{
+    size_t matchCode = matchLength - kMinMatch;
+    output.push_back(uint8_t((std::min<size_t>(literalLength, 15) << 4U) | std::min<size_t>(matchCode, 15)));
+    if (literalLength >= 15) {
+        WriteLength(output, literalLength - 15);
+    }
+    output.insert(output.end(), literals, literals + literalLength);
+    output.push_back(uint8_t(offset & 0xFFU));
+    output.push_back(uint8_t(offset >> 8U));
+    if (matchCode >= 15) {
+        WriteLength(output, matchCode - 15);
+    }
+}
+
+void WriteLastLiterals(std::vector<uint8_t>& output, const uint8_t* literals, size_t literalLength)
+{
+    output.push_back(uint8_t(std::min<size_t>(literalLength, 15) << 4U));
+    if (literalLength >= 15) {
+        WriteLength(output, literalLength - 15);
+    }
+    output.insert(output.end(), literals, literals + literalLength);
+}
+
+}
+
+void LoongLz4::Compress(const void* data, size_t size, std::vector<uint8_t>& output)
+{
+    auto* input = static_cast<const uint8_t*>(data);
+    output.clear();
+    output.reserve(GetMaxCompressedSize(size));
+
+    size_t anchor = 0;
+    if (size > kMatchStartLimit) {
+        // The positions plus 1 of the last sequences of each hash, 0 for none
+        std::unique_ptr<uint32_t[]> table(new uint32_t[size_t(1) << kHashBits]());
+        const size_t matchStartLimit = size - kMatchStartLimit;
+        const size_t matchEndLimit = size - kLastLiterals;
+        size_t position = 0;
+        while (position < matchStartLimit) {
+            uint32_t sequence = Read32(input + position);
+            uint32_t& entry = table[Hash(sequence)];
+            size_t candidate = entry;
+            entry = uint32_t(position + 1);
+            if (candidate == 0 || position + 1 - candidate > kMaxOffset || Read32(input + candidate - 1) != sequence) {
+                ++position;
+                continue;
+            }
+            size_t match = candidate - 1;
+            while (position > anchor && match > 0 && input[position - 1] == input[match - 1]) {
+                --position;
+                --match;
+            }
+            size_t length = kMinMatch;
+            while (position + length < matchEndLimit && input[position + length] == input[match + length]) {
+                ++length;
+            }
+            WriteSequence(output, input + anchor, position - anchor, position - match, length);
+            position += length;
+            anchor = position;
+        }
+    }
+    WriteLastLiterals(output, input + anchor, size - anchor);
+}
+
+bool LoongLz4::Decompress(const void* data, size_t size, void* output, size_t outputSize)
+{
+    auto* input = static_cast<const uint8_t*>(data);
+    auto* out = static_cast<uint8_t*>(output);
+    size_t in = 0;
+    size_t written = 0;
+    auto readLength = [input, size, &in](size_t& length) {
+        uint8_t byte;
+        do {
+            if (in >= size) {
+                return false;
+            }
+            byte = input[in++];
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+    while (in < size) {
+        uint8_t token = input[in++];
+        size_t literalLength = token >> 4U;
+        if (literalLength == 15 && !readLength(literalLength)) {
+            return false;
+        }
+        if (literalLength > size - in || literalLength > outputSize - written) {
+            return false;
+        }
+        memcpy(out + written, input + in, literalLength);
+        in += literalLength;
+        written += literalLength;
+        if (in == size) {
+            // The last sequence has no match
+            return written == outputSize;
+        }
+
+        if (size - in < 2) {
+            return false;
+        }
+        size_t offset = input[in] | (size_t(input[in + 1]) << 8U);
+        in += 2;
+        size_t matchLength = token & 0xFU;
+        if (matchLength == 15 && !readLength(matchLength)) {
+            return false;
+        }
+        matchLength += kMinMatch;
+        if (offset == 0 || offset > written || matchLength > outputSize - written) {
+            return false;
+        }
+        // The match may overlap the output, e.g. runs of a byte have offset 1
+        const uint8_t* match = out + written - offset;
+        if (offset >= matchLength) {
+            memcpy(out + written, match, matchLength);
+        } else {
+            for (size_t i = 0; i < matchLength; ++i) {
+                out[written + i] = match[i];
+            }
+        }
+        written += matchLength;
+    }
+    return false;
+}
+
+}
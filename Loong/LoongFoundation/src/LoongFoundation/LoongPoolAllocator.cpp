@@ -0,0 +1,56 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongPoolAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+namespace Loong::Foundation {
+
+LoongPoolAllocator::LoongPoolAllocator(size_t blockSize, size_t blocksPerChunk)
+{
+    // Every block must be able to hold the free list link, and keep the next one aligned
+    constexpr size_t kAlignment = alignof(std::max_align_t);
+    blockSize = std::max(blockSize, sizeof(FreeBlock));
+    blockSize_ = (blockSize + kAlignment - 1) / kAlignment * kAlignment;
+    blocksPerChunk_ = std::max<size_t>(blocksPerChunk, 1);
+}
+
+void* LoongPoolAllocator::Allocate()
+{
+    if (freeList_ == nullptr) {
+        AllocateChunk();
+    }
+    FreeBlock* block = freeList_;
+    freeList_ = block->next;
+    ++allocatedCount_;
+    return block;
+}
+
+void LoongPoolAllocator::Free(void* block)
+{
+    if (block == nullptr) {
+        return;
+    }
+    assert(allocatedCount_ > 0);
+    auto* freeBlock = static_cast<FreeBlock*>(block);
+    freeBlock->next = freeList_;
+    freeList_ = freeBlock;
+    --allocatedCount_;
+}
+
+void LoongPoolAllocator::AllocateChunk()
+{
+    const size_t chunkSize = blockSize_ * blocksPerChunk_;
+    chunks_.emplace_back(new std::max_align_t[(chunkSize + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)]);
+    auto* bytes = reinterpret_cast<uint8_t*>(chunks_.back().get());
+    // Link them backwards, so that the blocks are handed out in address order
+    for (size_t i = blocksPerChunk_; i > 0; --i) {
+        auto* block = reinterpret_cast<FreeBlock*>(bytes + (i - 1) * blockSize_);
+        block->next = freeList_;
+        freeList_ = block;
+    }
+}
+
+}
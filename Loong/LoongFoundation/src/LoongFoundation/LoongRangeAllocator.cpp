@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongRangeAllocator.h"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace Loong::Foundation {
+
+LoongRangeAllocator::LoongRangeAllocator(uint32_t capacity)
+{
+    Reset(capacity);
+}
+
+uint32_t LoongRangeAllocator::Allocate(uint32_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+    for (auto it = freeRanges_.begin(); it != freeRanges_.end(); ++it) {
+        if (it->second < size) {
+            continue;
+        }
+        uint32_t offset = it->first;
+        uint32_t remaining = it->second - size;
+        freeRanges_.erase(it);
+        if (remaining > 0) {
+            freeRanges_.emplace(offset + size, remaining);
+        }
+        freeSize_ -= size;
+        return offset;
+    }
+    return kInvalidOffset;
+}
+
+void LoongRangeAllocator::Free(uint32_t offset, uint32_t size)
+{
+    if (size == 0) {
+        return;
+    }
+    assert(offset + size <= capacity_);
+    AddFreeRange(offset, size);
+    freeSize_ += size;
+}
+
+void LoongRangeAllocator::Grow(uint32_t capacity)
+{
+    if (capacity <= capacity_) {
+        return;
+    }
+    uint32_t oldCapacity = capacity_;
+    capacity_ = capacity;
+    Free(oldCapacity, capacity - oldCapacity);
+}
+
+void LoongRangeAllocator::Reset(uint32_t capacity)
+{
+    freeRanges_.clear();
+    capacity_ = capacity;
+    freeSize_ = capacity;
+    if (capacity > 0) {
+        freeRanges_.emplace(0, capacity);
+    }
+}
+
+uint32_t LoongRangeAllocator::GetLargestFreeRange() const
+{
+    uint32_t largest = 0;
+    for (auto& [offset, size] : freeRanges_) {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
+
+void LoongRangeAllocator::AddFreeRange(uint32_t offset, uint32_t size)
+{
+    auto next = freeRanges_.lower_bound(offset);
+    assert(next == freeRanges_.end() || offset + size <= next->first);
+
+    // Merge with the previous range
+    if (next != freeRanges_.begin()) {
+        auto prev = std::prev(next);
+        assert(prev->first + prev->second <= offset);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            freeRanges_.erase(prev);
+        }
+    }
+    // Merge with the next range
+    if (next != freeRanges_.end() && offset + size == next->first) {
+        size += next->second;
+        freeRanges_.erase(next);
+    }
+    freeRanges_.emplace(offset, size);
+}
+
+}
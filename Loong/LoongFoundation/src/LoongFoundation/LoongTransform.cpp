@@ -0,0 +1,61 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongTransform.h"
+
+namespace Loong::Foundation {
+
+Transform::~Transform()
+{
+    Hierarchy().Destroy(id_);
+}
+
+void Transform::SetWorldPosition(const Math::Vector3& pos)
+{
+    auto& hierarchy = Hierarchy();
+    uint32_t parent = hierarchy.GetParent(id_);
+    if (parent == LoongTransformHierarchy::kNone) {
+        hierarchy.Position(id_) = pos;
+    } else {
+        // T_world = T_parent * T_local ====> T_local = T_parent^-1 * T_world
+        hierarchy.Position(id_) = Math::Inverse(hierarchy.GetWorldMatrix(parent)) * Math::Vector4 { pos, 1.0F };
+    }
+    OnTransformChange();
+}
+
+void Transform::SetWorldRotation(const Math::Quat& rot)
+{
+    auto& hierarchy = Hierarchy();
+    uint32_t parent = hierarchy.GetParent(id_);
+    if (parent == LoongTransformHierarchy::kNone) {
+        hierarchy.Rotation(id_) = rot;
+    } else {
+        hierarchy.Rotation(id_) = Math::Inverse(hierarchy.GetWorldRotation(parent)) * rot;
+    }
+    OnTransformChange();
+}
+
+Transform* Transform::GetParent() const
+{
+    uint32_t parent = Hierarchy().GetParent(id_);
+    return parent == LoongTransformHierarchy::kNone ? nullptr : Hierarchy().GetOwner(parent);
+}
+
+void Transform::SetParent(Transform* parent)
+{
+    auto& hierarchy = Hierarchy();
+    uint32_t parentId = parent == nullptr ? LoongTransformHierarchy::kNone : parent->id_;
+    if (parentId == hierarchy.GetParent(id_)) {
+        return;
+    }
+    // Calculate the new local matrix, so that the world matrix is kept
+    Math::Matrix4 worldMatrix = GetWorldTransformMatrix();
+    Math::Matrix4 newLocalMatrix = parent != nullptr ? Math::Inverse(parent->GetWorldTransformMatrix()) * worldMatrix : worldMatrix;
+    Math::Decompose(newLocalMatrix, hierarchy.Scale(id_), hierarchy.Rotation(id_), hierarchy.Position(id_));
+    // Although our world transform should not be changed, but if the parent has a different scale, the result may
+    // change, SetParent marks it as changed anyway
+    hierarchy.SetParent(id_, parentId);
+}
+
+}
@@ -0,0 +1,333 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongTransformHierarchy.h"
+#include "LoongFoundation/LoongJobSystem.h"
+#include <algorithm>
+#include <cassert>
+
+namespace Loong::Foundation {
+
+namespace {
+
+// Levels smaller than this are updated on the calling thread
+constexpr uint32_t kTransformsPerJob = 1024;
+
+}
+
+LoongTransformHierarchy& LoongTransformHierarchy::GetDefault()
+{
+    static LoongTransformHierarchy hierarchy;
+    return hierarchy;
+}
+
+uint32_t LoongTransformHierarchy::Create(Transform* owner, const Math::Vector3& position, const Math::Quat& rotation, const Math::Vector3& scale)
+{
+    uint32_t id = 0;
+    if (!freeIds_.empty()) {
+        id = freeIds_.back();
+        freeIds_.pop_back();
+    } else {
+        id = uint32_t(parents_.size());
+        size_t size = id + size_t(1);
+        parents_.resize(size);
+        firstChildren_.resize(size);
+        nextSiblings_.resize(size);
+        prevSiblings_.resize(size);
+        isAlive_.resize(size);
+        owners_.resize(size);
+        positions_.resize(size);
+        rotations_.resize(size);
+        scales_.resize(size);
+        localMatrices_.resize(size);
+        worldMatrices_.resize(size);
+        worldPositions_.resize(size);
+        worldRotations_.resize(size);
+        worldScales_.resize(size);
+        localVersions_.resize(size);
+        localMatrixVersions_.resize(size);
+        worldVersions_.resize(size);
+        checkedVersions_.resize(size);
+        decomposedVersions_.resize(size);
+        watchers_.resize(size);
+        isReported_.resize(size);
+    }
+    parents_[id] = kNone;
+    firstChildren_[id] = kNone;
+    nextSiblings_[id] = kNone;
+    prevSiblings_[id] = kNone;
+    isAlive_[id] = 1;
+    owners_[id] = owner;
+    positions_[id] = position;
+    rotations_[id] = rotation;
+    scales_[id] = scale;
+    localMatrixVersions_[id] = 0;
+    worldVersions_[id] = 0;
+    checkedVersions_[id] = 0;
+    decomposedVersions_[id] = 0;
+    watchers_[id] = 0;
+    isReported_[id] = 0;
+    MarkChanged(id);
+
+    ++count_;
+    isOrderDirty_ = true;
+    return id;
+}
+
+void LoongTransformHierarchy::Destroy(uint32_t id)
+{
+    assert(isAlive_[id]);
+    while (firstChildren_[id] != kNone) {
+        uint32_t child = firstChildren_[id];
+        Unlink(child);
+        MarkChanged(child);
+    }
+    Unlink(id);
+    Unreport(id);
+    watchers_[id] = 0;
+    isAlive_[id] = 0;
+    owners_[id] = nullptr;
+    freeIds_.push_back(id);
+
+    --count_;
+    isOrderDirty_ = true;
+}
+
+void LoongTransformHierarchy::SetParent(uint32_t id, uint32_t parent)
+{
+    if (parents_[id] == parent) {
+        return;
+    }
+    Unlink(id);
+    if (parent != kNone) {
+        Link(id, parent);
+    }
+    MarkChanged(id);
+    isOrderDirty_ = true;
+}
+
+const Math::Matrix4& LoongTransformHierarchy::GetLocalMatrix(uint32_t id)
+{
+    if (localMatrixVersions_[id] < localVersions_[id]) {
+        localMatrixVersions_[id] = localVersions_[id];
+        localMatrices_[id] = Math::Translate(positions_[id]) * Math::QuatToMatrix4(rotations_[id]) * Math::Scale(scales_[id]);
+    }
+    return localMatrices_[id];
+}
+
+const Math::Matrix4& LoongTransformHierarchy::GetWorldMatrix(uint32_t id)
+{
+    Validate(id);
+    return worldMatrices_[id];
+}
+
+const Math::Vector3& LoongTransformHierarchy::GetWorldPosition(uint32_t id)
+{
+    Validate(id);
+    return worldPositions_[id];
+}
+
+const Math::Quat& LoongTransformHierarchy::GetWorldRotation(uint32_t id)
+{
+    GetWorldScale(id);
+    return worldRotations_[id];
+}
+
+const Math::Vector3& LoongTransformHierarchy::GetWorldScale(uint32_t id)
+{
+    Validate(id);
+    if (decomposedVersions_[id] != worldVersions_[id]) {
+        decomposedVersions_[id] = worldVersions_[id];
+        if (parents_[id] == kNone) {
+            worldRotations_[id] = rotations_[id];
+            worldScales_[id] = scales_[id];
+        } else {
+            Math::Vector3 position;
+            Math::Decompose(worldMatrices_[id], worldScales_[id], worldRotations_[id], position);
+        }
+    }
+    return worldScales_[id];
+}
+
+uint64_t LoongTransformHierarchy::GetWorldVersion(uint32_t id)
+{
+    Validate(id);
+    return worldVersions_[id];
+}
+
+void LoongTransformHierarchy::Update()
+{
+    if (updatedVersion_ == version_ && !isOrderDirty_) {
+        return;
+    }
+    if (isOrderDirty_) {
+        RebuildOrder();
+    }
+    updatedVersion_ = version_;
+    for (size_t level = 0; level + 1 < levelOffsets_.size(); ++level) {
+        LoongJobSystem::ParallelFor(levelOffsets_[level], levelOffsets_[level + 1], kTransformsPerJob, [this](uint32_t first, uint32_t last) {
+            for (uint32_t i = first; i < last; ++i) {
+                UpdateWorld(order_[i]);
+            }
+        });
+    }
+}
+
+void LoongTransformHierarchy::Validate(uint32_t id)
+{
+    // Nothing changed since the last check
+    if (checkedVersions_[id] == version_) {
+        return;
+    }
+    if (parents_[id] != kNone) {
+        Validate(parents_[id]);
+    }
+    UpdateWorld(id);
+}
+
+void LoongTransformHierarchy::UpdateWorld(uint32_t id)
+{
+    uint32_t parent = parents_[id];
+    uint64_t parentVersion = parent == kNone ? 0 : worldVersions_[parent];
+    if (worldVersions_[id] < localVersions_[id] || worldVersions_[id] < parentVersion) {
+        auto& localMatrix = GetLocalMatrix(id);
+        worldMatrices_[id] = parent == kNone ? localMatrix : worldMatrices_[parent] * localMatrix;
+        worldPositions_[id] = Math::Vector3 { worldMatrices_[id][3] };
+        worldVersions_[id] = version_;
+        if (watchers_[id] != 0 && !isReported_[id]) {
+            Report(id);
+        }
+    }
+    checkedVersions_[id] = version_;
+}
+
+uint32_t LoongTransformHierarchy::CreateWatcher()
+{
+    if (changedLists_.empty()) {
+        // Watcher 0 is no watcher
+        changedLists_.emplace_back();
+        isWatcherAlive_.push_back(0);
+    }
+    uint32_t watcher = 0;
+    if (!freeWatchers_.empty()) {
+        watcher = freeWatchers_.back();
+        freeWatchers_.pop_back();
+    } else {
+        watcher = uint32_t(changedLists_.size());
+        changedLists_.emplace_back();
+        isWatcherAlive_.push_back(0);
+    }
+    isWatcherAlive_[watcher] = 1;
+    return watcher;
+}
+
+void LoongTransformHierarchy::DestroyWatcher(uint32_t watcher)
+{
+    assert(watcher != 0 && isWatcherAlive_[watcher]);
+    for (uint32_t id = 0; id < uint32_t(watchers_.size()); ++id) {
+        if (watchers_[id] == watcher) {
+            isReported_[id] = 0;
+            watchers_[id] = 0;
+        }
+    }
+    changedLists_[watcher].clear();
+    isWatcherAlive_[watcher] = 0;
+    freeWatchers_.push_back(watcher);
+}
+
+void LoongTransformHierarchy::SetWatcher(uint32_t id, uint32_t watcher)
+{
+    assert(watcher == 0 || isWatcherAlive_[watcher]);
+    if (watchers_[id] == watcher) {
+        return;
+    }
+    Unreport(id);
+    watchers_[id] = watcher;
+}
+
+void LoongTransformHierarchy::TakeChanged(uint32_t watcher, std::vector<Transform*>& changed)
+{
+    assert(watcher != 0 && isWatcherAlive_[watcher]);
+    changed.clear();
+    for (uint32_t id : changedLists_[watcher]) {
+        isReported_[id] = 0;
+        changed.push_back(owners_[id]);
+    }
+    changedLists_[watcher].clear();
+}
+
+void LoongTransformHierarchy::Report(uint32_t id)
+{
+    // Each transform is updated by one job only, so only the shared list needs the lock
+    isReported_[id] = 1;
+    std::lock_guard<std::mutex> lock(changedMutex_);
+    changedLists_[watchers_[id]].push_back(id);
+}
+
+void LoongTransformHierarchy::Unreport(uint32_t id)
+{
+    if (!isReported_[id]) {
+        return;
+    }
+    auto& changed = changedLists_[watchers_[id]];
+    changed.erase(std::find(changed.begin(), changed.end(), id));
+    isReported_[id] = 0;
+}
+
+void LoongTransformHierarchy::Link(uint32_t id, uint32_t parent)
+{
+    parents_[id] = parent;
+    prevSiblings_[id] = kNone;
+    nextSiblings_[id] = firstChildren_[parent];
+    if (firstChildren_[parent] != kNone) {
+        prevSiblings_[firstChildren_[parent]] = id;
+    }
+    firstChildren_[parent] = id;
+}
+
+void LoongTransformHierarchy::Unlink(uint32_t id)
+{
+    uint32_t parent = parents_[id];
+    if (parent == kNone) {
+        return;
+    }
+    if (prevSiblings_[id] != kNone) {
+        nextSiblings_[prevSiblings_[id]] = nextSiblings_[id];
+    } else {
+        firstChildren_[parent] = nextSiblings_[id];
+    }
+    if (nextSiblings_[id] != kNone) {
+        prevSiblings_[nextSiblings_[id]] = prevSiblings_[id];
+    }
+    parents_[id] = kNone;
+    prevSiblings_[id] = kNone;
+    nextSiblings_[id] = kNone;
+}
+
+void LoongTransformHierarchy::RebuildOrder()
+{
+    // Breadth first, so each level only depends on the previous one
+    order_.clear();
+    levelOffsets_.clear();
+    for (uint32_t id = 0; id < uint32_t(parents_.size()); ++id) {
+        if (isAlive_[id] && parents_[id] == kNone) {
+            order_.push_back(id);
+        }
+    }
+    size_t levelBegin = 0;
+    while (levelBegin < order_.size()) {
+        levelOffsets_.push_back(uint32_t(levelBegin));
+        size_t levelEnd = order_.size();
+        for (size_t i = levelBegin; i < levelEnd; ++i) {
+            for (uint32_t child = firstChildren_[order_[i]]; child != kNone; child = nextSiblings_[child]) {
+                order_.push_back(child);
+            }
+        }
+        levelBegin = levelEnd;
+    }
+    levelOffsets_.push_back(uint32_t(order_.size()));
+    isOrderDirty_ = false;
+}
+
+}
@@ -0,0 +1,275 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongFoundation/LoongTriangleBVH.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Loong::Foundation {
+
+namespace {
+
+constexpr int kBinCount = 12;
+
+Math::AABB EmptyAABB()
+{
+    constexpr float kMax = std::numeric_limits<float>::max();
+    return Math::AABB { Math::Vector3(kMax), Math::Vector3(-kMax) };
+}
+
+bool RayIntersectsAABB(const Math::AABB& aabb, const Math::Vector3& origin, const Math::Vector3& invDir, float maxDistance, float& distance)
+{
+    Math::Vector3 t1 = (aabb.min - origin) * invDir;
+    Math::Vector3 t2 = (aabb.max - origin) * invDir;
+    Math::Vector3 tMin = Math::Min(t1, t2);
+    Math::Vector3 tMax = Math::Max(t1, t2);
+    float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0F));
+    float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+    distance = enter;
+    return enter <= exit;
+}
+
+// Moller-Trumbore, double sided
+bool RayIntersectsTriangle(const Math::Vector3& origin, const Math::Vector3& direction, const Math::Vector3* v, float& distance)
+{
+    constexpr float kEpsilon = 1e-9F;
+    Math::Vector3 e1 = v[1] - v[0];
+    Math::Vector3 e2 = v[2] - v[0];
+    Math::Vector3 p = Math::Cross(direction, e2);
+    float det = Math::Dot(e1, p);
+    if (std::abs(det) < kEpsilon) {
+        return false;
+    }
+    float invDet = 1.0F / det;
+    Math::Vector3 s = origin - v[0];
+    float u = Math::Dot(s, p) * invDet;
+    if (u < 0.0F || u > 1.0F) {
+        return false;
+    }
+    Math::Vector3 q = Math::Cross(s, e1);
+    float w = Math::Dot(direction, q) * invDet;
+    if (w < 0.0F || u + w > 1.0F) {
+        return false;
+    }
+    distance = Math::Dot(e2, q) * invDet;
+    return distance >= 0.0F;
+}
+
+}
+
+void LoongTriangleBVH::Build(const void* vertices, size_t stride, size_t vertexCount, const void* indices, size_t indexSize, size_t indexCount)
+{
+    assert(indexSize == sizeof(uint16_t) || indexSize == sizeof(uint32_t));
+    Clear();
+
+    auto* bytes = static_cast<const uint8_t*>(vertices);
+    auto getPosition = [bytes, stride](uint32_t index) {
+        Math::Vector3 position;
+        memcpy(&position, bytes + index * stride, sizeof(position));
+        return position;
+    };
+    auto getIndex = [indices, indexSize](size_t i) -> uint32_t {
+        return indexSize == sizeof(uint16_t) ? static_cast<const uint16_t*>(indices)[i] : static_cast<const uint32_t*>(indices)[i];
+    };
+
+    std::vector<BuildItem> items;
+    items.reserve(indexCount / 3);
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        uint32_t i0 = getIndex(i);
+        uint32_t i1 = getIndex(i + 1);
+        uint32_t i2 = getIndex(i + 2);
+        if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount) {
+            continue;
+        }
+        Math::Vector3 v0 = getPosition(i0);
+        Math::Vector3 v1 = getPosition(i1);
+        Math::Vector3 v2 = getPosition(i2);
+        BuildItem item {};
+        item.aabb = Math::AABB { Math::Min(Math::Min(v0, v1), v2), Math::Max(Math::Max(v0, v1), v2) };
+        item.centroid = (item.aabb.min + item.aabb.max) * 0.5F;
+        item.triangle = uint32_t(i / 3);
+        items.push_back(item);
+    }
+    if (items.empty()) {
+        return;
+    }
+
+    nodes_.reserve(items.size() * 2);
+    BuildRecursive(items, 0, uint32_t(items.size()));
+
+    // Store the triangles in the order of the leaves, so that a leaf reads continuous memory
+    vertices_.reserve(items.size() * 3);
+    triangleIndices_.reserve(items.size());
+    for (auto& item : items) {
+        size_t first = size_t(item.triangle) * 3;
+        vertices_.push_back(getPosition(getIndex(first)));
+        vertices_.push_back(getPosition(getIndex(first + 1)));
+        vertices_.push_back(getPosition(getIndex(first + 2)));
+        triangleIndices_.push_back(item.triangle);
+    }
+}
+
+void LoongTriangleBVH::Clear()
+{
+    nodes_.clear();
+    vertices_.clear();
+    triangleIndices_.clear();
+}
+
+uint32_t LoongTriangleBVH::BuildRecursive(std::vector<BuildItem>& items, uint32_t begin, uint32_t end)
+{
+    uint32_t nodeIndex = uint32_t(nodes_.size());
+    nodes_.emplace_back();
+
+    Math::AABB aabb = EmptyAABB();
+    Math::AABB centroidBounds = EmptyAABB();
+    for (uint32_t i = begin; i < end; ++i) {
+        aabb = aabb.Merged(items[i].aabb);
+        centroidBounds = centroidBounds.Merged(Math::AABB { items[i].centroid, items[i].centroid });
+    }
+    nodes_[nodeIndex].aabb = aabb;
+
+    uint32_t count = end - begin;
+    auto makeLeaf = [this, nodeIndex, begin, count]() {
+        nodes_[nodeIndex].first = begin;
+        nodes_[nodeIndex].count = count;
+        return nodeIndex;
+    };
+    if (count <= kMaxLeafTriangles) {
+        return makeLeaf();
+    }
+
+    // Find the best split among the bins of every axis
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        float minCentroid = centroidBounds.min[axis];
+        float extent = centroidBounds.max[axis] - minCentroid;
+        if (extent <= 0.0F) {
+            continue;
+        }
+        Math::AABB binBounds[kBinCount];
+        uint32_t binCounts[kBinCount] {};
+        for (auto& bounds : binBounds) {
+            bounds = EmptyAABB();
+        }
+        float scale = kBinCount / extent;
+        for (uint32_t i = begin; i < end; ++i) {
+            int bin = std::min(kBinCount - 1, int((items[i].centroid[axis] - minCentroid) * scale));
+            binBounds[bin] = binBounds[bin].Merged(items[i].aabb);
+            ++binCounts[bin];
+        }
+
+        // Sweep from the right to get the cost of the right side of each split plane
+        float rightCosts[kBinCount] {};
+        Math::AABB rightBounds = EmptyAABB();
+        uint32_t rightCount = 0;
+        for (int i = kBinCount - 1; i > 0; --i) {
+            rightBounds = rightBounds.Merged(binBounds[i]);
+            rightCount += binCounts[i];
+            rightCosts[i] = rightCount == 0 ? 0.0F : rightBounds.GetSurfaceArea() * float(rightCount);
+        }
+        Math::AABB leftBounds = EmptyAABB();
+        uint32_t leftCount = 0;
+        for (int i = 0; i < kBinCount - 1; ++i) {
+            leftBounds = leftBounds.Merged(binBounds[i]);
+            leftCount += binCounts[i];
+            if (leftCount == 0 || leftCount == count) {
+                continue;
+            }
+            float cost = leftBounds.GetSurfaceArea() * float(leftCount) + rightCosts[i + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i + 1;
+            }
+        }
+    }
+
+    uint32_t middle = begin;
+    if (bestAxis >= 0) {
+        // Splitting is not worth it if intersecting all the triangles is cheaper
+        if (bestCost >= aabb.GetSurfaceArea() * float(count) && count <= kMaxLeafTriangles * 4) {
+            return makeLeaf();
+        }
+        float minCentroid = centroidBounds.min[bestAxis];
+        float scale = kBinCount / (centroidBounds.max[bestAxis] - minCentroid);
+        auto it = std::partition(items.begin() + begin, items.begin() + end, [&](const BuildItem& item) {
+            return std::min(kBinCount - 1, int((item.centroid[bestAxis] - minCentroid) * scale)) < bestSplit;
+        });
+        middle = uint32_t(it - items.begin());
+    }
+    if (middle == begin || middle == end) {
+        // All the centroids are at the same place, just split in the middle
+        middle = begin + count / 2;
+    }
+
+    BuildRecursive(items, begin, middle);
+    uint32_t second = BuildRecursive(items, middle, end);
+    nodes_[nodeIndex].first = second;
+    nodes_[nodeIndex].count = 0;
+    return nodeIndex;
+}
+
+bool LoongTriangleBVH::Raycast(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, RaycastHit& hit) const
+{
+    if (nodes_.empty()) {
+        return false;
+    }
+
+    const Math::Vector3 invDir = 1.0F / direction;
+    bool isHit = false;
+    float distance = 0.0F;
+    if (!RayIntersectsAABB(nodes_[0].aabb, origin, invDir, maxDistance, distance)) {
+        return false;
+    }
+
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    while (!stack.empty()) {
+        auto& node = nodes_[stack.back()];
+        stack.pop_back();
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                float t = 0.0F;
+                if (RayIntersectsTriangle(origin, direction, &vertices_[size_t(i) * 3], t) && t <= maxDistance) {
+                    maxDistance = t;
+                    isHit = true;
+                    hit.distance = t;
+                    hit.triangleIndex = triangleIndices_[i];
+                    auto* v = &vertices_[size_t(i) * 3];
+                    hit.normal = Math::Normalize(Math::Cross(v[1] - v[0], v[2] - v[0]));
+                }
+            }
+            continue;
+        }
+
+        // Visit the nearer child first, so that the farther one is more likely to be clipped
+        uint32_t child1 = uint32_t(&node - nodes_.data()) + 1;
+        uint32_t child2 = node.first;
+        float distance1 = 0.0F;
+        float distance2 = 0.0F;
+        bool hit1 = RayIntersectsAABB(nodes_[child1].aabb, origin, invDir, maxDistance, distance1);
+        bool hit2 = RayIntersectsAABB(nodes_[child2].aabb, origin, invDir, maxDistance, distance2);
+        if (hit1 && hit2) {
+            if (distance1 > distance2) {
+                std::swap(child1, child2);
+            }
+            stack.push_back(child2);
+            stack.push_back(child1);
+        } else if (hit1) {
+            stack.push_back(child1);
+        } else if (hit2) {
+            stack.push_back(child2);
+        }
+    }
+    return isHit;
+}
+
+}
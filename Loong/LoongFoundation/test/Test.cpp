@@ -2,14 +2,29 @@
 // Copyright (c) 2020 Carl Chen. All rights reserved.
 //
 
+#include "LoongFoundation/LoongAABBTree.h"
+#include "LoongFoundation/LoongBufferedFileStream.h"
+#include "LoongFoundation/LoongCullingKernels.h"
+#include "LoongFoundation/LoongFrustum.h"
+#include "LoongFoundation/LoongJobSystem.h"
 #include "LoongFoundation/LoongLogger.h"
+#include "LoongFoundation/LoongLz4.h"
 #include "LoongFoundation/LoongPathUtils.h"
+#include "LoongFoundation/LoongPoolAllocator.h"
+#include "LoongFoundation/LoongRangeAllocator.h"
+#include "LoongFoundation/LoongSerializer.h"
 #include "LoongFoundation/LoongSigslotHelper.h"
 #include "LoongFoundation/LoongStringUtils.h"
+#include "LoongFoundation/LoongTransform.h"
+#include "LoongFoundation/LoongTriangleBVH.h"
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <vector>
 
+using namespace Loong;
 using namespace Loong::Foundation;
 
 class SigEmmiter {
@@ -43,6 +58,24 @@ public:
 
 void TestPathUtils();
 
+void TestAABBTree();
+
+void TestRangeAllocator();
+
+void TestJobSystem();
+
+void TestTransformHierarchy();
+
+void TestCullingKernels();
+
+void TestPoolAllocator();
+
+void TestSerializer();
+
+void TestLz4();
+
+void TestTriangleBVH();
+
 int main(int argc, const char* argv[])
 {
     LogWriter writer;
@@ -64,6 +97,24 @@ int main(int argc, const char* argv[])
 
     TestPathUtils();
 
+    TestAABBTree();
+
+    TestRangeAllocator();
+
+    TestJobSystem();
+
+    TestTransformHierarchy();
+
+    TestCullingKernels();
+
+    TestPoolAllocator();
+
+    TestSerializer();
+
+    TestLz4();
+
+    TestTriangleBVH();
+
     return 0;
 }
 
@@ -94,4 +145,565 @@ void TestPathUtils()
 #else
     assert(LoongPathUtils::GetParent("/a") == "/");
 #endif
-}
\ No newline at end of file
+}
+
+void TestAABBTree()
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-100.0F, 100.0F);
+    std::uniform_real_distribution<float> extent(0.1F, 5.0F);
+    auto randomBox = [&]() {
+        Math::Vector3 center { position(rng), position(rng), position(rng) };
+        Math::Vector3 half { extent(rng), extent(rng), extent(rng) };
+        return Math::AABB { center - half, center + half };
+    };
+
+    LoongAABBTree tree;
+    std::vector<Math::AABB> boxes;
+    std::vector<int32_t> proxies;
+    for (int i = 0; i < 1000; ++i) {
+        boxes.push_back(randomBox());
+        proxies.push_back(tree.Insert(boxes.back(), reinterpret_cast<void*>(intptr_t(i))));
+    }
+    for (int i = 0; i < 1000; i += 3) {
+        boxes[i] = randomBox();
+        tree.Update(proxies[i], boxes[i]);
+    }
+    for (int i = 0; i < 1000; i += 7) {
+        tree.Remove(proxies[i]);
+        proxies[i] = LoongAABBTree::kNullNode;
+    }
+    assert(tree.Validate());
+    assert(tree.GetHeight() < 32);
+
+    // Every box overlapping the query must be reported
+    Math::AABB query { Math::Vector3(-30.0F), Math::Vector3(30.0F) };
+    std::vector<bool> reported(boxes.size(), false);
+    tree.QueryAABB(query, [&](int32_t proxy) { reported[intptr_t(tree.GetUserData(proxy))] = true; });
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        if (proxies[i] != LoongAABBTree::kNullNode && boxes[i].Overlaps(query)) {
+            assert(reported[i]);
+        }
+    }
+
+    // The nearest hit along a ray
+    Math::Vector3 origin { -200.0F, 0.0F, 0.0F };
+    Math::Vector3 direction { 1.0F, 0.0F, 0.0F };
+    int32_t nearest = LoongAABBTree::kNullNode;
+    tree.QueryRay(origin, direction, 1000.0F, [&](int32_t proxy, float distance) {
+        nearest = proxy;
+        return distance;
+    });
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        if (proxies[i] == LoongAABBTree::kNullNode || nearest == LoongAABBTree::kNullNode) {
+            continue;
+        }
+        auto& fat = tree.GetFatAABB(proxies[i]);
+        if (fat.min.y <= 0.0F && 0.0F <= fat.max.y && fat.min.z <= 0.0F && 0.0F <= fat.max.z) {
+            assert(tree.GetFatAABB(nearest).min.x <= fat.min.x);
+        }
+    }
+}
+
+void TestRangeAllocator()
+{
+    LoongRangeAllocator allocator(100);
+    uint32_t a = allocator.Allocate(30);
+    uint32_t b = allocator.Allocate(30);
+    uint32_t c = allocator.Allocate(30);
+    assert(a == 0 && b == 30 && c == 60);
+    assert(allocator.Allocate(20) == LoongRangeAllocator::kInvalidOffset);
+    assert(allocator.GetFreeSize() == 10);
+
+    // Freed ranges are merged with their neighbors
+    allocator.Free(a, 30);
+    allocator.Free(c, 30);
+    assert(allocator.GetFreeRangeCount() == 2);
+    allocator.Free(b, 30);
+    assert(allocator.GetFreeRangeCount() == 1);
+    assert(allocator.GetLargestFreeRange() == 100);
+
+    // First fit
+    a = allocator.Allocate(10);
+    b = allocator.Allocate(10);
+    allocator.Free(a, 10);
+    assert(allocator.Allocate(5) == a);
+    assert(allocator.Allocate(10) == b + 10);
+
+    allocator.Grow(200);
+    assert(allocator.GetCapacity() == 200);
+    assert(allocator.Allocate(150) == b + 20);
+    assert(allocator.GetUsedSize() == 175);
+
+    allocator.Reset(0);
+    assert(allocator.Allocate(1) == LoongRangeAllocator::kInvalidOffset);
+    assert(allocator.Allocate(0) == 0);
+}
+
+void TestJobSystem()
+{
+    auto testParallelFor = []() {
+        std::vector<uint32_t> values(10000, 0);
+        LoongJobSystem::ParallelFor(0, uint32_t(values.size()), 64, [&values](uint32_t first, uint32_t last) {
+            for (uint32_t i = first; i < last; ++i) {
+                values[i] += i;
+            }
+        });
+        for (uint32_t i = 0; i < values.size(); ++i) {
+            assert(values[i] == i);
+        }
+    };
+
+    // Inline without workers
+    testParallelFor();
+
+    LoongJobSystem::Initialize(3);
+    assert(LoongJobSystem::GetWorkerCount() == 3);
+    testParallelFor();
+
+    // Dependencies, and jobs scheduled by jobs
+    std::atomic<uint32_t> produced { 0 };
+    std::atomic<uint32_t> consumed { 0 };
+    LoongJobCounter producers;
+    LoongJobCounter consumers;
+    for (int i = 0; i < 100; ++i) {
+        LoongJobSystem::Schedule([&]() {
+            LoongJobSystem::Schedule([&]() { ++produced; }, &producers);
+            ++produced;
+        },
+            &producers);
+    }
+    LoongJobSystem::Schedule([&]() { consumed = produced.load(); }, &consumers, &producers);
+    LoongJobSystem::Wait(consumers);
+    assert(producers.IsDone());
+    assert(consumed == 200);
+
+    // Main thread jobs, which Wait() runs on the main thread
+    bool isOnMainThread = false;
+    LoongJobCounter mainThreadJobs;
+    LoongJobSystem::Schedule([]() {}, &producers);
+    LoongJobSystem::ScheduleOnMainThread([&]() { isOnMainThread = LoongJobSystem::IsMainThread(); }, &mainThreadJobs, &producers);
+    LoongJobSystem::Wait(mainThreadJobs);
+    assert(isOnMainThread);
+
+    LoongJobSystem::Uninitialize();
+    assert(LoongJobSystem::GetWorkerCount() == 0);
+}
+
+void TestTransformHierarchy()
+{
+    auto isNear = [](const Math::Vector3& a, const Math::Vector3& b) {
+        return Math::Distance(a, b) < 1e-4F;
+    };
+    auto& hierarchy = LoongTransformHierarchy::GetDefault();
+    uint32_t count = hierarchy.GetCount();
+    {
+        Transform parent;
+        Transform child;
+        child.SetParent(&parent);
+        child.SetPosition({ 1.0F, 0.0F, 0.0F });
+        parent.SetPosition({ 0.0F, 2.0F, 0.0F });
+        parent.SetScale({ 2.0F, 2.0F, 2.0F });
+        assert(isNear(child.GetWorldPosition(), { 2.0F, 2.0F, 0.0F }));
+        assert(isNear(child.GetWorldScale(), { 2.0F, 2.0F, 2.0F }));
+
+        // A change of the parent is seen by the child, the version only changes once it is
+        uint64_t version = child.GetWorldVersion();
+        hierarchy.Update();
+        assert(child.GetWorldVersion() == version);
+        parent.SetPosition({ 0.0F, 3.0F, 0.0F });
+        hierarchy.Update();
+        assert(child.GetWorldVersion() > version);
+        assert(isNear(child.GetWorldPosition(), { 2.0F, 3.0F, 0.0F }));
+
+        // Reparenting keeps the world transform
+        child.SetParent(nullptr);
+        assert(child.GetParent() == nullptr);
+        assert(isNear(child.GetPosition(), { 2.0F, 3.0F, 0.0F }));
+        child.SetParent(&parent);
+        assert(child.GetParent() == &parent);
+        assert(isNear(child.GetPosition(), { 1.0F, 0.0F, 0.0F }));
+
+        {
+            Transform grandChild;
+            grandChild.SetParent(&child);
+            hierarchy.Update();
+            assert(isNear(grandChild.GetWorldPosition(), { 0.0F, 0.0F, 0.0F }));
+            grandChild.SetPosition({ 0.0F, 0.0F, 0.0F });
+            hierarchy.Update();
+            assert(isNear(grandChild.GetWorldPosition(), { 2.0F, 3.0F, 0.0F }));
+        }
+        assert(hierarchy.GetCount() == count + 2);
+
+        // The ids are kept when more transforms are created, unlike the references
+        uint32_t childId = child.GetID();
+        {
+            std::vector<std::unique_ptr<Transform>> others;
+            for (int i = 0; i < 64; ++i) {
+                others.push_back(std::make_unique<Transform>());
+            }
+        }
+        assert(child.GetID() == childId);
+        assert(isNear(Math::Vector3 { hierarchy.GetWorldMatrix(childId)[3] }, { 2.0F, 3.0F, 0.0F }));
+
+        // Only the watched transforms whose world matrices changed are reported, once each
+        uint32_t watcher = hierarchy.CreateWatcher();
+        std::vector<Transform*> changed;
+        child.SetWatcher(watcher);
+        hierarchy.Update();
+        hierarchy.TakeChanged(watcher, changed);
+        assert(changed.empty());
+        parent.SetPosition({ 0.0F, 4.0F, 0.0F });
+        hierarchy.Update();
+        parent.SetPosition({ 0.0F, 5.0F, 0.0F });
+        hierarchy.Update();
+        hierarchy.TakeChanged(watcher, changed);
+        assert(changed.size() == 1 && changed[0] == &child);
+        hierarchy.TakeChanged(watcher, changed);
+        assert(changed.empty());
+        child.SetPosition({ 1.0F, 1.0F, 0.0F });
+        child.SetWatcher(0);
+        hierarchy.Update();
+        hierarchy.TakeChanged(watcher, changed);
+        assert(changed.empty());
+        child.SetWatcher(watcher);
+        hierarchy.DestroyWatcher(watcher);
+        assert(child.GetWatcher() == 0);
+    }
+    assert(hierarchy.GetCount() == count);
+}
+
+void TestCullingKernels()
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-50.0F, 50.0F);
+    std::uniform_real_distribution<float> extent(0.1F, 5.0F);
+    std::uniform_real_distribution<float> angle(0.0F, 3.14F);
+
+    // Not a multiple of the vector widths, so that the scalar tails are tested too
+    constexpr size_t kCount = 1000 + 3;
+    LoongBoxArray boxes;
+    LoongSphereArray spheres;
+    boxes.Resize(kCount);
+    spheres.Resize(kCount);
+    std::vector<Math::AABB> aabbs;
+    std::vector<Math::Matrix4> matrices;
+    for (size_t i = 0; i < kCount; ++i) {
+        Math::Vector3 center { position(rng), position(rng), position(rng) };
+        Math::Vector3 half { extent(rng), extent(rng), extent(rng) };
+        aabbs.push_back(Math::AABB { center - half, center + half });
+        boxes.Set(i, aabbs.back());
+        spheres.Set(i, center, half.x);
+        matrices.push_back(Math::Translate(Math::Vector3 { position(rng), 0.0F, 0.0F }) * Math::Rotate(Math::kUp, angle(rng)));
+    }
+
+    Frustum frustum;
+    frustum.Reset(Math::Perspective(Math::DegreeToRad(60.0F), 1.0F, 0.1F, 100.0F) * Math::LookAt(Math::Vector3 { 0.0F, 0.0F, 40.0F }, Math::Zero, Math::kUp));
+
+    auto isNear = [](const Math::AABB& a, const Math::AABB& b) {
+        return Math::Distance(a.min, b.min) < 1e-3F && Math::Distance(a.max, b.max) < 1e-3F;
+    };
+    auto supported = LoongCullingKernels::GetSupportedInstructionSet();
+    std::vector<uint32_t> expectedBoxMask;
+    std::vector<uint32_t> expectedSphereMask;
+    for (auto instructionSet : { LoongCullingKernels::InstructionSet::kScalar, LoongCullingKernels::InstructionSet::kSSE2, LoongCullingKernels::InstructionSet::kAVX2 }) {
+        if (instructionSet > supported) {
+            break;
+        }
+        LoongCullingKernels::SetInstructionSet(instructionSet);
+
+        LoongBoxArray transformed;
+        LoongCullingKernels::TransformBoxes(boxes, matrices[0], transformed);
+        for (size_t i = 0; i < kCount; ++i) {
+            assert(isNear(transformed.Get(i), aabbs[i].Transformed(matrices[0])));
+        }
+        LoongCullingKernels::TransformBoxes(boxes, matrices.data(), transformed);
+        for (size_t i = 0; i < kCount; ++i) {
+            assert(isNear(transformed.Get(i), aabbs[i].Transformed(matrices[i])));
+        }
+
+        std::vector<uint32_t> boxMask;
+        LoongCullingKernels::TestBoxes(frustum, boxes, boxMask);
+        for (size_t i = 0; i < kCount; ++i) {
+            uint32_t planeMask = Frustum::kAllPlanesMask;
+            bool isVisible = frustum.ClassifyBox(aabbs[i], planeMask) != Frustum::Containment::kOutside;
+            assert(LoongCullingKernels::IsVisible(boxMask, i) == isVisible);
+        }
+        std::vector<uint32_t> sphereMask;
+        LoongCullingKernels::TestSpheres(frustum, spheres, sphereMask);
+
+        // All the paths agree with the scalar one
+        if (instructionSet == LoongCullingKernels::InstructionSet::kScalar) {
+            expectedBoxMask = boxMask;
+            expectedSphereMask = sphereMask;
+        }
+        assert(boxMask == expectedBoxMask);
+        assert(sphereMask == expectedSphereMask);
+    }
+    LoongCullingKernels::SetInstructionSet(supported);
+}
+
+void TestPoolAllocator()
+{
+    LoongPoolAllocator allocator(20, 4);
+    assert(allocator.GetBlockSize() % alignof(std::max_align_t) == 0);
+
+    // Handed out in address order
+    std::vector<void*> blocks;
+    for (int i = 0; i < 6; ++i) {
+        blocks.push_back(allocator.Allocate());
+        assert(reinterpret_cast<uintptr_t>(blocks.back()) % alignof(std::max_align_t) == 0);
+    }
+    assert(static_cast<uint8_t*>(blocks[1]) == static_cast<uint8_t*>(blocks[0]) + allocator.GetBlockSize());
+    assert(allocator.GetChunkCount() == 2);
+    assert(allocator.GetAllocatedCount() == 6);
+
+    // The last freed is the first reused
+    allocator.Free(blocks[2]);
+    allocator.Free(blocks[4]);
+    assert(allocator.Allocate() == blocks[4]);
+    assert(allocator.Allocate() == blocks[2]);
+    assert(allocator.GetChunkCount() == 2);
+
+    for (auto* block : blocks) {
+        allocator.Free(block);
+    }
+    assert(allocator.GetAllocatedCount() == 0);
+}
+
+struct SerializerItem {
+    static constexpr uint32_t kArchiveTag = 0x4D455449; // "ITEM"
+    static constexpr uint32_t kArchiveVersion = 2;
+
+    std::string name;
+    std::vector<Math::Vector3> points;
+    uint32_t count { 0 }; // since version 2
+
+    template <class Archive>
+    bool Serialize(Archive& archive)
+    {
+        return archive(name, points) && (archive.GetVersion() < 2 || archive(count));
+    }
+};
+
+// Version 1 of SerializerItem, which doesn't know count
+struct SerializerItemV1 {
+    static constexpr uint32_t kArchiveTag = SerializerItem::kArchiveTag;
+    static constexpr uint32_t kArchiveVersion = 1;
+
+    std::string name;
+    std::vector<Math::Vector3> points;
+
+    template <class Archive>
+    bool Serialize(Archive& archive) { return archive(name, points); }
+};
+
+struct SerializerUnknown {
+    static constexpr uint32_t kArchiveTag = 0x4B4E4E55; // "UNNK"
+    static constexpr uint32_t kArchiveVersion = 1;
+
+    std::vector<uint16_t> data { 1, 2, 3 };
+
+    template <class Archive>
+    bool Serialize(Archive& archive) { return archive(data); }
+};
+
+struct SerializerDocument {
+    static constexpr uint32_t kArchiveTag = 0x434F444C; // "LDOC"
+    static constexpr uint32_t kArchiveVersion = 1;
+
+    SerializerUnknown unknown;
+    SerializerItem item;
+
+    template <class Archive>
+    bool Serialize(Archive& archive) { return archive.Section(unknown) && archive.Section(item); }
+};
+
+struct SerializerDocumentV1 {
+    static constexpr uint32_t kArchiveTag = SerializerDocument::kArchiveTag;
+    static constexpr uint32_t kArchiveVersion = 1;
+
+    SerializerItemV1 item;
+
+    template <class Archive>
+    bool Serialize(Archive& archive) { return archive.Section(item); }
+};
+
+// Counts the calls to check the arrays are written in bulk
+struct CountingOutputStream : public LoongMemoryOutputStream {
+    bool operator()(void* d, size_t l)
+    {
+        ++callCount;
+        return LoongMemoryOutputStream::operator()(d, l);
+    }
+    int callCount { 0 };
+};
+
+void TestSerializer()
+{
+    // Little endian
+    uint32_t value = 0x01020304;
+    LoongMemoryOutputStream valueStream;
+    assert(Serialize(value, valueStream));
+    assert((valueStream.GetData() == std::vector<uint8_t> { 4, 3, 2, 1 }));
+
+    // The size and the elements
+    std::vector<Math::Vector3> points(1000, Math::Vector3 { 1.0F, 2.0F, 3.0F });
+    CountingOutputStream pointStream;
+    assert(Serialize(points, pointStream));
+    assert(pointStream.callCount == 2);
+    assert(pointStream.GetData().size() == sizeof(uint32_t) + points.size() * sizeof(Math::Vector3));
+
+    // Corrupted sizes are rejected before allocating
+    std::vector<uint8_t> corrupted { 0xFF, 0xFF, 0xFF, 0x7F, 0, 0, 0, 0 };
+    LoongMemoryInputStream corruptedStream(corrupted.data(), corrupted.size());
+    std::vector<Math::Vector3> corruptedPoints;
+    assert(!Serialize(corruptedPoints, corruptedStream));
+
+    // The old reader skips the unknown section and the appended data
+    SerializerDocument document;
+    document.item = { "item", points, 42 };
+    LoongMemoryOutputStream documentStream;
+    assert(SerializeArchive(document, documentStream));
+
+    SerializerDocumentV1 documentV1;
+    LoongMemoryInputStream documentV1Stream(documentStream.GetData().data(), documentStream.GetData().size());
+    assert(SerializeArchive(documentV1, documentV1Stream));
+    assert(documentV1Stream.GetRemaining() == 0);
+    assert(documentV1.item.name == "item" && documentV1.item.points == points);
+
+    // The new reader doesn't read what the old writer doesn't write
+    LoongMemoryOutputStream itemV1Stream;
+    Internal::ArchiveHelper<LoongMemoryOutputStream> itemV1Archive(itemV1Stream);
+    assert(itemV1Archive.Section(documentV1.item));
+    SerializerItem item;
+    item.count = 7;
+    LoongMemoryInputStream itemStream(itemV1Stream.GetData().data(), itemV1Stream.GetData().size());
+    Internal::ArchiveHelper<LoongMemoryInputStream> itemArchive(itemStream);
+    assert(itemArchive.Section(item) && item.name == "item" && item.points == points && item.count == 7);
+
+    // Truncated archives fail
+    LoongMemoryInputStream truncatedStream(documentStream.GetData().data(), documentStream.GetData().size() - 1);
+    SerializerDocument truncated;
+    assert(!SerializeArchive(truncated, truncatedStream));
+
+    // A buffer smaller than the data
+    FILE* file = tmpfile();
+    assert(file != nullptr);
+    {
+        LoongBufferedFileOutputStream fileStream(file, 64);
+        assert(SerializeArchive(document, fileStream) && fileStream.Flush());
+    }
+    assert(uint64_t(ftell(file)) == documentStream.GetData().size());
+    rewind(file);
+    std::vector<uint8_t> fileData(documentStream.GetData().size());
+    assert(fread(fileData.data(), fileData.size(), 1, file) == 1);
+    assert(fileData == documentStream.GetData());
+    fclose(file);
+}
+
+void TestLz4()
+{
+    // Runs, repeated words, and noise that doesn't compress
+    std::vector<uint8_t> data(300000);
+    std::mt19937 random(42);
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (i < 1000) {
+            data[i] = 7;
+        } else if (i < 100000) {
+            data[i] = "Loong Engine "[i % 13];
+        } else {
+            data[i] = uint8_t(random());
+        }
+    }
+    for (size_t size : { size_t(0), size_t(5), size_t(13), size_t(1000), size_t(100000), data.size() }) {
+        std::vector<uint8_t> compressed;
+        LoongLz4::Compress(data.data(), size, compressed);
+        assert(compressed.size() <= LoongLz4::GetMaxCompressedSize(size));
+        std::vector<uint8_t> decompressed(size);
+        assert(LoongLz4::Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()));
+        assert(std::equal(decompressed.begin(), decompressed.end(), data.begin()));
+        if (size == 100000) {
+            assert(compressed.size() < size / 10);
+        }
+        if (size > 0) {
+            assert(!LoongLz4::Decompress(compressed.data(), compressed.size() - 1, decompressed.data(), decompressed.size()));
+            assert(!LoongLz4::Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size() - 1));
+        }
+    }
+}
+
+void TestTriangleBVH()
+{
+    // Two grids of quads, at z = 0 and z = -5, with the cell (x, y) made of the triangles 2 * (y * n + x) below the
+    // diagonal and 2 * (y * n + x) + 1 above it
+    constexpr uint32_t n = 16;
+    std::vector<Math::Vector3> vertices;
+    std::vector<uint32_t> indices;
+    for (float z : { 0.0F, -5.0F }) {
+        auto first = uint32_t(vertices.size());
+        for (uint32_t y = 0; y <= n; ++y) {
+            for (uint32_t x = 0; x <= n; ++x) {
+                vertices.emplace_back(float(x), float(y), z);
+            }
+        }
+        for (uint32_t y = 0; y < n; ++y) {
+            for (uint32_t x = 0; x < n; ++x) {
+                uint32_t v00 = first + y * (n + 1) + x;
+                uint32_t v10 = v00 + 1;
+                uint32_t v01 = v00 + n + 1;
+                uint32_t v11 = v01 + 1;
+                indices.insert(indices.end(), { v00, v10, v11, v00, v11, v01 });
+            }
+        }
+    }
+
+    LoongTriangleBVH bvh;
+    bvh.Build(vertices.data(), sizeof(Math::Vector3), vertices.size(), indices.data(), indices.size());
+    assert(!bvh.IsEmpty());
+    assert(bvh.GetTriangleCount() == 4 * n * n);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coordinate(0.0F, float(n));
+    for (int i = 0; i < 1000; ++i) {
+        float x = coordinate(rng);
+        float y = coordinate(rng);
+        if (std::abs((x - std::floor(x)) - (y - std::floor(y))) < 1e-3F) {
+            continue;
+        }
+        uint32_t cell = uint32_t(y) * n + uint32_t(x);
+        uint32_t expected = 2 * cell + (x - std::floor(x) >= y - std::floor(y) ? 0 : 1);
+
+        // The nearest of the two grids, from both sides
+        LoongTriangleBVH::RaycastHit hit {};
+        assert(bvh.Raycast({ x, y, 10.0F }, { 0.0F, 0.0F, -2.0F }, 100.0F, hit));
+        assert(std::abs(hit.distance - 5.0F) < 1e-4F);
+        assert(hit.triangleIndex == expected);
+        assert(std::abs(std::abs(hit.normal.z) - 1.0F) < 1e-4F);
+        assert(bvh.Raycast({ x, y, -10.0F }, { 0.0F, 0.0F, 1.0F }, 100.0F, hit));
+        assert(std::abs(hit.distance - 5.0F) < 1e-4F);
+        assert(hit.triangleIndex == expected + 2 * n * n);
+
+        // Clipped by the max distance
+        assert(!bvh.Raycast({ x, y, 10.0F }, { 0.0F, 0.0F, -1.0F }, 9.0F, hit));
+    }
+
+    // Missing the grids
+    LoongTriangleBVH::RaycastHit hit {};
+    assert(!bvh.Raycast({ -1.0F, 1.0F, 10.0F }, { 0.0F, 0.0F, -1.0F }, 100.0F, hit));
+    assert(!bvh.Raycast({ 1.0F, 1.0F, 10.0F }, { 0.0F, 0.0F, 1.0F }, 100.0F, hit));
+    assert(!bvh.Raycast({ 1.0F, 1.0F, 10.0F }, { 1.0F, 0.0F, 0.0F }, 100.0F, hit));
+
+    // The same triangles from 16 bits indices
+    std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+    LoongTriangleBVH shortBvh;
+    shortBvh.Build(vertices.data(), sizeof(Math::Vector3), vertices.size(), shortIndices.data(), sizeof(uint16_t), shortIndices.size());
+    assert(shortBvh.GetTriangleCount() == bvh.GetTriangleCount());
+    assert(shortBvh.GetMemorySize() > 0);
+    assert(shortBvh.Raycast({ 2.75F, 3.25F, 10.0F }, { 0.0F, 0.0F, -1.0F }, 100.0F, hit));
+    assert(hit.triangleIndex == 2 * (3 * n + 2));
+
+    bvh.Clear();
+    assert(bvh.IsEmpty());
+    assert(!bvh.Raycast({ 1.0F, 1.0F, 10.0F }, { 0.0F, 0.0F, -1.0F }, 100.0F, hit));
+}
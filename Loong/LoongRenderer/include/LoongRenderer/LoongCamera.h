@@ -27,6 +27,10 @@ public:
 
     const Foundation::Frustum& GetFrustum() const { return frustum_; }
 
+    // The size in pixels on the viewport of one unit at one unit away from the camera, a length l at distance d is
+    // about l / d * GetPixelsPerUnit() pixels
+    float GetPixelsPerUnit() const { return pixelsPerUnit_; }
+
     // radian
     void SetFov(float value) { fov_ = value; }
 
@@ -47,6 +51,7 @@ private:
     Foundation::Frustum frustum_ {};
     Math::Matrix4 viewMatrix_ {};
     Math::Matrix4 projectionMatrix_ {};
+    float pixelsPerUnit_ { 1.0F };
 
     float fov_ { Math::DegreeToRad(45.0F) };
     float near_ { 0.1F };
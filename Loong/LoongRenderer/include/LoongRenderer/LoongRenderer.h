@@ -4,6 +4,7 @@
 #pragma once
 #include <glad/glad.h>
 
+#include "LoongFoundation/LoongCullingKernels.h"
 #include "LoongFoundation/LoongMath.h"
 #include "LoongResource/LoongPipelineFixedState.h"
 #include <cstdint>
@@ -25,16 +26,30 @@ class LoongCamera;
 
 class LoongRenderer {
 public:
+    // One non instanced draw of MultiDraw()
+    struct DrawItem {
+        const Resource::LoongGpuMesh* mesh { nullptr };
+        uint32_t lod { 0 };
+    };
+
     struct FrameInfo {
         uint64_t batchCount { 0 };
         uint64_t instanceCount { 0 };
         uint64_t polyCount { 0 };
+        uint64_t visibleMeshCount { 0 };
+        uint64_t culledMeshCount { 0 };
+        uint64_t stateChangeCount { 0 }; // state changes and bindings sent to the driver
+        uint64_t redundantStateChangeCount { 0 }; // state changes and bindings dropped by the state cache
 
         void Clear()
         {
             batchCount = 0;
             instanceCount = 0;
             polyCount = 0;
+            visibleMeshCount = 0;
+            culledMeshCount = 0;
+            stateChangeCount = 0;
+            redundantStateChangeCount = 0;
         }
     };
 
@@ -167,21 +182,37 @@ public:
 
     void ClearFrameInfo();
 
-    void Draw(const Resource::LoongGpuMesh& mesh, PrimitiveMode primitiveMode = PrimitiveMode::kTriangles, uint32_t instances = 1);
+    void Draw(const Resource::LoongGpuMesh& mesh, PrimitiveMode primitiveMode = PrimitiveMode::kTriangles, uint32_t instances = 1, uint32_t lod = 0);
+
+    // Draw the meshes with one call, they must share a mesh arena (see LoongGpuMesh::GetArena) and the indexed draws
+    // only, it counts as one batch
+    void MultiDraw(const DrawItem* items, size_t count, PrimitiveMode primitiveMode = PrimitiveMode::kTriangles);
 
     std::vector<Resource::LoongGpuMesh*> GetMeshesInFrustum(const Resource::LoongGpuModel& model, const Foundation::Transform& modelTransform, const Foundation::Frustum& frustum);
 
     std::vector<Resource::LoongGpuMesh*> GetMeshesInFrustum(const Resource::LoongGpuModel& model, const Math::Matrix4& modelTransform, const Foundation::Frustum& frustum);
 
+    // Record how many meshes passed or failed the visibility test, for statistics only
+    void AddCullingResult(uint64_t visibleMeshCount, uint64_t culledMeshCount);
+
+    // NOTE: Only the first call queries the driver, the state is tracked by the renderer after that
     Resource::LoongPipelineFixedState FetchGLState();
 
     void ApplyStateMask(Resource::LoongPipelineFixedState mask);
 
-    const FrameInfo& GetFrameInfo() const;
+    FrameInfo GetFrameInfo() const;
 
 private:
     FrameInfo frameInfo_;
+    // Reused by MultiDraw
+    std::vector<GLsizei> multiDrawCounts_ {};
+    std::vector<const GLvoid*> multiDrawOffsets_ {};
+    std::vector<GLint> multiDrawBaseVertices_ {};
+    // Reused by GetMeshesInFrustum
+    Foundation::LoongBoxArray meshBounds_ {};
+    std::vector<uint32_t> meshVisibleMask_ {};
     Resource::LoongPipelineFixedState state_;
+    bool isStateFetched_ { false };
 };
 
 }
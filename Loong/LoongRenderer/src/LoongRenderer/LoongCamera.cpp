@@ -16,6 +16,7 @@ void LoongCamera::UpdateProjectionMatrix(uint32_t viewportWidth, uint32_t viewpo
 {
     // TODO: alternative ortho projection
     projectionMatrix_ = Math::Perspective(fov_, float(viewportWidth), float(viewportHeight), near_, far_);
+    pixelsPerUnit_ = projectionMatrix_[1][1] * float(viewportHeight) * 0.5F;
 }
 
 void LoongCamera::UpdateViewMatrix(const Math::Vector3& position, const Math::Quat& rotation)
@@ -2,10 +2,12 @@
 // Copyright (c) 2020 Carl Chen. All rights reserved.
 //
 #include "LoongRenderer/LoongRenderer.h"
+#include "LoongFoundation/LoongCullingKernels.h"
 #include "LoongFoundation/LoongFrustum.h"
 #include "LoongFoundation/LoongMath.h"
 #include "LoongFoundation/LoongTransform.h"
 #include "LoongRenderer/LoongCamera.h"
+#include "LoongResource/LoongGLStateCache.h"
 #include "LoongResource/LoongGpuMesh.h"
 #include "LoongResource/LoongGpuModel.h"
 
@@ -13,7 +15,7 @@ namespace Loong::Renderer {
 
 void LoongRenderer::SetClearColor(float r, float g, float b, float a)
 {
-    glClearColor(r, g, b, a);
+    Resource::LoongGLStateCache::SetClearColor(r, g, b, a);
 }
 
 void LoongRenderer::Clear(bool colorBuffer, bool depthBuffer, bool stencilBuffer)
@@ -28,7 +30,7 @@ void LoongRenderer::Clear(bool colorBuffer, bool depthBuffer, bool stencilBuffer
 void LoongRenderer::Clear(const LoongCamera& camera, bool colorBuffer, bool depthBuffer, bool stencilBuffer)
 {
     GLfloat previousClearColor[4];
-    glGetFloatv(GL_COLOR_CLEAR_VALUE, previousClearColor);
+    Resource::LoongGLStateCache::GetClearColor(previousClearColor);
 
     const auto& cameraClearColor = camera.GetClearColor();
     SetClearColor(cameraClearColor.x, cameraClearColor.y, cameraClearColor.z, 1.0f);
@@ -44,12 +46,22 @@ void LoongRenderer::SetLineWidth(float width)
 
 void LoongRenderer::SetPolygonMode(LoongRenderer::PolygonMode mode)
 {
-    glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(mode));
+    Resource::LoongGLStateCache::SetPolygonMode(static_cast<GLenum>(mode));
 }
 
 void LoongRenderer::SetCapability(LoongRenderer::Capability capability, bool value)
 {
+    ++frameInfo_.stateChangeCount;
     (value ? glEnable : glDisable)(static_cast<GLenum>(capability));
+
+    // clang-format off
+    switch (capability) {
+    case Capability::kBlend:        state_.SetBlendEnabled(value); break;
+    case Capability::kCullFace:     state_.SetFaceCullEnabled(value); break;
+    case Capability::kDepthTest:    state_.SetDepthTestEnabled(value); break;
+    default:                        break;
+    }
+    // clang-format on
 }
 
 bool LoongRenderer::IsCapabilityEnabled(LoongRenderer::Capability capability) const
@@ -64,7 +76,7 @@ void LoongRenderer::SetStencilAlgorithm(LoongRenderer::ComparisonAlgorithm algor
 
 void LoongRenderer::SetDepthAlgorithm(LoongRenderer::ComparisonAlgorithm algorithm)
 {
-    glDepthFunc(static_cast<GLenum>(algorithm));
+    Resource::LoongGLStateCache::SetDepthFunc(static_cast<GLenum>(algorithm));
 }
 
 void LoongRenderer::SetStencilMask(uint32_t mask)
@@ -79,17 +91,26 @@ void LoongRenderer::SetStencilOperations(LoongRenderer::Operation stencilFail, L
 
 void LoongRenderer::SetCullFace(LoongRenderer::CullMode cullMode)
 {
+    ++frameInfo_.stateChangeCount;
     glCullFace(static_cast<GLenum>(cullMode));
+
+    state_.SetBackCullEnabled(cullMode == CullMode::kBack);
+    state_.SetFrontCullEnabled(cullMode == CullMode::kFront);
+    state_.SetFrontAndBackCullEnabled(cullMode == CullMode::kFrontAndBack);
 }
 
 void LoongRenderer::SetDepthWriting(bool enable)
 {
+    ++frameInfo_.stateChangeCount;
     glDepthMask(enable);
+    state_.SetDepthWriteEnabled(enable);
 }
 
 void LoongRenderer::SetColorWriting(bool enableRed, bool enableGreen, bool enableBlue, bool enableAlpha)
 {
+    ++frameInfo_.stateChangeCount;
     glColorMask(enableRed, enableGreen, enableBlue, enableAlpha);
+    state_.SetColorWriteEnabled(enableRed);
 }
 
 void LoongRenderer::SetColorWriting(bool enable)
@@ -182,38 +203,70 @@ std::string LoongRenderer::GetString(GLenum parameter, uint32_t index)
 void LoongRenderer::ClearFrameInfo()
 {
     frameInfo_.Clear();
+    Resource::LoongGLStateCache::ResetCounters();
 }
 
-void LoongRenderer::Draw(const Resource::LoongGpuMesh& mesh, LoongRenderer::PrimitiveMode primitiveMode, uint32_t instances)
+void LoongRenderer::Draw(const Resource::LoongGpuMesh& mesh, LoongRenderer::PrimitiveMode primitiveMode, uint32_t instances, uint32_t lod)
 {
-    if (instances <= 0) {
+    // Meshes are always indexed ranges of their arenas, a mesh whose arena allocation failed has no indices
+    const auto& meshLod = mesh.GetLod(lod);
+    if (instances <= 0 || meshLod.indexCount == 0) {
         return;
     }
 
     ++frameInfo_.batchCount;
     frameInfo_.instanceCount += instances;
-    frameInfo_.polyCount += (mesh.GetIndexCount() / 3) * instances;
+    frameInfo_.polyCount += (meshLod.indexCount / 3) * instances;
 
     mesh.Bind();
 
-    if (mesh.GetIndexCount() > 0) {
-        /* With EBO */
-        if (instances == 1) {
-            glDrawElements(static_cast<GLenum>(primitiveMode), mesh.GetIndexCount(), GL_UNSIGNED_INT, nullptr);
-        } else {
-            glDrawElementsInstanced(static_cast<GLenum>(primitiveMode), mesh.GetIndexCount(), GL_UNSIGNED_INT, nullptr, instances);
-        }
+    const GLint baseVertex = GLint(mesh.GetBaseVertex());
+    auto* indexOffset = reinterpret_cast<const GLvoid*>(intptr_t(mesh.GetFirstIndex() + meshLod.indexOffset) * mesh.GetIndexSize());
+    if (instances == 1) {
+        glDrawElementsBaseVertex(static_cast<GLenum>(primitiveMode), meshLod.indexCount, mesh.GetIndexType(), indexOffset, baseVertex);
     } else {
-        /* Without EBO */
-        assert(false); // TODO
-        if (instances == 1) {
-            glDrawArrays(static_cast<GLenum>(primitiveMode), 0, mesh.GetVertexCount());
-        } else {
-            glDrawArraysInstanced(static_cast<GLenum>(primitiveMode), 0, mesh.GetVertexCount(), instances);
+        glDrawElementsInstancedBaseVertex(static_cast<GLenum>(primitiveMode), meshLod.indexCount, mesh.GetIndexType(), indexOffset, instances, baseVertex);
+    }
+
+    // NOTE: The vertex array is left bound, the next draw of the same mesh doesn't need to bind it again
+}
+
+void LoongRenderer::MultiDraw(const DrawItem* items, size_t count, LoongRenderer::PrimitiveMode primitiveMode)
+{
+    if (count == 0) {
+        return;
+    }
+    if (count == 1) {
+        Draw(*items[0].mesh, primitiveMode, 1, items[0].lod);
+        return;
+    }
+
+    multiDrawCounts_.clear();
+    multiDrawOffsets_.clear();
+    multiDrawBaseVertices_.clear();
+    const auto* arena = items[0].mesh->GetArena();
+    for (size_t i = 0; i < count; ++i) {
+        const auto& mesh = *items[i].mesh;
+        assert(mesh.GetArena() == arena);
+        const auto& meshLod = mesh.GetLod(items[i].lod);
+        if (meshLod.indexCount == 0) {
+            continue;
         }
+        multiDrawCounts_.push_back(GLsizei(meshLod.indexCount));
+        multiDrawOffsets_.push_back(reinterpret_cast<const GLvoid*>(intptr_t(mesh.GetFirstIndex() + meshLod.indexOffset) * arena->GetIndexSize()));
+        multiDrawBaseVertices_.push_back(GLint(mesh.GetBaseVertex()));
+        frameInfo_.polyCount += meshLod.indexCount / 3;
+    }
+    if (multiDrawCounts_.empty()) {
+        return;
     }
 
-    mesh.Unbind();
+    ++frameInfo_.batchCount;
+    frameInfo_.instanceCount += multiDrawCounts_.size();
+
+    arena->Bind();
+    glMultiDrawElementsBaseVertex(static_cast<GLenum>(primitiveMode), multiDrawCounts_.data(), arena->GetIndexType(), multiDrawOffsets_.data(),
+        GLsizei(multiDrawCounts_.size()), multiDrawBaseVertices_.data());
 }
 
 std::vector<Resource::LoongGpuMesh*> LoongRenderer::GetMeshesInFrustum(const Resource::LoongGpuModel& model, const Foundation::Transform& modelTransform, const Foundation::Frustum& frustum)
@@ -230,24 +283,37 @@ std::vector<Resource::LoongGpuMesh*> LoongRenderer::GetMeshesInFrustum(const Res
         return {};
     }
 
-    std::vector<Resource::LoongGpuMesh*> result;
-
     const auto& meshes = model.GetMeshes();
 
-    for (auto mesh : meshes) {
-        // Do not check if the mesh is in frustum if the model has only one mesh, because model and mesh bounding sphere are equals
-        auto meshAabb = mesh->GetAABB().Transformed(transformMatrix);
+    // Do not check if the mesh is in frustum if the model has only one mesh, because model and mesh bounding sphere are equals
+    if (meshes.size() == 1) {
+        return meshes;
+    }
+
+    Foundation::LoongCullingKernels::TransformBoxes(model.GetMeshBounds(), transformMatrix, meshBounds_);
+    Foundation::LoongCullingKernels::TestBoxes(frustum, meshBounds_, meshVisibleMask_);
 
-        if (meshes.size() == 1 || frustum.IsBoxVisible(meshAabb)) {
-            result.push_back(mesh);
+    std::vector<Resource::LoongGpuMesh*> result;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        if (Foundation::LoongCullingKernels::IsVisible(meshVisibleMask_, i)) {
+            result.push_back(meshes[i]);
         }
     }
-
     return result;
 }
 
+void LoongRenderer::AddCullingResult(uint64_t visibleMeshCount, uint64_t culledMeshCount)
+{
+    frameInfo_.visibleMeshCount += visibleMeshCount;
+    frameInfo_.culledMeshCount += culledMeshCount;
+}
+
 Resource::LoongPipelineFixedState LoongRenderer::FetchGLState()
 {
+    if (isStateFetched_) {
+        return state_;
+    }
+
     Resource::LoongPipelineFixedState result;
 
     // clang-format off
@@ -267,11 +333,17 @@ Resource::LoongPipelineFixedState LoongRenderer::FetchGLState()
     }
     // clang-format on
 
+    state_ = result;
+    isStateFetched_ = true;
     return result;
 }
 
 void LoongRenderer::ApplyStateMask(Resource::LoongPipelineFixedState mask)
 {
+    if (!isStateFetched_) {
+        FetchGLState();
+    }
+
     auto diffrence = mask ^ state_;
 
     // clang-format off
@@ -291,9 +363,12 @@ void LoongRenderer::ApplyStateMask(Resource::LoongPipelineFixedState mask)
     state_ = mask;
 }
 
-const LoongRenderer::FrameInfo& LoongRenderer::GetFrameInfo() const
+LoongRenderer::FrameInfo LoongRenderer::GetFrameInfo() const
 {
-    return frameInfo_;
+    FrameInfo result = frameInfo_;
+    result.stateChangeCount += Resource::LoongGLStateCache::GetStateChangeCount();
+    result.redundantStateChangeCount += Resource::LoongGLStateCache::GetRedundantStateChangeCount();
+    return result;
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+namespace Loong::Resource {
+
+// A shadow copy of the GL binding state. All the resource bind calls go through it, the calls that would not change
+// the GL state are dropped. The cached state is only valid as long as nobody else changes the GL state, call
+// Invalidate() after the state is touched by raw GL calls (e.g. third party libraries, or the application's own clear).
+class LoongGLStateCache {
+public:
+    static constexpr uint32_t kMaxTextureUnits = 32;
+    static constexpr uint32_t kMaxUniformBufferBindings = 36; // GL_MAX_UNIFORM_BUFFER_BINDINGS is at least 36 in GL 3.3
+
+    LoongGLStateCache() = delete;
+
+    static void UseProgram(GLuint program);
+
+    static void BindVertexArray(GLuint vertexArray);
+
+    // Bind a 2D texture to the texture unit, the active texture unit is changed to `unit`
+    static void BindTexture(uint32_t unit, GLuint texture);
+
+    // NOTE: Only GL_TEXTURE_2D and GL_TEXTURE_BUFFER are cached
+    static void BindTexture(uint32_t unit, GLenum target, GLuint texture);
+
+    // Bind a 2D texture to the active texture unit
+    static void BindTexture(GLuint texture);
+
+    // NOTE: GL_ELEMENT_ARRAY_BUFFER is part of the vertex array state, so it's always issued
+    static void BindBuffer(GLenum target, GLuint buffer);
+
+    // Only GL_UNIFORM_BUFFER is cached, it also changes the generic binding of the target
+    static void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+    static void SetClearColor(float r, float g, float b, float a);
+
+    // Query the driver if the clear color is unknown
+    static void GetClearColor(float color[4]);
+
+    static void SetPolygonMode(GLenum mode);
+
+    static void SetDepthFunc(GLenum func);
+
+    // GL unbinds the deleted objects and may reuse their names, so they have to be forgotten.
+    // NOTE: A program in use is only flagged for deletion and stays current, so there's nothing to forget for it
+    static void OnVertexArrayDeleted(GLuint vertexArray);
+
+    static void OnTextureDeleted(GLuint texture);
+
+    static void OnBufferDeleted(GLuint buffer);
+
+    // Forget all the cached state, the next call of each kind is always issued
+    static void Invalidate();
+
+    // Number of state changes sent to the driver since the last ResetCounters()
+    static uint64_t GetStateChangeCount();
+
+    // Number of state changes dropped since the last ResetCounters()
+    static uint64_t GetRedundantStateChangeCount();
+
+    static void ResetCounters();
+};
+
+}
@@ -6,6 +6,9 @@
 
 #include <glad/glad.h>
 
+#include "LoongResource/LoongGLStateCache.h"
+#include <cstddef>
+#include <cstdint>
 #include <utility>
 
 namespace Loong::Resource {
@@ -26,6 +29,7 @@ enum class LoongGpuBufferType {
     kVertexBuffer,
     kIndexBuffer,
     kUniformBuffer,
+    kTextureBuffer,
     // NOTE: Shader storage buffer requires OpenGL 4.3 which is not supported on macos by now(2020),
     // so... We don't use it now
     // kShaderStorageBuffer,
@@ -42,6 +46,9 @@ template <> struct LoongGpuBufferTypeTrait<LoongGpuBufferType::kIndexBuffer> {
 template <> struct LoongGpuBufferTypeTrait<LoongGpuBufferType::kUniformBuffer> {
     static constexpr GLenum kTargetType = GL_UNIFORM_BUFFER;
 };
+template <> struct LoongGpuBufferTypeTrait<LoongGpuBufferType::kTextureBuffer> {
+    static constexpr GLenum kTargetType = GL_TEXTURE_BUFFER;
+};
 // clang-format on
 
 template <LoongGpuBufferType BufferType>
@@ -63,6 +70,7 @@ public:
     {
         if (id_ != 0) {
             glDeleteBuffers(1, &id_);
+            LoongGLStateCache::OnBufferDeleted(id_);
             id_ = 0;
         }
     }
@@ -72,6 +80,7 @@ public:
     LoongGpuBuffer& operator=(LoongGpuBuffer&& b) noexcept
     {
         std::swap(id_, b.id_);
+        return *this;
     }
 
     bool operator!() const
@@ -87,6 +96,10 @@ public:
     template <class T>
     void BufferData(const T* data, size_t size, LoongGpuBufferUsage usage = LoongGpuBufferUsage::kStaticDraw)
     {
+        if constexpr (BufferType == LoongGpuBufferType::kIndexBuffer) {
+            // The index buffer binding is part of the vertex array state, don't touch the one which is left bound
+            LoongGLStateCache::BindVertexArray(0);
+        }
         Bind();
         glBufferData(LoongGpuBufferTypeTrait<BufferType>::kTargetType, sizeof(T) * size, data, GLenum(usage));
         Unbind();
@@ -95,19 +108,36 @@ public:
     template <typename T>
     void SetSubData(const T* data, size_t offset)
     {
+        if constexpr (BufferType == LoongGpuBufferType::kIndexBuffer) {
+            LoongGLStateCache::BindVertexArray(0);
+        }
         Bind();
         glBufferSubData(LoongGpuBufferTypeTrait<BufferType>::kTargetType, offset, sizeof(T), data);
         Unbind();
     }
 
+    // Update size bytes starting at the byte offset
+    void SetSubData(const void* data, size_t size, size_t offset)
+    {
+        if (size == 0) {
+            return;
+        }
+        if constexpr (BufferType == LoongGpuBufferType::kIndexBuffer) {
+            LoongGLStateCache::BindVertexArray(0);
+        }
+        Bind();
+        glBufferSubData(LoongGpuBufferTypeTrait<BufferType>::kTargetType, GLintptr(offset), GLsizeiptr(size), data);
+        Unbind();
+    }
+
     void Bind() const
     {
-        glBindBuffer(LoongGpuBufferTypeTrait<BufferType>::kTargetType, id_);
+        LoongGLStateCache::BindBuffer(LoongGpuBufferTypeTrait<BufferType>::kTargetType, id_);
     }
 
     void Unbind() const
     {
-        glBindBuffer(LoongGpuBufferTypeTrait<BufferType>::kTargetType, 0);
+        LoongGLStateCache::BindBuffer(LoongGpuBufferTypeTrait<BufferType>::kTargetType, 0);
     }
 
     GLuint GetID() const
@@ -127,7 +157,7 @@ public:
     void SetBindingPoint(uint32_t bindPoint, size_t size)
     {
 //        Bind();
-        glBindBufferRange(GL_UNIFORM_BUFFER, bindPoint, GetID(), 0, size);
+        LoongGLStateCache::BindBufferRange(GL_UNIFORM_BUFFER, bindPoint, GetID(), 0, size);
 //        Unbind();
     }
 };
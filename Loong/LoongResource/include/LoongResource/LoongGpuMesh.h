@@ -5,44 +5,83 @@
 #pragma once
 #include "LoongFoundation/LoongMath.h"
 #include "LoongResource/LoongGpuBuffer.h"
+#include "LoongResource/LoongGpuMeshArena.h"
 #include "LoongResource/LoongVertexArray.h"
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace Loong::Asset {
 class LoongMesh;
+class LoongModelFile;
 struct LoongVertex;
 }
 
 namespace Loong::Resource {
 
+// The vertices and indices live in a LoongGpuMeshArena shared with the other meshes of the same vertex layout and
+// index type, the indices are relative to GetBaseVertex()
 class LoongGpuMesh {
 public:
+    // A range of the index buffer, all the LODs share the same vertices
+    struct Lod {
+        uint32_t indexOffset { 0 };
+        uint32_t indexCount { 0 };
+        // The max geometric deviation from LOD 0, in the mesh's space
+        float error { 0.0F };
+    };
+
+    // The per instance data is a model matrix (mat4) followed by a normal matrix (mat4, only the upper left 3x3
+    // is used), they occupy 4 + 3 attribute locations starting from this one
+    static constexpr GLuint kInstanceAttributeLocation = 5;
+
     explicit LoongGpuMesh(const Asset::LoongMesh& mesh);
+    // Upload straight from the file, without any copy
+    LoongGpuMesh(const Asset::LoongModelFile& file, uint32_t meshIndex);
     LoongGpuMesh(const LoongGpuMesh&) = delete;
     LoongGpuMesh(LoongGpuMesh&&) = delete;
-    ~LoongGpuMesh() = default;
+    ~LoongGpuMesh();
     LoongGpuMesh& operator=(const LoongGpuMesh&) = delete;
     LoongGpuMesh& operator=(LoongGpuMesh&&) = delete;
 
-    void Bind() const { vao_.Bind(); }
-    void Unbind() const { vao_.Unbind(); }
+    void Bind() const { arena_->Bind(); }
+    void Unbind() const { arena_->GetVertexArray().Unbind(); }
+
+    // Source the per instance data from instanceBuffer, starting at the byte offset. The vertex array is shared by the
+    // arena, call UnbindInstanceAttributes after the instanced draw.
+    void BindInstanceAttributes(const LoongVertexBuffer& instanceBuffer, intptr_t offset) const;
+
+    // The non instanced draws of the arena don't read the instance buffer, which may be reallocated by then
+    void UnbindInstanceAttributes() const;
+
     uint32_t GetVertexCount() const { return verticesCount_; }
     uint32_t GetIndexCount() const { return indicesCount_; }
+    // GL_UNSIGNED_SHORT if the vertices can be indexed with 16 bits, otherwise GL_UNSIGNED_INT
+    GLenum GetIndexType() const { return arena_->GetIndexType(); }
+    uint32_t GetIndexSize() const { return arena_->GetIndexSize(); }
+    // Meshes of the same arena share the vertex array, the buffers and the attribute layout
+    const LoongGpuMeshArena* GetArena() const { return arena_.get(); }
+    // Where the mesh is in the arena, it changes when the arena grows or shrinks
+    uint32_t GetBaseVertex() const { return arena_->GetRange(allocation_).firstVertex; }
+    uint32_t GetFirstIndex() const { return arena_->GetRange(allocation_).firstIndex; }
     uint32_t GetMaterialIndex() const { return materialIndex_; }
     const Math::AABB& GetAABB() const { return aabb_; }
 
+    // LOD 0 is the full resolution mesh
+    uint32_t GetLodCount() const { return uint32_t(lods_.size()); }
+    const Lod& GetLod(uint32_t lod) const { return lods_[lod]; }
+
 private:
-    void CreateBuffers(const Asset::LoongVertex* vertices, size_t verticesCount, const uint32_t* indices, size_t indicesCount);
+    void CreateBuffers(const std::vector<Asset::LoongVertex>& vertices, const std::vector<uint32_t>& indices);
 
 private:
     const uint32_t verticesCount_ { 0 };
     const uint32_t indicesCount_ { 0 };
     const uint32_t materialIndex_ { 0 };
 
-    LoongVertexArray vao_ {};
-    std::unique_ptr<LoongVertexBuffer> vbo_ {};
-    std::unique_ptr<LoongIndexBuffer> ibo_ {};
+    std::shared_ptr<LoongGpuMeshArena> arena_ {};
+    uint32_t allocation_ { LoongGpuMeshArena::kInvalidAllocation };
+    std::vector<Lod> lods_ {};
 
     Math::AABB aabb_ {};
 };
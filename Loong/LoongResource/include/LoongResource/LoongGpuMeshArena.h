@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongFoundation/LoongRangeAllocator.h"
+#include "LoongResource/LoongGpuBuffer.h"
+#include "LoongResource/LoongVertexArray.h"
+#include <cstdint>
+#include <vector>
+
+namespace Loong::Resource {
+
+// Sub-allocates the vertices and indices of many meshes with the same vertex layout and index type from one vertex
+// buffer and one index buffer. The meshes share one vertex array, they are drawn with base vertex draws, and
+// consecutive draws can be merged into one multi draw.
+// The buffers grow when full, and are repacked when most of them is free. The ranges move then, so always look them
+// up with GetRange() instead of keeping them.
+class LoongGpuMeshArena {
+public:
+    struct Range {
+        uint32_t firstVertex { 0 };
+        uint32_t vertexCount { 0 };
+        uint32_t firstIndex { 0 };
+        uint32_t indexCount { 0 };
+    };
+
+    // Set up the vertex attributes of the vertex array, the vertex buffer is bound
+    using BindAttributesFunc = void (*)(LoongVertexArray& vao, const LoongVertexBuffer& vbo);
+
+    static constexpr uint32_t kInvalidAllocation = ~uint32_t(0);
+
+    LoongGpuMeshArena(uint32_t vertexSize, GLenum indexType, BindAttributesFunc bindAttributes);
+    LoongGpuMeshArena(const LoongGpuMeshArena&) = delete;
+    LoongGpuMeshArena(LoongGpuMeshArena&&) = delete;
+    ~LoongGpuMeshArena() = default;
+    LoongGpuMeshArena& operator=(const LoongGpuMeshArena&) = delete;
+    LoongGpuMeshArena& operator=(LoongGpuMeshArena&&) = delete;
+
+    // The vertices are vertexCount * vertex size bytes, the indices are relative to the first vertex of the mesh
+    uint32_t Allocate(const void* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount);
+
+    void Free(uint32_t allocation);
+
+    // An invalid allocation has an empty range
+    const Range& GetRange(uint32_t allocation) const;
+
+    void Bind() const { vao_.Bind(); }
+
+    const LoongVertexArray& GetVertexArray() const { return vao_; }
+
+    uint32_t GetVertexSize() const { return vertexSize_; }
+
+    GLenum GetIndexType() const { return indexType_; }
+
+    uint32_t GetIndexSize() const { return indexType_ == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t); }
+
+    uint32_t GetVertexCapacity() const { return vertexAllocator_.GetCapacity(); }
+
+    uint32_t GetIndexCapacity() const { return indexAllocator_.GetCapacity(); }
+
+private:
+    // Copy all the live ranges to the front of new buffers with the capacities
+    void Repack(uint32_t vertexCapacity, uint32_t indexCapacity);
+
+    void ShrinkIfSparse();
+
+    const uint32_t vertexSize_ { 0 };
+    const GLenum indexType_ { GL_UNSIGNED_INT };
+    const BindAttributesFunc bindAttributes_ { nullptr };
+
+    LoongVertexArray vao_ {};
+    LoongVertexBuffer vbo_ {};
+    LoongIndexBuffer ibo_ {};
+    Foundation::LoongRangeAllocator vertexAllocator_ {};
+    Foundation::LoongRangeAllocator indexAllocator_ {};
+
+    std::vector<Range> ranges_ {};
+    std::vector<uint8_t> isAlive_ {};
+    std::vector<uint32_t> freeAllocations_ {};
+};
+
+}
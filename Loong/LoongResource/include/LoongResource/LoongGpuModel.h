@@ -4,12 +4,17 @@
 
 #pragma once
 
+#include "LoongFoundation/LoongCullingKernels.h"
 #include "LoongFoundation/LoongMath.h"
+#include "LoongFoundation/LoongTriangleBVH.h"
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace Loong::Asset {
 class LoongModel;
+class LoongModelFile;
 }
 
 namespace Loong::Resource {
@@ -18,7 +23,18 @@ class LoongGpuMesh;
 
 class LoongGpuModel {
 public:
-    explicit LoongGpuModel(const Asset::LoongModel& model, const std::string& path);
+    struct RaycastHit {
+        // In units of the ray direction length
+        float distance { 0.0F };
+        uint32_t meshIndex { 0 };
+        uint32_t triangleIndex { 0 };
+        // In the model space
+        Math::Vector3 normal {};
+    };
+
+    // The sources are kept until the triangle BVHs are built from them, see Raycast
+    explicit LoongGpuModel(std::shared_ptr<const Asset::LoongModel> model, const std::string& path);
+    explicit LoongGpuModel(std::shared_ptr<const Asset::LoongModelFile> file, const std::string& path);
     LoongGpuModel(const LoongGpuModel&) = delete;
     LoongGpuModel(LoongGpuModel&) = delete;
     ~LoongGpuModel();
@@ -29,14 +45,56 @@ public:
     const std::vector<std::string>& GetMaterialNames() const { return materialNames_; }
     const Math::AABB GetAABB() const { return aabb_; }
 
+    // The AABBs of the meshes, for the batch culling kernels
+    const Foundation::LoongBoxArray& GetMeshBounds() const { return meshBounds_; }
+
     const std::string& GetPath() const { return path_; }
 
+    // Ray cast against the triangles in the model space, the GPU is not touched. The first call starts a job building
+    // the triangle BVHs from the source vertices in place, until it is done the bounds of the meshes are hit instead.
+    bool Raycast(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, RaycastHit& hit) const;
+
+    bool IsTriangleBVHsReady() const { return triangleBVHs_->isReady; }
+
+    // The CPU memory for the ray casts, the triangle BVHs, or the source kept for them if it is not mapped
+    uint64_t GetRaycastMemory() const;
+
+private:
+    // The LOD 0 triangles of a mesh, in the source
+    struct MeshGeometry {
+        const void* vertices { nullptr };
+        uint32_t stride { 0 };
+        uint32_t vertexCount { 0 };
+        const void* indices { nullptr };
+        uint32_t indexSize { 0 };
+        uint32_t indexCount { 0 };
+    };
+
+    // Shared with the building job, which may finish after we are gone
+    struct TriangleBVHs {
+        std::shared_ptr<const void> source {}; // released by the job
+        uint64_t sourceSize { 0 };
+        std::vector<MeshGeometry> geometries {};
+        std::vector<Foundation::LoongTriangleBVH> bvhs {};
+        bool isScheduled { false };
+        std::atomic<bool> isReady { false };
+    };
+
+    void UpdateMeshBounds();
+
+    void BuildTriangleBVHs() const;
+
+    bool RaycastMeshBounds(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, RaycastHit& hit) const;
+
 private:
     std::vector<LoongGpuMesh*> meshes_ {};
     std::vector<std::string> materialNames_ {};
 
     Math::AABB aabb_ {};
+    Foundation::LoongBoxArray meshBounds_ {};
     std::string path_ {};
+
+    std::shared_ptr<TriangleBVHs> triangleBVHs_ {};
 };
 
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "LoongFoundation/LoongLogger.h"
+#include "LoongResource/LoongMaterialParameterBlock.h"
 #include "LoongResource/LoongPipelineFixedState.h"
 #include "LoongResource/LoongRuntimeShader.h"
 #include "LoongResource/LoongTexture.h"
@@ -38,21 +39,30 @@ public:
 
     void Bind(LoongTexture* emptyTexture) const;
 
+    // Only runtime generated materials can be drawn instanced, the model matrix is read from vertex attributes
+    // (see LoongGpuMesh::BindInstanceAttributes) instead of ObjectUBO
+    bool IsInstancingSupported() const { return type_ == Type::kRuntimeGenerated && HasShader(); }
+
+    // Bind the instancing variant of the shader and upload the uniforms to it
+    void BindInstanced(LoongTexture* emptyTexture) const;
+
     void UnBind() const;
 
     template <typename T>
     void Set(const std::string& key, const T& value)
     {
         if (HasShader()) {
-            if (uniformsData_.find(key) != uniformsData_.end())
+            if (uniformsData_.find(key) != uniformsData_.end()) {
                 uniformsData_[key] = std::any(value);
+                MarkParametersDirty();
+            }
         } else {
             LOONG_ERROR("Material Set failed: No attached shader");
         }
     }
 
     template <typename T>
-    const T& Get(const std::string& key)
+    T Get(const std::string& key) const
     {
         if (auto it = uniformsData_.find(key); it == uniformsData_.end() || it->second.type() != typeid(T)) {
             return T();
@@ -93,7 +103,12 @@ public:
 
     LoongPipelineFixedState GenerateStateMask() const;
 
-    std::map<std::string, std::any>& GetUniformsData() { return uniformsData_; }
+    // NOTE: The data may be modified through the returned reference, so the parameters are updated on the next Bind()
+    std::map<std::string, std::any>& GetUniformsData()
+    {
+        MarkParametersDirty();
+        return uniformsData_;
+    }
 
     const std::map<std::string, std::any>& GetUniformsData() const { return uniformsData_; }
 
@@ -108,10 +123,21 @@ public:
 private:
     void FillUniform();
 
+    void BindUniforms(LoongShader& shader, LoongMaterialParameterBlock& parameters, LoongTexture* emptyTexture) const;
+
+    void MarkParametersDirty()
+    {
+        parameters_.MarkDirty();
+        instancedParameters_.MarkDirty();
+    }
+
 private:
     std::shared_ptr<LoongShader> shader_ { nullptr };
+    mutable std::shared_ptr<LoongShader> instancedShader_ { nullptr }; // created lazily
 
     std::map<std::string, std::any> uniformsData_ {};
+    mutable LoongMaterialParameterBlock parameters_ {}; // compiled against shader_
+    mutable LoongMaterialParameterBlock instancedParameters_ {}; // compiled against instancedShader_
 
     bool blendable_ { false };
     bool backFaceCulling_ { true };
@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include "LoongResource/LoongShader.h"
+#include <any>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Loong::Resource {
+
+class LoongTexture;
+
+// The parameters of a material compiled against a shader: the uniform locations and the texture units are resolved
+// once, the values are kept in a flat buffer, and they are uploaded only if the program doesn't hold them already.
+//
+// Each Update() gives the values a new version which is unique among all the blocks, the shader remembers the version
+// it was last uploaded with, so binding the same material again, or another shader in between, costs no upload.
+class LoongMaterialParameterBlock {
+public:
+    // Resolve the layout of the shader's uniforms, the block is dirty until the next Update()
+    void Compile(const LoongShader& shader);
+
+    // Copy the values of the compiled parameters from the material's uniform data
+    void Update(const std::map<std::string, std::any>& uniformsData);
+
+    // Bind the textures and upload the values if needed, the shader must be in use
+    void Apply(const LoongShader& shader, LoongTexture* emptyTexture) const;
+
+    void MarkDirty() { isDirty_ = true; }
+
+    bool IsDirty() const { return isDirty_; }
+
+private:
+    struct Parameter {
+        LoongShader::UniformType type;
+        GLint location;
+        uint32_t offset; // in values_
+        int32_t textureIndex; // in textures_, -1 if it's not a sampler
+        bool isValid; // false if the value has a wrong type
+    };
+
+    std::vector<Parameter> parameters_ {};
+    std::vector<std::string> names_ {}; // names of parameters_, only used by Update()
+    std::vector<uint8_t> values_ {};
+    std::vector<std::shared_ptr<LoongTexture>> textures_ {};
+    uint64_t version_ { 0 };
+    bool isDirty_ { true };
+};
+
+}
@@ -0,0 +1,39 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Loong::Resource {
+
+// Caches the linked shader programs in the user's pref dir (see LoongFileSystem::GetPrefDir), out of the projects, so
+// the later runs load them with glProgramBinary instead of compiling and linking the sources. The binaries only work
+// with the driver that produced them, so the keys are hashes of the sources and the GL vendor, renderer and version
+// strings. The entries not loaded for a month are deleted when the cache starts, e.g. the ones of an older driver. It
+// is disabled if the driver supports no binary formats, or the cache directory can't be created.
+// NOTE: GL thread only
+class LoongProgramBinaryCache {
+public:
+    using ShaderSources = std::vector<std::pair<uint32_t, const std::string&>>;
+
+    LoongProgramBinaryCache() = delete;
+
+    static bool IsEnabled();
+
+    static uint64_t GetKey(const ShaderSources& shaders);
+
+    // 0 if the program is not cached, or the cached binary is rejected by the driver, e.g. after a driver update
+    static GLuint Load(uint64_t key, const std::string& name);
+
+    // The program should be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT, an existing entry is replaced
+    static void Store(uint64_t key, GLuint program, const std::string& name);
+};
+
+}
@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace Loong::Resource {
+
+enum class LoongResourceType {
+    kTexture = 0,
+    kModel = 1,
+    kShader = 2,
+    kMaterial = 3,
+    kCount = 4,
+};
+
+struct LoongResourceSize {
+    uint64_t cpuBytes { 0 };
+    uint64_t gpuBytes { 0 };
+};
+
+// How much memory the resources nobody uses any more may keep
+struct LoongResourceCacheBudget {
+    uint64_t cpuBytes { 0 };
+    uint64_t gpuBytes { 0 };
+};
+
+struct LoongResourceCacheStats {
+    uint64_t hitCount { 0 }; // taken back from the cache
+    uint64_t missCount { 0 }; // loaded from the file
+    uint64_t evictionCount { 0 };
+    // The resources nobody but the cache holds
+    uint64_t retainedCount { 0 };
+    uint64_t retainedCpuBytes { 0 };
+    uint64_t retainedGpuBytes { 0 };
+};
+
+// Keeps the resources alive after their last users release them, so that using them again soon doesn't load them
+// again. The references handed out give the resource back to the cache when the last of them goes away, the released
+// resources are ordered by the time of the release. The least recently released ones are destroyed when they don't
+// fit in the budget.
+// NOTE: The cache must outlive the references it hands out
+template <class Key, class T>
+class LoongResourceCache {
+public:
+    // An estimation, only the relative sizes matter
+    using SizeFunc = LoongResourceSize (*)(const T&);
+
+    explicit LoongResourceCache(SizeFunc sizeFunc)
+        : sizeFunc_(sizeFunc)
+    {
+    }
+    LoongResourceCache(const LoongResourceCache&) = delete;
+    LoongResourceCache(LoongResourceCache&&) = delete;
+    ~LoongResourceCache() = default;
+    LoongResourceCache& operator=(const LoongResourceCache&) = delete;
+    LoongResourceCache& operator=(LoongResourceCache&&) = delete;
+
+    // A new resource, returns the reference to hand out instead of it
+    std::shared_ptr<T> Add(const Key& key, std::shared_ptr<T> resource)
+    {
+        ++stats_.missCount;
+        if (resource == nullptr) {
+            return nullptr;
+        }
+        return Share(key, std::move(resource));
+    }
+
+    // Takes a released resource back, nullptr if the cache doesn't have it
+    std::shared_ptr<T> Acquire(const Key& key)
+    {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return nullptr;
+        }
+        ++stats_.hitCount;
+        return Share(key, Unlink(it->second));
+    }
+
+    // The references of the key handed out so far aren't kept on release, and the released one is destroyed now, e.g.
+    // when the resource failed to load. The ones added later are cached as usual.
+    void Forget(const Key& key)
+    {
+        ++forgetCounts_[key];
+        if (auto it = index_.find(key); it != index_.end()) {
+            ++stats_.evictionCount;
+            auto resource = Unlink(it->second);
+        }
+    }
+
+    // Destroy the least recently released resources until the rest of them fit in the budget
+    void Trim()
+    {
+        while (!entries_.empty() && (stats_.retainedCpuBytes > budget_.cpuBytes || stats_.retainedGpuBytes > budget_.gpuBytes)) {
+            ++stats_.evictionCount;
+            // Destroyed after the cache is updated, its deleter may release other resources
+            auto resource = Unlink(std::prev(entries_.end()));
+        }
+    }
+
+    // Destroy all the released resources, the ones still in use come back when they are released
+    void Clear()
+    {
+        std::list<Entry> entries;
+        entries.swap(entries_);
+        index_.clear();
+        stats_.retainedCount = 0;
+        stats_.retainedCpuBytes = 0;
+        stats_.retainedGpuBytes = 0;
+    }
+
+    void SetBudget(const LoongResourceCacheBudget& budget) { budget_ = budget; }
+
+    const LoongResourceCacheBudget& GetBudget() const { return budget_; }
+
+    const LoongResourceCacheStats& GetStats() const { return stats_; }
+
+private:
+    struct Entry {
+        Key key;
+        std::shared_ptr<T> resource;
+        LoongResourceSize size;
+    };
+    using EntryIterator = typename std::list<Entry>::iterator;
+
+    // The reference owns the cache's one, which comes back on the release of the last copy
+    std::shared_ptr<T> Share(const Key& key, std::shared_ptr<T> resource)
+    {
+        T* pointer = resource.get();
+        return std::shared_ptr<T>(pointer, [this, key, forgetCount = GetForgetCount(key), resource = std::move(resource)](T*) mutable {
+            if (forgetCount == GetForgetCount(key)) {
+                Release(key, std::move(resource));
+            }
+        });
+    }
+
+    uint32_t GetForgetCount(const Key& key) const
+    {
+        auto it = forgetCounts_.find(key);
+        return it != forgetCounts_.end() ? it->second : 0;
+    }
+
+    void Release(const Key& key, std::shared_ptr<T> resource)
+    {
+        std::shared_ptr<T> replaced;
+        if (auto it = index_.find(key); it != index_.end()) {
+            // Two resources of one key, only the newer one is kept
+            ++stats_.evictionCount;
+            replaced = Unlink(it->second);
+        }
+        // Measured now, the asynchronous loads are done by the time they are released
+        auto size = sizeFunc_(*resource);
+        entries_.push_front({ key, std::move(resource), size });
+        index_.insert({ key, entries_.begin() });
+        ++stats_.retainedCount;
+        stats_.retainedCpuBytes += size.cpuBytes;
+        stats_.retainedGpuBytes += size.gpuBytes;
+    }
+
+    std::shared_ptr<T> Unlink(EntryIterator it)
+    {
+        auto resource = std::move(it->resource);
+        --stats_.retainedCount;
+        stats_.retainedCpuBytes -= it->size.cpuBytes;
+        stats_.retainedGpuBytes -= it->size.gpuBytes;
+        index_.erase(it->key);
+        entries_.erase(it);
+        return resource;
+    }
+
+    SizeFunc sizeFunc_ { nullptr };
+    LoongResourceCacheBudget budget_ {};
+    LoongResourceCacheStats stats_ {};
+    // The most recently released first
+    std::list<Entry> entries_ {};
+    std::map<Key, EntryIterator> index_ {};
+    std::map<Key, uint32_t> forgetCounts_ {}; // only the keys ever forgotten
+};
+
+}
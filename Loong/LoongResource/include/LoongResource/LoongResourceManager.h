@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include "LoongResource/LoongResourceCache.h"
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -16,8 +19,17 @@ class LoongShader;
 class LoongMaterial;
 class LoongRuntimeShader;
 
+// The Get functions load the resources on the calling thread, they finish the asynchronous loads of the same paths
+// instead of loading them twice.
+// The Async functions read and decode the files on the job system workers, then Update() creates the GL objects on
+// the main thread within the upload budget. The requests for the same path share one load.
+// The released textures, models, shaders and materials are kept in a cache within a budget per type, see
+// LoongResourceCache, Update() evicts the ones over the budget.
+// NOTE: Call all of them on the main thread
 class LoongResourceManager {
 public:
+    using ModelCallback = std::function<void(std::shared_ptr<LoongGpuModel>)>;
+
     LoongResourceManager() = delete;
 
     static bool Initialize();
@@ -26,8 +38,35 @@ public:
 
     static std::shared_ptr<LoongTexture> GetTexture(const std::string& path);
 
+    // Returns a 1x1 white placeholder if the texture is not loaded yet, the real image is uploaded into the same
+    // texture object later
+    static std::shared_ptr<LoongTexture> GetTextureAsync(const std::string& path);
+
     static std::shared_ptr<LoongGpuModel> GetModel(const std::string& path);
 
+    // The callback is called on the main thread with the model, or nullptr if it failed. It is called right away if
+    // the model is loaded already. Bind GetPlaceholderModel() meanwhile.
+    static void GetModelAsync(const std::string& path, ModelCallback callback);
+
+    // A unit cube
+    static std::shared_ptr<LoongGpuModel> GetPlaceholderModel();
+
+    static bool IsLoading(const std::string& path);
+
+    // Upload the decoded resources until either budget of this frame is used up, at least one is uploaded per call so
+    // that a large one doesn't block the others. Call it once per frame.
+    static void Update();
+
+    static void SetUploadBudget(uint64_t bytesPerFrame, float secondsPerFrame);
+
+    static void SetCacheBudget(LoongResourceType type, const LoongResourceCacheBudget& budget);
+
+    static LoongResourceCacheStats GetCacheStats(LoongResourceType type);
+
+    // Release all the cached resources, e.g. when a level is unloaded. The ones in use stay loaded.
+    // The apps must call it before the GL context is destroyed, Uninitialize runs too late for that.
+    static void ClearCache();
+
     static std::shared_ptr<LoongShader> GetShader(const std::string& path);
 
     static std::shared_ptr<LoongShader> GetRuntimeShader(const LoongRuntimeShader& rs);
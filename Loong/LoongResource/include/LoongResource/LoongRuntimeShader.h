@@ -32,6 +32,9 @@ public:
 	void SetUseRoughnessMap(bool b) { if (b) { defMask_ |= (1u<<6u); } else { defMask_ &= ~(1u<<6u); } }
 	bool IsUseRoughnessMap() const { return defMask_ & (1u<<6u); }
 
+	void SetUseInstancing(bool b) { if (b) { defMask_ |= (1u<<7u); } else { defMask_ &= ~(1u<<7u); } }
+	bool IsUseInstancing() const { return defMask_ & (1u<<7u); }
+
 	uint32_t GetDefinitionMask() const { return defMask_; }
 	LoongRuntimeShaderCode GenerateShaderSources() const;
 private:
@@ -5,6 +5,7 @@
 #include <glad/glad.h>
 
 #include "LoongFoundation/LoongMath.h"
+#include "LoongResource/LoongGLStateCache.h"
 #include <any>
 #include <string>
 #include <unordered_map>
@@ -34,6 +35,17 @@ public:
         std::any defaultValue;
     };
 
+    // Binding points of the uniform blocks shared by all the shaders of the engine
+    static constexpr uint32_t kBasicUBOBindingPoint = 0;
+    static constexpr uint32_t kLightUBOBindingPoint = 1;
+    static constexpr uint32_t kObjectUBOBindingPoint = 2;
+
+    // Texture units of the buffer textures shared by all the shaders of the engine (the clustered lights), they are
+    // taken from the top of the 16 units guaranteed by GL 3.3 since materials use the units from 0
+    static constexpr uint32_t kLightBufferTextureUnit = 13;
+    static constexpr uint32_t kClusterBufferTextureUnit = 14;
+    static constexpr uint32_t kLightIndexBufferTextureUnit = 15;
+
 public:
     // Note: This construct will take over the ownship
     explicit LoongShader(GLuint id, const std::string& path);
@@ -43,21 +55,21 @@ public:
     LoongShader& operator=(LoongShader&& s) noexcept;
     ~LoongShader();
 
-    void Bind() const { glUseProgram(id_); }
+    void Bind() const { LoongGLStateCache::UseProgram(id_); }
 
-    void Unbind() const { glUseProgram(0); }
+    void Unbind() const { LoongGLStateCache::UseProgram(0); }
 
-    void SetUniformInt(const std::string& name, int value) { glUniform1i(GetUniformLocation(name), value); }
+    void SetUniformInt(const std::string& name, int value) { parameterVersion_ = 0; glUniform1i(GetUniformLocation(name), value); }
 
-    void SetUniformFloat(const std::string& name, float value) { glUniform1f(GetUniformLocation(name), value); }
+    void SetUniformFloat(const std::string& name, float value) { parameterVersion_ = 0; glUniform1f(GetUniformLocation(name), value); }
 
-    void SetUniformVec2(const std::string& name, const Math::Vector2& value) { glUniform2f(GetUniformLocation(name), value.x, value.y); }
+    void SetUniformVec2(const std::string& name, const Math::Vector2& value) { parameterVersion_ = 0; glUniform2f(GetUniformLocation(name), value.x, value.y); }
 
-    void SetUniformVec3(const std::string& name, const Math::Vector3& value) { glUniform3f(GetUniformLocation(name), value.x, value.y, value.z); }
+    void SetUniformVec3(const std::string& name, const Math::Vector3& value) { parameterVersion_ = 0; glUniform3f(GetUniformLocation(name), value.x, value.y, value.z); }
 
-    void SetUniformVec4(const std::string& name, const Math::Vector4& value) { glUniform4f(GetUniformLocation(name), value.x, value.y, value.z, value.w); }
+    void SetUniformVec4(const std::string& name, const Math::Vector4& value) { parameterVersion_ = 0; glUniform4f(GetUniformLocation(name), value.x, value.y, value.z, value.w); }
 
-    void SetUniformMat4(const std::string& name, const Math::Matrix4& value) { glUniformMatrix4fv(GetUniformLocation(name), 1, GL_TRUE, &value[0].x); }
+    void SetUniformMat4(const std::string& name, const Math::Matrix4& value) { parameterVersion_ = 0; glUniformMatrix4fv(GetUniformLocation(name), 1, GL_TRUE, &value[0].x); }
 
     int GetUniformInt(const std::string& name) const
     {
@@ -106,10 +118,20 @@ public:
 
     void BindUniformBlock(uint32_t uniformBlockIndex, uint32_t bindingPoint);
 
+    // Bind BasicUBO, LightUBO and ObjectUBO (those declared by this shader) to their binding points, and assign the
+    // builtin buffer textures to their texture units
+    void BindBuiltinUniformBlocks();
+
     const std::vector<UniformInfo>& GetUniformInfo() const { return uniforms_; }
 
     const std::string& GetPath() const { return path_; }
 
+    // Version of the material parameters (see LoongMaterialParameterBlock) the program holds, 0 if unknown.
+    // Setting a uniform directly resets it
+    uint64_t GetParameterVersion() const { return parameterVersion_; }
+
+    void SetParameterVersion(uint64_t version) const { parameterVersion_ = version; }
+
 private:
     void QueryUniforms();
     uint32_t GetUniformLocation(const std::string& name) const;
@@ -119,6 +141,7 @@ private:
     mutable std::unordered_map<std::string, int> locationCache_ {};
     std::vector<UniformInfo> uniforms_ {};
     std::string path_ {};
+    mutable uint64_t parameterVersion_ { 0 };
 };
 
 }
\ No newline at end of file
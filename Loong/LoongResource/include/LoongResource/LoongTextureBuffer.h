@@ -0,0 +1,39 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include "LoongResource/LoongGpuBuffer.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Loong::Resource {
+
+// A buffer texture (GL_TEXTURE_BUFFER): a large 1D array of texels which shaders read with texelFetch. It's used to
+// pass variable sized data to shaders, since shader storage buffers are not available on GL 4.1 (macos)
+class LoongTextureBuffer {
+public:
+    // internalFormat: the format of each texel, e.g. GL_RGBA32F, GL_R32UI
+    explicit LoongTextureBuffer(GLenum internalFormat);
+    LoongTextureBuffer(const LoongTextureBuffer&) = delete;
+    LoongTextureBuffer(LoongTextureBuffer&&) = delete;
+    ~LoongTextureBuffer();
+    LoongTextureBuffer& operator=(const LoongTextureBuffer&) = delete;
+    LoongTextureBuffer& operator=(LoongTextureBuffer&&) = delete;
+
+    // Replace the whole content, the old storage is orphaned so the draws already issued are not stalled
+    void BufferData(const void* data, size_t size);
+
+    void Bind(uint32_t unit) const;
+
+    GLuint GetId() const { return textureId_; }
+
+private:
+    LoongGpuBuffer<LoongGpuBufferType::kTextureBuffer> buffer_ {};
+    GLuint textureId_ { 0 };
+};
+
+}
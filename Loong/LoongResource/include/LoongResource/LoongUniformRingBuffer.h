@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#pragma once
+
+#include "LoongResource/LoongGpuBuffer.h"
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace Loong::Resource {
+
+// A uniform buffer holding an array of same sized elements (e.g. per object data), each one is bound by its slot
+// with glBindBufferRange. The buffer is split into kFrameCount regions that are used round robin per frame, so the
+// data written for the current frame never overlaps the regions the GPU may still read from the previous frames,
+// and the writes can be unsynchronized. A fence is inserted after the draws of each frame, the region is only written
+// again after the GPU passed its fence, in case the driver queues more than kFrameCount frames.
+//
+// Usage per frame: BeginFrame(), Push() the elements of a pass, Upload() them at once, then BindSlot() for each draw.
+// Push/Upload can be repeated within a frame, e.g. once per render pass. If the elements of a frame don't fit, the
+// buffer grows in Upload(): the draws issued before keep reading the orphaned storage, and all the slots of the frame
+// are uploaded again to the new one, so the slots from the earlier passes stay valid for BindSlot().
+class LoongUniformRingBuffer {
+public:
+    static constexpr uint32_t kFrameCount = 3;
+
+    LoongUniformRingBuffer(uint32_t bindingPoint, uint32_t elementSize, uint32_t elementsPerFrame = 1024);
+    LoongUniformRingBuffer(const LoongUniformRingBuffer&) = delete;
+    LoongUniformRingBuffer(LoongUniformRingBuffer&&) = delete;
+    ~LoongUniformRingBuffer();
+    LoongUniformRingBuffer& operator=(const LoongUniformRingBuffer&) = delete;
+    LoongUniformRingBuffer& operator=(LoongUniformRingBuffer&&) = delete;
+
+    // Fence the draws of the last frame, and switch to the next region, waits for the GPU if it is still in use
+    void BeginFrame();
+
+    // Copy the element to the CPU side staging memory, returns its slot in the current frame
+    uint32_t Push(const void* data);
+
+    template <class T>
+    uint32_t Push(const T& data)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        assert(sizeof(T) == elementSize_);
+        return Push(static_cast<const void*>(&data));
+    }
+
+    // Send all the elements pushed since the last Upload() to the GPU
+    void Upload();
+
+    void BindSlot(uint32_t slot) const;
+
+    uint32_t GetElementSize() const { return elementSize_; }
+
+private:
+    void Reallocate(uint32_t elementsPerFrame);
+
+    void DeleteFences();
+
+private:
+    LoongUniformBuffer buffer_ {};
+    uint32_t bindingPoint_ { 0 };
+    uint32_t elementSize_ { 0 };
+    uint32_t stride_ { 0 }; // elementSize_ aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    uint32_t elementsPerFrame_ { 0 };
+    uint32_t frameIndex_ { 0 };
+    uint32_t uploadedCount_ { 0 };
+    uint32_t pushedCount_ { 0 };
+    std::vector<uint8_t> staging_ {};
+    GLsync fences_[kFrameCount] {};
+};
+
+}
@@ -7,6 +7,7 @@
 #include <glad/glad.h>
 #include <utility>
 
+#include "LoongResource/LoongGLStateCache.h"
 #include "LoongResource/LoongGpuBuffer.h"
 
 namespace Loong::Resource {
@@ -30,6 +31,7 @@ public:
     {
         if (id_ != 0) {
             glDeleteVertexArrays(1, &id_);
+            LoongGLStateCache::OnVertexArrayDeleted(id_);
             id_ = 0;
         }
     }
@@ -70,14 +72,23 @@ public:
         }
     }
 
+    // For the types which can't be told by a C++ type, e.g. GL_HALF_FLOAT, or normalized integers
+    void BindAttribute(GLuint attrib, const LoongVertexBuffer& vertexBuffer, GLint count, GLenum type, bool normalized, GLsizei stride, intptr_t offset)
+    {
+        Bind();
+        vertexBuffer.Bind();
+        glEnableVertexAttribArray(attrib);
+        glVertexAttribPointer(attrib, count, type, normalized ? GL_TRUE : GL_FALSE, stride, reinterpret_cast<const GLvoid*>(offset));
+    }
+
     void Bind() const
     {
-        glBindVertexArray(id_);
+        LoongGLStateCache::BindVertexArray(id_);
     }
 
     void Unbind() const
     {
-        glBindVertexArray(0);
+        LoongGLStateCache::BindVertexArray(0);
     }
 
     GLint GetId() const
@@ -23,6 +23,9 @@ public:
 
     static std::shared_ptr<LoongTexture> Create(const Asset::LoongImage& image, bool generateMipmap, const std::function<void(const std::string&)>& onDestroy);
 
+    // Replace the GL texture of an existing texture object with the image, the users of the object see the new one
+    static bool Upload(LoongTexture& texture, const Asset::LoongImage& image, bool generateMipmap);
+
     static std::shared_ptr<LoongTexture> CreateColor(uint8_t data[4], bool generateMipmap, const std::function<void(const std::string&)>& onDestroy);
 
     static std::shared_ptr<LoongTexture> CreateFromMemory(uint8_t* data, uint32_t width, uint32_t height, bool generateMipmap, const std::function<void(const std::string&)>& onDestroy, int channelCount = 4);
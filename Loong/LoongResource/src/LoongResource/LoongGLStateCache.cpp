@@ -0,0 +1,270 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongResource/LoongGLStateCache.h"
+#include <cassert>
+
+namespace Loong::Resource {
+
+namespace {
+
+    // Names are never ~0u, it is used to mark a binding as unknown
+    constexpr GLuint kUnknown = ~GLuint(0);
+
+    struct IndexedBinding {
+        GLuint buffer { kUnknown };
+        GLintptr offset { 0 };
+        GLsizeiptr size { 0 };
+    };
+
+    struct GLState {
+        GLuint program { kUnknown };
+        GLuint vertexArray { kUnknown };
+        GLuint activeTextureUnit { kUnknown };
+        GLuint textures[LoongGLStateCache::kMaxTextureUnits];
+        GLuint bufferTextures[LoongGLStateCache::kMaxTextureUnits];
+        GLuint arrayBuffer { kUnknown };
+        GLuint uniformBuffer { kUnknown };
+        IndexedBinding uniformBufferBindings[LoongGLStateCache::kMaxUniformBufferBindings] {};
+        bool isClearColorKnown { false };
+        float clearColor[4] { 0.0F, 0.0F, 0.0F, 0.0F };
+        GLenum polygonMode { kUnknown };
+        GLenum depthFunc { kUnknown };
+
+        GLState()
+        {
+            for (auto& t : textures) {
+                t = kUnknown;
+            }
+            for (auto& t : bufferTextures) {
+                t = kUnknown;
+            }
+        }
+    };
+
+    GLState gState {};
+    uint64_t gStateChangeCount { 0 };
+    uint64_t gRedundantStateChangeCount { 0 };
+
+    // Returns true if the change has to be issued
+    template <class T>
+    bool Update(T& cached, T value)
+    {
+        if (cached == value) {
+            ++gRedundantStateChangeCount;
+            return false;
+        }
+        cached = value;
+        ++gStateChangeCount;
+        return true;
+    }
+
+    GLuint* GetBufferBinding(GLenum target)
+    {
+        switch (target) {
+        case GL_ARRAY_BUFFER:
+            return &gState.arrayBuffer;
+        case GL_UNIFORM_BUFFER:
+            return &gState.uniformBuffer;
+        default:
+            return nullptr;
+        }
+    }
+
+    void ActiveTexture(uint32_t unit)
+    {
+        if (Update(gState.activeTextureUnit, GLuint(unit))) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+        }
+    }
+
+}
+
+void LoongGLStateCache::UseProgram(GLuint program)
+{
+    if (Update(gState.program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void LoongGLStateCache::BindVertexArray(GLuint vertexArray)
+{
+    if (Update(gState.vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void LoongGLStateCache::BindTexture(uint32_t unit, GLuint texture)
+{
+    BindTexture(unit, GL_TEXTURE_2D, texture);
+}
+
+void LoongGLStateCache::BindTexture(uint32_t unit, GLenum target, GLuint texture)
+{
+    assert(unit < kMaxTextureUnits);
+    ActiveTexture(unit);
+
+    GLuint* cached = nullptr;
+    switch (target) {
+    case GL_TEXTURE_2D:
+        cached = &gState.textures[unit];
+        break;
+    case GL_TEXTURE_BUFFER:
+        cached = &gState.bufferTextures[unit];
+        break;
+    default:
+        ++gStateChangeCount;
+        glBindTexture(target, texture);
+        return;
+    }
+    if (Update(*cached, texture)) {
+        glBindTexture(target, texture);
+    }
+}
+
+void LoongGLStateCache::BindTexture(GLuint texture)
+{
+    if (gState.activeTextureUnit >= kMaxTextureUnits) {
+        // The active unit is unknown, there is no way to know which unit is changed
+        ActiveTexture(0);
+    }
+    BindTexture(gState.activeTextureUnit, texture);
+}
+
+void LoongGLStateCache::BindBuffer(GLenum target, GLuint buffer)
+{
+    auto* cached = GetBufferBinding(target);
+    if (cached == nullptr) {
+        ++gStateChangeCount;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (Update(*cached, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void LoongGLStateCache::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    if (target != GL_UNIFORM_BUFFER || index >= kMaxUniformBufferBindings) {
+        ++gStateChangeCount;
+        glBindBufferRange(target, index, buffer, offset, size);
+        if (auto* cached = GetBufferBinding(target)) {
+            *cached = buffer;
+        }
+        return;
+    }
+
+    auto& binding = gState.uniformBufferBindings[index];
+    if (binding.buffer == buffer && binding.offset == offset && binding.size == size) {
+        ++gRedundantStateChangeCount;
+        return;
+    }
+    ++gStateChangeCount;
+    glBindBufferRange(target, index, buffer, offset, size);
+    binding.buffer = buffer;
+    binding.offset = offset;
+    binding.size = size;
+    gState.uniformBuffer = buffer;
+}
+
+void LoongGLStateCache::SetClearColor(float r, float g, float b, float a)
+{
+    auto& c = gState.clearColor;
+    if (gState.isClearColorKnown && c[0] == r && c[1] == g && c[2] == b && c[3] == a) {
+        ++gRedundantStateChangeCount;
+        return;
+    }
+    ++gStateChangeCount;
+    glClearColor(r, g, b, a);
+    c[0] = r;
+    c[1] = g;
+    c[2] = b;
+    c[3] = a;
+    gState.isClearColorKnown = true;
+}
+
+void LoongGLStateCache::GetClearColor(float color[4])
+{
+    if (!gState.isClearColorKnown) {
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, gState.clearColor);
+        gState.isClearColorKnown = true;
+    }
+    for (int i = 0; i < 4; ++i) {
+        color[i] = gState.clearColor[i];
+    }
+}
+
+void LoongGLStateCache::SetPolygonMode(GLenum mode)
+{
+    if (Update(gState.polygonMode, mode)) {
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+    }
+}
+
+void LoongGLStateCache::SetDepthFunc(GLenum func)
+{
+    if (Update(gState.depthFunc, func)) {
+        glDepthFunc(func);
+    }
+}
+
+void LoongGLStateCache::OnVertexArrayDeleted(GLuint vertexArray)
+{
+    if (gState.vertexArray == vertexArray) {
+        gState.vertexArray = 0;
+    }
+}
+
+void LoongGLStateCache::OnTextureDeleted(GLuint texture)
+{
+    for (auto& t : gState.textures) {
+        if (t == texture) {
+            t = 0;
+        }
+    }
+    for (auto& t : gState.bufferTextures) {
+        if (t == texture) {
+            t = 0;
+        }
+    }
+}
+
+void LoongGLStateCache::OnBufferDeleted(GLuint buffer)
+{
+    if (gState.arrayBuffer == buffer) {
+        gState.arrayBuffer = 0;
+    }
+    if (gState.uniformBuffer == buffer) {
+        gState.uniformBuffer = 0;
+    }
+    for (auto& binding : gState.uniformBufferBindings) {
+        if (binding.buffer == buffer) {
+            binding = IndexedBinding { 0, 0, 0 };
+        }
+    }
+}
+
+void LoongGLStateCache::Invalidate()
+{
+    gState = GLState {};
+}
+
+uint64_t LoongGLStateCache::GetStateChangeCount()
+{
+    return gStateChangeCount;
+}
+
+uint64_t LoongGLStateCache::GetRedundantStateChangeCount()
+{
+    return gRedundantStateChangeCount;
+}
+
+void LoongGLStateCache::ResetCounters()
+{
+    gStateChangeCount = 0;
+    gRedundantStateChangeCount = 0;
+}
+
+}
@@ -4,36 +4,155 @@
 
 #include "LoongResource/LoongGpuMesh.h"
 #include "LoongAsset/LoongMesh.h"
+#include "LoongAsset/LoongModelFile.h"
+#include "LoongAsset/LoongVertexPacking.h"
+#include <cstddef>
+#include <limits>
+#include <type_traits>
 
 namespace Loong::Resource {
 
+namespace {
+
+template <class UV>
+void BindVertexAttributes(LoongVertexArray& vao, const LoongVertexBuffer& vbo)
+{
+    using Vertex = Asset::LoongPackedVertex<UV>;
+    constexpr GLenum kUvType = std::is_same_v<UV, uint32_t> ? GL_HALF_FLOAT : GL_FLOAT;
+    constexpr intptr_t kFrameOffset = offsetof(Vertex, frame);
+
+    vao.BindAttribute<float>(0, vbo, 3, sizeof(Vertex), offsetof(Vertex, position));
+    vao.BindAttribute(1, vbo, 2, kUvType, false, sizeof(Vertex), offsetof(Vertex, uv));
+    vao.BindAttribute(2, vbo, 2, GL_SHORT, true, sizeof(Vertex), kFrameOffset);
+    vao.BindAttribute(3, vbo, 4, GL_BYTE, true, sizeof(Vertex), kFrameOffset + offsetof(Asset::LoongPackedFrame, tangent));
+}
+
+// One arena per vertex layout and index type, indexed by [isHalfUv][is16BitIndex]. The meshes own the arenas, so an
+// arena goes away with its last mesh, i.e. before the GL context does.
+std::weak_ptr<LoongGpuMeshArena> gArenas[2][2];
+
+std::shared_ptr<LoongGpuMeshArena> GetSharedArena(bool isHalfUv, bool is16BitIndex)
+{
+    auto& weakArena = gArenas[isHalfUv][is16BitIndex];
+    auto arena = weakArena.lock();
+    if (arena == nullptr) {
+        const GLenum indexType = is16BitIndex ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        if (isHalfUv) {
+            arena = std::make_shared<LoongGpuMeshArena>(uint32_t(sizeof(Asset::LoongPackedVertex<uint32_t>)), indexType, BindVertexAttributes<uint32_t>);
+        } else {
+            arena = std::make_shared<LoongGpuMeshArena>(uint32_t(sizeof(Asset::LoongPackedVertex<Math::Vector2>)), indexType, BindVertexAttributes<Math::Vector2>);
+        }
+        weakArena = arena;
+    }
+    return arena;
+}
+
+}
+
 LoongGpuMesh::LoongGpuMesh(const Asset::LoongMesh& mesh)
     : verticesCount_(uint32_t(mesh.GetVertices().size()))
     , indicesCount_(uint32_t(mesh.GetIndices().size()))
     , materialIndex_(uint32_t(mesh.GetMaterialIndex()))
 {
-    CreateBuffers(mesh.GetVertices().data(), mesh.GetVertices().size(), mesh.GetIndices().data(), mesh.GetIndices().size());
+    // Put the indices of all the LODs in one index buffer
+    std::vector<uint32_t> indices(mesh.GetIndices());
+    lods_.push_back({ 0, indicesCount_, 0.0F });
+    for (auto& meshLod : mesh.GetLods()) {
+        lods_.push_back({ uint32_t(indices.size()), uint32_t(meshLod.indices.size()), meshLod.error });
+        indices.insert(indices.end(), meshLod.indices.begin(), meshLod.indices.end());
+    }
+    CreateBuffers(mesh.GetVertices(), indices);
     aabb_ = mesh.GetAABB();
 }
 
-void LoongGpuMesh::CreateBuffers(const Asset::LoongVertex* vertices, size_t verticesCount, const uint32_t* indices, size_t indicesCount)
+LoongGpuMesh::LoongGpuMesh(const Asset::LoongModelFile& file, uint32_t meshIndex)
+    : verticesCount_(file.GetMesh(meshIndex).mesh->vertexCount)
+    , indicesCount_(file.GetMesh(meshIndex).lods[0].indexCount)
+    , materialIndex_(file.GetMesh(meshIndex).mesh->materialIndex)
 {
-    vbo_ = std::make_unique<LoongVertexBuffer>();
-    vbo_->BufferData(vertices, verticesCount);
-    ibo_ = std::make_unique<LoongIndexBuffer>();
-    ibo_->BufferData(indices, indicesCount);
+    auto& view = file.GetMesh(meshIndex);
+    for (uint32_t i = 0; i < view.mesh->lodCount; ++i) {
+        lods_.push_back({ view.lods[i].indexOffset, view.lods[i].indexCount, view.lods[i].error });
+    }
+    // The file decides the layout the same way as CreateBuffers()
+    const bool isHalfUv = view.mesh->flags & Asset::LoongModelFileMesh::kHalfUvs;
+    const bool is16BitIndex = view.mesh->flags & Asset::LoongModelFileMesh::k16BitIndices;
+    arena_ = GetSharedArena(isHalfUv, is16BitIndex);
+    allocation_ = arena_->Allocate(view.vertices, verticesCount_, view.indices, view.mesh->indexCount);
+    if (allocation_ == LoongGpuMeshArena::kInvalidAllocation) {
+        for (auto& lod : lods_) {
+            lod.indexCount = 0;
+        }
+    }
+    aabb_ = view.mesh->aabb;
+}
 
-    const GLsizei vertexSize = sizeof(Asset::LoongVertex);
+LoongGpuMesh::~LoongGpuMesh()
+{
+    if (allocation_ != LoongGpuMeshArena::kInvalidAllocation) {
+        arena_->Free(allocation_);
+    }
+}
+
+void LoongGpuMesh::CreateBuffers(const std::vector<Asset::LoongVertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    // Half float UVs if they are precise enough, otherwise fall back to floats, the shaders see vec2 either way
+    const bool isHalfUv = Asset::CanUseHalfUvs(vertices);
+    const bool is16BitIndex = vertices.size() <= std::numeric_limits<uint16_t>::max() + size_t(1);
+    arena_ = GetSharedArena(isHalfUv, is16BitIndex);
+
+    std::vector<uint16_t> shortIndices;
+    const void* indexData = indices.data();
+    if (is16BitIndex) {
+        shortIndices.assign(indices.begin(), indices.end());
+        indexData = shortIndices.data();
+    }
+    if (isHalfUv) {
+        auto gpuVertices = Asset::PackVerticesWithHalfUvs(vertices);
+        allocation_ = arena_->Allocate(gpuVertices.data(), uint32_t(gpuVertices.size()), indexData, uint32_t(indices.size()));
+    } else {
+        auto gpuVertices = Asset::PackVertices(vertices);
+        allocation_ = arena_->Allocate(gpuVertices.data(), uint32_t(gpuVertices.size()), indexData, uint32_t(indices.size()));
+    }
+    if (allocation_ == LoongGpuMeshArena::kInvalidAllocation) {
+        // Nothing to draw
+        for (auto& lod : lods_) {
+            lod.indexCount = 0;
+        }
+    }
+}
 
-    vao_.Bind();
-    vbo_->Bind();
-    ibo_->Bind();
-    vao_.BindAttribute<float>(0, *vbo_, 3, vertexSize, 0);
-    vao_.BindAttribute<float>(1, *vbo_, 2, vertexSize, sizeof(float) * 3);
-    vao_.BindAttribute<float>(2, *vbo_, 3, vertexSize, sizeof(float) * 5);
-    vao_.BindAttribute<float>(3, *vbo_, 3, vertexSize, sizeof(float) * 8);
-    vao_.BindAttribute<float>(4, *vbo_, 3, vertexSize, sizeof(float) * 11);
-    vao_.Unbind();
+void LoongGpuMesh::BindInstanceAttributes(const LoongVertexBuffer& instanceBuffer, intptr_t offset) const
+{
+    const GLsizei instanceSize = sizeof(Math::Matrix4) * 2;
+
+    arena_->Bind();
+    instanceBuffer.Bind();
+    // model matrix
+    for (GLuint i = 0; i < 4; ++i) {
+        GLuint location = kInstanceAttributeLocation + i;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, instanceSize, reinterpret_cast<const GLvoid*>(offset + sizeof(Math::Vector4) * i));
+        glVertexAttribDivisor(location, 1);
+    }
+    // normal matrix
+    for (GLuint i = 0; i < 3; ++i) {
+        GLuint location = kInstanceAttributeLocation + 4 + i;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, instanceSize, reinterpret_cast<const GLvoid*>(offset + sizeof(Math::Matrix4) + sizeof(Math::Vector4) * i));
+        glVertexAttribDivisor(location, 1);
+    }
+    arena_->GetVertexArray().Unbind();
+}
+
+void LoongGpuMesh::UnbindInstanceAttributes() const
+{
+    arena_->Bind();
+    // The model matrix and the normal matrix
+    for (GLuint i = 0; i < 4 + 3; ++i) {
+        glDisableVertexAttribArray(kInstanceAttributeLocation + i);
+    }
+    arena_->GetVertexArray().Unbind();
 }
 
 }
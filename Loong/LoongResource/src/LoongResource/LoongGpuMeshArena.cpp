@@ -0,0 +1,154 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongResource/LoongGpuMeshArena.h"
+#include "LoongFoundation/LoongLogger.h"
+#include <algorithm>
+#include <cassert>
+
+namespace Loong::Resource {
+
+namespace {
+
+constexpr uint32_t kMinVertexCapacity = 64 * 1024;
+constexpr uint32_t kMinIndexCapacity = 3 * 64 * 1024;
+
+void CopyBufferRange(GLuint source, GLuint destination, size_t sourceOffset, size_t destinationOffset, size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+    LoongGLStateCache::BindBuffer(GL_COPY_READ_BUFFER, source);
+    LoongGLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, destination);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GLintptr(sourceOffset), GLintptr(destinationOffset), GLsizeiptr(size));
+}
+
+// The capacity to repack to, so that `size` more can be allocated. Fragmented buffers are only defragmented, full ones
+// are doubled.
+uint32_t GetCapacityFor(const Foundation::LoongRangeAllocator& allocator, uint32_t size, uint32_t minCapacity)
+{
+    uint32_t capacity = std::max(allocator.GetCapacity(), minCapacity);
+    uint64_t required = uint64_t(allocator.GetUsedSize()) + size;
+    if (required * 4 <= uint64_t(capacity) * 3) {
+        return capacity;
+    }
+    return uint32_t(std::min<uint64_t>(std::max<uint64_t>(uint64_t(capacity) * 2, required), ~uint32_t(0)));
+}
+
+}
+
+LoongGpuMeshArena::LoongGpuMeshArena(uint32_t vertexSize, GLenum indexType, BindAttributesFunc bindAttributes)
+    : vertexSize_(vertexSize)
+    , indexType_(indexType)
+    , bindAttributes_(bindAttributes)
+{
+    Repack(kMinVertexCapacity, kMinIndexCapacity);
+}
+
+uint32_t LoongGpuMeshArena::Allocate(const void* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount)
+{
+    constexpr uint32_t kInvalidOffset = Foundation::LoongRangeAllocator::kInvalidOffset;
+
+    uint32_t firstVertex = vertexAllocator_.Allocate(vertexCount);
+    uint32_t firstIndex = indexAllocator_.Allocate(indexCount);
+    if (firstVertex == kInvalidOffset || firstIndex == kInvalidOffset) {
+        if (firstVertex != kInvalidOffset) {
+            vertexAllocator_.Free(firstVertex, vertexCount);
+        }
+        if (firstIndex != kInvalidOffset) {
+            indexAllocator_.Free(firstIndex, indexCount);
+        }
+        Repack(GetCapacityFor(vertexAllocator_, vertexCount, kMinVertexCapacity), GetCapacityFor(indexAllocator_, indexCount, kMinIndexCapacity));
+        firstVertex = vertexAllocator_.Allocate(vertexCount);
+        firstIndex = indexAllocator_.Allocate(indexCount);
+        if (firstVertex == kInvalidOffset || firstIndex == kInvalidOffset) {
+            LOONG_ERROR("Allocate {} vertices and {} indices from the mesh arena failed", vertexCount, indexCount);
+            return kInvalidAllocation;
+        }
+    }
+    vbo_.SetSubData(vertices, size_t(vertexCount) * vertexSize_, size_t(firstVertex) * vertexSize_);
+    ibo_.SetSubData(indices, size_t(indexCount) * GetIndexSize(), size_t(firstIndex) * GetIndexSize());
+
+    uint32_t allocation = 0;
+    if (!freeAllocations_.empty()) {
+        allocation = freeAllocations_.back();
+        freeAllocations_.pop_back();
+    } else {
+        allocation = uint32_t(ranges_.size());
+        ranges_.emplace_back();
+        isAlive_.push_back(0);
+    }
+    ranges_[allocation] = Range { firstVertex, vertexCount, firstIndex, indexCount };
+    isAlive_[allocation] = 1;
+    return allocation;
+}
+
+void LoongGpuMeshArena::Free(uint32_t allocation)
+{
+    assert(allocation < ranges_.size() && isAlive_[allocation]);
+    auto& range = ranges_[allocation];
+    vertexAllocator_.Free(range.firstVertex, range.vertexCount);
+    indexAllocator_.Free(range.firstIndex, range.indexCount);
+    range = Range {};
+    isAlive_[allocation] = 0;
+    freeAllocations_.push_back(allocation);
+
+    ShrinkIfSparse();
+}
+
+const LoongGpuMeshArena::Range& LoongGpuMeshArena::GetRange(uint32_t allocation) const
+{
+    static const Range kEmptyRange {};
+    return allocation < ranges_.size() ? ranges_[allocation] : kEmptyRange;
+}
+
+void LoongGpuMeshArena::ShrinkIfSparse()
+{
+    // Give the memory back once less than a quarter of a buffer is used, this also defragments the buffers
+    auto isSparse = [](const Foundation::LoongRangeAllocator& allocator, uint32_t minCapacity) {
+        return allocator.GetCapacity() > minCapacity && uint64_t(allocator.GetUsedSize()) * 4 < allocator.GetCapacity();
+    };
+    if (isSparse(vertexAllocator_, kMinVertexCapacity) || isSparse(indexAllocator_, kMinIndexCapacity)) {
+        Repack(std::max(vertexAllocator_.GetUsedSize() * 2, kMinVertexCapacity), std::max(indexAllocator_.GetUsedSize() * 2, kMinIndexCapacity));
+    }
+}
+
+void LoongGpuMeshArena::Repack(uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+    LoongVertexBuffer vbo;
+    LoongIndexBuffer ibo;
+    vbo.BufferData<uint8_t>(nullptr, size_t(vertexCapacity) * vertexSize_);
+    ibo.BufferData<uint8_t>(nullptr, size_t(indexCapacity) * GetIndexSize());
+
+    // Pack the live ranges at the front of the new buffers, the indices are relative to the first vertex so they
+    // don't change
+    vertexAllocator_.Reset(vertexCapacity);
+    indexAllocator_.Reset(indexCapacity);
+    for (size_t i = 0; i < ranges_.size(); ++i) {
+        if (!isAlive_[i]) {
+            continue;
+        }
+        auto& range = ranges_[i];
+        uint32_t firstVertex = vertexAllocator_.Allocate(range.vertexCount);
+        uint32_t firstIndex = indexAllocator_.Allocate(range.indexCount);
+        assert(firstVertex != Foundation::LoongRangeAllocator::kInvalidOffset);
+        assert(firstIndex != Foundation::LoongRangeAllocator::kInvalidOffset);
+        CopyBufferRange(vbo_.GetID(), vbo.GetID(), size_t(range.firstVertex) * vertexSize_, size_t(firstVertex) * vertexSize_, size_t(range.vertexCount) * vertexSize_);
+        CopyBufferRange(ibo_.GetID(), ibo.GetID(), size_t(range.firstIndex) * GetIndexSize(), size_t(firstIndex) * GetIndexSize(), size_t(range.indexCount) * GetIndexSize());
+        range.firstVertex = firstVertex;
+        range.firstIndex = firstIndex;
+    }
+    // The old buffers are deleted with the locals
+    std::swap(vbo_, vbo);
+    std::swap(ibo_, ibo);
+
+    vao_.Bind();
+    bindAttributes_(vao_, vbo_);
+    ibo_.Bind();
+    vao_.Unbind();
+
+    LOONG_TRACE("Repack mesh arena 0x{:0X} to {} vertices and {} indices", intptr_t(this), vertexCapacity, indexCapacity);
+}
+
+}
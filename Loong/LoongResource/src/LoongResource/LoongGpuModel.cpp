@@ -3,20 +3,77 @@
 //
 
 #include "LoongResource/LoongGpuModel.h"
+#include "LoongAsset/LoongMesh.h"
 #include "LoongAsset/LoongModel.h"
+#include "LoongAsset/LoongModelFile.h"
+#include "LoongFoundation/LoongJobSystem.h"
+#include "LoongFoundation/LoongLogger.h"
 #include "LoongResource/LoongGpuMesh.h"
 
 namespace Loong::Resource {
 
-LoongGpuModel::LoongGpuModel(const Asset::LoongModel& model, const std::string& path)
+namespace {
+
+// The entering face of the box is the normal, the ray starting inside the box hits it at the origin
+bool RayIntersectsAABB(const Math::AABB& aabb, const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, float& distance, Math::Vector3& normal)
 {
-    meshes_.reserve(model.GetMeshes().size());
-    materialNames_ = model.GetMaterialNames();
-    aabb_ = model.GetAABB();
+    const Math::Vector3 invDir = 1.0F / direction;
+    Math::Vector3 t1 = (aabb.min - origin) * invDir;
+    Math::Vector3 t2 = (aabb.max - origin) * invDir;
+    Math::Vector3 tMin = Math::Min(t1, t2);
+    Math::Vector3 tMax = Math::Max(t1, t2);
+    float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0F));
+    float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+    if (enter > exit) {
+        return false;
+    }
+    distance = enter;
+    int axis = tMin.x >= tMin.y && tMin.x >= tMin.z ? 0 : (tMin.y >= tMin.z ? 1 : 2);
+    normal = Math::Vector3 { 0.0F };
+    normal[axis] = direction[axis] > 0.0F ? -1.0F : 1.0F;
+    return true;
+}
+
+}
 
-    for (auto& mesh : model.GetMeshes()) {
+LoongGpuModel::LoongGpuModel(std::shared_ptr<const Asset::LoongModel> model, const std::string& path)
+{
+    meshes_.reserve(model->GetMeshes().size());
+    materialNames_ = model->GetMaterialNames();
+    aabb_ = model->GetAABB();
+
+    triangleBVHs_ = std::make_shared<TriangleBVHs>();
+    for (auto* mesh : model->GetMeshes()) {
         meshes_.emplace_back(new LoongGpuMesh(*mesh));
+        auto& vertices = mesh->GetVertices();
+        auto& indices = mesh->GetIndices();
+        triangleBVHs_->geometries.push_back({ vertices.data(), uint32_t(sizeof(Asset::LoongVertex)), uint32_t(vertices.size()), indices.data(), uint32_t(sizeof(uint32_t)), uint32_t(indices.size()) });
+        triangleBVHs_->sourceSize += vertices.size() * sizeof(Asset::LoongVertex) + indices.size() * sizeof(uint32_t);
+    }
+    triangleBVHs_->source = std::move(model);
+    UpdateMeshBounds();
+    path_ = path;
+}
+
+LoongGpuModel::LoongGpuModel(std::shared_ptr<const Asset::LoongModelFile> file, const std::string& path)
+{
+    meshes_.reserve(file->GetMeshCount());
+    materialNames_ = file->GetMaterialNames();
+    aabb_ = file->GetAABB();
+
+    triangleBVHs_ = std::make_shared<TriangleBVHs>();
+    for (uint32_t i = 0; i < file->GetMeshCount(); ++i) {
+        meshes_.emplace_back(new LoongGpuMesh(*file, i));
+        // The packed vertices start with the position
+        auto& view = file->GetMesh(i);
+        auto& lod = view.lods[0];
+        auto* indices = static_cast<const uint8_t*>(view.indices) + size_t(lod.indexOffset) * view.GetIndexSize();
+        triangleBVHs_->geometries.push_back({ view.vertices, view.GetVertexSize(), view.mesh->vertexCount, indices, view.GetIndexSize(), lod.indexCount });
     }
+    // The mapped pages are the page cache's
+    triangleBVHs_->sourceSize = file->GetFile().IsMapped() ? 0 : file->GetFile().GetSize();
+    triangleBVHs_->source = std::move(file);
+    UpdateMeshBounds();
     path_ = path;
 }
 
@@ -28,4 +85,86 @@ LoongGpuModel::~LoongGpuModel()
     meshes_.clear();
 }
 
+bool LoongGpuModel::Raycast(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, RaycastHit& hit) const
+{
+    if (!triangleBVHs_->isReady) {
+        BuildTriangleBVHs();
+        return RaycastMeshBounds(origin, direction, maxDistance, hit);
+    }
+
+    auto& bvhs = triangleBVHs_->bvhs;
+    bool isHit = false;
+    Foundation::LoongTriangleBVH::RaycastHit meshHit {};
+    for (size_t i = 0; i < bvhs.size(); ++i) {
+        if (bvhs[i].Raycast(origin, direction, maxDistance, meshHit)) {
+            isHit = true;
+            maxDistance = meshHit.distance;
+            hit.distance = meshHit.distance;
+            hit.meshIndex = uint32_t(i);
+            hit.triangleIndex = meshHit.triangleIndex;
+            hit.normal = meshHit.normal;
+        }
+    }
+    return isHit;
+}
+
+uint64_t LoongGpuModel::GetRaycastMemory() const
+{
+    if (!triangleBVHs_->isReady) {
+        return triangleBVHs_->sourceSize;
+    }
+    uint64_t size = 0;
+    for (auto& bvh : triangleBVHs_->bvhs) {
+        size += bvh.GetMemorySize();
+    }
+    return size;
+}
+
+void LoongGpuModel::UpdateMeshBounds()
+{
+    meshBounds_.Resize(meshes_.size());
+    for (size_t i = 0; i < meshes_.size(); ++i) {
+        meshBounds_.Set(i, meshes_[i]->GetAABB());
+    }
+}
+
+bool LoongGpuModel::RaycastMeshBounds(const Math::Vector3& origin, const Math::Vector3& direction, float maxDistance, RaycastHit& hit) const
+{
+    bool isHit = false;
+    for (size_t i = 0; i < meshes_.size(); ++i) {
+        float distance = 0.0F;
+        Math::Vector3 normal {};
+        if (RayIntersectsAABB(meshes_[i]->GetAABB(), origin, direction, maxDistance, distance, normal)) {
+            isHit = true;
+            maxDistance = distance;
+            hit.distance = distance;
+            hit.meshIndex = uint32_t(i);
+            hit.triangleIndex = 0;
+            hit.normal = normal;
+        }
+    }
+    return isHit;
+}
+
+void LoongGpuModel::BuildTriangleBVHs() const
+{
+    if (triangleBVHs_->isScheduled) {
+        return;
+    }
+    triangleBVHs_->isScheduled = true;
+    Foundation::LoongJobSystem::Schedule([triangleBVHs = triangleBVHs_, path = path_]() {
+        auto& geometries = triangleBVHs->geometries;
+        triangleBVHs->bvhs.resize(geometries.size());
+        for (size_t i = 0; i < geometries.size(); ++i) {
+            auto& geometry = geometries[i];
+            triangleBVHs->bvhs[i].Build(geometry.vertices, geometry.stride, geometry.vertexCount, geometry.indices, geometry.indexSize, geometry.indexCount);
+        }
+        // The pointers into the source are dangling from here on
+        geometries.clear();
+        triangleBVHs->source = nullptr;
+        triangleBVHs->isReady = true;
+        LOONG_TRACE("Build triangle BVHs for model '{}'", path);
+    });
+}
+
 }
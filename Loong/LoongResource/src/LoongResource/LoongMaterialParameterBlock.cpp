@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongResource/LoongMaterialParameterBlock.h"
+#include "LoongFoundation/LoongLogger.h"
+#include "LoongResource/LoongGLStateCache.h"
+#include "LoongResource/LoongTexture.h"
+#include <cassert>
+#include <cstring>
+
+namespace Loong::Resource {
+
+static uint64_t gNextParameterVersion = 1;
+
+inline uint32_t GetUniformValueSize(LoongShader::UniformType type)
+{
+    switch (type) {
+    // clang-format off
+    case LoongShader::UniformType::kUniformBool:        return sizeof(GLint);
+    case LoongShader::UniformType::kUniformInt:         return sizeof(GLint);
+    case LoongShader::UniformType::kUniformFloat:       return sizeof(float);
+    case LoongShader::UniformType::kUniformFloatVec2:   return sizeof(Math::Vector2);
+    case LoongShader::UniformType::kUniformFloatVec3:   return sizeof(Math::Vector3);
+    case LoongShader::UniformType::kUniformFloatVec4:   return sizeof(Math::Vector4);
+    case LoongShader::UniformType::kUniformFloatMat4:   return sizeof(Math::Matrix4);
+    case LoongShader::UniformType::kUniformSampler2D:   return sizeof(GLint); // texture unit
+    // clang-format on
+    case LoongShader::UniformType::kUniformSamplerCube:
+    default:
+        assert(false); // impossible, or thers is a bug in Shader::GetUniformInfo();
+        return 0;
+    }
+}
+
+void LoongMaterialParameterBlock::Compile(const LoongShader& shader)
+{
+    parameters_.clear();
+    names_.clear();
+    textures_.clear();
+
+    uint32_t offset = 0;
+    for (const auto& info : shader.GetUniformInfo()) {
+        Parameter parameter { info.type, GLint(info.location), offset, -1, false };
+        if (info.type == LoongShader::UniformType::kUniformSampler2D) {
+            parameter.textureIndex = int32_t(textures_.size());
+            textures_.push_back(nullptr);
+        }
+        offset += GetUniformValueSize(info.type);
+        parameters_.push_back(parameter);
+        names_.push_back(info.name);
+    }
+    values_.assign(offset, 0);
+    isDirty_ = true;
+}
+
+template <class T>
+static bool CopyValue(const std::any& value, uint8_t* dst)
+{
+    if (value.type() != typeid(T)) {
+        return false;
+    }
+    const auto& v = std::any_cast<const T&>(value);
+    memcpy(dst, &v, sizeof(T));
+    return true;
+}
+
+void LoongMaterialParameterBlock::Update(const std::map<std::string, std::any>& uniformsData)
+{
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+        auto& parameter = parameters_[i];
+        auto& name = names_[i];
+        parameter.isValid = false;
+
+        auto it = uniformsData.find(name);
+        if (it == uniformsData.end()) {
+            continue;
+        }
+        auto& value = it->second;
+        uint8_t* dst = values_.data() + parameter.offset;
+
+        switch (parameter.type) {
+        case LoongShader::UniformType::kUniformBool:
+            if (value.type() == typeid(bool)) {
+                GLint v = std::any_cast<bool>(value);
+                memcpy(dst, &v, sizeof(v));
+                parameter.isValid = true;
+            } else {
+                LOONG_WARNING("Wrong value type for shader variable {}, expect Bool!", name);
+            }
+            break;
+        // clang-format off
+        case LoongShader::UniformType::kUniformInt:       if (!(parameter.isValid = CopyValue<GLint>(value, dst)))          { LOONG_WARNING("Wrong value type for shader variable {}, expect Int!", name); } break;
+        case LoongShader::UniformType::kUniformFloat:     if (!(parameter.isValid = CopyValue<float>(value, dst)))          { LOONG_WARNING("Wrong value type for shader variable {}, expect Float!", name); } break;
+        case LoongShader::UniformType::kUniformFloatVec2: if (!(parameter.isValid = CopyValue<Math::Vector2>(value, dst)))  { LOONG_WARNING("Wrong value type for shader variable {}, expect FloatVec2!", name); } break;
+        case LoongShader::UniformType::kUniformFloatVec3: if (!(parameter.isValid = CopyValue<Math::Vector3>(value, dst)))  { LOONG_WARNING("Wrong value type for shader variable {}, expect FloatVec3!", name); } break;
+        case LoongShader::UniformType::kUniformFloatVec4: if (!(parameter.isValid = CopyValue<Math::Vector4>(value, dst)))  { LOONG_WARNING("Wrong value type for shader variable {}, expect FloatVec4!", name); } break;
+        case LoongShader::UniformType::kUniformFloatMat4: if (!(parameter.isValid = CopyValue<Math::Matrix4>(value, dst)))  { LOONG_WARNING("Wrong value type for shader variable {}, expect FloatMat4!", name); } break;
+        // clang-format on
+        case LoongShader::UniformType::kUniformSampler2D:
+            if (value.type() == typeid(std::shared_ptr<LoongTexture>)) {
+                textures_[parameter.textureIndex] = std::any_cast<std::shared_ptr<LoongTexture>>(value);
+                GLint unit = parameter.textureIndex;
+                memcpy(dst, &unit, sizeof(unit));
+                parameter.isValid = true;
+            }
+            break;
+        case LoongShader::UniformType::kUniformSamplerCube:
+        default:
+            assert(false); // impossible, or thers is a bug in Shader::GetUniformInfo();
+        }
+    }
+
+    version_ = gNextParameterVersion++;
+    isDirty_ = false;
+}
+
+void LoongMaterialParameterBlock::Apply(const LoongShader& shader, LoongTexture* emptyTexture) const
+{
+    assert(!isDirty_);
+
+    // The texture units are shared by all the materials, so they are always bound, the redundant ones are dropped by
+    // the state cache
+    for (const auto& parameter : parameters_) {
+        if (parameter.textureIndex < 0 || !parameter.isValid) {
+            continue;
+        }
+        if (auto& tex = textures_[parameter.textureIndex]; tex) {
+            tex->Bind(parameter.textureIndex);
+        } else if (emptyTexture) {
+            emptyTexture->Bind(parameter.textureIndex);
+        } else {
+            LoongGLStateCache::BindTexture(parameter.textureIndex, 0);
+        }
+    }
+
+    if (shader.GetParameterVersion() == version_) {
+        return;
+    }
+
+    for (const auto& parameter : parameters_) {
+        if (!parameter.isValid) {
+            continue;
+        }
+        const uint8_t* data = values_.data() + parameter.offset;
+        switch (parameter.type) {
+        // clang-format off
+        case LoongShader::UniformType::kUniformBool:
+        case LoongShader::UniformType::kUniformInt:
+        case LoongShader::UniformType::kUniformSampler2D: glUniform1iv(parameter.location, 1, reinterpret_cast<const GLint*>(data)); break;
+        case LoongShader::UniformType::kUniformFloat:     glUniform1fv(parameter.location, 1, reinterpret_cast<const GLfloat*>(data)); break;
+        case LoongShader::UniformType::kUniformFloatVec2: glUniform2fv(parameter.location, 1, reinterpret_cast<const GLfloat*>(data)); break;
+        case LoongShader::UniformType::kUniformFloatVec3: glUniform3fv(parameter.location, 1, reinterpret_cast<const GLfloat*>(data)); break;
+        case LoongShader::UniformType::kUniformFloatVec4: glUniform4fv(parameter.location, 1, reinterpret_cast<const GLfloat*>(data)); break;
+        case LoongShader::UniformType::kUniformFloatMat4: glUniformMatrix4fv(parameter.location, 1, GL_TRUE, reinterpret_cast<const GLfloat*>(data)); break;
+        // clang-format on
+        case LoongShader::UniformType::kUniformSamplerCube:
+        default:
+            assert(false);
+        }
+    }
+
+    shader.SetParameterVersion(version_);
+}
+
+}
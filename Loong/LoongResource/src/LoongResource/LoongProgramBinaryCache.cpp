@@ -0,0 +1,215 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongResource/LoongProgramBinaryCache.h"
+#include "LoongFileSystem/LoongFileSystem.h"
+#include "LoongFoundation/LoongDefer.h"
+#include "LoongFoundation/LoongLogger.h"
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace Loong::Resource {
+
+namespace {
+
+// The file of an entry is the header, then the binary
+struct BinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t size;
+};
+
+constexpr uint32_t kBinaryMagic = 0x4250474C; // "LGPB"
+constexpr uint32_t kBinaryVersion = 1;
+constexpr const char* kOrganization = "Loong";
+constexpr const char* kAppName = "Loong";
+constexpr const char* kCacheDir = "ShaderCache";
+// The last write time of an entry is the last time it is loaded
+constexpr auto kMaxUnusedTime = std::chrono::hours(24 * 30);
+
+enum class Support {
+    kUnknown,
+    kSupported,
+    kUnsupported,
+};
+
+Support gSupport { Support::kUnknown };
+// Of the driver strings
+uint64_t gDriverHash { 0 };
+// Native, ends with the separator
+std::string gCacheDir {};
+
+uint64_t Hash(uint64_t hash, const void* data, size_t size)
+{
+    auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t HashString(uint64_t hash, const char* s)
+{
+    // With the '\0', so that the strings don't run into each other
+    return s != nullptr ? Hash(hash, s, strlen(s) + 1) : Hash(hash, "", 1);
+}
+
+std::string GetEntryPath(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".bin", key);
+    return gCacheDir + name;
+}
+
+void PruneEntries()
+{
+    std::error_code error;
+    const auto now = std::filesystem::file_time_type::clock::now();
+    uint32_t count = 0;
+    for (std::filesystem::directory_iterator it(gCacheDir, error), end; !error && it != end; it.increment(error)) {
+        std::error_code entryError;
+        auto lastUsedTime = it->last_write_time(entryError);
+        if (!entryError && it->is_regular_file(entryError) && now - lastUsedTime > kMaxUnusedTime
+            && std::filesystem::remove(it->path(), entryError)) {
+            ++count;
+        }
+    }
+    if (count > 0) {
+        LOONG_INFO("Delete {} unused program binaries", count);
+    }
+}
+
+}
+
+bool LoongProgramBinaryCache::IsEnabled()
+{
+    if (gSupport == Support::kUnknown) {
+        GLint formatCount = 0;
+        if (glProgramBinary != nullptr && glGetProgramBinary != nullptr && glProgramParameteri != nullptr) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        }
+        uint64_t hash = Hash(14695981039346656037ULL, &kBinaryVersion, sizeof(kBinaryVersion));
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION }) {
+            hash = HashString(hash, reinterpret_cast<const char*>(glGetString(name)));
+        }
+        gDriverHash = hash;
+
+        gSupport = Support::kUnsupported;
+        const char* prefDir = formatCount > 0 ? FS::LoongFileSystem::GetPrefDir(kOrganization, kAppName) : nullptr;
+        if (formatCount <= 0) {
+            LOONG_INFO("Program binary cache disabled, the driver supports no binary formats");
+        } else if (prefDir == nullptr) {
+            LOONG_WARNING("Program binary cache disabled: {}", FS::LoongFileSystem::GetLastError());
+        } else {
+            gCacheDir = std::string(prefDir) + kCacheDir + "/";
+            std::error_code error;
+            std::filesystem::create_directories(gCacheDir, error);
+            if (error) {
+                LOONG_WARNING("Program binary cache disabled, create '{}' failed: {}", gCacheDir, error.message());
+            } else {
+                gSupport = Support::kSupported;
+                LOONG_INFO("Program binary cache enabled in '{}'", gCacheDir);
+                PruneEntries();
+            }
+        }
+    }
+    return gSupport == Support::kSupported;
+}
+
+uint64_t LoongProgramBinaryCache::GetKey(const ShaderSources& shaders)
+{
+    // The defines of the runtime shaders are part of the sources
+    uint64_t hash = gDriverHash;
+    for (auto& [type, source] : shaders) {
+        hash = Hash(hash, &type, sizeof(type));
+        hash = HashString(hash, source.c_str());
+    }
+    return hash;
+}
+
+GLuint LoongProgramBinaryCache::Load(uint64_t key, const std::string& name)
+{
+    if (gSupport != Support::kSupported) {
+        return 0;
+    }
+    std::string path = GetEntryPath(key);
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return 0;
+    }
+    OnScopeExit { fclose(file); };
+
+    // The size is checked before it is allocated
+    std::error_code error;
+    const uint64_t fileSize = std::filesystem::file_size(path, error);
+    BinaryHeader header {};
+    if (error || fread(&header, sizeof(header), 1, file) != 1 || header.magic != kBinaryMagic
+        || header.version != kBinaryVersion || header.key != key || sizeof(header) + uint64_t(header.size) != fileSize) {
+        LOONG_WARNING("Load program binary of {} failed: Corrupted file", name);
+        return 0;
+    }
+    std::vector<uint8_t> binary(header.size);
+    if (fread(binary.data(), 1, binary.size(), file) != binary.size()) {
+        LOONG_WARNING("Load program binary of {} failed: Corrupted file", name);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    if (program == 0) {
+        return 0;
+    }
+    glProgramBinary(program, header.format, binary.data(), GLsizei(binary.size()));
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE) {
+        LOONG_INFO("Program binary of {} is rejected by the driver, compile it again", name);
+        glDeleteProgram(program);
+        return 0;
+    }
+    // Keeps it from being pruned
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    LOONG_TRACE("Load program binary of {}", name);
+    return program;
+}
+
+void LoongProgramBinaryCache::Store(uint64_t key, GLuint program, const std::string& name)
+{
+    if (gSupport != Support::kSupported) {
+        return;
+    }
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0) {
+        return;
+    }
+    std::vector<uint8_t> buffer(sizeof(BinaryHeader) + size_t(size));
+    GLsizei length = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, size, &length, &format, buffer.data() + sizeof(BinaryHeader));
+    if (length <= 0) {
+        return;
+    }
+    BinaryHeader header { kBinaryMagic, kBinaryVersion, key, format, uint32_t(length) };
+    memcpy(buffer.data(), &header, sizeof(header));
+    buffer.resize(sizeof(BinaryHeader) + size_t(length));
+
+    std::string path = GetEntryPath(key);
+    FILE* file = fopen(path.c_str(), "wb");
+    bool isOk = file != nullptr && fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    isOk = (file == nullptr || fclose(file) == 0) && isOk;
+    if (!isOk) {
+        int errorCode = errno;
+        // A partial entry is rejected by the size check anyway
+        std::remove(path.c_str());
+        LOONG_WARNING("Store program binary of {} failed: {}", name, strerror(errorCode));
+    }
+}
+
+}
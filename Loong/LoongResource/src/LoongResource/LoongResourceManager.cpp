@@ -6,19 +6,28 @@
 #include "LoongAsset/LoongImage.h"
 #include "LoongAsset/LoongMesh.h"
 #include "LoongAsset/LoongModel.h"
+#include "LoongAsset/LoongModelFile.h"
 #include "LoongAsset/LoongShaderCode.h"
+#include "LoongFileSystem/LoongMappedFile.h"
 #include "LoongFoundation/LoongDefer.h"
+#include "LoongFoundation/LoongJobSystem.h"
 #include "LoongFoundation/LoongLogger.h"
 #include "LoongResource/LoongGpuMesh.h"
+#include "LoongResource/LoongGpuMeshArena.h"
 #include "LoongResource/LoongGpuModel.h"
 #include "LoongResource/LoongMaterial.h"
+#include "LoongResource/LoongProgramBinaryCache.h"
 #include "LoongResource/LoongRuntimeShader.h"
 #include "LoongResource/LoongShader.h"
 #include "LoongResource/LoongTexture.h"
 #include "LoongResource/loader/LoongMaterialLoader.h"
 #include "LoongResource/loader/LoongTextureLoader.h"
+#include <any>
 #include <cassert>
+#include <chrono>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <vector>
 
 namespace Loong::Resource {
@@ -29,14 +38,255 @@ static std::map<std::string, std::weak_ptr<LoongShader>> gLoadedShaders;
 static std::map<LoongRuntimeShader, std::weak_ptr<LoongShader>> gLoadedRuntimesShaders;
 static std::map<std::string, std::weak_ptr<LoongMaterial>> gLoadedMaterials;
 static std::shared_ptr<LoongGpuMesh> gSkyBoxMesh;
+static std::shared_ptr<LoongGpuModel> gPlaceholderModel;
+
+// Drivers don't tell the memory of the programs, it is roughly the binary size
+static constexpr uint64_t kShaderProgramSize = 64U << 10U;
+
+static LoongResourceSize GetTextureMemory(const LoongTexture& texture)
+{
+    // Always RGBA8, the mipmaps are one third more
+    uint64_t size = uint64_t(texture.GetWidth()) * texture.GetHeight() * 4;
+    return { sizeof(LoongTexture), texture.IsMipmapped() ? size * 4 / 3 : size };
+}
+
+static LoongResourceSize GetModelMemory(const LoongGpuModel& model)
+{
+    LoongResourceSize size { sizeof(LoongGpuModel), 0 };
+    for (auto* mesh : model.GetMeshes()) {
+        size.cpuBytes += sizeof(LoongGpuMesh);
+        size.gpuBytes += uint64_t(mesh->GetVertexCount()) * mesh->GetArena()->GetVertexSize();
+        size.gpuBytes += uint64_t(mesh->GetIndexCount()) * mesh->GetIndexSize();
+    }
+    size.cpuBytes += model.GetRaycastMemory();
+    return size;
+}
+
+static LoongResourceSize GetShaderMemory(const LoongShader& shader)
+{
+    return { sizeof(LoongShader) + shader.GetUniformInfo().size() * sizeof(LoongShader::UniformInfo), kShaderProgramSize };
+}
+
+static LoongResourceSize GetMaterialMemory(const LoongMaterial& material)
+{
+    return { sizeof(LoongMaterial) + material.GetUniformsData().size() * sizeof(std::pair<std::string, std::any>), 0 };
+}
+
+// Destroyed before the maps above, the deleters of the resources erase them from the maps
+static LoongResourceCache<std::string, LoongTexture> gTextureCache(GetTextureMemory);
+static LoongResourceCache<std::string, LoongGpuModel> gModelCache(GetModelMemory);
+static LoongResourceCache<std::string, LoongShader> gShaderCache(GetShaderMemory);
+static LoongResourceCache<std::string, LoongMaterial> gMaterialCache(GetMaterialMemory);
+
+// The resource in use, or the released one in the cache
+template <class Key, class T>
+static std::shared_ptr<T> FindResource(std::map<Key, std::weak_ptr<T>>& loaded, LoongResourceCache<Key, T>& cache, const Key& key)
+{
+    if (auto it = loaded.find(key); it != loaded.end()) {
+        if (auto sp = it->second.lock(); sp != nullptr) {
+            return sp;
+        }
+    }
+    auto sp = cache.Acquire(key);
+    if (sp != nullptr) {
+        loaded[key] = sp;
+    }
+    return sp;
+}
+
+static void TrimCaches()
+{
+    // The materials first, they release their shaders and textures
+    gMaterialCache.Trim();
+    gShaderCache.Trim();
+    gModelCache.Trim();
+    gTextureCache.Trim();
+}
+
+struct TextureRequest {
+    std::string path {};
+    std::weak_ptr<LoongTexture> texture {}; // the placeholder the image is uploaded into
+    std::unique_ptr<Asset::LoongImage> image {}; // written by the worker
+    Foundation::LoongJobCounter counter {};
+    bool isDone { false };
+};
+
+// Version 2 model files are uploaded in place, the older ones are decoded
+struct ModelSource {
+    // Shared with the GPU models, which build the picking BVHs from them
+    std::shared_ptr<Asset::LoongModelFile> file {};
+    std::shared_ptr<Asset::LoongModel> model {};
+
+    bool IsValid() const { return (file != nullptr && *file) || (model != nullptr && *model); }
+};
+
+struct ModelRequest {
+    std::string path {};
+    ModelSource source {}; // written by the worker
+    std::vector<LoongResourceManager::ModelCallback> callbacks {};
+    Foundation::LoongJobCounter counter {};
+    bool isDone { false };
+};
+
+// A decoded resource waiting for Update()
+struct PendingUpload {
+    uint64_t size { 0 };
+    std::function<void()> upload {};
+};
+
+static std::map<std::string, std::shared_ptr<TextureRequest>> gTextureRequests;
+static std::map<std::string, std::shared_ptr<ModelRequest>> gModelRequests;
+static std::mutex gUploadMutex;
+static std::deque<PendingUpload> gUploadQueue;
+static uint64_t gUploadBytesPerFrame { 16U << 20U };
+static std::chrono::duration<float> gUploadTimePerFrame { 0.004F };
+
+static void PushUpload(uint64_t size, std::function<void()> upload)
+{
+    std::lock_guard<std::mutex> lock(gUploadMutex);
+    gUploadQueue.push_back({ size, std::move(upload) });
+}
+
+static ModelSource LoadModelSource(const std::string& path)
+{
+    ModelSource source;
+    FS::LoongMappedFile file(path);
+    if (Asset::LoongModelFile::IsModelFile(file)) {
+        source.file = std::make_shared<Asset::LoongModelFile>(std::move(file), path);
+    } else if (file) {
+        // Decoded from the bytes already read
+        source.model = std::make_shared<Asset::LoongModel>(file.GetData(), file.GetSize(), path);
+    }
+    return source;
+}
+
+static uint64_t GetModelSize(const ModelSource& source)
+{
+    if (source.file != nullptr) {
+        return source.file->GetGeometrySize();
+    }
+    uint64_t size = 0;
+    if (source.model != nullptr) {
+        for (auto* mesh : source.model->GetMeshes()) {
+            size += mesh->GetVertices().size() * sizeof(Asset::LoongVertex) + mesh->GetIndices().size() * sizeof(uint32_t);
+        }
+    }
+    return size;
+}
+
+static std::shared_ptr<LoongTexture> CreatePlaceholderTexture(const std::string& path)
+{
+    uint8_t white[4] { 255, 255, 255, 255 };
+    auto texture = gTextureCache.Add(path, LoongTextureLoader::CreateColor(white, false, [path](const std::string&) {
+        // A failed one may outlive the texture loaded again for the path
+        if (auto it = gLoadedTextures.find(path); it != gLoadedTextures.end() && it->second.expired()) {
+            gLoadedTextures.erase(it);
+        }
+        LOONG_TRACE("Unload texture '{}'", path);
+    }));
+    gLoadedTextures[path] = texture;
+    return texture;
+}
+
+static void FinishTextureRequest(TextureRequest& request)
+{
+    if (request.isDone) {
+        return;
+    }
+    // The worker may not have returned yet
+    Foundation::LoongJobSystem::Wait(request.counter);
+    request.isDone = true;
+    gTextureRequests.erase(request.path);
+
+    auto image = std::move(request.image);
+    auto texture = request.texture.lock();
+    if (texture == nullptr) {
+        // The image is still wanted if the placeholder is in the cache
+        texture = gTextureCache.Acquire(request.path);
+    }
+    if (texture == nullptr) {
+        LOONG_TRACE("Texture '{}' is released before it is loaded", request.path);
+        return;
+    }
+    if (image == nullptr || !*image) {
+        LOONG_ERROR("Load image '{}' failed", request.path);
+    } else if (LoongTextureLoader::Upload(*texture, *image, true)) {
+        LOONG_TRACE("Load texture '{}' succeed", request.path);
+        return;
+    } else {
+        LOONG_ERROR("Load texture '{}' failed", request.path);
+    }
+    // The placeholder stays with its current users only, the next request of the path loads it again
+    gLoadedTextures.erase(request.path);
+    gTextureCache.Forget(request.path);
+}
+
+static std::shared_ptr<LoongGpuModel> CreateGpuModel(const ModelSource& source, const std::string& path)
+{
+    LOONG_TRACE("Load GPU model '{}'", path);
+    auto* gpuModel = source.file != nullptr ? new LoongGpuModel(source.file, path) : new LoongGpuModel(source.model, path);
+    std::shared_ptr<LoongGpuModel> spGpuModel(gpuModel, [path](LoongGpuModel* m) {
+        gLoadedModels.erase(path);
+        delete m;
+    });
+    assert(gpuModel != nullptr);
+
+    spGpuModel = gModelCache.Add(path, std::move(spGpuModel));
+    gLoadedModels[path] = spGpuModel;
+    LOONG_TRACE("Load GPU model '{}' succeed", path);
+    return spGpuModel;
+}
+
+static std::shared_ptr<LoongGpuModel> FinishModelRequest(ModelRequest& request)
+{
+    if (request.isDone) {
+        return nullptr;
+    }
+    // The worker may not have returned yet
+    Foundation::LoongJobSystem::Wait(request.counter);
+    request.isDone = true;
+    gModelRequests.erase(request.path);
+
+    std::shared_ptr<LoongGpuModel> gpuModel;
+    auto source = std::move(request.source);
+    if (!source.IsValid()) {
+        LOONG_ERROR("Load model '{}' failed", request.path);
+    } else {
+        gpuModel = CreateGpuModel(source, request.path);
+    }
+    // The callbacks may request the model again
+    auto callbacks = std::move(request.callbacks);
+    for (auto& callback : callbacks) {
+        callback(gpuModel);
+    }
+    return gpuModel;
+}
 
 bool LoongResourceManager::Initialize()
 {
+    gTextureCache.SetBudget({ 1U << 20U, 256U << 20U });
+    gModelCache.SetBudget({ 1U << 20U, 128U << 20U });
+    gShaderCache.SetBudget({ 1U << 20U, 8U << 20U });
+    gMaterialCache.SetBudget({ 1U << 20U, 0 });
     return true;
 }
 
 void LoongResourceManager::Uninitialize()
 {
+    for (auto& [path, request] : gTextureRequests) {
+        Foundation::LoongJobSystem::Wait(request->counter);
+    }
+    for (auto& [path, request] : gModelRequests) {
+        Foundation::LoongJobSystem::Wait(request->counter);
+    }
+    {
+        std::lock_guard<std::mutex> lock(gUploadMutex);
+        gUploadQueue.clear();
+    }
+    gTextureRequests.clear();
+    gModelRequests.clear();
+    ClearCache();
+    gPlaceholderModel = nullptr;
     gLoadedTextures.clear();
     gLoadedModels.clear();
     gLoadedShaders.clear();
@@ -47,11 +297,17 @@ void LoongResourceManager::Uninitialize()
 
 std::shared_ptr<LoongTexture> LoongResourceManager::GetTexture(const std::string& path)
 {
-    auto it = gLoadedTextures.find(path);
-    if (it != gLoadedTextures.end()) {
-        auto sp = it->second.lock();
-        assert(sp != nullptr);
-        return sp;
+    if (auto requestIt = gTextureRequests.find(path); requestIt != gTextureRequests.end()) {
+        auto request = requestIt->second;
+        auto texture = request->texture.lock();
+        FinishTextureRequest(*request);
+        if (texture != nullptr) {
+            return texture;
+        }
+    }
+
+    if (auto texture = FindResource(gLoadedTextures, gTextureCache, path); texture != nullptr) {
+        return texture;
     }
 
     Asset::LoongImage image(path);
@@ -62,12 +318,12 @@ std::shared_ptr<LoongTexture> LoongResourceManager::GetTexture(const std::string
     }
 
     LOONG_TRACE("Load texture '{}'", path);
-    auto texture = LoongTextureLoader::Create(image, true, [](const std::string& p) {
+    auto texture = gTextureCache.Add(path, LoongTextureLoader::Create(image, true, [](const std::string& p) {
         gLoadedTextures.erase(p);
         LOONG_TRACE("Unload texture '{}'", p);
-    });
+    }));
     if (texture != nullptr) {
-        gLoadedTextures.insert({ path, texture });
+        gLoadedTextures[path] = texture;
         LOONG_TRACE("Load texture '{}' succeed", path);
     } else {
         LOONG_ERROR("Load texture '{}' failed", path);
@@ -75,32 +331,200 @@ std::shared_ptr<LoongTexture> LoongResourceManager::GetTexture(const std::string
     return texture;
 }
 
+std::shared_ptr<LoongTexture> LoongResourceManager::GetTextureAsync(const std::string& path)
+{
+    if (auto texture = FindResource(gLoadedTextures, gTextureCache, path); texture != nullptr) {
+        if (auto requestIt = gTextureRequests.find(path); requestIt != gTextureRequests.end()) {
+            // The placeholder may be taken back from the cache, the image goes to the new reference
+            requestIt->second->texture = texture;
+        }
+        return texture;
+    }
+
+    if (auto requestIt = gTextureRequests.find(path); requestIt != gTextureRequests.end()) {
+        // The previous placeholder is released, the image goes to the new one
+        auto texture = CreatePlaceholderTexture(path);
+        requestIt->second->texture = texture;
+        return texture;
+    }
+
+    LOONG_TRACE("Load texture '{}' asynchronously", path);
+    auto texture = CreatePlaceholderTexture(path);
+    auto request = std::make_shared<TextureRequest>();
+    request->path = path;
+    request->texture = texture;
+    gTextureRequests.insert({ path, request });
+    Foundation::LoongJobSystem::Schedule([request]() {
+        request->image = std::make_unique<Asset::LoongImage>(request->path);
+        request->image->FlipVertically();
+        auto& image = *request->image;
+        uint64_t size = bool(image) ? uint64_t(image.GetWidth()) * image.GetHeight() * image.GetChannelCount() : 0;
+        PushUpload(size, [request]() { FinishTextureRequest(*request); });
+    },
+        &request->counter);
+    return texture;
+}
+
 std::shared_ptr<LoongGpuModel> LoongResourceManager::GetModel(const std::string& path)
 {
-    auto it = gLoadedModels.find(path);
-    if (it != gLoadedModels.end()) {
-        auto sp = it->second.lock();
-        assert(sp != nullptr);
-        return sp;
+    if (auto requestIt = gModelRequests.find(path); requestIt != gModelRequests.end()) {
+        auto request = requestIt->second;
+        return FinishModelRequest(*request);
     }
 
-    Asset::LoongModel model(path);
-    if (!model) {
+    if (auto model = FindResource(gLoadedModels, gModelCache, path); model != nullptr) {
+        return model;
+    }
+
+    auto source = LoadModelSource(path);
+    if (!source.IsValid()) {
         LOONG_ERROR("Load model '{}' failed", path);
         return nullptr;
     }
 
-    LOONG_TRACE("Load GPU model '{}'", path);
-    auto* gpuModel = new LoongGpuModel(model, path);
-    std::shared_ptr<LoongGpuModel> spGpuModel(gpuModel, [path](LoongGpuModel* m) {
-        gLoadedModels.erase(path);
-        delete m;
-    });
-    assert(gpuModel != nullptr);
+    return CreateGpuModel(source, path);
+}
 
-    gLoadedModels.insert({ path, spGpuModel });
-    LOONG_TRACE("Load GPU model '{}' succeed", path);
-    return spGpuModel;
+void LoongResourceManager::GetModelAsync(const std::string& path, ModelCallback callback)
+{
+    assert(callback != nullptr);
+    if (auto model = FindResource(gLoadedModels, gModelCache, path); model != nullptr) {
+        callback(model);
+        return;
+    }
+
+    if (auto requestIt = gModelRequests.find(path); requestIt != gModelRequests.end()) {
+        requestIt->second->callbacks.push_back(std::move(callback));
+        return;
+    }
+
+    LOONG_TRACE("Load GPU model '{}' asynchronously", path);
+    auto request = std::make_shared<ModelRequest>();
+    request->path = path;
+    request->callbacks.push_back(std::move(callback));
+    gModelRequests.insert({ path, request });
+    Foundation::LoongJobSystem::Schedule([request]() {
+        request->source = LoadModelSource(request->path);
+        if (request->source.file != nullptr) {
+            // Read the mapped file here instead of in the upload
+            request->source.file->GetFile().Prefault();
+        }
+        PushUpload(GetModelSize(request->source), [request]() { FinishModelRequest(*request); });
+    },
+        &request->counter);
+}
+
+std::shared_ptr<LoongGpuModel> LoongResourceManager::GetPlaceholderModel()
+{
+    if (gPlaceholderModel == nullptr) {
+        const Math::Vector2 kCorners[] { { 0.0F, 0.0F }, { 1.0F, 0.0F }, { 1.0F, 1.0F }, { 0.0F, 1.0F } };
+        std::vector<Asset::LoongVertex> vertices;
+        std::vector<uint32_t> indices;
+        for (int axis = 0; axis < 3; ++axis) {
+            for (float sign : { -1.0F, 1.0F }) {
+                Math::Vector3 normal {};
+                normal[axis] = sign;
+                Math::Vector3 tangent {};
+                tangent[(axis + 1) % 3] = 1.0F;
+                Math::Vector3 bitangent = Math::Cross(normal, tangent);
+                auto first = uint32_t(vertices.size());
+                for (const auto& uv : kCorners) {
+                    Math::Vector3 position = (normal + tangent * (uv.x * 2.0F - 1.0F) + bitangent * (uv.y * 2.0F - 1.0F)) * 0.5F;
+                    vertices.push_back({ position, uv, normal, tangent, bitangent });
+                }
+                indices.insert(indices.end(), { first, first + 1, first + 2, first + 2, first + 3, first });
+            }
+        }
+        auto model = std::make_shared<Asset::LoongModel>(std::vector<Asset::LoongMesh*> { new Asset::LoongMesh(std::move(vertices), std::move(indices), 0) }, std::vector<std::string> { "" });
+        gPlaceholderModel = std::make_shared<LoongGpuModel>(model, "");
+    }
+    return gPlaceholderModel;
+}
+
+bool LoongResourceManager::IsLoading(const std::string& path)
+{
+    return gTextureRequests.count(path) > 0 || gModelRequests.count(path) > 0;
+}
+
+void LoongResourceManager::Update()
+{
+    using Clock = std::chrono::steady_clock;
+    const auto startTime = Clock::now();
+    uint64_t uploadedBytes = 0;
+    while (true) {
+        PendingUpload upload;
+        {
+            std::lock_guard<std::mutex> lock(gUploadMutex);
+            if (gUploadQueue.empty()) {
+                break;
+            }
+            if (uploadedBytes > 0 && uploadedBytes + gUploadQueue.front().size > gUploadBytesPerFrame) {
+                break;
+            }
+            upload = std::move(gUploadQueue.front());
+            gUploadQueue.pop_front();
+        }
+        // Already finished if a Get function needed it earlier
+        upload.upload();
+        uploadedBytes += upload.size;
+        if (Clock::now() - startTime >= gUploadTimePerFrame) {
+            break;
+        }
+    }
+
+    TrimCaches();
+}
+
+void LoongResourceManager::SetUploadBudget(uint64_t bytesPerFrame, float secondsPerFrame)
+{
+    gUploadBytesPerFrame = bytesPerFrame;
+    gUploadTimePerFrame = std::chrono::duration<float>(secondsPerFrame);
+}
+
+void LoongResourceManager::SetCacheBudget(LoongResourceType type, const LoongResourceCacheBudget& budget)
+{
+    switch (type) {
+    case LoongResourceType::kTexture:
+        gTextureCache.SetBudget(budget);
+        break;
+    case LoongResourceType::kModel:
+        gModelCache.SetBudget(budget);
+        break;
+    case LoongResourceType::kShader:
+        gShaderCache.SetBudget(budget);
+        break;
+    case LoongResourceType::kMaterial:
+        gMaterialCache.SetBudget(budget);
+        break;
+    default:
+        assert(false);
+    }
+}
+
+LoongResourceCacheStats LoongResourceManager::GetCacheStats(LoongResourceType type)
+{
+    switch (type) {
+    case LoongResourceType::kTexture:
+        return gTextureCache.GetStats();
+    case LoongResourceType::kModel:
+        return gModelCache.GetStats();
+    case LoongResourceType::kShader:
+        return gShaderCache.GetStats();
+    case LoongResourceType::kMaterial:
+        return gMaterialCache.GetStats();
+    default:
+        assert(false);
+        return {};
+    }
+}
+
+void LoongResourceManager::ClearCache()
+{
+    // The materials first, they hold the shaders and textures
+    gMaterialCache.Clear();
+    gShaderCache.Clear();
+    gModelCache.Clear();
+    gTextureCache.Clear();
 }
 
 static const char* GetShaderTypeName(uint32_t type)
@@ -145,6 +569,15 @@ static GLuint CompileShader(const std::string& filePath, uint32_t type, const st
 
 static GLuint CreateProgram(const std::string& filePath, const std::vector<std::pair<uint32_t, const std::string&>>& shaders)
 {
+    const bool isCacheEnabled = LoongProgramBinaryCache::IsEnabled();
+    const uint64_t cacheKey = isCacheEnabled ? LoongProgramBinaryCache::GetKey(shaders) : 0;
+    if (isCacheEnabled) {
+        const GLuint cachedProgram = LoongProgramBinaryCache::Load(cacheKey, filePath);
+        if (cachedProgram != 0) {
+            return cachedProgram;
+        }
+    }
+
     const uint32_t program = glCreateProgram();
     if (program == 0) {
         LOONG_ERROR("Create shader program for {} failed", filePath);
@@ -167,6 +600,9 @@ static GLuint CreateProgram(const std::string& filePath, const std::vector<std::
         });
         glAttachShader(program, shaderId);
     }
+    if (isCacheEnabled) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(program);
 
     GLint linkStatus;
@@ -186,6 +622,9 @@ static GLuint CreateProgram(const std::string& filePath, const std::vector<std::
     }
 
     glValidateProgram(program);
+    if (isCacheEnabled) {
+        LoongProgramBinaryCache::Store(cacheKey, program, filePath);
+    }
 
     deferDeleteProgram.Cancel();
     return program;
@@ -193,11 +632,8 @@ static GLuint CreateProgram(const std::string& filePath, const std::vector<std::
 
 std::shared_ptr<LoongShader> LoongResourceManager::GetShader(const std::string& path)
 {
-    auto it = gLoadedShaders.find(path);
-    if (it != gLoadedShaders.end()) {
-        auto sp = it->second.lock();
-        assert(sp != nullptr);
-        return sp;
+    if (auto shader = FindResource(gLoadedShaders, gShaderCache, path); shader != nullptr) {
+        return shader;
     }
 
     Asset::LoongShaderCode code(path);
@@ -219,13 +655,15 @@ std::shared_ptr<LoongShader> LoongResourceManager::GetShader(const std::string&
         return nullptr;
     }
     auto* shaderProgram = new LoongShader(program, path);
+    shaderProgram->BindBuiltinUniformBlocks();
     std::shared_ptr<LoongShader> spShaderProgram(shaderProgram, [path](LoongShader* m) {
         gLoadedShaders.erase(path);
         delete m;
     });
     assert(spShaderProgram != nullptr);
 
-    gLoadedShaders.insert({ path, spShaderProgram });
+    spShaderProgram = gShaderCache.Add(path, std::move(spShaderProgram));
+    gLoadedShaders[path] = spShaderProgram;
     LOONG_TRACE("Load shader '{}' succeed", path);
     return spShaderProgram;
 }
@@ -253,6 +691,7 @@ std::shared_ptr<LoongShader> LoongResourceManager::GetRuntimeShader(const LoongR
         return nullptr;
     }
     auto* shaderProgram = new LoongShader(program, "");
+    shaderProgram->BindBuiltinUniformBlocks();
     std::shared_ptr<LoongShader> spShaderProgram(shaderProgram, [rs](LoongShader* m) {
         gLoadedRuntimesShaders.erase(rs);
         delete m;
@@ -266,21 +705,18 @@ std::shared_ptr<LoongShader> LoongResourceManager::GetRuntimeShader(const LoongR
 
 std::shared_ptr<LoongMaterial> LoongResourceManager::GetMaterial(const std::string& path)
 {
-    auto it = gLoadedMaterials.find(path);
-    if (it != gLoadedMaterials.end()) {
-        auto sp = it->second.lock();
-        assert(sp != nullptr);
-        return sp;
+    if (auto material = FindResource(gLoadedMaterials, gMaterialCache, path); material != nullptr) {
+        return material;
     }
 
     LOONG_TRACE("Load material '{}'", path);
-    auto material = LoongMaterialLoader::Create(path, [](const std::string& path) {
+    auto material = gMaterialCache.Add(path, LoongMaterialLoader::Create(path, [](const std::string& path) {
         gLoadedMaterials.erase(path);
         LOONG_TRACE("Unload material '{}'", path);
-    });
+    }));
 
     if (material != nullptr) {
-        gLoadedMaterials.insert({ path, material });
+        gLoadedMaterials[path] = material;
         LOONG_TRACE("Load material '{}' succeed", path);
     } else {
         LOONG_ERROR("Load material '{}' failed", path);
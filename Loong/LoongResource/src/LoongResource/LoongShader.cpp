@@ -57,6 +57,37 @@ void LoongShader::BindUniformBlock(uint32_t uniformBlockIndex, uint32_t bindingP
     glUniformBlockBinding(id_, uniformBlockIndex, bindingPoint);
 }
 
+void LoongShader::BindBuiltinUniformBlocks()
+{
+    // clang-format off
+    static const std::pair<const char*, uint32_t> kBuiltinBlocks[] = {
+        { "BasicUBO",   kBasicUBOBindingPoint },
+        { "LightUBO",   kLightUBOBindingPoint },
+        { "ObjectUBO",  kObjectUBOBindingPoint },
+    };
+    // clang-format on
+    for (auto& [name, bindingPoint] : kBuiltinBlocks) {
+        // Not all the shaders declare all the blocks, so query it directly instead of GetUniformBlockLocation() to avoid error logs
+        if (auto index = glGetUniformBlockIndex(id_, name); index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(id_, index, bindingPoint);
+        }
+    }
+
+    // clang-format off
+    static const std::pair<const char*, uint32_t> kBuiltinSamplers[] = {
+        { "ub_LightBuffer",         kLightBufferTextureUnit },
+        { "ub_ClusterBuffer",       kClusterBufferTextureUnit },
+        { "ub_LightIndexBuffer",    kLightIndexBufferTextureUnit },
+    };
+    // clang-format on
+    for (auto& [name, unit] : kBuiltinSamplers) {
+        if (auto location = glGetUniformLocation(id_, name); location != -1) {
+            LoongGLStateCache::UseProgram(id_);
+            glUniform1i(location, GLint(unit));
+        }
+    }
+}
+
 uint32_t LoongShader::GetUniformLocation(const std::string& name) const
 {
     if (locationCache_.find(name) != locationCache_.end()) {
@@ -3,6 +3,7 @@
 // Copyright (c) 2020 Carl Chen. All rights reserved.
 //
 #include "LoongResource/LoongTexture.h"
+#include "LoongResource/LoongGLStateCache.h"
 
 namespace Loong::Resource {
 
@@ -10,19 +11,19 @@ LoongTexture::~LoongTexture()
 {
     if (0 != id_) {
         glDeleteTextures(1, &id_);
+        LoongGLStateCache::OnTextureDeleted(id_);
         id_ = 0;
     }
 }
 
 void LoongTexture::Bind(uint32_t slot) const
 {
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, id_);
+    LoongGLStateCache::BindTexture(slot, id_);
 }
 
 void LoongTexture::Unbind() const
 {
-    glBindTexture(GL_TEXTURE_2D, 0);
+    LoongGLStateCache::BindTexture(0);
 }
 
 void LoongTexture::Resize(uint32_t width, uint32_t height)
@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongResource/LoongTextureBuffer.h"
+#include "LoongResource/LoongGLStateCache.h"
+
+namespace Loong::Resource {
+
+LoongTextureBuffer::LoongTextureBuffer(GLenum internalFormat)
+{
+    // Allocate some storage, a buffer texture with no storage is not complete
+    uint8_t zeros[16] { 0 };
+    BufferData(zeros, sizeof(zeros));
+
+    glGenTextures(1, &textureId_);
+    LoongGLStateCache::BindTexture(0, GL_TEXTURE_BUFFER, textureId_);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, buffer_.GetID());
+    LoongGLStateCache::BindTexture(0, GL_TEXTURE_BUFFER, 0);
+}
+
+LoongTextureBuffer::~LoongTextureBuffer()
+{
+    if (textureId_ != 0) {
+        glDeleteTextures(1, &textureId_);
+        LoongGLStateCache::OnTextureDeleted(textureId_);
+        textureId_ = 0;
+    }
+}
+
+void LoongTextureBuffer::BufferData(const void* data, size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+    buffer_.BufferData(static_cast<const uint8_t*>(data), size, LoongGpuBufferUsage::kStreamDraw);
+}
+
+void LoongTextureBuffer::Bind(uint32_t unit) const
+{
+    LoongGLStateCache::BindTexture(unit, GL_TEXTURE_BUFFER, textureId_);
+}
+
+}
@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongResource/LoongUniformRingBuffer.h"
+#include "LoongFoundation/LoongLogger.h"
+#include "LoongResource/LoongGLStateCache.h"
+#include <cassert>
+#include <cstring>
+
+namespace Loong::Resource {
+
+LoongUniformRingBuffer::LoongUniformRingBuffer(uint32_t bindingPoint, uint32_t elementSize, uint32_t elementsPerFrame)
+    : bindingPoint_(bindingPoint)
+    , elementSize_(elementSize)
+{
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment <= 0) {
+        alignment = 256;
+    }
+    stride_ = (elementSize_ + uint32_t(alignment) - 1) / uint32_t(alignment) * uint32_t(alignment);
+
+    Reallocate(elementsPerFrame > 0 ? elementsPerFrame : 1);
+}
+
+LoongUniformRingBuffer::~LoongUniformRingBuffer()
+{
+    DeleteFences();
+}
+
+void LoongUniformRingBuffer::DeleteFences()
+{
+    for (auto& fence : fences_) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+}
+
+void LoongUniformRingBuffer::Reallocate(uint32_t elementsPerFrame)
+{
+    // The new storage is not used by the GPU yet
+    DeleteFences();
+    elementsPerFrame_ = elementsPerFrame;
+    buffer_.Bind();
+    // The old storage is orphaned, the draws already issued still read from it
+    glBufferData(GL_UNIFORM_BUFFER, GLsizeiptr(stride_) * elementsPerFrame_ * kFrameCount, nullptr, GL_STREAM_DRAW);
+    buffer_.Unbind();
+}
+
+void LoongUniformRingBuffer::BeginFrame()
+{
+    if (uploadedCount_ > 0) {
+        assert(fences_[frameIndex_] == nullptr);
+        fences_[frameIndex_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    frameIndex_ = (frameIndex_ + 1) % kFrameCount;
+
+    if (auto& fence = fences_[frameIndex_]; fence != nullptr) {
+        constexpr GLuint64 kTimeout = 1000000000; // 1 second, in nanoseconds
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kTimeout);
+        while (result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync(fence, 0, kTimeout);
+        }
+        if (result == GL_WAIT_FAILED) {
+            LOONG_ERROR("Wait for the uniform ring buffer region {} failed", frameIndex_);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    uploadedCount_ = 0;
+    pushedCount_ = 0;
+    staging_.clear();
+}
+
+uint32_t LoongUniformRingBuffer::Push(const void* data)
+{
+    auto offset = staging_.size();
+    staging_.resize(offset + stride_);
+    memcpy(staging_.data() + offset, data, elementSize_);
+    return pushedCount_++;
+}
+
+void LoongUniformRingBuffer::Upload()
+{
+    if (uploadedCount_ == pushedCount_) {
+        return;
+    }
+
+    uint32_t firstSlot = uploadedCount_;
+    if (pushedCount_ > elementsPerFrame_) {
+        uint32_t newElementsPerFrame = elementsPerFrame_;
+        while (newElementsPerFrame < pushedCount_) {
+            newElementsPerFrame *= 2;
+        }
+        LOONG_TRACE("Grow uniform ring buffer from {} to {} elements per frame", elementsPerFrame_, newElementsPerFrame);
+        Reallocate(newElementsPerFrame);
+        // The slots uploaded earlier in this frame are only in the orphaned storage, the draws issued later may still
+        // bind them, so they are uploaded again. The staging memory keeps all the elements of the frame.
+        firstSlot = 0;
+    }
+
+    const GLintptr offset = GLintptr(stride_) * (GLintptr(elementsPerFrame_) * frameIndex_ + firstSlot);
+    const GLsizeiptr size = GLsizeiptr(stride_) * (pushedCount_ - firstSlot);
+    const uint8_t* data = staging_.data() + size_t(stride_) * firstSlot;
+
+    buffer_.Bind();
+    // The GPU passed the fence of this region in BeginFrame(), so there's no need to sync
+    void* mapped = glMapBufferRange(GL_UNIFORM_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (mapped != nullptr) {
+        memcpy(mapped, data, size);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    } else {
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    }
+    buffer_.Unbind();
+
+    uploadedCount_ = pushedCount_;
+}
+
+void LoongUniformRingBuffer::BindSlot(uint32_t slot) const
+{
+    assert(slot < uploadedCount_);
+    const GLintptr offset = GLintptr(stride_) * (GLintptr(elementsPerFrame_) * frameIndex_ + slot);
+    LoongGLStateCache::BindBufferRange(GL_UNIFORM_BUFFER, bindingPoint_, buffer_.GetID(), offset, elementSize_);
+}
+
+}
@@ -9,13 +9,11 @@
 #include "LoongResource/LoongResourceManager.h"
 #include "LoongResource/LoongShader.h"
 #include <rapidjson/document.h>
-#include <rapidjson/istreamwrapper.h>
 #include <rapidjson/ostreamwrapper.h>
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/rapidjson.h>
 #include <sstream>
 #include <string>
-#include <string_view>
 
 namespace Loong::Resource {
 
@@ -90,19 +88,14 @@ std::shared_ptr<LoongMaterial> LoongMaterialLoader::Create(const std::string& fi
 {
     rapidjson::Document root;
     {
-        int64_t fileSize = FS::LoongFileSystem::GetFileSize(filePath);
-        if (fileSize <= 0) {
-            LOONG_ERROR("Failed to load material '{}': Wrong file size", filePath);
+        auto file = FS::LoongFileSystem::MapFile(filePath);
+        if (!file) {
+            LOONG_ERROR("Failed to load material '{}': Open file failed", filePath);
             return nullptr;
         }
-        std::vector<char> buffer(fileSize);
-        assert(FS::LoongFileSystem::LoadFileContent(filePath, buffer.data(), fileSize) == fileSize);
 
-        std::stringstream iss(std::ios::binary | std::ios::in | std::ios::out);
-        iss << std::string_view(buffer.data(), buffer.size());
-
-        rapidjson::IStreamWrapper issw(iss);
-        root.ParseStream(issw);
+        // Parsed in place of the mapped file
+        root.Parse(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
         if (root.HasParseError()) {
             LOONG_ERROR("Parse material file '{}' failed", filePath);
             return nullptr;
@@ -265,7 +258,8 @@ std::shared_ptr<LoongMaterial> LoongMaterialLoader::Create(const std::string& fi
                 material->GetUniformsData()[paramName] = bool(ParseStringToInt(valueString));
             } else if (typeString == "tex2d") {
                 if (!valueString.empty()) {
-                    auto texture = LoongResourceManager::GetTexture(valueString);
+                    // Materials are loaded with the scenes, don't wait for the images
+                    auto texture = LoongResourceManager::GetTextureAsync(valueString);
                     material->GetUniformsData()[paramName] = texture;
                 } else {
                     material->GetUniformsData()[paramName] = TextureRef(nullptr);
@@ -5,6 +5,7 @@
 
 #include "LoongAsset/LoongImage.h"
 #include "LoongFoundation/LoongLogger.h"
+#include "LoongResource/LoongGLStateCache.h"
 #include "LoongResource/LoongTexture.h"
 #include "LoongResource/loader/LoongTextureLoader.h"
 #include <cassert>
@@ -25,19 +26,19 @@ inline GLenum ChannelCountToGLTextureFormat(int count)
     }
 }
 
-std::shared_ptr<LoongTexture> LoongTextureLoader::Create(const Asset::LoongImage& image, bool generateMipmap, const std::function<void(const std::string&)>& onDestroy)
+static GLuint CreateGLTexture(const Asset::LoongImage& image, bool generateMipmap)
 {
     assert(bool(image));
 
     auto imageFormat = ChannelCountToGLTextureFormat(image.GetChannelCount());
     if (imageFormat == -1) {
         LOONG_WARNING("Cannot crate texture from image '{}': Unknown format", image.GetPath());
-        return {};
+        return 0;
     }
 
     GLuint textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    LoongGLStateCache::BindTexture(textureID);
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Disable alignment
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.GetWidth(), image.GetHeight(), 0, imageFormat, GL_UNSIGNED_BYTE, image.GetData());
@@ -52,7 +53,16 @@ std::shared_ptr<LoongTexture> LoongTextureLoader::Create(const Asset::LoongImage
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    LoongGLStateCache::BindTexture(0);
+    return textureID;
+}
+
+std::shared_ptr<LoongTexture> LoongTextureLoader::Create(const Asset::LoongImage& image, bool generateMipmap, const std::function<void(const std::string&)>& onDestroy)
+{
+    GLuint textureID = CreateGLTexture(image, generateMipmap);
+    if (textureID == 0) {
+        return {};
+    }
 
     auto* tex = new LoongTexture(textureID, image.GetWidth(), image.GetHeight(), image.GetChannelCount(), generateMipmap);
     tex->SetPath(image.GetPath());
@@ -66,11 +76,25 @@ std::shared_ptr<LoongTexture> LoongTextureLoader::Create(const Asset::LoongImage
     }
 }
 
+bool LoongTextureLoader::Upload(LoongTexture& texture, const Asset::LoongImage& image, bool generateMipmap)
+{
+    GLuint textureID = CreateGLTexture(image, generateMipmap);
+    if (textureID == 0) {
+        return false;
+    }
+
+    // The old GL texture is deleted with the temporary object
+    LoongTexture uploaded(textureID, image.GetWidth(), image.GetHeight(), image.GetChannelCount(), generateMipmap);
+    texture = std::move(uploaded);
+    texture.SetPath(image.GetPath());
+    return true;
+}
+
 std::shared_ptr<LoongTexture> LoongTextureLoader::CreateColor(uint8_t data[4], bool generateMipmap, const std::function<void(const std::string&)>& onDestroy)
 {
     GLuint textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    LoongGLStateCache::BindTexture(textureID);
 
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 
@@ -86,7 +110,7 @@ std::shared_ptr<LoongTexture> LoongTextureLoader::CreateColor(uint8_t data[4], b
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    LoongGLStateCache::BindTexture(0);
 
     auto* tex = new LoongTexture(textureID, 1, 1, 32, generateMipmap);
     if (onDestroy != nullptr) {
@@ -110,7 +134,7 @@ std::shared_ptr<LoongTexture> LoongTextureLoader::CreateFromMemory(uint8_t* data
     GLuint textureID;
     glGenTextures(1, &textureID);
 
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    LoongGLStateCache::BindTexture(textureID);
 
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, imageFormat, GL_UNSIGNED_BYTE, data);
 
@@ -124,7 +148,7 @@ std::shared_ptr<LoongTexture> LoongTextureLoader::CreateFromMemory(uint8_t* data
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    LoongGLStateCache::BindTexture(0);
 
     auto* tex = new LoongTexture(textureID, width, height, 32, generateMipmap);
     if (onDestroy != nullptr) {
@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2020 Carl Chen. All rights reserved.
+//
+
+#include "LoongResource/LoongResourceCache.h"
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Loong;
+using namespace Loong::Resource;
+
+void TestResourceCacheEvictionOrder();
+
+void TestResourceCacheBudget();
+
+void TestResourceCacheForget();
+
+int main(int argc, const char* argv[])
+{
+    TestResourceCacheEvictionOrder();
+
+    TestResourceCacheBudget();
+
+    TestResourceCacheForget();
+
+    return 0;
+}
+
+struct Blob {
+    std::string name {};
+    LoongResourceSize size {};
+};
+
+LoongResourceSize GetBlobSize(const Blob& blob)
+{
+    return blob.size;
+}
+
+// The destroyed blobs are appended to the list
+std::shared_ptr<Blob> MakeBlob(const std::string& name, LoongResourceSize size, std::vector<std::string>& destroyed)
+{
+    return std::shared_ptr<Blob>(new Blob { name, size }, [&destroyed](Blob* blob) {
+        destroyed.push_back(blob->name);
+        delete blob;
+    });
+}
+
+void TestResourceCacheEvictionOrder()
+{
+    std::vector<std::string> destroyed;
+    LoongResourceCache<std::string, Blob> cache(GetBlobSize);
+    cache.SetBudget({ 30, 0 });
+
+    auto a = cache.Add("a", MakeBlob("a", { 10, 0 }, destroyed));
+    auto b = cache.Add("b", MakeBlob("b", { 10, 0 }, destroyed));
+    auto c = cache.Add("c", MakeBlob("c", { 10, 0 }, destroyed));
+    auto d = cache.Add("d", MakeBlob("d", { 10, 0 }, destroyed));
+    assert(cache.GetStats().missCount == 4);
+
+    // Nothing is released, nothing can be evicted
+    cache.Trim();
+    assert(destroyed.empty());
+    assert(cache.GetStats().retainedCount == 0);
+
+    // A copy still uses it
+    auto copy = b;
+    b = nullptr;
+    assert(cache.GetStats().retainedCount == 0);
+    copy = nullptr;
+    assert(cache.GetStats().retainedCount == 1);
+
+    // Released in the order b, a, d, c. The order of the loads doesn't matter.
+    a = nullptr;
+    d = nullptr;
+    c = nullptr;
+    assert(cache.GetStats().retainedCount == 4);
+    assert(cache.GetStats().retainedCpuBytes == 40);
+    assert(destroyed.empty());
+
+    cache.Trim();
+    assert(destroyed == std::vector<std::string>({ "b" }));
+    assert(cache.GetStats().retainedCount == 3);
+    assert(cache.GetStats().retainedCpuBytes == 30);
+    assert(cache.GetStats().evictionCount == 1);
+
+    // Taken back and released again, it is the most recently released one now
+    a = cache.Acquire("a");
+    assert(a != nullptr && a->name == "a");
+    assert(cache.GetStats().hitCount == 1);
+    assert(cache.GetStats().retainedCount == 2);
+    assert(cache.GetStats().retainedCpuBytes == 20);
+    a = nullptr;
+
+    cache.SetBudget({ 15, 0 });
+    cache.Trim();
+    assert(destroyed == std::vector<std::string>({ "b", "d", "c" }));
+    assert(cache.GetStats().retainedCount == 1);
+    assert(cache.GetStats().evictionCount == 3);
+
+    assert(cache.Acquire("b") == nullptr);
+    assert(cache.GetStats().hitCount == 1);
+
+    // The ones in use stay alive, and come back to the cache later
+    auto e = cache.Add("e", MakeBlob("e", { 10, 0 }, destroyed));
+    cache.Clear();
+    assert(destroyed == std::vector<std::string>({ "b", "d", "c", "a" }));
+    assert(cache.GetStats().retainedCount == 0);
+    assert(cache.GetStats().retainedCpuBytes == 0);
+    e = nullptr;
+    assert(cache.GetStats().retainedCount == 1);
+    cache.Clear();
+    assert(destroyed.back() == "e");
+}
+
+void TestResourceCacheBudget()
+{
+    std::vector<std::string> destroyed;
+    LoongResourceCache<std::string, Blob> cache(GetBlobSize);
+    cache.SetBudget({ 100, 100 });
+
+    // Either budget evicts
+    for (int i = 0; i < 8; ++i) {
+        auto name = std::to_string(i);
+        cache.Add(name, MakeBlob(name, { 1, 20 }, destroyed));
+    }
+    assert(cache.GetStats().retainedCount == 8);
+    assert(cache.GetStats().retainedCpuBytes == 8);
+    assert(cache.GetStats().retainedGpuBytes == 160);
+    cache.Trim();
+    assert(destroyed == std::vector<std::string>({ "0", "1", "2" }));
+    assert(cache.GetStats().retainedGpuBytes == 100);
+
+    // Exactly at the budget is fine
+    cache.Trim();
+    assert(destroyed.size() == 3);
+
+    cache.SetBudget({ 4, 100 });
+    cache.Trim();
+    assert(destroyed.size() == 4);
+    assert(cache.GetStats().retainedCpuBytes == 4);
+    assert(cache.GetStats().retainedGpuBytes == 80);
+
+    // A zero budget keeps nothing that is released
+    cache.SetBudget({ 0, 0 });
+    auto held = cache.Acquire("7");
+    cache.Trim();
+    assert(destroyed.size() == 7);
+    assert(cache.GetStats().retainedCount == 0);
+    held = nullptr;
+    assert(cache.GetStats().retainedCount == 1);
+    cache.Trim();
+    assert(destroyed.size() == 8 && destroyed.back() == "7");
+    assert(cache.GetStats().evictionCount == 8);
+    assert(cache.GetStats().missCount == 8);
+    assert(cache.GetStats().hitCount == 1);
+}
+
+void TestResourceCacheForget()
+{
+    std::vector<std::string> destroyed;
+    LoongResourceCache<std::string, Blob> cache(GetBlobSize);
+    cache.SetBudget({ 100, 100 });
+
+    // The released one is destroyed at once
+    cache.Add("a", MakeBlob("a", { 10, 0 }, destroyed));
+    assert(cache.GetStats().retainedCount == 1);
+    cache.Forget("a");
+    assert(destroyed == std::vector<std::string>({ "a" }));
+    assert(cache.GetStats().retainedCount == 0);
+    assert(cache.Acquire("a") == nullptr);
+
+    // The ones in use are destroyed on release instead of being kept
+    auto b = cache.Add("b", MakeBlob("b", { 10, 0 }, destroyed));
+    auto copy = b;
+    cache.Forget("b");
+    b = nullptr;
+    assert(destroyed.size() == 1);
+    copy = nullptr;
+    assert(destroyed.back() == "b");
+    assert(cache.GetStats().retainedCount == 0);
+
+    // Loaded again, it is cached as usual
+    cache.Add("b", MakeBlob("b2", { 10, 0 }, destroyed));
+    assert(cache.GetStats().retainedCount == 1);
+    auto b2 = cache.Acquire("b");
+    assert(b2 != nullptr && b2->name == "b2");
+    b2 = nullptr;
+    assert(cache.GetStats().retainedCount == 1);
+    cache.Clear();
+    assert(destroyed.size() == 3 && destroyed.back() == "b2");
+}
@@ -18,12 +18,14 @@
 #include "LoongRenderer/LoongCamera.h"
 #include "LoongRenderer/LoongRenderer.h"
 #include "LoongResource/Driver.h"
+#include "LoongResource/LoongGLStateCache.h"
 #include "LoongResource/LoongGpuBuffer.h"
 #include "LoongResource/LoongGpuModel.h"
 #include "LoongResource/LoongMaterial.h"
 #include "LoongResource/LoongResourceManager.h"
 #include "LoongResource/LoongShader.h"
 #include "LoongResource/LoongTexture.h"
+#include "LoongResource/LoongUniformRingBuffer.h"
 #include <imgui.h>
 #include <iostream>
 
@@ -81,6 +83,7 @@ public:
         ImGuizmo::BeginFrame();
 
         clock_.Update();
+        Resource::LoongResourceManager::Update();
 
         auto& input = gApp->GetInputManager();
 
@@ -151,15 +154,18 @@ public:
         int width, height;
         {
             gApp->GetFramebufferSize(width, height);
+            // The app clears the default frame buffer with raw GL calls, so the cached state can't be trusted any more
+            Resource::LoongGLStateCache::Invalidate();
             glEnable(GL_DEPTH_TEST);
             glViewport(0, 0, width, height);
-            glClearColor(clearColor_[0], clearColor_[1], clearColor_[2], clearColor_[3]);
+            renderer_.SetClearColor(clearColor_[0], clearColor_[1], clearColor_[2], clearColor_[3]);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
         }
         auto& cameraActorTransform = cameraComponent_->GetOwner()->GetTransform();
         cameraComponent_->GetCamera().UpdateMatrices(width, height, cameraActorTransform.GetWorldPosition(), cameraActorTransform.GetWorldRotation());
 
-        Core::LoongRenderPass::Context renderContext { &renderer_, &basicUniforms_, &lightUniforms_, scene_.get(), cameraComponent_ };
+        objectUniforms_.BeginFrame();
+        Core::LoongRenderPass::Context renderContext { &renderer_, &basicUniforms_, &lightUniforms_, &objectUniforms_, scene_.get(), cameraComponent_ };
         scenePass_->Render(renderContext);
     }
 
@@ -179,6 +185,7 @@ public:
     Renderer::LoongRenderer renderer_;
     Resource::LoongUniformBuffer basicUniforms_;
     Resource::LoongUniformBuffer lightUniforms_;
+    Resource::LoongUniformRingBuffer objectUniforms_ { Resource::LoongShader::kObjectUBOBindingPoint, sizeof(Core::LoongRenderPass::ObjectUBO) };
 
     std::shared_ptr<Core::LoongScene> scene_ { nullptr };
     Core::LoongCCamera* cameraComponent_ { nullptr };
@@ -192,9 +199,13 @@ void StartApp()
     config.title = "Play Ground";
     gApp = std::make_shared<Loong::App::LoongApp>(config);
 
-    Loong::LoongEditor myApp;
+    {
+        Loong::LoongEditor myApp;
 
-    gApp->Run();
+        gApp->Run();
+    }
+    // The cached resources own GL objects, release them while the context is still alive
+    Loong::Resource::LoongResourceManager::ClearCache();
 
     gApp = nullptr;
 }
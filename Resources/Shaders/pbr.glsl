@@ -3,19 +3,23 @@
 
 layout (location = 0) in vec3 v_Pos;
 layout (location = 1) in vec2 v_Uv;
-layout (location = 2) in vec3 v_Normal;
-layout (location = 3) in vec3 v_Tan;
-layout (location = 4) in vec3 v_BiTan;
+layout (location = 2) in vec2 v_Normal; // octahedral encoded
+layout (location = 3) in vec4 v_Tan; // octahedral encoded in xy, z is the handedness of the bitangent
 
 layout (std140) uniform BasicUBO
 {
-    mat4    ub_Model;
     mat4    ub_View;
     mat4    ub_Projection;
     vec3    ub_ViewPos;
     float   ub_Time;
 };
 
+layout (std140) uniform ObjectUBO
+{
+    mat4    ub_Model;
+    mat4    ub_NormalMatrix;
+};
+
 out VS_OUT
 {
     vec2 Uv;
@@ -25,16 +29,30 @@ out VS_OUT
     mat3 TBN;
 } vs_out;
 
+vec3 OctDecode(vec2 e)
+{
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
 void main()
 {
-    vec3 T = normalize(vec3(ub_Model * vec4(v_Tan,   0.0)));
-    vec3 B = normalize(vec3(ub_Model * vec4(v_BiTan, 0.0)));
-    vec3 N = normalize(vec3(ub_Model * vec4(v_Normal,0.0)));
+    mat4 model = ub_Model;
+    mat3 normalMatrix = mat3(ub_NormalMatrix);
+    vec3 normal = OctDecode(v_Normal);
+    vec3 tangent = OctDecode(v_Tan.xy);
+    vec3 bitangent = cross(normal, tangent) * (v_Tan.z < 0.0 ? -1.0 : 1.0);
+    vec3 T = normalize(vec3(model * vec4(tangent,   0.0)));
+    vec3 B = normalize(vec3(model * vec4(bitangent, 0.0)));
+    vec3 N = normalize(vec3(model * vec4(normal,    0.0)));
 
     vs_out.Uv = v_Uv;
     vs_out.TBN = mat3(T, B, N);
-    vs_out.WorldNormal = normalize(mat3(transpose(inverse(ub_Model))) * v_Normal.xyz);
-    vs_out.WorldPos = ub_Model * vec4(v_Pos, 1.0);
+    vs_out.WorldNormal = normalize(normalMatrix * normal);
+    vs_out.WorldPos = model * vec4(v_Pos, 1.0);
     vs_out.CameraPos = ub_ViewPos;
     gl_Position = ub_Projection * ub_View * vs_out.WorldPos;
 }
@@ -42,7 +60,6 @@ void main()
 #shader fragment
 #version 330 core
 
-#define MAX_LIGHT_COUNT 32
 #define PI 3.141592653589793238
 
 // material
@@ -122,13 +139,61 @@ struct Light {
     // float   padding1_[2];
 };
 
+layout (std140) uniform BasicUBO
+{
+    mat4    ub_View;
+    mat4    ub_Projection;
+    vec3    ub_ViewPos;
+    float   ub_Time;
+};
+
 layout (std140) uniform LightUBO
 {
-    float   ub_lightsCount;
-    //float   padding1_[3];// align to vec4
-    Light   ub_lights[MAX_LIGHT_COUNT];
+    vec4    ub_ClusterGrid;     // xyz: cluster count along each axis, w: directional light count
+    vec4    ub_ClusterDepth;    // x: near, y: far, slice = log(depth) * z + w
 };
 
+// 4 texels (a Light) per light, the directional lights come first
+uniform samplerBuffer   ub_LightBuffer;
+// Per cluster, x: offset of its first light index in ub_LightIndexBuffer, y: light count
+uniform usamplerBuffer  ub_ClusterBuffer;
+uniform usamplerBuffer  ub_LightIndexBuffer;
+
+Light FetchLight(int index)
+{
+    vec4 t0 = texelFetch(ub_LightBuffer, index * 4);
+    vec4 t1 = texelFetch(ub_LightBuffer, index * 4 + 1);
+    vec4 t2 = texelFetch(ub_LightBuffer, index * 4 + 2);
+    vec4 t3 = texelFetch(ub_LightBuffer, index * 4 + 3);
+
+    Light light;
+    light.pos = t0.xyz;
+    light.lightType = t0.w;
+    light.dir = t1.xyz;
+    light.falloffRadius = t1.w;
+    light.color = t2.xyz;
+    light.intencity = t2.w;
+    light.innerAngle = t3.x;
+    light.outerAngle = t3.y;
+    return light;
+}
+
+// Returns the light list of the cluster that contains worldPos
+uvec2 FetchCluster(vec3 worldPos)
+{
+    vec4 viewPos = ub_View * vec4(worldPos, 1.0);
+    vec4 clipPos = ub_Projection * viewPos;
+    ivec3 grid = ivec3(ub_ClusterGrid.xyz);
+
+    vec2 screen = clamp(clipPos.xy / clipPos.w * 0.5 + 0.5, 0.0, 1.0);
+    int x = min(int(screen.x * grid.x), grid.x - 1);
+    int y = min(int(screen.y * grid.y), grid.y - 1);
+    float depth = max(-viewPos.z, ub_ClusterDepth.x);
+    int z = clamp(int(log(depth) * ub_ClusterDepth.z + ub_ClusterDepth.w), 0, grid.z - 1);
+
+    return texelFetch(ub_ClusterBuffer, x + grid.x * (y + grid.y * z)).xy;
+}
+
 // a = remapped roughness
 //                               a*a
 // D_GGX(h, a) = ------------------------------------
@@ -380,29 +445,26 @@ void main()
 
     vec3 Lo = vec3(0.0, 0.0, 0.0);
 
-    for (int i = 0; i < ub_lightsCount; ++i) {
-        Light light = ub_lights[i];
-        if (light.lightType == 0) {
-            // directional
-            vec3 l = normalize(light.dir);
-            Lo += ComputeLight(l, n, v, light, uv, material);
-        } else if (light.lightType == 1) {
-            // point
-            vec3 posToLight = light.pos - worldPos;
-            vec3 l = normalize(posToLight);
-            vec3 contrib = ComputeLight(l, n, v, light, uv, material);
-            float attenuation = getSquareFalloffAttenuation(posToLight, light.falloffRadius);
-            Lo += contrib * attenuation;
-        } else {
+    int directionalLightCount = int(ub_ClusterGrid.w);
+    for (int i = 0; i < directionalLightCount; ++i) {
+        Light light = FetchLight(i);
+        vec3 l = normalize(light.dir);
+        Lo += ComputeLight(l, n, v, light, uv, material);
+    }
+
+    // point and spot lights, only those which may reach the cluster of this fragment
+    uvec2 cluster = FetchCluster(worldPos);
+    for (uint i = 0u; i < cluster.y; ++i) {
+        Light light = FetchLight(int(texelFetch(ub_LightIndexBuffer, int(cluster.x + i)).r));
+        vec3 posToLight = light.pos - worldPos;
+        vec3 l = normalize(posToLight);
+        vec3 contrib = ComputeLight(l, n, v, light, uv, material);
+        float attenuation = getSquareFalloffAttenuation(posToLight, light.falloffRadius);
+        if (light.lightType == 2) {
             // spot
-            vec3 posToLight = light.pos - worldPos;
-            vec3 lightDir = normalize(light.dir);
-            vec3 l = normalize(posToLight);
-            vec3 contrib = ComputeLight(l, n, v, light, uv, material);
-            float attenuation = getSquareFalloffAttenuation(posToLight, light.falloffRadius);
-            attenuation *= getSpotAngleAttenuation(l, lightDir, light.innerAngle, light.outerAngle);
-            Lo += contrib * attenuation;
+            attenuation *= getSpotAngleAttenuation(l, normalize(light.dir), light.innerAngle, light.outerAngle);
         }
+        Lo += contrib * attenuation;
     }
 #ifdef USE_EMISSIVE
     Lo += material.emissive * material.emissiveFactor;
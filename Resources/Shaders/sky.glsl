@@ -5,7 +5,6 @@ layout (location = 0) in vec3 v_Pos;
 
 layout (std140) uniform BasicUBO
 {
-    mat4    ub_Model;
     mat4    ub_View;
     mat4    ub_Projection;
     vec3    ub_ViewPos;
@@ -3,17 +3,22 @@
 
 layout (location = 0) in vec3 v_Pos;
 layout (location = 1) in vec2 v_Uv;
-layout (location = 2) in vec3 v_Normal;
+layout (location = 2) in vec2 v_Normal; // octahedral encoded
 
 layout (std140) uniform BasicUBO
 {
-    mat4    ub_Model;
     mat4    ub_View;
     mat4    ub_Projection;
     vec3    ub_ViewPos;
     float   ub_Time;
 };
 
+layout (std140) uniform ObjectUBO
+{
+    mat4    ub_Model;
+    mat4    ub_NormalMatrix;
+};
+
 out VS_OUT
 {
     vec2 Uv;
@@ -5,13 +5,18 @@ layout (location = 0) in vec3 v_Pos;
 
 layout (std140) uniform BasicUBO
 {
-    mat4    ub_Model;
     mat4    ub_View;
     mat4    ub_Projection;
     vec3    ub_ViewPos;
     float   ub_Time;
 };
 
+layout (std140) uniform ObjectUBO
+{
+    mat4    ub_Model;
+    mat4    ub_NormalMatrix;
+};
+
 void main()
 {
     gl_Position = ub_Projection * ub_View * ub_Model * vec4(v_Pos, 1.0);